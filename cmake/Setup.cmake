@@ -48,6 +48,8 @@ option(SPOAC_BUILD_SERVICES "Enables compilation of all IceBox services" ON)
 option(SPOAC_BUILD_JAVA     "Enables compilation of all Java interfaces and components" ON)
 option(SPOAC_BUILD_PYTHON   "Enables compilation of all Python interfaces and components" ON)
 option(SPOAC_BUILD_TESTS    "Enables compilation of all tests" ON)
+option(SPOAC_BUILD_BENCHMARKS "Enables compilation of all benchmarks" ON)
+option(SPOAC_BUILD_FUZZERS  "Enables compilation of libFuzzer targets, requires clang" OFF)
 option(SPOAC_BUILD_EXAMPLES "Enables compilation of all examples" ON)
 option(SPOAC_BUILD_XML      "Enables generation of XML file for IceGrid" ON)
 
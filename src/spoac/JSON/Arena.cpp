@@ -0,0 +1,112 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "Arena.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+using namespace JSON;
+
+// all allocations are aligned for the largest scalar stored in a document
+static const size_t ALIGNMENT = 8;
+
+static inline size_t alignSize(size_t size)
+{
+	return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+Arena::Arena(size_t blockSize) :
+	blocks(NULL),
+	position(NULL),
+	end(NULL),
+	blockSize(blockSize),
+	memoryUsage(0)
+{
+}
+
+Arena::~Arena()
+{
+	clear();
+}
+
+void* Arena::allocate(size_t size)
+{
+	size = alignSize(size);
+
+	if ((size_t) (end - position) < size)
+	{
+		addBlock(size);
+	}
+
+	void* result = position;
+	position += size;
+
+	return result;
+}
+
+const char* Arena::copyString(const char* data, size_t len)
+{
+	char* copy = static_cast<char*>(allocate(len + 1));
+
+	memcpy(copy, data, len);
+	copy[len] = 0;
+
+	return copy;
+}
+
+void Arena::clear()
+{
+	while (blocks != NULL)
+	{
+		Block* next = blocks->next;
+		free(blocks);
+		blocks = next;
+	}
+
+	position = NULL;
+	end = NULL;
+	memoryUsage = 0;
+}
+
+size_t Arena::getMemoryUsage() const
+{
+	return memoryUsage;
+}
+
+void Arena::addBlock(size_t minSize)
+{
+	// oversized requests get a block of their own
+	size_t size = (minSize > blockSize) ? minSize : blockSize;
+	size_t header = alignSize(sizeof(Block));
+
+	Block* block = static_cast<Block*>(malloc(header + size));
+
+	if (block == NULL)
+	{
+		throw std::bad_alloc();
+	}
+
+	block->next = blocks;
+	block->size = size;
+	blocks = block;
+
+	position = reinterpret_cast<char*>(block) + header;
+	end = position + size;
+	memoryUsage += header + size;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <stddef.h>
+
+namespace JSON
+{
+	/**
+	* A simple bump allocator.
+	*
+	* Memory is handed out from large blocks by advancing a pointer. There
+	* is no way to release a single allocation, all memory is released at
+	* once when the arena is cleared or destroyed. Destructors of objects
+	* placed in the arena are never run, so only trivially destructible
+	* data must be stored in it.
+	*/
+	class Arena
+	{
+	public:
+		Arena(size_t blockSize = 8192);
+		~Arena();
+
+		void* allocate(size_t size);
+		const char* copyString(const char* data, size_t len);
+		void clear();
+		size_t getMemoryUsage() const;
+	private:
+		Arena(const Arena&) {}; // do not allow copying
+		Arena& operator=(const Arena&) { return *this; }; // do not allow assignment
+
+		struct Block
+		{
+			Block* next;
+			size_t size;
+		};
+
+		void addBlock(size_t minSize);
+
+		Block* blocks;
+		char* position;
+		char* end;
+
+		size_t blockSize;
+		size_t memoryUsage;
+	};
+}
+
+#endif
@@ -30,6 +30,14 @@ Array::Array(const Array& a) :
 {
 }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+Array::Array(Array&& a) :
+	Value(a),
+	vector(std::move(a.vector))
+{
+}
+#endif
+
 bool Array::empty() const
 {
 	return vector.empty();
@@ -85,6 +93,19 @@ Array& Array::operator=(const Array& a)
 	return *this;
 }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+Array& Array::operator=(Array&& a)
+{
+	vector = std::move(a.vector);
+	return *this;
+}
+#endif
+
+void Array::swap(Array& a)
+{
+	vector.swap(a.vector);
+}
+
 Array::value_type& Array::front()
 {
 	return vector.front();
@@ -127,7 +148,14 @@ Array::const_iterator Array::end() const
 
 void Array::push_back(Array::value_type value)
 {
-	vector.push_back(value);
+	// swapped into place, saving a reference count update for a copy
+	vector.push_back(value_type());
+	vector.back().swap(value);
+}
+
+void Array::reserve(size_t n)
+{
+	vector.reserve(n);
 }
 
 void Array::pop_back()
@@ -165,34 +193,3 @@ const Array& Array::toArray() const
 {
 	return *this;
 }
-
-void Array::_toJSON(std::string& json, const std::string& indent) const
-{
-	std::string subindent = indent;
-	subindent.append("\t");
-
-	if (!empty())
-	{
-		json.append("[\n");
-		json.append(subindent);
-
-		for (Array::const_iterator it = begin(); it != end(); ++it)
-		{
-			if (it != begin())
-			{
-				json.append(",\n");
-				json.append(subindent);
-			}
-
-			(*it)->_toJSON(json, subindent);
-		}
-
-		json.append("\n");
-		json.append(indent);
-		json.append("]");
-	}
-	else
-	{
-		json.append("[]");
-	}
-}
@@ -19,6 +19,7 @@
 
 #include "Value.h"
 #include <vector>
+#include <boost/make_shared.hpp>
 
 namespace JSON
 {
@@ -34,6 +35,10 @@ namespace JSON
 	* stored by the array are deleted. Following this behaviour erase()
 	* deletes the value as well. So make sure you copy data if you wish to
 	* continue using it after destructing the array.
+	*
+	* Copying an array copies the pointers to all its values, swap()
+	* exchanges them instead. C++11 builds can also move arrays and
+	* emplace_back() new values.
 	*/
 	class Array : public Value
 	{
@@ -46,6 +51,9 @@ namespace JSON
 
 		Array();
 		Array(const Array& a);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+		Array(Array&& a);
+#endif
 
 		size_t size() const;
 		bool empty() const;
@@ -53,6 +61,10 @@ namespace JSON
 		const_value_type at(size_t pos) const;
 		value_type& operator[](const size_t pos);
 		Array& operator=(const Array& a);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+		Array& operator=(Array&& a);
+#endif
+		void swap(Array& a);
 		value_type& front();
 		value_type& back();
 		const_value_type front() const;
@@ -62,6 +74,17 @@ namespace JSON
 		const_iterator begin() const;
 		const_iterator end() const;
 		void push_back(value_type value);
+#ifndef BOOST_NO_CXX11_VARIADIC_TEMPLATES
+		/**
+		* Appends a new value of type T constructed from the arguments.
+		*/
+		template <class T, class... Args>
+		void emplace_back(Args&&... args)
+		{
+			vector.push_back(boost::make_shared<T>(std::forward<Args>(args)...));
+		}
+#endif
+		void reserve(size_t n);
 		void pop_back();
 		void insert(size_t index, value_type value);
 		void insert(iterator it, value_type value);
@@ -69,7 +92,6 @@ namespace JSON
 		void erase(iterator it);
 		Array& toArray();
 		const Array& toArray() const;
-		void _toJSON(std::string& json, const std::string& indent) const;
 	private:
 		vector_type vector;
 	};
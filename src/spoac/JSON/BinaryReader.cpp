@@ -0,0 +1,374 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "BinaryReader.h"
+#include "Document.h"
+#include "Number.h"
+
+#include <math.h>
+#include <sstream>
+#include <string.h>
+#include <limits>
+
+using namespace JSON;
+
+BinaryReader::BinaryReader() :
+	handler(&valueBuilder)
+{
+}
+
+BinaryReader::BinaryReader(Document& document) :
+	documentBuilder(new DocumentBuilder(document))
+{
+	handler = documentBuilder.get();
+}
+
+BinaryReader::BinaryReader(Handler& handler) :
+	handler(&handler)
+{
+}
+
+ValuePtr BinaryReader::read(const std::string& data)
+{
+	return read(data.data(), data.size());
+}
+
+ValuePtr BinaryReader::read(const char* data, size_t len)
+{
+	this->data = data;
+	this->len = len;
+	pos = 0;
+	done = false;
+	frames.clear();
+	valueBuilder.reset();
+
+	if (documentBuilder)
+	{
+		documentBuilder->reset();
+	}
+
+	while (true)
+	{
+		// definite length containers end after their last item
+		while (!frames.empty() && !frames.back().indefinite &&
+			frames.back().remaining == 0 && (!frames.back().object || frames.back().key))
+		{
+			endContainer();
+		}
+
+		if (done)
+		{
+			break;
+		}
+
+		uint8_t initial = readByte();
+		uint8_t major = initial >> 5;
+		uint8_t info = initial & 0x1f;
+
+		bool key = !frames.empty() && frames.back().object && frames.back().key;
+
+		if (initial == 0xff)
+		{
+			if (frames.empty() || !frames.back().indefinite || (frames.back().object && !key))
+			{
+				error("Unexpected break");
+			}
+
+			endContainer();
+			continue;
+		}
+
+		switch (major)
+		{
+			case 0:
+			case 1:
+			{
+				uint64_t argument = readArgument(info);
+				Number n;
+
+				if (argument <= (uint64_t) std::numeric_limits<int64_t>::max())
+				{
+					// the negative value is -1 - argument
+					n = Number((major == 0) ? (int64_t) argument : -1 - (int64_t) argument);
+				}
+				else
+				{
+					n = Number((major == 0) ? (double) argument : -1.0 - (double) argument);
+				}
+
+				if (key)
+				{
+					handler->onKey(n);
+				}
+				else
+				{
+					handler->onNumber(n);
+				}
+			}
+			break;
+
+			case 3:
+			{
+				if (info == 31)
+				{
+					error("Indefinite length strings are not supported");
+				}
+
+				uint64_t length = readArgument(info);
+
+				if (length > len - pos)
+				{
+					error("Unexpected end of binary data");
+				}
+
+				stringBuffer.assign(data + pos, length);
+				pos += length;
+
+				if (key)
+				{
+					handler->onKey(stringBuffer);
+				}
+				else
+				{
+					handler->onString(stringBuffer);
+				}
+			}
+			break;
+
+			case 4:
+			case 5:
+			{
+				if (key)
+				{
+					error("Containers cannot be used as keys");
+				}
+
+				Frame frame;
+				frame.object = (major == 5);
+				frame.indefinite = (info == 31);
+				frame.remaining = (frame.indefinite) ? 0 : readArgument(info);
+				frame.key = true;
+				frames.push_back(frame);
+
+				if (frame.object)
+				{
+					handler->onObjectStart();
+				}
+				else
+				{
+					handler->onArrayStart();
+				}
+			}
+			continue;
+
+			case 6:
+				// tags, like the self-describe tag, only annotate the next item
+				readArgument(info);
+			continue;
+
+			case 7:
+				if (info >= 25 && info <= 27)
+				{
+					Number n(readFloat(info));
+
+					if (key)
+					{
+						handler->onKey(n);
+					}
+					else
+					{
+						handler->onNumber(n);
+					}
+				}
+				else if (key)
+				{
+					error("Object keys must be strings or numbers");
+				}
+				else if (info == 20 || info == 21)
+				{
+					handler->onBool(info == 21);
+				}
+				else if (info == 22 || info == 23)
+				{
+					handler->onNull();
+				}
+				else
+				{
+					error("Unsupported simple value");
+				}
+			break;
+
+			default:
+				error("Byte strings are not supported");
+			break;
+		}
+
+		itemDone();
+	}
+
+	if (pos != len)
+	{
+		error("Unexpected data after binary value");
+	}
+
+	ValuePtr result = valueBuilder.getResult();
+
+	if (documentBuilder)
+	{
+		documentBuilder->finish();
+	}
+
+	valueBuilder.reset();
+
+	return result;
+}
+
+bool BinaryReader::isBinary(const std::string& data)
+{
+	return isBinary(data.data(), data.size());
+}
+
+bool BinaryReader::isBinary(const char* data, size_t len)
+{
+	// the self-describe tag, no JSON text starts with byte 0xd9
+	return len >= 3 &&
+		(uint8_t) data[0] == 0xd9 &&
+		(uint8_t) data[1] == 0xd9 &&
+		(uint8_t) data[2] == 0xf7;
+}
+
+inline uint8_t BinaryReader::readByte()
+{
+	if (pos >= len)
+	{
+		error("Unexpected end of binary data");
+	}
+
+	return (uint8_t) data[pos++];
+}
+
+uint64_t BinaryReader::readArgument(uint8_t info)
+{
+	if (info < 24)
+	{
+		return info;
+	}
+
+	if (info > 27)
+	{
+		error("Invalid additional information");
+	}
+
+	size_t bytes = 1 << (info - 24);
+	uint64_t argument = 0;
+
+	for (size_t i = 0; i < bytes; i++)
+	{
+		argument = (argument << 8) | readByte();
+	}
+
+	return argument;
+}
+
+double BinaryReader::readFloat(uint8_t info)
+{
+	uint64_t bits = readArgument(info);
+
+	if (info == 25)
+	{
+		int exponent = (bits >> 10) & 0x1f;
+		int mantissa = bits & 0x3ff;
+		double value;
+
+		if (exponent == 0)
+		{
+			value = ldexp((double) mantissa, -24);
+		}
+		else if (exponent != 31)
+		{
+			value = ldexp((double) (mantissa + 1024), exponent - 25);
+		}
+		else
+		{
+			value = (mantissa == 0) ?
+				std::numeric_limits<double>::infinity() :
+				std::numeric_limits<double>::quiet_NaN();
+		}
+
+		return (bits & 0x8000) ? -value : value;
+	}
+
+	if (info == 26)
+	{
+		uint32_t floatBits = (uint32_t) bits;
+		float value;
+		memcpy(&value, &floatBits, sizeof(value));
+		return value;
+	}
+
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+void BinaryReader::endContainer()
+{
+	if (frames.back().object)
+	{
+		handler->onObjectEnd();
+	}
+	else
+	{
+		handler->onArrayEnd();
+	}
+
+	frames.pop_back();
+	itemDone();
+}
+
+void BinaryReader::itemDone()
+{
+	if (frames.empty())
+	{
+		done = true;
+		return;
+	}
+
+	Frame& frame = frames.back();
+
+	if (frame.object)
+	{
+		frame.key = !frame.key;
+
+		// a member is complete after its value
+		if (frame.key && !frame.indefinite)
+		{
+			frame.remaining--;
+		}
+	}
+	else if (!frame.indefinite)
+	{
+		frame.remaining--;
+	}
+}
+
+void BinaryReader::error(const std::string& message)
+{
+	std::ostringstream s;
+	s << message << " at byte " << pos;
+	throw ParserException(s.str(), 0);
+}
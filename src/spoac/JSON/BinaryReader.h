@@ -0,0 +1,96 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JSON_BINARYREADER_H
+#define JSON_BINARYREADER_H
+
+#include "DocumentBuilder.h"
+#include "Handler.h"
+#include "ParserException.h"
+#include "ValueBuilder.h"
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+
+namespace JSON
+{
+	class Document;
+
+	/**
+	* Decodes the CBOR produced by a BinaryWriter and reports its structure
+	* to a Handler, by default constructing a JSON::Value from it.
+	*
+	* Like a Parser a reader can instead build the values inside a
+	* Document or only emit events to a custom Handler, in which case
+	* read() returns an empty ValuePtr. Unlike a Parser it reads a complete
+	* buffer in one call. Definite and indefinite length arrays and maps
+	* as well as tags are accepted, CBOR types without a JSON counterpart
+	* like byte strings are not. Undefined values are read as null.
+	* Malformed data raises a ParserException.
+	*/
+	class BinaryReader
+	{
+	public:
+		BinaryReader();
+		BinaryReader(Document& document);
+		BinaryReader(Handler& handler);
+
+		ValuePtr read(const std::string& data);
+		ValuePtr read(const char* data, size_t len);
+
+		static bool isBinary(const std::string& data);
+		static bool isBinary(const char* data, size_t len);
+	private:
+		BinaryReader(const BinaryReader&) {}; // do not allow copying
+		BinaryReader& operator=(const BinaryReader&) { return *this; }; // do not allow assignment
+
+		struct Frame
+		{
+			bool object;
+			bool indefinite;
+			// items left in a definite array, members in a definite map
+			uint64_t remaining;
+			// the next item of a map is a key
+			bool key;
+		};
+
+		inline uint8_t readByte();
+		uint64_t readArgument(uint8_t info);
+		double readFloat(uint8_t info);
+		void endContainer();
+		void itemDone();
+		void error(const std::string& message);
+
+		Handler* handler;
+		ValueBuilder valueBuilder;
+		boost::shared_ptr<DocumentBuilder> documentBuilder;
+
+		std::vector<Frame> frames;
+		std::string stringBuffer;
+
+		const char* data;
+		size_t len;
+		size_t pos;
+
+		// the top level value is complete
+		bool done;
+	};
+}
+
+#endif
@@ -0,0 +1,405 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "BinaryWriter.h"
+#include "AllValueTypes.h"
+#include "DocumentValue.h"
+#include "DocumentArray.h"
+#include "DocumentObject.h"
+
+#include <string.h>
+
+using namespace JSON;
+
+// major types
+static const uint8_t CBOR_UNSIGNED = 0;
+static const uint8_t CBOR_NEGATIVE = 1;
+static const uint8_t CBOR_TEXT = 3;
+static const uint8_t CBOR_ARRAY = 4;
+static const uint8_t CBOR_MAP = 5;
+
+// simple values and the other initial bytes used
+static const char CBOR_FALSE = (char) 0xf4;
+static const char CBOR_TRUE = (char) 0xf5;
+static const char CBOR_NULL = (char) 0xf6;
+static const char CBOR_UNDEFINED = (char) 0xf7;
+static const char CBOR_FLOAT = (char) 0xfa;
+static const char CBOR_DOUBLE = (char) 0xfb;
+static const char CBOR_INDEFINITE_ARRAY = (char) 0x9f;
+static const char CBOR_INDEFINITE_MAP = (char) 0xbf;
+static const char CBOR_BREAK = (char) 0xff;
+
+// tag 55799, marks the data as CBOR
+static const char selfDescribeTag[] = { (char) 0xd9, (char) 0xd9, (char) 0xf7 };
+
+BinaryWriter::BinaryWriter() :
+	data(&buffer),
+	depth(0)
+{
+}
+
+BinaryWriter::BinaryWriter(std::string& data) :
+	data(&data),
+	depth(0)
+{
+}
+
+void BinaryWriter::write(const Value& value)
+{
+	beforeValue();
+	encode(value);
+}
+
+void BinaryWriter::write(const DocumentValue& value)
+{
+	beforeValue();
+	encode(value);
+}
+
+void BinaryWriter::onNull()
+{
+	beforeValue();
+	data->push_back(CBOR_NULL);
+}
+
+void BinaryWriter::onBool(bool b)
+{
+	beforeValue();
+	data->push_back((b) ? CBOR_TRUE : CBOR_FALSE);
+}
+
+void BinaryWriter::onNumber(const Number& n)
+{
+	beforeValue();
+	appendNumber(n);
+}
+
+void BinaryWriter::onNumber(int64_t n)
+{
+	beforeValue();
+	appendInt(n);
+}
+
+void BinaryWriter::onNumber(double n)
+{
+	beforeValue();
+	appendDouble(n);
+}
+
+void BinaryWriter::onString(const std::string& s)
+{
+	beforeValue();
+	appendString(s.data(), s.size());
+}
+
+void BinaryWriter::onString(const char* data, size_t length)
+{
+	beforeValue();
+	appendString(data, length);
+}
+
+void BinaryWriter::onKey(const std::string& key)
+{
+	appendString(key.data(), key.size());
+}
+
+void BinaryWriter::onKey(const char* data, size_t length)
+{
+	appendString(data, length);
+}
+
+void BinaryWriter::onKey(const Number& key)
+{
+	appendNumber(key);
+}
+
+void BinaryWriter::onArrayStart()
+{
+	beforeValue();
+	data->push_back(CBOR_INDEFINITE_ARRAY);
+	depth++;
+}
+
+void BinaryWriter::onArrayEnd()
+{
+	data->push_back(CBOR_BREAK);
+	depth--;
+}
+
+void BinaryWriter::onObjectStart()
+{
+	beforeValue();
+	data->push_back(CBOR_INDEFINITE_MAP);
+	depth++;
+}
+
+void BinaryWriter::onObjectEnd()
+{
+	data->push_back(CBOR_BREAK);
+	depth--;
+}
+
+void BinaryWriter::onStringReference(const char* data, size_t length)
+{
+	onString(data, length);
+}
+
+void BinaryWriter::onKeyReference(const char* data, size_t length)
+{
+	onKey(data, length);
+}
+
+const std::string& BinaryWriter::getBuffer() const
+{
+	return buffer;
+}
+
+void BinaryWriter::clear()
+{
+	data->clear();
+	depth = 0;
+}
+
+inline void BinaryWriter::beforeValue()
+{
+	if (depth == 0)
+	{
+		data->append(selfDescribeTag, sizeof(selfDescribeTag));
+	}
+}
+
+inline void BinaryWriter::appendHead(uint8_t major, uint64_t argument)
+{
+	char head[9];
+	size_t length;
+	major <<= 5;
+
+	if (argument < 24)
+	{
+		head[0] = (char) (major | argument);
+		length = 1;
+	}
+	else if (argument <= 0xff)
+	{
+		head[0] = (char) (major | 24);
+		head[1] = (char) argument;
+		length = 2;
+	}
+	else if (argument <= 0xffff)
+	{
+		head[0] = (char) (major | 25);
+		head[1] = (char) (argument >> 8);
+		head[2] = (char) argument;
+		length = 3;
+	}
+	else if (argument <= 0xffffffffULL)
+	{
+		head[0] = (char) (major | 26);
+		for (int i = 0; i < 4; i++)
+		{
+			head[1 + i] = (char) (argument >> (24 - 8 * i));
+		}
+		length = 5;
+	}
+	else
+	{
+		head[0] = (char) (major | 27);
+		for (int i = 0; i < 8; i++)
+		{
+			head[1 + i] = (char) (argument >> (56 - 8 * i));
+		}
+		length = 9;
+	}
+
+	data->append(head, length);
+}
+
+void BinaryWriter::appendNumber(const Number& n)
+{
+	if (n.isExactInt())
+	{
+		appendInt(n.toInt());
+	}
+	else
+	{
+		appendDouble(n.toDouble());
+	}
+}
+
+void BinaryWriter::appendInt(int64_t n)
+{
+	if (n >= 0)
+	{
+		appendHead(CBOR_UNSIGNED, (uint64_t) n);
+	}
+	else
+	{
+		// -1 - n without overflowing for the smallest int64_t
+		appendHead(CBOR_NEGATIVE, ~(uint64_t) n);
+	}
+}
+
+void BinaryWriter::appendDouble(double n)
+{
+	float f = (float) n;
+
+	if ((double) f == n)
+	{
+		uint32_t bits;
+		memcpy(&bits, &f, sizeof(bits));
+
+		data->push_back(CBOR_FLOAT);
+		for (int i = 0; i < 4; i++)
+		{
+			data->push_back((char) (bits >> (24 - 8 * i)));
+		}
+	}
+	else
+	{
+		uint64_t bits;
+		memcpy(&bits, &n, sizeof(bits));
+
+		data->push_back(CBOR_DOUBLE);
+		for (int i = 0; i < 8; i++)
+		{
+			data->push_back((char) (bits >> (56 - 8 * i)));
+		}
+	}
+}
+
+void BinaryWriter::appendString(const char* data, size_t length)
+{
+	appendHead(CBOR_TEXT, length);
+	this->data->append(data, length);
+}
+
+void BinaryWriter::encode(const Value& value)
+{
+	switch (value.getType())
+	{
+		case NULLTYPE:
+			// placeholders created by Object::operator[] and the like
+			data->push_back((value.isNull()) ? CBOR_NULL : CBOR_UNDEFINED);
+		break;
+
+		case BOOL:
+			data->push_back((value.toBool()) ? CBOR_TRUE : CBOR_FALSE);
+		break;
+
+		case NUMBER:
+			appendNumber(static_cast<const Number&>(value));
+		break;
+
+		case STRING:
+			appendString(value.toString().data(), value.toString().size());
+		break;
+
+		case ARRAY:
+		{
+			const Array& array = value.toArray();
+			appendHead(CBOR_ARRAY, array.size());
+
+			for (Array::const_iterator it = array.begin(); it != array.end(); ++it)
+			{
+				if (*it)
+				{
+					encode(**it);
+				}
+				else
+				{
+					data->push_back(CBOR_NULL);
+				}
+			}
+		}
+		break;
+
+		case OBJECT:
+		{
+			const Object& object = value.toObject();
+			appendHead(CBOR_MAP, object.size());
+
+			for (Object::const_iterator it = object.begin(); it != object.end(); ++it)
+			{
+				encode(it->first.getValue());
+
+				if (it->second)
+				{
+					encode(*it->second);
+				}
+				else
+				{
+					data->push_back(CBOR_NULL);
+				}
+			}
+		}
+		break;
+	}
+}
+
+void BinaryWriter::encode(const DocumentValue& value)
+{
+	switch (value.getType())
+	{
+		case NULLTYPE:
+			data->push_back(CBOR_NULL);
+		break;
+
+		case BOOL:
+			data->push_back((value.toBool()) ? CBOR_TRUE : CBOR_FALSE);
+		break;
+
+		case NUMBER:
+			if (value.isExactInt())
+			{
+				appendInt(value.toInt());
+			}
+			else
+			{
+				appendDouble(value.toDouble());
+			}
+		break;
+
+		case STRING:
+			appendString(value.data(), value.length());
+		break;
+
+		case ARRAY:
+		{
+			const DocumentArray& array = value.toArray();
+			appendHead(CBOR_ARRAY, array.size());
+
+			for (DocumentArray::const_iterator it = array.begin(); it != array.end(); ++it)
+			{
+				encode(**it);
+			}
+		}
+		break;
+
+		case OBJECT:
+		{
+			const DocumentObject& object = value.toObject();
+			appendHead(CBOR_MAP, object.size());
+
+			for (DocumentObject::const_iterator it = object.begin(); it != object.end(); ++it)
+			{
+				encode(*it->first);
+				encode(*it->second);
+			}
+		}
+		break;
+	}
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JSON_BINARYWRITER_H
+#define JSON_BINARYWRITER_H
+
+#include "Handler.h"
+
+#include <string>
+#include <stdint.h>
+
+namespace JSON
+{
+	class Value;
+	class DocumentValue;
+
+	/**
+	* Serializes values into CBOR (RFC 7049), a compact binary encoding
+	* of the JSON data model.
+	*
+	* Every top level value starts with the CBOR self-describe tag, so
+	* BinaryReader::isBinary() can tell the encoding apart from JSON text.
+	* Containers written with write() have their size encoded up front,
+	* those reported through the Handler events use indefinite lengths
+	* terminated by a break code, as their size is not known in advance.
+	* Numbers that are exact integers are encoded as integers, all others
+	* as single or double precision floats, whichever holds them exactly.
+	*
+	* Like a Writer a binary writer appends to its own buffer or to a
+	* given string and can be reused after calling clear().
+	*/
+	class BinaryWriter : public Handler
+	{
+	public:
+		BinaryWriter();
+		BinaryWriter(std::string& data);
+
+		void write(const Value& value);
+		void write(const DocumentValue& value);
+
+		void onNull();
+		void onBool(bool b);
+		void onNumber(const Number& n);
+		void onNumber(int64_t n);
+		void onNumber(double n);
+		void onString(const std::string& s);
+		void onString(const char* data, size_t length);
+		void onKey(const std::string& key);
+		void onKey(const char* data, size_t length);
+		void onKey(const Number& key);
+		void onArrayStart();
+		void onArrayEnd();
+		void onObjectStart();
+		void onObjectEnd();
+		void onStringReference(const char* data, size_t length);
+		void onKeyReference(const char* data, size_t length);
+
+		const std::string& getBuffer() const;
+		void clear();
+	private:
+		BinaryWriter(const BinaryWriter&) {}; // do not allow copying
+		BinaryWriter& operator=(const BinaryWriter&) { return *this; }; // do not allow assignment
+
+		inline void beforeValue();
+		inline void appendHead(uint8_t major, uint64_t argument);
+		void appendNumber(const Number& n);
+		void appendInt(int64_t n);
+		void appendDouble(double n);
+		void appendString(const char* data, size_t length);
+		void encode(const Value& value);
+		void encode(const DocumentValue& value);
+
+		std::string buffer;
+		std::string* data;
+
+		// number of open containers
+		size_t depth;
+	};
+}
+
+#endif
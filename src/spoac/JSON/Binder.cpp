@@ -0,0 +1,70 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#include "Binder.h"
+#include "ValueException.h"
+
+using namespace JSON;
+
+void Binder::bindNull()
+{
+	throw ValueException(NULLTYPE, getType());
+}
+
+void Binder::bindBool(bool b)
+{
+	throw ValueException(BOOL, getType());
+}
+
+void Binder::bindNumber(const Number& n)
+{
+	throw ValueException(NUMBER, getType());
+}
+
+void Binder::bindString(const char* data, size_t length)
+{
+	throw ValueException(STRING, getType());
+}
+
+void Binder::beginArray()
+{
+	throw ValueException(ARRAY, getType());
+}
+
+Binder* Binder::bindElement(size_t index)
+{
+	return NULL;
+}
+
+void Binder::endArray()
+{
+}
+
+void Binder::beginObject()
+{
+	throw ValueException(OBJECT, getType());
+}
+
+Binder* Binder::bindMember(const char* key, size_t length)
+{
+	return NULL;
+}
+
+void Binder::endObject()
+{
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#ifndef JSON_BINDER_H
+#define JSON_BINDER_H
+
+#include "Number.h"
+#include "Value.h"
+
+namespace JSON
+{
+	/**
+	* Stores the events of a single JSON value in a C++ object.
+	*
+	* A BindingReader passes each value to the binder for its position.
+	* Array elements and object members are passed to the binders
+	* returned by bindElement() and bindMember(), or skipped if they return
+	* NULL. The default implementations reject the value with a
+	* ValueException from the type it has to getType(), the reader adds
+	* the path of the value to errors.
+	*/
+	class Binder
+	{
+	public:
+		virtual ~Binder() {};
+
+		/**
+		* The type of value this binder expects.
+		*/
+		virtual ValueType getType() const = 0;
+
+		virtual void bindNull();
+		virtual void bindBool(bool b);
+		virtual void bindNumber(const Number& n);
+		virtual void bindString(const char* data, size_t length);
+
+		virtual void beginArray();
+		virtual Binder* bindElement(size_t index);
+		virtual void endArray();
+
+		virtual void beginObject();
+		virtual Binder* bindMember(const char* key, size_t length);
+		virtual void endObject();
+	};
+
+	/**
+	* A Binder which stores values in an object of type T. The target has
+	* to be set before any value is bound.
+	*/
+	template <class T>
+	class TargetBinder : public Binder
+	{
+	public:
+		TargetBinder() : target(NULL) {};
+
+		void setTarget(T* target)
+		{
+			this->target = target;
+		}
+
+	protected:
+		T* target;
+	};
+}
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#include "Binding.h"
+
+using namespace JSON;
+
+ValueType StringBinder::getType() const
+{
+	return STRING;
+}
+
+void StringBinder::bindString(const char* data, size_t length)
+{
+	target->assign(data, length);
+}
+
+ValueType BoolBinder::getType() const
+{
+	return BOOL;
+}
+
+void BoolBinder::bindBool(bool b)
+{
+	*target = b;
+}
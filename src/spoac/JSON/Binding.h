@@ -0,0 +1,506 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#ifndef JSON_BINDING_H
+#define JSON_BINDING_H
+
+#include "Binder.h"
+#include "BindingReader.h"
+#include "Exception.h"
+#include "ValueException.h"
+
+#include <cstring>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace JSON
+{
+	template <class T> class StructBinder;
+	template <class T> class FieldList;
+
+	/**
+	* Declares how an object of type T is bound to a JSON object.
+	*
+	* Specialize it for every struct which is to be bound and add its
+	* members to the field list in describe():
+	*
+	*   template <>
+	*   struct Mapping<PredicateDefinition>
+	*   {
+	*       static void describe(FieldList<PredicateDefinition>& fields)
+	*       {
+	*           fields.add("name", &PredicateDefinition::name, BIND_REQUIRED);
+	*           fields.add("arguments", &PredicateDefinition::arguments);
+	*       }
+	*   };
+	*/
+	template <class T>
+	struct Mapping;
+
+	/**
+	* Selects the Binder for values of type T. Types without a
+	* specialization are bound as objects according to their Mapping.
+	*/
+	template <class T>
+	struct BinderType
+	{
+		typedef StructBinder<T> type;
+	};
+
+	/**
+	* An enum of whether a member has to be present in a bound object.
+	*/
+	typedef enum
+	{
+		BIND_OPTIONAL,
+		BIND_REQUIRED
+	} BindingFlag;
+
+	class StringBinder : public TargetBinder<std::string>
+	{
+	public:
+		ValueType getType() const;
+		void bindString(const char* data, size_t length);
+	};
+
+	class BoolBinder : public TargetBinder<bool>
+	{
+	public:
+		ValueType getType() const;
+		void bindBool(bool b);
+	};
+
+	/**
+	* Binds numbers to an integer type, rejecting fractions and values out
+	* of the type's range.
+	*/
+	template <class T>
+	class IntegerBinder : public TargetBinder<T>
+	{
+	public:
+		ValueType getType() const
+		{
+			return NUMBER;
+		}
+
+		void bindNumber(const Number& n)
+		{
+			if (!n.isExactInt())
+			{
+				throw Exception("Number is not an integer");
+			}
+
+			int64_t value = n.toInt();
+
+			if (value < (int64_t) std::numeric_limits<T>::min() ||
+				value > (int64_t) std::numeric_limits<T>::max())
+			{
+				throw Exception("Number is out of range");
+			}
+
+			*this->target = (T) value;
+		}
+	};
+
+	template <class T>
+	class FloatBinder : public TargetBinder<T>
+	{
+	public:
+		ValueType getType() const
+		{
+			return NUMBER;
+		}
+
+		void bindNumber(const Number& n)
+		{
+			*this->target = (T) n.toDouble();
+		}
+	};
+
+	/**
+	* Binds an array to a vector, replacing its previous contents.
+	*/
+	template <class E>
+	class VectorBinder : public TargetBinder<std::vector<E> >
+	{
+	public:
+		ValueType getType() const
+		{
+			return ARRAY;
+		}
+
+		void beginArray()
+		{
+			this->target->clear();
+		}
+
+		Binder* bindElement(size_t index)
+		{
+			this->target->push_back(E());
+			element.setTarget(&this->target->back());
+
+			return &element;
+		}
+
+	private:
+		typename BinderType<E>::type element;
+	};
+
+	/**
+	* Binds an object to a map from member names to values, replacing its
+	* previous contents.
+	*/
+	template <class V>
+	class MapBinder : public TargetBinder<std::map<std::string, V> >
+	{
+	public:
+		ValueType getType() const
+		{
+			return OBJECT;
+		}
+
+		void beginObject()
+		{
+			this->target->clear();
+		}
+
+		Binder* bindMember(const char* key, size_t length)
+		{
+			value.setTarget(&(*this->target)[std::string(key, length)]);
+
+			return &value;
+		}
+
+	private:
+		typename BinderType<V>::type value;
+	};
+
+	template <> struct BinderType<std::string> { typedef StringBinder type; };
+	template <> struct BinderType<bool> { typedef BoolBinder type; };
+	template <> struct BinderType<short> { typedef IntegerBinder<short> type; };
+	template <> struct BinderType<int> { typedef IntegerBinder<int> type; };
+	template <> struct BinderType<long> { typedef IntegerBinder<long> type; };
+	template <> struct BinderType<float> { typedef FloatBinder<float> type; };
+	template <> struct BinderType<double> { typedef FloatBinder<double> type; };
+
+	template <class E>
+	struct BinderType<std::vector<E> >
+	{
+		typedef VectorBinder<E> type;
+	};
+
+	template <class V>
+	struct BinderType<std::map<std::string, V> >
+	{
+		typedef MapBinder<V> type;
+	};
+
+	/**
+	* A member of T declared in a Mapping.
+	*/
+	template <class T>
+	class FieldBase
+	{
+	public:
+		FieldBase(const std::string& name, BindingFlag flag) :
+			name(name), flag(flag) {};
+		virtual ~FieldBase() {};
+
+		virtual Binder* createBinder() const = 0;
+		virtual void setTarget(Binder* binder, T& object) const = 0;
+
+		const std::string name;
+		const BindingFlag flag;
+	};
+
+	template <class T, class M>
+	class Field : public FieldBase<T>
+	{
+	public:
+		Field(const std::string& name, M T::*member, BindingFlag flag) :
+			FieldBase<T>(name, flag), member(member) {};
+
+		Binder* createBinder() const
+		{
+			return new typename BinderType<M>::type();
+		}
+
+		void setTarget(Binder* binder, T& object) const
+		{
+			static_cast<typename BinderType<M>::type*>(binder)->setTarget(&(object.*member));
+		}
+
+	private:
+		M T::*member;
+	};
+
+	/**
+	* The members of T, as declared by Mapping<T>::describe(). The list of
+	* each type is built once, on first use.
+	*/
+	template <class T>
+	class FieldList
+	{
+	public:
+		static const FieldList<T>& get()
+		{
+			static FieldList<T> fields;
+			return fields;
+		}
+
+		~FieldList()
+		{
+			for (size_t i = 0; i < fields.size(); i++)
+			{
+				delete fields[i];
+			}
+
+			delete shorthand;
+		}
+
+		/**
+		* Binds the member of the given name to a member of T.
+		*/
+		template <class M>
+		void add(const std::string& name, M T::*member, BindingFlag flag = BIND_OPTIONAL)
+		{
+			fields.push_back(new Field<T, M>(name, member, flag));
+		}
+
+		/**
+		* Binds values which are not objects to a member of T, so that
+		* e.g. a plain string can stand for an object with just a name.
+		*/
+		template <class M>
+		void setShorthand(M T::*member)
+		{
+			delete shorthand;
+			shorthand = new Field<T, M>("", member, BIND_OPTIONAL);
+		}
+
+		size_t size() const
+		{
+			return fields.size();
+		}
+
+		const FieldBase<T>& operator[](size_t i) const
+		{
+			return *fields[i];
+		}
+
+		/**
+		* Finds a member by name.
+		*
+		* @return The index of the member or size() if there is none.
+		*/
+		size_t find(const char* key, size_t length) const
+		{
+			for (size_t i = 0; i < fields.size(); i++)
+			{
+				const std::string& name = fields[i]->name;
+
+				if (name.size() == length && memcmp(name.data(), key, length) == 0)
+				{
+					return i;
+				}
+			}
+
+			return fields.size();
+		}
+
+		const FieldBase<T>* getShorthand() const
+		{
+			return shorthand;
+		}
+
+	private:
+		FieldList() : shorthand(NULL)
+		{
+			Mapping<T>::describe(*this);
+		}
+
+		FieldList(const FieldList& l) {}; // do not allow copying
+
+		std::vector<FieldBase<T>*> fields;
+		FieldBase<T>* shorthand;
+	};
+
+	/**
+	* Binds an object to a struct according to its Mapping. Members which
+	* are not declared are skipped. The binders of the members are created
+	* once and reused for every object.
+	*/
+	template <class T>
+	class StructBinder : public TargetBinder<T>
+	{
+	public:
+		StructBinder() :
+			fields(FieldList<T>::get()),
+			binders(fields.size(), (Binder*) NULL),
+			shorthand(NULL)
+		{
+		}
+
+		~StructBinder()
+		{
+			for (size_t i = 0; i < binders.size(); i++)
+			{
+				delete binders[i];
+			}
+
+			delete shorthand;
+		}
+
+		ValueType getType() const
+		{
+			return OBJECT;
+		}
+
+		void bindNull()
+		{
+			getShorthand(NULLTYPE)->bindNull();
+		}
+
+		void bindBool(bool b)
+		{
+			getShorthand(BOOL)->bindBool(b);
+		}
+
+		void bindNumber(const Number& n)
+		{
+			getShorthand(NUMBER)->bindNumber(n);
+		}
+
+		void bindString(const char* data, size_t length)
+		{
+			getShorthand(STRING)->bindString(data, length);
+		}
+
+		void beginArray()
+		{
+			getShorthand(ARRAY)->beginArray();
+		}
+
+		Binder* bindElement(size_t index)
+		{
+			return shorthand->bindElement(index);
+		}
+
+		void endArray()
+		{
+			shorthand->endArray();
+		}
+
+		void beginObject()
+		{
+			seen.assign(fields.size(), false);
+		}
+
+		Binder* bindMember(const char* key, size_t length)
+		{
+			size_t i = fields.find(key, length);
+
+			if (i == fields.size())
+			{
+				return NULL;
+			}
+
+			if (binders[i] == NULL)
+			{
+				binders[i] = fields[i].createBinder();
+			}
+
+			fields[i].setTarget(binders[i], *this->target);
+			seen[i] = true;
+
+			return binders[i];
+		}
+
+		void endObject()
+		{
+			for (size_t i = 0; i < fields.size(); i++)
+			{
+				if (!seen[i] && fields[i].flag == BIND_REQUIRED)
+				{
+					throw Exception(std::string("Missing member ") + fields[i].name);
+				}
+			}
+		}
+
+	private:
+		StructBinder(const StructBinder& b) {}; // do not allow copying
+
+		/**
+		* Returns the binder of the shorthand member, or rejects a value of
+		* the given type if the mapping declares none.
+		*/
+		Binder* getShorthand(ValueType type)
+		{
+			const FieldBase<T>* field = fields.getShorthand();
+
+			if (field == NULL)
+			{
+				throw ValueException(type, OBJECT);
+			}
+
+			if (shorthand == NULL)
+			{
+				shorthand = field->createBinder();
+			}
+
+			field->setTarget(shorthand, *this->target);
+
+			return shorthand;
+		}
+
+		const FieldList<T>& fields;
+		std::vector<Binder*> binders;
+		std::vector<bool> seen;
+		Binder* shorthand;
+	};
+
+	/**
+	* Binds a document to an object of type T while it is being parsed,
+	* without building any Values:
+	*
+	*   Scenario scenario;
+	*   JSON::Binding<Scenario> binding(scenario);
+	*   JSON::Parser parser(binding);
+	*   parser.readFromFile(path);
+	*
+	* Throws a BindingException naming the path of the first value which
+	* does not fit its target.
+	*/
+	template <class T>
+	class Binding : public BindingReader
+	{
+	public:
+		Binding(T& target)
+		{
+			binder.setTarget(&target);
+			setRoot(binder);
+		}
+
+	private:
+		typename BinderType<T>::type binder;
+	};
+}
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#ifndef JSON_BINDINGEXCEPTION_H
+#define JSON_BINDINGEXCEPTION_H
+
+#include "Exception.h"
+
+namespace JSON
+{
+	/**
+	* Thrown when a value cannot be bound to its target, e.g. because it
+	* has the wrong type. The path names the offending value, like
+	* $.predicates[2].arguments
+	*/
+	class BindingException : public Exception
+	{
+	public:
+		BindingException(const std::string& error, const std::string& path);
+		virtual ~BindingException() throw() {};
+		const std::string& getPath() const;
+	private:
+		std::string path;
+	};
+}
+
+#endif
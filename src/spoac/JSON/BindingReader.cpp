@@ -0,0 +1,336 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#include "BindingReader.h"
+#include "BindingException.h"
+#include "NumberConversion.h"
+
+using namespace JSON;
+
+BindingReader::BindingReader(Binder& root) :
+	root(&root), depth(0), skipDepth(0)
+{
+}
+
+BindingReader::BindingReader() :
+	root(NULL), depth(0), skipDepth(0)
+{
+}
+
+void BindingReader::setRoot(Binder& root)
+{
+	this->root = &root;
+}
+
+void BindingReader::reset()
+{
+	depth = 0;
+	skipDepth = 0;
+}
+
+void BindingReader::onNull()
+{
+	if (skipDepth > 0)
+	{
+		return;
+	}
+
+	Binder* binder = next();
+
+	if (binder != NULL)
+	{
+		try
+		{
+			binder->bindNull();
+		}
+		catch (const Exception& e)
+		{
+			fail(e, depth);
+		}
+	}
+}
+
+void BindingReader::onBool(bool b)
+{
+	if (skipDepth > 0)
+	{
+		return;
+	}
+
+	Binder* binder = next();
+
+	if (binder != NULL)
+	{
+		try
+		{
+			binder->bindBool(b);
+		}
+		catch (const Exception& e)
+		{
+			fail(e, depth);
+		}
+	}
+}
+
+void BindingReader::onNumber(const Number& n)
+{
+	if (skipDepth > 0)
+	{
+		return;
+	}
+
+	Binder* binder = next();
+
+	if (binder != NULL)
+	{
+		try
+		{
+			binder->bindNumber(n);
+		}
+		catch (const Exception& e)
+		{
+			fail(e, depth);
+		}
+	}
+}
+
+void BindingReader::onString(const std::string& s)
+{
+	onStringReference(s.data(), s.size());
+}
+
+void BindingReader::onStringReference(const char* data, size_t length)
+{
+	if (skipDepth > 0)
+	{
+		return;
+	}
+
+	Binder* binder = next();
+
+	if (binder != NULL)
+	{
+		try
+		{
+			binder->bindString(data, length);
+		}
+		catch (const Exception& e)
+		{
+			fail(e, depth);
+		}
+	}
+}
+
+void BindingReader::onKey(const std::string& key)
+{
+	onKeyReference(key.data(), key.size());
+}
+
+void BindingReader::onKey(const Number& key)
+{
+	// bound by their text, so the key 1 selects the member named "1"
+	char buffer[NumberConversion::BUFFER_SIZE];
+	size_t length;
+
+	if (key.isExactInt())
+	{
+		length = NumberConversion::formatInt(key.toInt(), buffer);
+	}
+	else
+	{
+		length = NumberConversion::formatDouble(key.toDouble(), buffer);
+	}
+
+	onKeyReference(buffer, length);
+}
+
+void BindingReader::onKeyReference(const char* data, size_t length)
+{
+	if (skipDepth > 0)
+	{
+		return;
+	}
+
+	Frame& frame = frames[depth - 1];
+	frame.key.assign(data, length);
+
+	try
+	{
+		frame.member = frame.binder->bindMember(data, length);
+	}
+	catch (const Exception& e)
+	{
+		fail(e, depth);
+	}
+}
+
+void BindingReader::onArrayStart()
+{
+	beginContainer(true);
+}
+
+void BindingReader::onArrayEnd()
+{
+	endContainer();
+}
+
+void BindingReader::onObjectStart()
+{
+	beginContainer(false);
+}
+
+void BindingReader::onObjectEnd()
+{
+	endContainer();
+}
+
+Binder* BindingReader::next()
+{
+	if (depth == 0)
+	{
+		return root;
+	}
+
+	Frame& frame = frames[depth - 1];
+	Binder* binder = NULL;
+
+	if (frame.array)
+	{
+		try
+		{
+			binder = frame.binder->bindElement(frame.count++);
+		}
+		catch (const Exception& e)
+		{
+			fail(e, depth);
+		}
+	}
+	else
+	{
+		binder = frame.member;
+		frame.member = NULL;
+	}
+
+	return binder;
+}
+
+void BindingReader::beginContainer(bool array)
+{
+	if (skipDepth > 0)
+	{
+		skipDepth++;
+		return;
+	}
+
+	Binder* binder = next();
+
+	if (binder == NULL)
+	{
+		skipDepth++;
+		return;
+	}
+
+	try
+	{
+		if (array)
+		{
+			binder->beginArray();
+		}
+		else
+		{
+			binder->beginObject();
+		}
+	}
+	catch (const Exception& e)
+	{
+		fail(e, depth);
+	}
+
+	// frames are reused, so their keys keep their buffers between members
+	if (depth == frames.size())
+	{
+		frames.push_back(Frame());
+	}
+
+	Frame& frame = frames[depth++];
+	frame.binder = binder;
+	frame.member = NULL;
+	frame.array = array;
+	frame.count = 0;
+	frame.key.clear();
+}
+
+void BindingReader::endContainer()
+{
+	if (skipDepth > 0)
+	{
+		skipDepth--;
+		return;
+	}
+
+	Frame& frame = frames[depth - 1];
+
+	try
+	{
+		if (frame.array)
+		{
+			frame.binder->endArray();
+		}
+		else
+		{
+			frame.binder->endObject();
+		}
+	}
+	catch (const Exception& e)
+	{
+		fail(e, depth - 1);
+	}
+
+	depth--;
+}
+
+void BindingReader::fail(const Exception& e, size_t depth) const
+{
+	throw BindingException(e.getMessage(), getPath(depth));
+}
+
+std::string BindingReader::getPath(size_t depth) const
+{
+	std::string path("$");
+
+	for (size_t i = 0; i < depth; i++)
+	{
+		const Frame& frame = frames[i];
+
+		if (frame.array)
+		{
+			char buffer[NumberConversion::BUFFER_SIZE];
+
+			path.append("[");
+			path.append(buffer, NumberConversion::formatInt(frame.count - 1, buffer));
+			path.append("]");
+		}
+		else
+		{
+			path.append(".");
+			path.append(frame.key);
+		}
+	}
+
+	return path;
+}
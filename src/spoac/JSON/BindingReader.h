@@ -0,0 +1,92 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#ifndef JSON_BINDINGREADER_H
+#define JSON_BINDINGREADER_H
+
+#include "Handler.h"
+#include "Binder.h"
+
+#include <string>
+#include <vector>
+
+namespace JSON
+{
+	class Exception;
+
+	/**
+	* A Handler which passes parser events to Binders instead of building
+	* values, so data is decoded straight into its C++ representation.
+	*
+	* Values the binders do not ask for are skipped. Errors thrown by a
+	* binder are rethrown as a BindingException carrying the path of the
+	* value, like $.predicates[2].arguments
+	*
+	* Use Binding to bind a document to an object with a declared Mapping.
+	*/
+	class BindingReader : public Handler
+	{
+	public:
+		BindingReader(Binder& root);
+
+		void reset();
+
+		void onNull();
+		void onBool(bool b);
+		void onNumber(const Number& n);
+		void onString(const std::string& s);
+		void onKey(const std::string& key);
+		void onKey(const Number& key);
+		void onStringReference(const char* data, size_t length);
+		void onKeyReference(const char* data, size_t length);
+		void onArrayStart();
+		void onArrayEnd();
+		void onObjectStart();
+		void onObjectEnd();
+
+	protected:
+		BindingReader();
+
+		void setRoot(Binder& root);
+
+	private:
+		BindingReader(const BindingReader& r) {}; // do not allow copying
+
+		struct Frame
+		{
+			Binder* binder;
+			Binder* member;
+			bool array;
+			size_t count;
+			std::string key;
+		};
+
+		Binder* next();
+		void beginContainer(bool array);
+		void endContainer();
+		void fail(const Exception& e, size_t depth) const;
+		std::string getPath(size_t depth) const;
+
+		Binder* root;
+		std::vector<Frame> frames;
+		size_t depth;
+		size_t skipDepth;
+	};
+}
+
+#endif
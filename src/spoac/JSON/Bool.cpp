@@ -27,15 +27,3 @@ bool Bool::toBool() const
 {
 	return value;
 }
-
-void Bool::_toJSON(std::string& json, const std::string& indent) const
-{
-	if (value)
-	{
-		json.append("true");
-	}
-	else
-	{
-		json.append("false");
-	}
-}
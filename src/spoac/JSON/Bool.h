@@ -33,7 +33,6 @@ namespace JSON
 		Bool(bool b);
 
 		bool toBool() const;
-		void _toJSON(std::string& json, const std::string& indent) const;
 	private:
 		bool value;
 	};
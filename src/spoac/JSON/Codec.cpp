@@ -0,0 +1,94 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "Codec.h"
+#include "BinaryReader.h"
+#include "BinaryWriter.h"
+#include "Exception.h"
+#include "Parser.h"
+#include "Writer.h"
+
+using namespace JSON;
+
+void Codec::encode(const Value& value, CodecFormat format, std::string& data)
+{
+	if (format == CODEC_BINARY)
+	{
+		BinaryWriter writer(data);
+		writer.write(value);
+	}
+	else
+	{
+		Writer writer(data, WRITER_COMPACT);
+		writer.write(value);
+	}
+}
+
+void Codec::encode(const DocumentValue& value, CodecFormat format, std::string& data)
+{
+	if (format == CODEC_BINARY)
+	{
+		BinaryWriter writer(data);
+		writer.write(value);
+	}
+	else
+	{
+		Writer writer(data, WRITER_COMPACT);
+		writer.write(value);
+	}
+}
+
+std::string Codec::encode(const Value& value, CodecFormat format)
+{
+	std::string data;
+	encode(value, format, data);
+	return data;
+}
+
+ValuePtr Codec::decode(const std::string& data)
+{
+	return decode(data.data(), data.size());
+}
+
+ValuePtr Codec::decode(const char* data, size_t len)
+{
+	if (BinaryReader::isBinary(data, len))
+	{
+		BinaryReader reader;
+		return reader.read(data, len);
+	}
+
+	Parser parser;
+	parser.read(data, len);
+	return parser.finish();
+}
+
+CodecFormat Codec::getFormat(const std::string& name)
+{
+	if (name == "text")
+	{
+		return CODEC_TEXT;
+	}
+
+	if (name == "binary")
+	{
+		return CODEC_BINARY;
+	}
+
+	throw Exception(std::string("Unknown encoding ") + name +
+		", expecting text or binary");
+}
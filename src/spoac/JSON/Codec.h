@@ -0,0 +1,60 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JSON_CODEC_H
+#define JSON_CODEC_H
+
+#include "Value.h"
+
+#include <string>
+
+namespace JSON
+{
+	class DocumentValue;
+
+	/**
+	* An enum of the encodings a Codec can produce.
+	*/
+	typedef enum
+	{
+		CODEC_TEXT,
+		CODEC_BINARY
+	} CodecFormat;
+
+	/**
+	* Encodes values as compact JSON text or as CBOR and decodes either.
+	*
+	* Where values are exchanged as strings, the sender can pick the format
+	* while the receiver simply calls decode(), which recognizes binary
+	* data by its self-describe tag. Binary data skips text parsing and
+	* number formatting, at the cost of not being human readable.
+	*/
+	class Codec
+	{
+	public:
+		static void encode(const Value& value, CodecFormat format, std::string& data);
+		static void encode(const DocumentValue& value, CodecFormat format, std::string& data);
+		static std::string encode(const Value& value, CodecFormat format);
+
+		static ValuePtr decode(const std::string& data);
+		static ValuePtr decode(const char* data, size_t len);
+
+		static CodecFormat getFormat(const std::string& name);
+	};
+}
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "Document.h"
+#include "Number.h"
+
+#include <cstring>
+#include <new>
+
+using namespace JSON;
+
+Document::Document() :
+	root(&DocumentValue::nullValue)
+{
+}
+
+const DocumentValue& Document::getRoot() const
+{
+	return *root;
+}
+
+void Document::setRoot(const DocumentValue* value)
+{
+	root = (value == NULL) ? &DocumentValue::nullValue : value;
+}
+
+void Document::clear()
+{
+	root = &DocumentValue::nullValue;
+	arena.clear();
+	files.clear();
+}
+
+size_t Document::getMemoryUsage() const
+{
+	return arena.getMemoryUsage();
+}
+
+void Document::retain(MappedFilePtr file)
+{
+	files.push_back(file);
+}
+
+const DocumentValue* Document::createNull()
+{
+	return &DocumentValue::nullValue;
+}
+
+const DocumentValue* Document::createBool(bool b)
+{
+	DocumentValue* value = createValue(BOOL);
+	value->intValue = (b) ? 1 : 0;
+	return value;
+}
+
+const DocumentValue* Document::createNumber(const Number& n)
+{
+	DocumentValue* value = createValue(NUMBER);
+	value->intValue = n.toInt();
+	value->doubleValue = n.toDouble();
+	value->exactInt = n.isExactInt();
+	return value;
+}
+
+const DocumentValue* Document::createString(const char* data, size_t len)
+{
+	DocumentValue* value = createValue(STRING);
+	value->content.string = arena.copyString(data, len);
+	value->size = len;
+	return value;
+}
+
+const DocumentValue* Document::createStringReference(const char* data, size_t len)
+{
+	DocumentValue* value = createValue(STRING);
+	value->content.string = data;
+	value->size = len;
+	return value;
+}
+
+const DocumentValue* Document::createNumberReference(const char* data, size_t len)
+{
+	DocumentValue* value = createValue(NUMBER);
+	value->content.string = data;
+	value->size = len;
+	return value;
+}
+
+const DocumentValue* Document::createArray(const DocumentValue* const* elements, size_t size)
+{
+	DocumentValue* value = createValue(ARRAY);
+	const DocumentValue** copy = static_cast<const DocumentValue**>(
+		arena.allocate(size * sizeof(const DocumentValue*)));
+
+	if (size > 0)
+	{
+		memcpy(copy, elements, size * sizeof(const DocumentValue*));
+	}
+
+	value->content.elements = copy;
+	value->size = size;
+	return value;
+}
+
+const DocumentValue* Document::createObject(const DocumentMember* members, size_t size)
+{
+	DocumentValue* value = createValue(OBJECT);
+	DocumentMember* copy = static_cast<DocumentMember*>(
+		arena.allocate(size * sizeof(DocumentMember)));
+
+	if (size > 0)
+	{
+		memcpy(copy, members, size * sizeof(DocumentMember));
+	}
+
+	value->content.members = copy;
+	value->size = size;
+	return value;
+}
+
+void Document::setSource(const DocumentValue* value, const char* source, size_t len)
+{
+	// null values are shared, they are written as null without a source
+	if (value == &DocumentValue::nullValue)
+	{
+		return;
+	}
+
+	// all other values were created in the arena of this document
+	DocumentValue* mutableValue = const_cast<DocumentValue*>(value);
+	mutableValue->source = source;
+	mutableValue->sourceLength = len;
+}
+
+DocumentValue* Document::createValue(ValueType type)
+{
+	DocumentValue* value = new (arena.allocate(sizeof(DocumentValue))) DocumentValue;
+	value->type = type;
+	return value;
+}
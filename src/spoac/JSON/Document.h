@@ -0,0 +1,82 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JSON_DOCUMENT_H
+#define JSON_DOCUMENT_H
+
+#include "Arena.h"
+#include "DocumentValue.h"
+#include "DocumentArray.h"
+#include "DocumentObject.h"
+#include "MappedFile.h"
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+namespace JSON
+{
+	class Number;
+
+	/**
+	* A read-only JSON document whose values all live in a single Arena.
+	*
+	* A Parser constructed with a Document builds the parsed values inside
+	* the document's arena instead of allocating a separate Value for each
+	* of them. All values are released at once when the document is cleared
+	* or destroyed, so pointers obtained from it must not outlive it.
+	*
+	* String values created with createStringReference() point into a
+	* buffer the document does not copy, like a file it retains. So do
+	* numbers created with createNumberReference(), which are converted
+	* from their text each time they are accessed, and the source set for
+	* values with setSource().
+	*/
+	class Document
+	{
+	public:
+		Document();
+
+		const DocumentValue& getRoot() const;
+		void setRoot(const DocumentValue* value);
+		void clear();
+		size_t getMemoryUsage() const;
+		void retain(MappedFilePtr file);
+
+		const DocumentValue* createNull();
+		const DocumentValue* createBool(bool b);
+		const DocumentValue* createNumber(const Number& n);
+		const DocumentValue* createString(const char* data, size_t len);
+		const DocumentValue* createStringReference(const char* data, size_t len);
+		const DocumentValue* createNumberReference(const char* data, size_t len);
+		const DocumentValue* createArray(const DocumentValue* const* elements, size_t size);
+		const DocumentValue* createObject(const DocumentMember* members, size_t size);
+		void setSource(const DocumentValue* value, const char* source, size_t len);
+	private:
+		Document(const Document&) {}; // do not allow copying
+		Document& operator=(const Document&) { return *this; }; // do not allow assignment
+
+		DocumentValue* createValue(ValueType type);
+
+		Arena arena;
+		const DocumentValue* root;
+		std::vector<MappedFilePtr> files;
+	};
+
+    typedef boost::shared_ptr<Document> DocumentPtr;
+}
+
+#endif
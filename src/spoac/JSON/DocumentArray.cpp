@@ -0,0 +1,67 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "DocumentArray.h"
+
+#include <stdexcept>
+
+using namespace JSON;
+
+size_t DocumentArray::size() const
+{
+	return DocumentValue::size;
+}
+
+bool DocumentArray::empty() const
+{
+	return DocumentValue::size == 0;
+}
+
+DocumentArray::value_type DocumentArray::at(size_t pos) const
+{
+	if (pos >= size())
+	{
+		throw std::out_of_range("DocumentArray::at");
+	}
+
+	return content.elements[pos];
+}
+
+DocumentArray::value_type DocumentArray::operator[](size_t pos) const
+{
+	return content.elements[pos];
+}
+
+DocumentArray::value_type DocumentArray::front() const
+{
+	return content.elements[0];
+}
+
+DocumentArray::value_type DocumentArray::back() const
+{
+	return content.elements[size() - 1];
+}
+
+DocumentArray::const_iterator DocumentArray::begin() const
+{
+	return content.elements;
+}
+
+DocumentArray::const_iterator DocumentArray::end() const
+{
+	return content.elements + size();
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JSON_DOCUMENTARRAY_H
+#define JSON_DOCUMENTARRAY_H
+
+#include "DocumentValue.h"
+
+namespace JSON
+{
+	/**
+	* Read-only view of an array stored in a Document.
+	*
+	* The elements are stored contiguously in the document's arena. The
+	* interface mirrors the const part of Array, iterators dereference to
+	* pointers to the element values.
+	*/
+	class DocumentArray : public DocumentValue
+	{
+	public:
+		typedef const DocumentValue* value_type;
+		typedef const value_type* const_iterator;
+
+		size_t size() const;
+		bool empty() const;
+		value_type at(size_t pos) const;
+		value_type operator[](size_t pos) const;
+		value_type front() const;
+		value_type back() const;
+		const_iterator begin() const;
+		const_iterator end() const;
+	private:
+		DocumentArray(); // only ever used as a view of a DocumentValue
+	};
+}
+
+#endif
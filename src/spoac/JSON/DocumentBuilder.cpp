@@ -0,0 +1,178 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "DocumentBuilder.h"
+#include "Document.h"
+
+using namespace JSON;
+
+DocumentBuilder::DocumentBuilder(Document& document) :
+	document(document),
+	result(NULL),
+	sourceEnd(NULL)
+{
+}
+
+void DocumentBuilder::reset()
+{
+	frames.clear();
+	elements.clear();
+	members.clear();
+	result = NULL;
+	sourceStarts.clear();
+	sourceEnd = NULL;
+}
+
+void DocumentBuilder::finish()
+{
+	document.setRoot(result);
+}
+
+void DocumentBuilder::onNull()
+{
+	add(document.createNull());
+}
+
+void DocumentBuilder::onBool(bool b)
+{
+	add(document.createBool(b));
+}
+
+void DocumentBuilder::onNumber(const Number& n)
+{
+	add(document.createNumber(n));
+}
+
+void DocumentBuilder::onString(const std::string& s)
+{
+	add(document.createString(s.data(), s.size()));
+}
+
+void DocumentBuilder::onKey(const std::string& key)
+{
+	frames.back().key = document.createString(key.data(), key.size());
+}
+
+void DocumentBuilder::onStringReference(const char* data, size_t length)
+{
+	add(document.createStringReference(data, length));
+}
+
+void DocumentBuilder::onKeyReference(const char* data, size_t length)
+{
+	frames.back().key = document.createStringReference(data, length);
+}
+
+void DocumentBuilder::onNumberReference(const char* data, size_t length)
+{
+	add(document.createNumberReference(data, length));
+}
+
+void DocumentBuilder::onKey(const Number& key)
+{
+	frames.back().key = document.createNumber(key);
+}
+
+void DocumentBuilder::onArrayStart()
+{
+	Frame frame;
+	frame.type = ARRAY;
+	frame.start = elements.size();
+	frame.key = NULL;
+	frames.push_back(frame);
+}
+
+void DocumentBuilder::onArrayEnd()
+{
+	size_t start = frames.back().start;
+	size_t size = elements.size() - start;
+	frames.pop_back();
+
+	const DocumentValue* array = document.createArray(
+		(size) ? &elements[start] : NULL, size);
+	elements.resize(start);
+
+	add(array);
+}
+
+void DocumentBuilder::onObjectStart()
+{
+	Frame frame;
+	frame.type = OBJECT;
+	frame.start = members.size();
+	frame.key = NULL;
+	frames.push_back(frame);
+}
+
+void DocumentBuilder::onObjectEnd()
+{
+	size_t start = frames.back().start;
+	size_t size = members.size() - start;
+	frames.pop_back();
+
+	const DocumentValue* object = document.createObject(
+		(size) ? &members[start] : NULL, size);
+	members.resize(start);
+
+	add(object);
+}
+
+void DocumentBuilder::beginSource(const char* position)
+{
+	sourceStarts.push_back(position);
+}
+
+void DocumentBuilder::endSource(const char* position)
+{
+	sourceEnd = position;
+}
+
+void DocumentBuilder::add(const DocumentValue* value)
+{
+	// the parser only reports sources for persistent input, a value that
+	// ended outside of it has no source
+	if (!sourceStarts.empty())
+	{
+		if (sourceEnd)
+		{
+			document.setSource(value, sourceStarts.back(), sourceEnd - sourceStarts.back());
+		}
+
+		sourceStarts.pop_back();
+		sourceEnd = NULL;
+	}
+
+	if (frames.empty())
+	{
+		result = value;
+		return;
+	}
+
+	Frame& frame = frames.back();
+
+	if (frame.type == ARRAY)
+	{
+		elements.push_back(value);
+	}
+	else
+	{
+		DocumentMember member;
+		member.first = frame.key;
+		member.second = value;
+		members.push_back(member);
+	}
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JSON_DOCUMENTBUILDER_H
+#define JSON_DOCUMENTBUILDER_H
+
+#include "Handler.h"
+#include "DocumentValue.h"
+
+#include <vector>
+
+namespace JSON
+{
+	/**
+	* A Handler which builds the values of a Document from parser events.
+	*
+	* Children of open arrays and objects are collected on scratch stacks
+	* and copied into the document's arena in one piece once the container
+	* is complete. The root is stored in the document on finish().
+	*
+	* While reading persistent input the parser calls beginSource() where
+	* a value begins and endSource() right before reporting its end, so
+	* the document can keep the value's original text.
+	*/
+	class DocumentBuilder : public Handler
+	{
+	public:
+		DocumentBuilder(Document& document);
+
+		void reset();
+		void finish();
+
+		void onNull();
+		void onBool(bool b);
+		void onNumber(const Number& n);
+		void onString(const std::string& s);
+		void onKey(const std::string& key);
+		void onKey(const Number& key);
+		void onArrayStart();
+		void onArrayEnd();
+		void onObjectStart();
+		void onObjectEnd();
+		void onStringReference(const char* data, size_t length);
+		void onKeyReference(const char* data, size_t length);
+		void onNumberReference(const char* data, size_t length);
+
+		void beginSource(const char* position);
+		void endSource(const char* position);
+	private:
+		struct Frame
+		{
+			ValueType type;
+			size_t start;
+			const DocumentValue* key;
+		};
+
+		void add(const DocumentValue* value);
+
+		Document& document;
+
+		std::vector<Frame> frames;
+		std::vector<const DocumentValue*> elements;
+		std::vector<DocumentMember> members;
+		const DocumentValue* result;
+
+		// where the values being read begin and the last one ended
+		std::vector<const char*> sourceStarts;
+		const char* sourceEnd;
+	};
+}
+
+#endif
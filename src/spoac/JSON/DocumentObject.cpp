@@ -0,0 +1,133 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "DocumentObject.h"
+
+#include <cstring>
+
+using namespace JSON;
+
+bool DocumentObject::empty() const
+{
+	return DocumentValue::size == 0;
+}
+
+size_t DocumentObject::size() const
+{
+	return DocumentValue::size;
+}
+
+DocumentObject::const_iterator DocumentObject::begin() const
+{
+	return content.members;
+}
+
+DocumentObject::const_iterator DocumentObject::end() const
+{
+	return content.members + size();
+}
+
+DocumentObject::value_type DocumentObject::operator[](const char* key) const
+{
+	return valueOrNull(find(key));
+}
+
+DocumentObject::value_type DocumentObject::operator[](const std::string& key) const
+{
+	return valueOrNull(find(key));
+}
+
+DocumentObject::value_type DocumentObject::operator[](const Identifier& key) const
+{
+	return valueOrNull(find(key));
+}
+
+DocumentObject::const_iterator DocumentObject::find(const char* key) const
+{
+	return find(key, strlen(key));
+}
+
+DocumentObject::const_iterator DocumentObject::find(const std::string& key) const
+{
+	return find(key.data(), key.size());
+}
+
+DocumentObject::const_iterator DocumentObject::find(const char* key, size_t len) const
+{
+	for (const_iterator it = begin(); it != end(); ++it)
+	{
+		if (it->first->getType() == STRING &&
+			it->first->length() == len &&
+			memcmp(it->first->data(), key, len) == 0)
+		{
+			return it;
+		}
+	}
+
+	return end();
+}
+
+DocumentObject::const_iterator DocumentObject::find(int64_t key) const
+{
+	for (const_iterator it = begin(); it != end(); ++it)
+	{
+		if (it->first->getType() == NUMBER &&
+			it->first->isExactInt() &&
+			it->first->toInt() == key)
+		{
+			return it;
+		}
+	}
+
+	return end();
+}
+
+DocumentObject::const_iterator DocumentObject::find(const Identifier& key) const
+{
+	const Value& value = key.getValue();
+
+	if (key.getType() == STRING)
+	{
+		return find(value.toString().data(), value.toString().size());
+	}
+
+	if (value.isExactInt())
+	{
+		return find(value.toInt());
+	}
+
+	for (const_iterator it = begin(); it != end(); ++it)
+	{
+		if (it->first->getType() == NUMBER &&
+			it->first->toDouble() == value.toDouble())
+		{
+			return it;
+		}
+	}
+
+	return end();
+}
+
+DocumentObject::value_type DocumentObject::valueOrNull(const_iterator it) const
+{
+	if (it == end())
+	{
+		return &DocumentValue::nullValue;
+	}
+
+	return it->second;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JSON_DOCUMENTOBJECT_H
+#define JSON_DOCUMENTOBJECT_H
+
+#include "DocumentValue.h"
+#include "Identifier.h"
+
+namespace JSON
+{
+	/**
+	* Read-only view of an object stored in a Document.
+	*
+	* Members are kept in the order they appeared in the input and are
+	* looked up by a linear scan, which is faster than a tree for the small
+	* objects typically found in configuration files. Iterators dereference
+	* to a DocumentMember with first (key) and second (value) pointers.
+	*
+	* Like Object::operator[] looking up a missing key yields a null value
+	* rather than failing, so lookups can be chained safely.
+	*/
+	class DocumentObject : public DocumentValue
+	{
+	public:
+		typedef const DocumentValue* value_type;
+		typedef const DocumentMember* const_iterator;
+
+		bool empty() const;
+		size_t size() const;
+
+		const_iterator begin() const;
+		const_iterator end() const;
+
+		value_type operator[](const char* key) const;
+		value_type operator[](const std::string& key) const;
+		value_type operator[](const Identifier& key) const;
+
+		const_iterator find(const char* key) const;
+		const_iterator find(const std::string& key) const;
+		const_iterator find(const char* key, size_t len) const;
+		const_iterator find(int64_t key) const;
+		const_iterator find(const Identifier& key) const;
+	private:
+		DocumentObject(); // only ever used as a view of a DocumentValue
+
+		value_type valueOrNull(const_iterator it) const;
+	};
+}
+
+#endif
@@ -0,0 +1,266 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "DocumentValue.h"
+#include "DocumentArray.h"
+#include "DocumentObject.h"
+#include "ValueException.h"
+#include "AllValueTypes.h"
+#include "Handler.h"
+#include "Writer.h"
+
+using namespace JSON;
+
+const DocumentValue DocumentValue::nullValue;
+
+DocumentValue::DocumentValue() :
+	type(NULLTYPE),
+	size(0),
+	source(NULL),
+	sourceLength(0),
+	intValue(0),
+	doubleValue(0.0),
+	exactInt(true)
+{
+	content.string = NULL;
+}
+
+ValueType DocumentValue::getType() const
+{
+	return type;
+}
+
+bool DocumentValue::isNull() const
+{
+	return type == NULLTYPE;
+}
+
+int64_t DocumentValue::toInt() const
+{
+	if (type != NUMBER)
+	{
+		throw ValueException(type, NUMBER);
+	}
+
+	if (size)
+	{
+		return toNumber().toInt();
+	}
+
+	return intValue;
+}
+
+double DocumentValue::toDouble() const
+{
+	if (type != NUMBER)
+	{
+		throw ValueException(type, NUMBER);
+	}
+
+	if (size)
+	{
+		return toNumber().toDouble();
+	}
+
+	return doubleValue;
+}
+
+bool DocumentValue::isExactInt() const
+{
+	if (type != NUMBER)
+	{
+		throw ValueException(type, NUMBER);
+	}
+
+	if (size)
+	{
+		return toNumber().isExactInt();
+	}
+
+	return exactInt;
+}
+
+bool DocumentValue::toBool() const
+{
+	if (type != BOOL)
+	{
+		throw ValueException(type, BOOL);
+	}
+
+	return intValue != 0;
+}
+
+std::string DocumentValue::toString() const
+{
+	return std::string(data(), size);
+}
+
+const char* DocumentValue::data() const
+{
+	if (type != STRING)
+	{
+		throw ValueException(type, STRING);
+	}
+
+	return content.string;
+}
+
+size_t DocumentValue::length() const
+{
+	if (type != STRING)
+	{
+		throw ValueException(type, STRING);
+	}
+
+	return size;
+}
+
+const DocumentArray& DocumentValue::toArray() const
+{
+	if (type != ARRAY)
+	{
+		throw ValueException(type, ARRAY);
+	}
+
+	return static_cast<const DocumentArray&>(*this);
+}
+
+const DocumentObject& DocumentValue::toObject() const
+{
+	if (type != OBJECT)
+	{
+		throw ValueException(type, OBJECT);
+	}
+
+	return static_cast<const DocumentObject&>(*this);
+}
+
+void DocumentValue::_toJSON(std::string& json, const std::string& indent) const
+{
+	Writer writer(json, WRITER_PRETTY, indent);
+	writer.write(*this);
+}
+
+std::string DocumentValue::toJSON() const
+{
+	std::string json;
+	Writer writer(json);
+	writer.write(*this);
+	return json;
+}
+
+const char* DocumentValue::getSource() const
+{
+	return source;
+}
+
+size_t DocumentValue::getSourceLength() const
+{
+	return sourceLength;
+}
+
+std::string DocumentValue::toRawJSON() const
+{
+	if (source)
+	{
+		return std::string(source, sourceLength);
+	}
+
+	std::string json;
+	Writer writer(json, WRITER_COMPACT);
+	writer.write(*this);
+	return json;
+}
+
+/**
+* Reports the value to a handler. Strings and numbers kept as text are
+* passed as references into the document.
+*/
+void DocumentValue::emit(Handler& handler) const
+{
+	switch (type)
+	{
+		case NULLTYPE:
+			handler.onNull();
+		break;
+
+		case BOOL:
+			handler.onBool(intValue != 0);
+		break;
+
+		case NUMBER:
+			if (size)
+			{
+				handler.onNumberReference(content.string, size);
+			}
+			else if (exactInt)
+			{
+				handler.onNumber(Number(intValue));
+			}
+			else
+			{
+				handler.onNumber(Number(doubleValue));
+			}
+		break;
+
+		case STRING:
+			handler.onStringReference(content.string, size);
+		break;
+
+		case ARRAY:
+			handler.onArrayStart();
+
+			for (size_t i = 0; i < size; i++)
+			{
+				content.elements[i]->emit(handler);
+			}
+
+			handler.onArrayEnd();
+		break;
+
+		case OBJECT:
+			handler.onObjectStart();
+
+			for (size_t i = 0; i < size; i++)
+			{
+				const DocumentValue& key = *content.members[i].first;
+
+				if (key.type == STRING)
+				{
+					handler.onKeyReference(key.content.string, key.size);
+				}
+				else if (key.size)
+				{
+					handler.onKey(key.toNumber());
+				}
+				else
+				{
+					handler.onKey(key.exactInt ? Number(key.intValue) : Number(key.doubleValue));
+				}
+
+				content.members[i].second->emit(handler);
+			}
+
+			handler.onObjectEnd();
+		break;
+	}
+}
+
+Number DocumentValue::toNumber() const
+{
+	return Number(content.string, size);
+}
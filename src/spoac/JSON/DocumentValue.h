@@ -0,0 +1,113 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JSON_DOCUMENTVALUE_H
+#define JSON_DOCUMENTVALUE_H
+
+#include "Value.h"
+
+namespace JSON
+{
+	class Document;
+	class DocumentArray;
+	class DocumentObject;
+	class DocumentValue;
+	class Handler;
+	class Number;
+
+	/**
+	* A key value pair of a DocumentObject.
+	*/
+	struct DocumentMember
+	{
+		const DocumentValue* first;
+		const DocumentValue* second;
+	};
+
+	/**
+	* Read-only counterpart of Value for values stored in a Document.
+	*
+	* Document values live in the arena of the Document that created them
+	* and are only valid as long as the Document exists. They offer the
+	* same accessors as Value, so code reading a tree can switch between
+	* the two by changing the types it names. Mismatching accessors throw
+	* a ValueException just like Value does.
+	*
+	* Values read from a file remember where they are in its contents.
+	* toRawJSON() returns those original bytes, so a subtree can be passed
+	* on as JSON without writing it again. Numbers read from a file are
+	* only kept as text and converted whenever they are accessed.
+	*
+	* emit() reports a value to a Handler as a Parser reading it would, so
+	* a document which is kept around can be bound or written again
+	* without reading it from its file a second time.
+	*/
+	class DocumentValue
+	{
+	public:
+		DocumentValue();
+
+		ValueType getType() const;
+		bool isNull() const;
+		int64_t toInt() const;
+		double toDouble() const;
+		bool isExactInt() const;
+		bool toBool() const;
+		std::string toString() const;
+		const char* data() const;
+		size_t length() const;
+		const DocumentArray& toArray() const;
+		const DocumentObject& toObject() const;
+		void _toJSON(std::string& json, const std::string& indent) const;
+		std::string toJSON() const;
+
+		const char* getSource() const;
+		size_t getSourceLength() const;
+		std::string toRawJSON() const;
+
+		void emit(Handler& handler) const;
+
+		static const DocumentValue nullValue;
+	protected:
+		friend class Document;
+
+		ValueType type;
+
+		union
+		{
+			const char* string;
+			const DocumentValue* const* elements;
+			const DocumentMember* members;
+		} content;
+
+		Number toNumber() const;
+
+		// string length, number of elements/members or length of a
+		// number kept as text
+		size_t size;
+
+		// the value's JSON text in the input, if it was persistent
+		const char* source;
+		size_t sourceLength;
+
+		int64_t intValue;
+		double doubleValue;
+		bool exactInt;
+	};
+}
+
+#endif
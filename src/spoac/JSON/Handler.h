@@ -0,0 +1,76 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JSON_HANDLER_H
+#define JSON_HANDLER_H
+
+#include "Number.h"
+
+#include <string>
+
+namespace JSON
+{
+	/**
+	* Receives the events a Parser emits while reading JSON data.
+	*
+	* Implement this interface to process a document as a stream of events
+	* without building a tree of values. Values are reported as soon as
+	* they are complete, object members are reported as an onKey() call
+	* followed by the events of the member's value. The string and number
+	* references are only valid for the duration of the call.
+	*
+	* When reading a file into a Document the parser reports strings
+	* without escapes through onStringReference() and onKeyReference()
+	* and number values through onNumberReference() instead. Their data
+	* points into the file contents, which the document keeps alive, and
+	* is not null terminated. By default they pass a copy to onString()
+	* and onKey(), or the parsed number to onNumber().
+	*/
+	class Handler
+	{
+	public:
+		virtual ~Handler() {};
+
+		virtual void onNull() = 0;
+		virtual void onBool(bool b) = 0;
+		virtual void onNumber(const Number& n) = 0;
+		virtual void onString(const std::string& s) = 0;
+		virtual void onKey(const std::string& key) = 0;
+		virtual void onKey(const Number& key) = 0;
+		virtual void onArrayStart() = 0;
+		virtual void onArrayEnd() = 0;
+		virtual void onObjectStart() = 0;
+		virtual void onObjectEnd() = 0;
+
+		virtual void onStringReference(const char* data, size_t length)
+		{
+			onString(std::string(data, length));
+		}
+
+		virtual void onKeyReference(const char* data, size_t length)
+		{
+			onKey(std::string(data, length));
+		}
+
+		virtual void onNumberReference(const char* data, size_t length)
+		{
+			onNumber(Number(data, length));
+		}
+	};
+}
+
+#endif
@@ -14,126 +14,347 @@
  * limitations under the License.
  */
 
+
 #include "Identifier.h"
 #include "String.h"
 #include "Number.h"
+#include "NumberConversion.h"
+
+#include <pthread.h>
+#include <string.h>
 
 using namespace JSON;
 
-Identifier::Identifier(NumberPtr n) :
-	type(NUMBER),
-	value(n)
+struct Identifier::Entry
 {
+	ValueType type;
+	size_t hash;
+	std::string text;
+	ValuePtr value;
+};
+
+// open addressing table of all interned keys, entries are never freed so
+// the pointers handed out stay valid for the lifetime of the process
+struct Identifier::Table
+{
+	pthread_rwlock_t lock;
+	Entry** slots;
+	size_t capacity;
+	size_t count;
+};
+
+const size_t Identifier::INTERN_LIMIT;
+
+Identifier::Table Identifier::table = {PTHREAD_RWLOCK_INITIALIZER, NULL, 0, 0};
+
+namespace
+{
+	class ReadLock
+	{
+	public:
+		ReadLock(pthread_rwlock_t& lock) : lock(lock) { pthread_rwlock_rdlock(&lock); }
+		~ReadLock() { pthread_rwlock_unlock(&lock); }
+	private:
+		pthread_rwlock_t& lock;
+	};
+
+	class WriteLock
+	{
+	public:
+		WriteLock(pthread_rwlock_t& lock) : lock(lock) { pthread_rwlock_wrlock(&lock); }
+		~WriteLock() { pthread_rwlock_unlock(&lock); }
+	private:
+		pthread_rwlock_t& lock;
+	};
+
+	size_t hashKey(ValueType type, const char* data, size_t len)
+	{
+		// FNV-1a
+		uint64_t hash = 14695981039346656037ULL ^ type;
+		for (size_t i = 0; i < len; i++)
+		{
+			hash = (hash ^ (unsigned char) data[i]) * 1099511628211ULL;
+		}
+		return (size_t) hash;
+	}
 }
 
-Identifier::Identifier(const Number& n) :
-	type(NUMBER),
-	value(new Number(n))
+Identifier::Identifier()
 {
+	init("", 0, true);
 }
 
-Identifier::Identifier(StringPtr s) :
-	type(STRING),
-	value(s)
+Identifier::Identifier(NumberPtr n)
 {
+	init(*n, true);
 }
 
-Identifier::Identifier(const String& s) :
-	type(STRING),
-	value(new String(s))
+Identifier::Identifier(const Number& n)
 {
+	init(n, true);
+}
+
+Identifier::Identifier(StringPtr s)
+{
+	init(s->toString().data(), s->toString().size(), true);
+}
+
+Identifier::Identifier(const String& s)
+{
+	init(s.toString().data(), s.toString().size(), true);
+}
+
+Identifier::Identifier(const char* key)
+{
+	init(key, strlen(key), true);
+}
+
+Identifier::Identifier(const char* key, size_t len)
+{
+	init(key, len, true);
+}
+
+Identifier::Identifier(const std::string& key)
+{
+	init(key.data(), key.size(), true);
 }
 
 Identifier::Identifier(const Identifier& i) :
-	type(i.type)
+	entry(i.entry),
+	owned(i.owned)
 {
-	switch (i.getType())
+}
+
+Identifier::Identifier(const char* key, size_t len, bool add)
+{
+	init(key, len, add);
+}
+
+Identifier::Identifier(const Number& n, bool add)
+{
+	init(n, add);
+}
+
+Identifier Identifier::lookup(const char* key, size_t len)
+{
+	return Identifier(key, len, false);
+}
+
+Identifier Identifier::lookup(const std::string& key)
+{
+	return Identifier(key.data(), key.size(), false);
+}
+
+Identifier Identifier::lookup(const Number& n)
+{
+	return Identifier(n, false);
+}
+
+size_t Identifier::internedCount()
+{
+	ReadLock lock(table.lock);
+	return table.count;
+}
+
+void Identifier::init(const Number& n, bool add)
+{
+	char buffer[NumberConversion::BUFFER_SIZE];
+	size_t len = (n.isExactInt()) ?
+		NumberConversion::formatInt(n.toInt(), buffer) :
+		NumberConversion::formatDouble(n.toDouble(), buffer);
+
+	init(NUMBER, buffer, len, &n, add);
+}
+
+void Identifier::init(const char* data, size_t len, bool add)
+{
+	init(STRING, data, len, NULL, add);
+}
+
+void Identifier::init(ValueType type, const char* data, size_t len, const Number* n, bool add)
+{
+	size_t hash = hashKey(type, data, len);
+
+	{
+		ReadLock lock(table.lock);
+		entry = findEntry(type, hash, data, len);
+	}
+
+	if (entry != NULL)
 	{
-		case STRING:
-			value.reset(new String(*(i.getString())));
-		break;
+		return;
+	}
 
-		case NUMBER:
-			value.reset(new Number(*(i.getNumber())));
-		break;
+	Entry* e = new Entry;
+	e->type = type;
+	e->hash = hash;
+	e->text.assign(data, len);
 
-		default:
-		break;
+	if (type == NUMBER)
+	{
+		e->value.reset(new Number(*n));
 	}
+	else
+	{
+		e->value.reset(new String(e->text));
+	}
+
+	if (add)
+	{
+		WriteLock lock(table.lock);
+
+		// another thread may have added the key in the meantime
+		entry = findEntry(type, hash, data, len);
+
+		if (entry != NULL)
+		{
+			delete e;
+			return;
+		}
+
+		if (table.count < INTERN_LIMIT)
+		{
+			addEntry(e);
+			entry = e;
+			return;
+		}
+	}
+
+	owned.reset(e);
+	entry = e;
+}
+
+const Identifier::Entry* Identifier::findEntry(ValueType type, size_t hash, const char* data, size_t len)
+{
+	if (table.slots == NULL)
+	{
+		return NULL;
+	}
+
+	size_t mask = table.capacity - 1;
+
+	for (size_t i = hash & mask; table.slots[i] != NULL; i = (i + 1) & mask)
+	{
+		const Entry* e = table.slots[i];
+		if (e->hash == hash && e->type == type && e->text.size() == len &&
+			memcmp(e->text.data(), data, len) == 0)
+		{
+			return e;
+		}
+	}
+
+	return NULL;
+}
+
+void Identifier::addEntry(Entry* e)
+{
+	if ((table.count + 1) * 2 > table.capacity)
+	{
+		size_t newCapacity = (table.capacity) ? table.capacity * 2 : 256;
+		Entry** newSlots = new Entry*[newCapacity];
+		memset(newSlots, 0, newCapacity * sizeof(Entry*));
+
+		for (size_t i = 0; i < table.capacity; i++)
+		{
+			if (table.slots[i] != NULL)
+			{
+				size_t j = table.slots[i]->hash & (newCapacity - 1);
+				while (newSlots[j] != NULL)
+				{
+					j = (j + 1) & (newCapacity - 1);
+				}
+				newSlots[j] = table.slots[i];
+			}
+		}
+
+		delete[] table.slots;
+		table.slots = newSlots;
+		table.capacity = newCapacity;
+	}
+
+	size_t i = e->hash & (table.capacity - 1);
+	while (table.slots[i] != NULL)
+	{
+		i = (i + 1) & (table.capacity - 1);
+	}
+	table.slots[i] = e;
+	table.count++;
 }
 
 ValueType Identifier::getType() const
 {
-	return type;
+	return entry->type;
 }
 
-StringPtr Identifier::getString() const
+ConstStringPtr Identifier::getString() const
 {
 	if (getType() != STRING)
 	{
-		return StringPtr();
+		return ConstStringPtr();
 	}
-	return boost::dynamic_pointer_cast<String>(value);
+	return boost::static_pointer_cast<const String>(entry->value);
 }
 
-NumberPtr Identifier::getNumber() const
+ConstNumberPtr Identifier::getNumber() const
 {
 	if (getType() != NUMBER)
 	{
-		return NumberPtr();
+		return ConstNumberPtr();
 	}
-	return boost::dynamic_pointer_cast<Number>(value);
+	return boost::static_pointer_cast<const Number>(entry->value);
 }
 
-void Identifier::_toJSON(std::string& json, const std::string& indent) const
+const Value& Identifier::getValue() const
 {
-	value->_toJSON(json, indent);
+	return *entry->value;
 }
 
-Identifier& Identifier::operator=(const Identifier& i)
+size_t Identifier::hash() const
 {
-	if (&i != this)
-	{
-		switch (i.getType())
-		{
-			case STRING:
-				value.reset(new String(*(i.getString())));
-			break;
+	return entry->hash;
+}
 
-			case NUMBER:
-				value.reset(new Number(*(i.getNumber())));
-			break;
+void Identifier::_toJSON(std::string& json, const std::string& indent) const
+{
+	entry->value->_toJSON(json, indent);
+}
 
-			default:
-			break;
-		}
-	}
+Identifier& Identifier::operator=(const Identifier& i)
+{
+	entry = i.entry;
+	owned = i.owned;
 	return *this;
 }
 
-#define COMPARE(operator) \
-	if (getType() == i.getType()) \
-		switch (getType()) \
-		{ \
-			case STRING: \
-				return *getString() operator *(i.getString()); \
-			case NUMBER: \
-				return *getNumber() operator *(i.getNumber()); \
-			default: \
-				return (getType() operator i.getType()); \
-		} \
-	else return (getType() operator i.getType());
-
 bool Identifier::operator==(const Identifier& i) const
 {
-	COMPARE(==)
+	if (entry == i.entry)
+	{
+		return true;
+	}
+
+	// two interned keys are equal only if they share their entry
+	if (owned.get() == NULL && i.owned.get() == NULL)
+	{
+		return false;
+	}
+
+	return entry->hash == i.entry->hash && entry->type == i.entry->type &&
+		entry->text == i.entry->text;
 }
 
 bool Identifier::operator!=(const Identifier& i) const
 {
-	COMPARE(!=)
+	return !(*this == i);
 }
 
+// ordering compares the keys themselves, strings after numbers
+
+#define COMPARE(operator) \
+	if (getType() == i.getType()) \
+		return getValue() operator i.getValue(); \
+	else return (getType() operator i.getType());
+
 bool Identifier::operator>(const Identifier& i) const
 {
 	COMPARE(>)
@@ -23,21 +23,68 @@ namespace JSON
 {
 	class String;
     typedef boost::shared_ptr<String> StringPtr;
+    typedef boost::shared_ptr<const String> ConstStringPtr;
 	class Number;
     typedef boost::shared_ptr<Number> NumberPtr;
+    typedef boost::shared_ptr<const Number> ConstNumberPtr;
 
+	/**
+	* Key of an object member, either a String or a Number.
+	*
+	* Identifiers are interned: the first INTERN_LIMIT distinct keys are
+	* stored once in a process wide table and an Identifier is only a
+	* handle to its entry. Copying interned identifiers and comparing them
+	* for equality is as cheap as copying and comparing a pointer. Interned
+	* keys are never released. Once the table is full further keys are
+	* owned by the identifiers holding them and compared by hash and text,
+	* so documents with arbitrary keys like object ids cannot grow the
+	* table without bound.
+	*
+	* Looking a key up in the table takes a shared lock, only adding a new
+	* key takes an exclusive one. Identifiers created with lookup() never
+	* add to the table, they are used to find members. Code that accesses
+	* the same members over and over should create its identifiers once
+	* and reuse them, e.g.
+	*
+	*     static const JSON::Identifier nameKey("name");
+	*     object[nameKey]->toString();
+	*
+	* Numbers are interned by value, so 1 and 1.0 are the same key.
+	*/
 	class Identifier
 	{
 	public:
+		Identifier();
 		Identifier(NumberPtr n);
 		Identifier(const Number& n);
 		Identifier(StringPtr s);
 		Identifier(const String& s);
+		Identifier(const char* key);
+		Identifier(const char* key, size_t len);
+		Identifier(const std::string& key);
 		Identifier(const Identifier& i);
 
+		// number of keys interned at most
+		static const size_t INTERN_LIMIT = 16384;
+
+		/**
+		* Creates an identifier without adding its key to the table, e.g.
+		* to find a member by a key which may not exist.
+		*/
+		static Identifier lookup(const char* key, size_t len);
+		static Identifier lookup(const std::string& key);
+		static Identifier lookup(const Number& n);
+
+		/**
+		* Returns the number of keys in the table.
+		*/
+		static size_t internedCount();
+
 		ValueType getType() const;
-		StringPtr getString() const;
-		NumberPtr getNumber() const;
+		ConstStringPtr getString() const;
+		ConstNumberPtr getNumber() const;
+		const Value& getValue() const;
+		size_t hash() const;
 		void _toJSON(std::string& json, const std::string& indent) const;
 
 		Identifier& operator=(const Identifier& i);
@@ -48,8 +95,24 @@ namespace JSON
 		bool operator>=(const Identifier& i) const;
 		bool operator<=(const Identifier& i) const;
 	private:
-		ValueType type;
-		ValuePtr value;
+		struct Entry;
+		struct Table;
+
+		Identifier(const char* key, size_t len, bool add);
+		Identifier(const Number& n, bool add);
+
+		void init(const char* data, size_t len, bool add);
+		void init(const Number& n, bool add);
+		void init(ValueType type, const char* data, size_t len, const Number* n, bool add);
+
+		static const Entry* findEntry(ValueType type, size_t hash, const char* data, size_t len);
+		static void addEntry(Entry* e);
+
+		static Table table;
+
+		const Entry* entry;
+		// holds the entry of a key which is not interned
+		boost::shared_ptr<const Entry> owned;
 	};
 
     typedef boost::shared_ptr<Identifier> IdentifierPtr;
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+
+#ifndef MAP_POPULATE
+#define MAP_POPULATE 0
+#endif
+
+using namespace JSON;
+
+static const size_t blockSize = 64 * 1024;
+
+// below this size setting up a mapping costs more than copying the data
+static const size_t mapThreshold = 256 * 1024;
+
+MappedFile::MappedFile(const std::string& path, FileAccess access) :
+	open(false),
+	mapping(MAP_FAILED),
+	length(0)
+{
+	int fd = ::open(path.c_str(), O_RDONLY);
+
+	if (fd == -1)
+	{
+		return;
+	}
+
+	struct stat info;
+
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode))
+	{
+		length = info.st_size;
+
+		if (access == FILE_COPY || (length < mapThreshold && access != FILE_MAP_LAZY))
+		{
+			open = readBlocks(fd, length);
+		}
+		else if (length > 0)
+		{
+			// a lazy mapping reads each page on first access only
+			int flags = (access == FILE_MAP_LAZY) ? MAP_PRIVATE : MAP_PRIVATE | MAP_POPULATE;
+			mapping = mmap(NULL, length, PROT_READ, flags, fd, 0);
+
+			open = (mapping != MAP_FAILED);
+		}
+	}
+
+	if (!open)
+	{
+		open = readBlocks(fd, blockSize);
+	}
+
+	close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+	if (mapping != MAP_FAILED)
+	{
+		munmap(mapping, length);
+	}
+}
+
+bool MappedFile::readBlocks(int fd, size_t expectedSize)
+{
+	length = 0;
+	buffer.clear();
+
+	size_t size = (expectedSize) ? expectedSize : blockSize;
+
+	while (true)
+	{
+		buffer.resize(length + size);
+		ssize_t count = ::read(fd, &buffer[length], size);
+
+		if (count < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			return false;
+		}
+
+		if (count == 0)
+		{
+			break;
+		}
+
+		length += count;
+
+		// continue in the rest of the block or start a new one
+		size = ((size_t) count == size) ? blockSize : size - count;
+	}
+
+	buffer.resize(length);
+	return true;
+}
+
+bool MappedFile::isOpen() const
+{
+	return open;
+}
+
+const char* MappedFile::data() const
+{
+	if (mapping != MAP_FAILED)
+	{
+		return static_cast<const char*>(mapping);
+	}
+
+	return (length) ? &buffer[0] : NULL;
+}
+
+size_t MappedFile::size() const
+{
+	return length;
+}
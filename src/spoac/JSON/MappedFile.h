@@ -0,0 +1,74 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JSON_MAPPEDFILE_H
+#define JSON_MAPPEDFILE_H
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+namespace JSON
+{
+	/**
+	* An enum of the ways a MappedFile can read a file.
+	*/
+	typedef enum
+	{
+		FILE_MAP,
+		FILE_COPY,
+		FILE_MAP_LAZY
+	} FileAccess;
+
+	/**
+	* The read-only contents of a file as one contiguous buffer.
+	*
+	* Large files are mapped into memory where possible. Small files and
+	* files which cannot be mapped, like pipes, are read in large blocks
+	* instead. The contents
+	* stay valid until the object is destroyed, the file must not be
+	* truncated while it is mapped. With FILE_COPY a file is always read,
+	* so the contents do not change even if the file is rewritten. With
+	* FILE_MAP_LAZY a file is always mapped and its pages are only read
+	* when they are first accessed, for large files of which little is
+	* used.
+	*/
+	class MappedFile
+	{
+	public:
+		MappedFile(const std::string& path, FileAccess access = FILE_MAP);
+		~MappedFile();
+
+		bool isOpen() const;
+		const char* data() const;
+		size_t size() const;
+	private:
+		MappedFile(const MappedFile&) {}; // do not allow copying
+		MappedFile& operator=(const MappedFile&) { return *this; }; // do not allow assignment
+
+		bool readBlocks(int fd, size_t expectedSize);
+
+		bool open;
+		void* mapping;
+		size_t length;
+		std::vector<char> buffer;
+	};
+
+	typedef boost::shared_ptr<MappedFile> MappedFilePtr;
+}
+
+#endif
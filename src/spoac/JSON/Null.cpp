@@ -27,8 +27,3 @@ bool Null::isNull() const
 {
 	return true;
 }
-
-void Null::_toJSON(std::string& json, const std::string& indent) const
-{
-	json.append("null");
-}
@@ -33,7 +33,6 @@ namespace JSON
 		Null();
 
 		bool isNull() const;
-		void _toJSON(std::string& json, const std::string& indent) const;
 	private:
 	};
 
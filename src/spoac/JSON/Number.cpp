@@ -15,7 +15,9 @@
  */
 
 #include "Number.h"
-#include <sstream>
+#include "NumberConversion.h"
+
+#include <cstring>
 #include <limits>
 
 using namespace JSON;
@@ -47,50 +49,61 @@ Number::Number(int64_t iVal) :
 Number::Number(double dVal) :
 	Value(NUMBER)
 {
-	intValue = (int64_t) dVal;
-	doubleValue = dVal;
-	exactInt = ((double) intValue == dVal) ? true : false;
+	setDouble(dVal);
 }
 
 Number::Number(const std::string& number) :
 	Value(NUMBER)
 {
+	parse(number.data(), number.size());
+}
+
+Number::Number(const char* data, size_t len) :
+	Value(NUMBER)
+{
+	parse(data, len);
+}
 
-	if (number == "NaN")
+void Number::parse(const char* data, size_t len)
+{
+	if (len == 3 && memcmp(data, "NaN", 3) == 0)
 	{
-		doubleValue = std::numeric_limits<double>::quiet_NaN();
-		intValue = (int64_t) doubleValue;
-		exactInt = false;
+		setDouble(std::numeric_limits<double>::quiet_NaN());
 		return;
 	}
 
-	// check whether it's a double
-	bool isDouble = false;
-	for (std::string::const_iterator it = number.begin(); !isDouble && it != number.end(); ++it)
+	bool isDouble;
+
+	if (!NumberConversion::parse(data, len, intValue, doubleValue, isDouble))
+	{
+		intValue = 0;
+		doubleValue = 0.0;
+		exactInt = true;
+	}
+	else if (isDouble)
+	{
+		setDouble(doubleValue);
+	}
+	else
 	{
-		switch (*it)
-		{
-			case 'e':
-			case 'E':
-			case '.':
-				isDouble = true;
-			break;
-		}
+		exactInt = true;
 	}
-	// parse the number
-	std::istringstream in(number);
+}
 
-	if (isDouble)
+void Number::setDouble(double dVal)
+{
+	// only convert doubles within the range of int64_t, 2^63 itself is not
+	if (dVal >= -9223372036854775808.0 && dVal < 9223372036854775808.0)
 	{
-		in >> doubleValue;
-		intValue = (int64_t) doubleValue;
+		intValue = (int64_t) dVal;
 	}
 	else
 	{
-		in >> intValue;
-		doubleValue = intValue;
+		intValue = (dVal > 0) ? std::numeric_limits<int64_t>::max() : std::numeric_limits<int64_t>::min();
 	}
-	exactInt = ((double) intValue == doubleValue) ? true : false;
+
+	doubleValue = dVal;
+	exactInt = ((double) intValue == dVal && dVal < 9223372036854775808.0) ? true : false;
 }
 
 Number::Number(const Number& n) :
@@ -116,27 +129,6 @@ bool Number::isExactInt() const
 	return exactInt;
 }
 
-void Number::_toJSON(std::string& json, const std::string& indent) const
-{
-	// use a stringstream to read in the number and then write it into a
-	// tring
-	std::stringstream ss;
-	std::string num;
-
-	if (exactInt)
-	{
-		ss << intValue;
-	}
-	else
-	{
-		ss << doubleValue;
-	}
-
-	ss >> num;
-	
-	json.append(num);
-}
-
 bool Number::operator==(const Value& v) const
 {
 	if (getType() == v.getType())
@@ -27,6 +27,7 @@ namespace JSON
 	* A number is either an integer or a double. It can be constructed from
 	* a string containing the number in JSON format. To find out whether it
 	* is an exact integer value you can use the isExactInt() method.
+	* Integers too large for 64 bit are read as doubles.
 	*/
 	class Number : public Value
 	{
@@ -36,11 +37,11 @@ namespace JSON
 		Number(int64_t iVal);
 		Number(double dVal);
 		Number(const std::string& number);
+		Number(const char* data, size_t len);
 		Number(const Number& n);
 
 		int64_t toInt() const;
 		double toDouble() const;
-		void _toJSON(std::string& json, const std::string& indent) const;
 		bool isExactInt() const;
 
 		bool operator==(const Value& v) const;
@@ -50,6 +51,9 @@ namespace JSON
 		bool operator>=(const Value& v) const;
 		bool operator<=(const Value& v) const;
 	private:
+		void parse(const char* data, size_t len);
+		void setDouble(double dVal);
+
 		int64_t intValue;
 		double doubleValue;
 		bool exactInt;
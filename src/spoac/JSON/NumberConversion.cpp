@@ -0,0 +1,573 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "NumberConversion.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <locale.h>
+
+using namespace JSON;
+
+// double values of 10^0 to 10^22, all of which are exact
+static const double exactPowers[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const uint64_t powers10[] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+	10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+	100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+	100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+	100000000000000000ULL, 1000000000000000000ULL,
+	10000000000000000000ULL
+};
+
+static inline bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+/**
+* Converts the given number with strtod in the "C" locale. Only used for
+* the rare numbers the fast path in parse() cannot round correctly.
+*/
+static double slowParse(const char* data, size_t len)
+{
+	std::string number(data, len);
+
+#ifdef __GLIBC__
+	static locale_t cLocale = newlocale(LC_ALL_MASK, "C", (locale_t) 0);
+	return strtod_l(number.c_str(), NULL, cLocale);
+#else
+	return strtod(number.c_str(), NULL);
+#endif
+}
+
+bool NumberConversion::parse(const char* data, size_t len, int64_t& intValue, double& doubleValue, bool& isDouble)
+{
+	const char* p = data;
+	const char* end = data + len;
+
+	bool negative = false;
+	bool anyDigits = false;
+	bool truncated = false;
+
+	// the first 19 significant digits, which always fit into 64 bit
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+
+	isDouble = false;
+
+	if (p != end && (*p == '-' || *p == '+'))
+	{
+		negative = (*p == '-');
+		++p;
+	}
+
+	for (; p != end && isDigit(*p); ++p)
+	{
+		anyDigits = true;
+
+		if (digits < 19)
+		{
+			mantissa = mantissa * 10 + (*p - '0');
+			digits += (mantissa) ? 1 : 0;
+		}
+		else
+		{
+			++exponent;
+			truncated = truncated || (*p != '0');
+		}
+	}
+
+	if (p != end && *p == '.')
+	{
+		isDouble = true;
+
+		for (++p; p != end && isDigit(*p); ++p)
+		{
+			anyDigits = true;
+
+			if (digits < 19)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				digits += (mantissa) ? 1 : 0;
+				--exponent;
+			}
+			else
+			{
+				truncated = truncated || (*p != '0');
+			}
+		}
+	}
+
+	if (!anyDigits)
+	{
+		return false;
+	}
+
+	if (p != end && (*p == 'e' || *p == 'E'))
+	{
+		bool negativeExponent = false;
+		int value = 0;
+
+		isDouble = true;
+		++p;
+
+		if (p != end && (*p == '-' || *p == '+'))
+		{
+			negativeExponent = (*p == '-');
+			++p;
+		}
+
+		if (p == end || !isDigit(*p))
+		{
+			return false;
+		}
+
+		for (; p != end && isDigit(*p); ++p)
+		{
+			// anything beyond this is zero or infinity anyway
+			if (value < 100000)
+			{
+				value = value * 10 + (*p - '0');
+			}
+		}
+
+		exponent += (negativeExponent) ? -value : value;
+	}
+
+	if (p != end)
+	{
+		return false;
+	}
+
+	if (!isDouble)
+	{
+		const uint64_t limit = 0x7FFFFFFFFFFFFFFFULL + ((negative) ? 1 : 0);
+
+		if (exponent == 0 && mantissa <= limit)
+		{
+			intValue = (negative) ? (int64_t) (0 - mantissa) : (int64_t) mantissa;
+			doubleValue = (double) intValue;
+			return true;
+		}
+
+		// integers out of range are read as doubles
+		isDouble = true;
+	}
+
+	// both the mantissa and the power of ten are exact doubles, so a single
+	// multiplication or division rounds correctly
+	if (!truncated && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22)
+	{
+		double value = (double) mantissa;
+		value = (exponent < 0) ? value / exactPowers[-exponent] : value * exactPowers[exponent];
+		doubleValue = (negative) ? -value : value;
+	}
+	else
+	{
+		doubleValue = slowParse(data, len);
+	}
+
+	return true;
+}
+
+size_t NumberConversion::formatInt(int64_t value, char* buffer)
+{
+	char digits[20];
+	size_t count = 0;
+	size_t length = 0;
+	uint64_t magnitude = (value < 0) ? 0 - (uint64_t) value : (uint64_t) value;
+
+	do
+	{
+		digits[count++] = '0' + (char) (magnitude % 10);
+		magnitude /= 10;
+	}
+	while (magnitude);
+
+	if (value < 0)
+	{
+		buffer[length++] = '-';
+	}
+
+	while (count)
+	{
+		buffer[length++] = digits[--count];
+	}
+
+	return length;
+}
+
+// Grisu2, see Florian Loitsch, "Printing Floating-Point Numbers Quickly and
+// Accurately with Integers", PLDI 2010
+
+namespace
+{
+	const uint64_t significandMask = 0x000FFFFFFFFFFFFFULL;
+	const uint64_t exponentMask = 0x7FF0000000000000ULL;
+	const uint64_t hiddenBit = 0x0010000000000000ULL;
+	const int significandSize = 52;
+	const int exponentBias = 0x3FF + significandSize;
+	const int minExponent = -exponentBias;
+
+	/**
+	* A floating point number with a 64 bit significand f and binary
+	* exponent e, without any implicit bits.
+	*/
+	struct DiyFp
+	{
+		DiyFp() : f(0), e(0) {}
+		DiyFp(uint64_t f, int e) : f(f), e(e) {}
+
+		explicit DiyFp(double d)
+		{
+			uint64_t bits;
+			memcpy(&bits, &d, sizeof(bits));
+
+			int biasedExponent = (int) ((bits & exponentMask) >> significandSize);
+			uint64_t significand = bits & significandMask;
+
+			if (biasedExponent != 0)
+			{
+				f = significand + hiddenBit;
+				e = biasedExponent - exponentBias;
+			}
+			else
+			{
+				f = significand;
+				e = minExponent + 1;
+			}
+		}
+
+		DiyFp operator-(const DiyFp& rhs) const
+		{
+			return DiyFp(f - rhs.f, e);
+		}
+
+		// the upper 64 bits of the product, rounded
+		DiyFp operator*(const DiyFp& rhs) const
+		{
+			const uint64_t mask32 = 0xFFFFFFFFULL;
+			uint64_t a = f >> 32;
+			uint64_t b = f & mask32;
+			uint64_t c = rhs.f >> 32;
+			uint64_t d = rhs.f & mask32;
+			uint64_t ac = a * c;
+			uint64_t bc = b * c;
+			uint64_t ad = a * d;
+			uint64_t bd = b * d;
+			uint64_t tmp = (bd >> 32) + (ad & mask32) + (bc & mask32);
+			tmp += 1ULL << 31;
+			return DiyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e + rhs.e + 64);
+		}
+
+		DiyFp normalize() const
+		{
+			DiyFp result = *this;
+
+			while (!(result.f & 0x8000000000000000ULL))
+			{
+				result.f <<= 1;
+				result.e--;
+			}
+
+			return result;
+		}
+
+		DiyFp normalizeBoundary() const
+		{
+			DiyFp result = *this;
+
+			while (!(result.f & (hiddenBit << 1)))
+			{
+				result.f <<= 1;
+				result.e--;
+			}
+
+			result.f <<= (64 - significandSize - 2);
+			result.e -= (64 - significandSize - 2);
+			return result;
+		}
+
+		// the boundaries between this and its neighbouring doubles
+		void normalizedBoundaries(DiyFp& minus, DiyFp& plus) const
+		{
+			plus = DiyFp((f << 1) + 1, e - 1).normalizeBoundary();
+			minus = (f == hiddenBit) ? DiyFp((f << 2) - 1, e - 2) : DiyFp((f << 1) - 1, e - 1);
+			minus.f <<= minus.e - plus.e;
+			minus.e = plus.e;
+		}
+
+		uint64_t f;
+		int e;
+	};
+
+	// normalized significands and binary exponents of 10^-348 to 10^340 in
+	// steps of 8
+	const uint64_t cachedPowersF[] = {
+	0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL, 0xcf42894a5dce35eaULL,
+	0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL, 0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL,
+	0xbe5691ef416bd60cULL, 0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+	0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL, 0xc21094364dfb5637ULL,
+	0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL, 0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL,
+	0xb23867fb2a35b28eULL, 0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+	0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL, 0xb5b5ada8aaff80b8ULL,
+	0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL, 0x964e858c91ba2655ULL, 0xdff9772470297ebdULL,
+	0xa6dfbd9fb8e5b88fULL, 0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+	0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL, 0xaa242499697392d3ULL,
+	0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL, 0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL,
+	0x9c40000000000000ULL, 0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+	0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL, 0x9f4f2726179a2245ULL,
+	0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL, 0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL,
+	0x924d692ca61be758ULL, 0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+	0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL, 0x952ab45cfa97a0b3ULL,
+	0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL, 0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL,
+	0x88fcf317f22241e2ULL, 0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+	0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL, 0x8bab8eefb6409c1aULL,
+	0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL, 0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL,
+	0x80444b5e7aa7cf85ULL, 0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+	0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+	};
+
+	const int16_t cachedPowersE[] = {
+	-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+	-954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+	-688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+	-422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+	-157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+	109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+	375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+	641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+	907, 933, 960, 986, 1013, 1039, 1066
+	};
+
+	DiyFp getCachedPower(int e, int& k)
+	{
+		double dk = (-61 - e) * 0.30102999566398114 + 347;
+		int ik = (int) dk;
+
+		if (dk - ik > 0.0)
+		{
+			ik++;
+		}
+
+		unsigned int index = (unsigned int) ((ik >> 3) + 1);
+		k = -(-348 + (int) (index << 3));
+		return DiyFp(cachedPowersF[index], cachedPowersE[index]);
+	}
+
+	void grisuRound(char* buffer, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance)
+	{
+		while (rest < distance && delta - rest >= tenKappa &&
+			(rest + tenKappa < distance || distance - rest > rest + tenKappa - distance))
+		{
+			buffer[length - 1]--;
+			rest += tenKappa;
+		}
+	}
+
+	int countDigits(uint32_t n)
+	{
+		int count = 1;
+
+		while (count < 10 && n >= powers10[count])
+		{
+			count++;
+		}
+
+		return count;
+	}
+
+	void digitGen(const DiyFp& w, const DiyFp& mp, uint64_t delta, char* buffer, int& length, int& k)
+	{
+		const DiyFp one(1ULL << -mp.e, mp.e);
+		const DiyFp distance = mp - w;
+		uint32_t p1 = (uint32_t) (mp.f >> -one.e);
+		uint64_t p2 = mp.f & (one.f - 1);
+		int kappa = countDigits(p1);
+
+		length = 0;
+
+		while (kappa > 0)
+		{
+			uint32_t d = (uint32_t) (p1 / powers10[kappa - 1]);
+			p1 = (uint32_t) (p1 % powers10[kappa - 1]);
+
+			if (d || length)
+			{
+				buffer[length++] = '0' + (char) d;
+			}
+
+			kappa--;
+
+			uint64_t rest = ((uint64_t) p1 << -one.e) + p2;
+
+			if (rest <= delta)
+			{
+				k += kappa;
+				grisuRound(buffer, length, delta, rest, powers10[kappa] << -one.e, distance.f);
+				return;
+			}
+		}
+
+		while (true)
+		{
+			p2 *= 10;
+			delta *= 10;
+
+			char d = (char) (p2 >> -one.e);
+
+			if (d || length)
+			{
+				buffer[length++] = '0' + d;
+			}
+
+			p2 &= one.f - 1;
+			kappa--;
+
+			if (p2 < delta)
+			{
+				k += kappa;
+				int index = -kappa;
+				grisuRound(buffer, length, delta, p2, one.f, distance.f * ((index < 20) ? powers10[index] : 0));
+				return;
+			}
+		}
+	}
+
+	// writes the digits of a positive finite value, which is digits * 10^k
+	void grisu2(double value, char* buffer, int& length, int& k)
+	{
+		const DiyFp v(value);
+		DiyFp minus, plus;
+		v.normalizedBoundaries(minus, plus);
+
+		const DiyFp cached = getCachedPower(plus.e, k);
+		const DiyFp w = v.normalize() * cached;
+		DiyFp wPlus = plus * cached;
+		DiyFp wMinus = minus * cached;
+
+		wMinus.f++;
+		wPlus.f--;
+
+		digitGen(w, wPlus, wPlus.f - wMinus.f, buffer, length, k);
+	}
+
+	// formats digits * 10^k like JavaScript's Number.prototype.toString()
+	size_t prettify(char* buffer, int length, int k)
+	{
+		// the decimal point is behind the first kk digits
+		const int kk = length + k;
+
+		if (k >= 0 && kk <= 21)
+		{
+			memset(buffer + length, '0', k);
+			return kk;
+		}
+
+		if (kk > 0 && kk <= 21)
+		{
+			memmove(buffer + kk + 1, buffer + kk, length - kk);
+			buffer[kk] = '.';
+			return length + 1;
+		}
+
+		if (kk > -6 && kk <= 0)
+		{
+			const int offset = 2 - kk;
+			memmove(buffer + offset, buffer, length);
+			buffer[0] = '0';
+			buffer[1] = '.';
+			memset(buffer + 2, '0', offset - 2);
+			return length + offset;
+		}
+
+		size_t result = length;
+
+		if (length > 1)
+		{
+			memmove(buffer + 2, buffer + 1, length - 1);
+			buffer[1] = '.';
+			result++;
+		}
+
+		buffer[result++] = 'e';
+
+		int exponent = kk - 1;
+
+		if (exponent < 0)
+		{
+			buffer[result++] = '-';
+			exponent = -exponent;
+		}
+
+		if (exponent >= 100)
+		{
+			buffer[result++] = '0' + (char) (exponent / 100);
+			exponent %= 100;
+			buffer[result++] = '0' + (char) (exponent / 10);
+		}
+		else if (exponent >= 10)
+		{
+			buffer[result++] = '0' + (char) (exponent / 10);
+		}
+
+		buffer[result++] = '0' + (char) (exponent % 10);
+		return result;
+	}
+}
+
+size_t NumberConversion::formatDouble(double value, char* buffer)
+{
+	if (value != value)
+	{
+		memcpy(buffer, "NaN", 3);
+		return 3;
+	}
+
+	size_t sign = 0;
+
+	if (value < 0.0 || (value == 0.0 && 1.0 / value < 0.0))
+	{
+		buffer[sign++] = '-';
+		value = -value;
+	}
+
+	if (value == 0.0)
+	{
+		buffer[sign] = '0';
+		return sign + 1;
+	}
+
+	if (value > 1.7976931348623157e308)
+	{
+		memcpy(buffer + sign, "inf", 3);
+		return sign + 3;
+	}
+
+	int length;
+	int k;
+
+	grisu2(value, buffer + sign, length, k);
+	return sign + prettify(buffer + sign, length, k);
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JSON_NUMBERCONVERSION_H
+#define JSON_NUMBERCONVERSION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace JSON
+{
+	/**
+	* Converts numbers between their JSON text and binary representation
+	* without streams, allocations or dependence on the current locale.
+	*
+	* parse() reads integers exactly and rounds doubles correctly. Doubles
+	* are formatted with the Grisu2 algorithm, which yields the shortest
+	* digits that read back as the same value in nearly all cases, in the
+	* notation JavaScript uses for numbers.
+	*/
+	class NumberConversion
+	{
+	public:
+		// enough for any formatted int64_t or double
+		static const size_t BUFFER_SIZE = 32;
+
+		static bool parse(const char* data, size_t len, int64_t& intValue, double& doubleValue, bool& isDouble);
+		static size_t formatInt(int64_t value, char* buffer);
+		static size_t formatDouble(double value, char* buffer);
+	};
+}
+
+#endif
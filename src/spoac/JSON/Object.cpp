@@ -14,13 +14,17 @@
  * limitations under the License.
  */
 
+
 #include "Object.h"
-#include "Identifier.h"
 #include "String.h"
 #include "Number.h"
 
+#include <string.h>
+
 using namespace JSON;
 
+static const size_t NOT_FOUND = (size_t) -1;
+
 Object::Object() :
 	Value(OBJECT)
 {
@@ -28,39 +32,49 @@ Object::Object() :
 
 Object::Object(const Object& o) :
 	Value(o),
-	map(o.map)
+	members(o.members),
+	index(o.index)
+{
+}
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+Object::Object(Object&& o) :
+	Value(o),
+	members(std::move(o.members)),
+	index(std::move(o.index))
 {
 }
+#endif
 
 bool Object::empty() const
 {
-	return map.empty();
+	return members.empty();
 }
 
 size_t Object::size() const
 {
-	return map.size();
+	return members.size();
 }
 
 
 Object::iterator Object::begin()
 {
-	return map.begin();
+	return members.begin();
 }
 
 Object::iterator Object::end()
 {
-	return map.end();
+	return members.end();
 }
 
 Object::const_iterator Object::begin() const
 {
-	return map.begin();
+	return members.begin();
 }
 
 Object::const_iterator Object::end() const
 {
-	return map.end();
+	return members.end();
 }
 
 
@@ -68,22 +82,47 @@ Object& Object::operator=(const Object& o)
 {
 	if (&o != this)
 	{
-		map = o.map;
+		members = o.members;
+		index = o.index;
 	}
 	return *this;
 }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+Object& Object::operator=(Object&& o)
+{
+	members = std::move(o.members);
+	index = std::move(o.index);
+	return *this;
+}
+#endif
+
+void Object::swap(Object& o)
+{
+	members.swap(o.members);
+	index.swap(o.index);
+}
+
 
 Object::value_type& Object::operator[](const Identifier& key)
 {
-	Object::value_type& value = map[key];
+	size_t pos = position(key);
+
+	if (pos == NOT_FOUND)
+	{
+		pos = members.size();
+		members.push_back(member_type(key, value_type()));
+		addToIndex(pos);
+	}
+
+	Object::value_type& value = members[pos].second;
 
 	if (value == Object::value_type()) // make sure it's a valid pointer
 	{
 		value = Object::value_type(new Value);
 	}
 
-	return map[key];
+	return value;
 }
 
 Object::value_type& Object::operator[](const Number& key)
@@ -100,13 +139,13 @@ Object::value_type& Object::operator[](const String& key)
 
 Object::value_type& Object::operator[](const char* key)
 {
-	String i(key);
+	Identifier i(key);
 	return (*this)[i];
 }
 
 Object::value_type& Object::operator[](const std::string& key)
 {
-	String i(key);
+	Identifier i(key);
 	return (*this)[i];
 }
 
@@ -131,30 +170,31 @@ Object::value_type& Object::operator[](double key)
 
 Object::iterator Object::find(const Identifier& key)
 {
-	return map.find(key);
+	size_t pos = position(key);
+	return (pos == NOT_FOUND) ? members.end() : members.begin() + pos;
 }
 
 Object::iterator Object::find(const String& key)
 {
-	Identifier i(key);
+	Identifier i = Identifier::lookup(key.toString());
 	return find(i);
 }
 
 Object::iterator Object::find(const Number& key)
 {
-	Identifier i(key);
+	Identifier i = Identifier::lookup(key);
 	return find(i);
 }
 
 Object::iterator Object::find(const char* key)
 {
-	String i(key);
+	Identifier i = Identifier::lookup(key, strlen(key));
 	return find(i);
 }
 
 Object::iterator Object::find(const std::string& key)
 {
-	String i(key);
+	Identifier i = Identifier::lookup(key);
 	return find(i);
 }
 
@@ -179,24 +219,31 @@ Object::iterator Object::find(double key)
 
 Object::const_iterator Object::find(const Identifier& key) const
 {
-	return map.find(key);
+	size_t pos = position(key);
+	return (pos == NOT_FOUND) ? members.end() : members.begin() + pos;
 }
 
 Object::const_iterator Object::find(const String& key) const
 {
-	Identifier i(key);
+	Identifier i = Identifier::lookup(key.toString());
 	return find(i);
 }
 
 Object::const_iterator Object::find(const Number& key) const
 {
-	Identifier i(key);
+	Identifier i = Identifier::lookup(key);
 	return find(i);
 }
 
 Object::const_iterator Object::find(const char* key) const
 {
-	String i(key);
+	Identifier i = Identifier::lookup(key, strlen(key));
+	return find(i);
+}
+
+Object::const_iterator Object::find(const std::string& key) const
+{
+	Identifier i = Identifier::lookup(key);
 	return find(i);
 }
 
@@ -221,7 +268,21 @@ Object::const_iterator Object::find(double key) const
 
 std::pair<Object::iterator, bool> Object::insert(const Identifier& key, value_type val)
 {
-	return map.insert(std::pair<Identifier, value_type>(key, val));
+	size_t pos = position(key);
+
+	if (pos != NOT_FOUND)
+	{
+		return std::pair<iterator, bool>(members.begin() + pos, false);
+	}
+
+	// the value is swapped into place, which saves updating its reference
+	// count for a temporary copy
+	pos = members.size();
+	members.push_back(member_type(key, value_type()));
+	members.back().second.swap(val);
+	addToIndex(pos);
+
+	return std::pair<iterator, bool>(members.begin() + pos, true);
 }
 
 std::pair<Object::iterator, bool> Object::insert(const String& key, value_type val)
@@ -238,13 +299,13 @@ std::pair<Object::iterator, bool> Object::insert(const Number& key, value_type v
 
 std::pair<Object::iterator, bool> Object::insert(const char* key, value_type val)
 {
-	String i(key);
+	Identifier i(key);
 	return insert(i, val);
 }
 
 std::pair<Object::iterator, bool> Object::insert(const std::string& key, value_type val)
 {
-	String i(key);
+	Identifier i(key);
 	return insert(i, val);
 }
 
@@ -269,31 +330,36 @@ std::pair<Object::iterator, bool> Object::insert(double key, value_type val)
 
 void Object::erase(const Identifier& key)
 {
-	iterator position = find(key);
-	map.erase(position);
+	size_t pos = position(key);
+
+	if (pos != NOT_FOUND)
+	{
+		members.erase(members.begin() + pos);
+		rebuildIndex();
+	}
 }
 
 void Object::erase(const String& key)
 {
-	Identifier i(key);
+	Identifier i = Identifier::lookup(key.toString());
 	erase(i);
 }
 
 void Object::erase(const Number& key)
 {
-	Identifier i(key);
+	Identifier i = Identifier::lookup(key);
 	erase(i);
 }
 
 void Object::erase(const char* key)
 {
-	String i(key);
+	Identifier i = Identifier::lookup(key, strlen(key));
 	erase(i);
 }
 
 void Object::erase(const std::string& key)
 {
-	String i(key);
+	Identifier i = Identifier::lookup(key);
 	erase(i);
 }
 
@@ -325,42 +391,78 @@ const Object& Object::toObject() const
 	return *this;
 }
 
-void Object::_toJSON(std::string& json, const std::string& indent) const
+size_t Object::position(const Identifier& key) const
 {
-	std::string subindent = indent;
-	subindent.append("\t");
-
-	if (!empty())
+	if (index.empty())
 	{
-		json.append("{\n");
-		json.append(subindent);
-
-		for (Object::const_iterator it = begin(); it != end(); ++it)
+		for (size_t pos = 0; pos < members.size(); pos++)
 		{
-			if (it != begin())
+			if (members[pos].first == key)
 			{
-				json.append(",\n");
-				json.append(subindent);
+				return pos;
 			}
+		}
 
-			it->first._toJSON(json, subindent);
-			json.append(": ");
-			if (it->second)
-			{
-				it->second->_toJSON(json, subindent);
-			}
-			else
-			{
-				json.append("null");
-			}
+		return NOT_FOUND;
+	}
+
+	size_t mask = index.size() - 1;
+
+	for (size_t slot = key.hash() & mask; index[slot] != 0; slot = (slot + 1) & mask)
+	{
+		if (members[index[slot] - 1].first == key)
+		{
+			return index[slot] - 1;
 		}
+	}
+
+	return NOT_FOUND;
+}
+
+void Object::addToIndex(size_t position)
+{
+	if (members.size() <= INDEX_THRESHOLD)
+	{
+		return;
+	}
+
+	// keep the index at most half full
+	if (members.size() * 2 > index.size())
+	{
+		rebuildIndex();
+		return;
+	}
 
-		json.append("\n");
-		json.append(indent);
-		json.append("}");
+	size_t mask = index.size() - 1;
+	size_t slot = members[position].first.hash() & mask;
+
+	while (index[slot] != 0)
+	{
+		slot = (slot + 1) & mask;
 	}
-	else
+
+	index[slot] = position + 1;
+}
+
+void Object::rebuildIndex()
+{
+	index.clear();
+
+	if (members.size() <= INDEX_THRESHOLD)
+	{
+		return;
+	}
+
+	size_t slots = 16;
+	while (slots < members.size() * 4)
+	{
+		slots *= 2;
+	}
+
+	index.resize(slots, 0);
+
+	for (size_t pos = 0; pos < members.size(); pos++)
 	{
-		json.append("{}");
+		addToIndex(pos);
 	}
 }
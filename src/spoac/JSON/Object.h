@@ -18,20 +18,26 @@
 #define JSON_OBJECT_H
 
 #include "Value.h"
-#include <map>
+#include "Identifier.h"
+#include <vector>
+#include <boost/make_shared.hpp>
 
 namespace JSON
 {
-	class Identifier;
 	class Number;
 	class String;
 
 	/**
 	* Represents a JSON Object containing key value pairs.
 	*
-	* This class implements a JSON Object using a STL map. Its interface
-	* is similar to that of a standard map. Alternatively you can still
-	* retrieve the map itself and work with that directly using getMap().
+	* Members are stored in a vector in the order they were inserted, which
+	* is also the order in which they are written as JSON. Its interface is
+	* similar to that of a standard map, iterators dereference to a pair of
+	* key and value. Keys are Identifiers, mostly interned ones which are
+	* compared by pointer. Finding or erasing members never interns the
+	* key looked for. Small objects are searched linearly, once an object
+	* holds more than INDEX_THRESHOLD members a hash index is kept
+	* alongside.
 	*
 	* Properties are identified by an Identifier. That means you can access
 	* them by either a String or a Number. The object stores pointers to
@@ -39,18 +45,33 @@ namespace JSON
 	* deleted. Following this behaviour erase() deletes the value as well.
 	* So make sure you copy data if you wish to continue using it after
 	* destructing the object.
+	*
+	* Unlike with a map inserting a member invalidates iterators and
+	* references to other members, and keys must not be modified through
+	* an iterator.
+	*
+	* Copying an object copies the pointers to all its members, swap()
+	* exchanges them instead. C++11 builds can also move objects and
+	* emplace() new members.
 	*/
 	class Object : public Value
 	{
 	public:
 		typedef ValuePtr value_type;
 		typedef boost::shared_ptr<const Value> const_value_type;
-		typedef std::map<Identifier, value_type> map_type;
-		typedef map_type::iterator iterator;
-		typedef map_type::const_iterator const_iterator;
+		typedef std::pair<Identifier, value_type> member_type;
+		typedef std::vector<member_type> member_list;
+		typedef member_list::iterator iterator;
+		typedef member_list::const_iterator const_iterator;
+
+		// objects with more members than this are hash indexed
+		static const size_t INDEX_THRESHOLD = 8;
 
 		Object();
 		Object(const Object& o);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+		Object(Object&& o);
+#endif
 
 		bool empty() const;
 		size_t size() const;
@@ -62,6 +83,10 @@ namespace JSON
 		const_iterator end() const;
 
 		Object& operator=(const Object& o);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+		Object& operator=(Object&& o);
+#endif
+		void swap(Object& o);
 
 		value_type& operator[](const Identifier& key);
 		value_type& operator[](const String& key);
@@ -98,6 +123,25 @@ namespace JSON
 		std::pair<iterator, bool> insert(int32_t key, value_type val);
 		std::pair<iterator, bool> insert(int64_t key, value_type val);
 		std::pair<iterator, bool> insert(double key, value_type val);
+#ifndef BOOST_NO_CXX11_VARIADIC_TEMPLATES
+		/**
+		* Inserts a new value of type T constructed from the arguments,
+		* unless the key is present already, in which case nothing is
+		* constructed.
+		*/
+		template <class T, class... Args>
+		std::pair<iterator, bool> emplace(const Identifier& key, Args&&... args)
+		{
+			iterator it = find(key);
+
+			if (it != members.end())
+			{
+				return std::pair<iterator, bool>(it, false);
+			}
+
+			return insert(key, boost::make_shared<T>(std::forward<Args>(args)...));
+		}
+#endif
 
 		void erase(const Identifier& key);
 		void erase(const String& key);
@@ -110,9 +154,14 @@ namespace JSON
 
 		Object& toObject();
 		const Object& toObject() const;
-		void _toJSON(std::string& json, const std::string& indent) const;
 	private:
-		map_type map;
+		size_t position(const Identifier& key) const;
+		void addToIndex(size_t position);
+		void rebuildIndex();
+
+		member_list members;
+		// slots hold the position of a member plus one, zero if empty
+		std::vector<uint32_t> index;
 	};
 
     typedef boost::shared_ptr<Object> ObjectPtr;
@@ -15,23 +15,36 @@
  */
 
 #include "Parser.h"
+#include "Document.h"
+#include "Scanner.h"
 
-#include <fstream>
 
 using namespace JSON;
 
-Parser::Parser()
+Parser::Parser() :
+	handler(&valueBuilder),
+	document(NULL)
 {
 	reset();
 }
 
-void Parser::reset()
+Parser::Parser(Document& document) :
+	documentBuilder(new DocumentBuilder(document)),
+	document(&document)
 {
-	while (!values.empty())
-	{
-		values.pop();
-	}
+	handler = documentBuilder.get();
+	reset();
+}
 
+Parser::Parser(Handler& handler) :
+	handler(&handler),
+	document(NULL)
+{
+	reset();
+}
+
+void Parser::reset()
+{
 	while (!states.empty())
 	{
 		states.pop();
@@ -48,6 +61,22 @@ void Parser::reset()
 	lastChar = 0;
 
 	numBuffer.clear();
+	stringBuffer.clear();
+	spanStart = NULL;
+	numberStart = NULL;
+	persistentInput = false;
+
+	valueBuilder.reset();
+
+	if (documentBuilder)
+	{
+		documentBuilder->reset();
+	}
+}
+
+void Parser::setLineNumber(size_t line)
+{
+	lineNumber = line;
 }
 
 #define PARSE_ERROR_SIMPLE(message) \
@@ -61,14 +90,75 @@ void Parser::reset()
 		throw ParserException(s, lineNumber); \
 	}
 
+// line terminators are skipped one at a time so they can be counted
 #define SKIP_WHITESPACE(char) \
-	if (char == 0x20 || char == 0x09 || char == 0x0A || char == 0x0D) \
+	if (char == 0x20 || char == 0x09) \
+	{ \
+		i += Scanner::blankRun(data + i + 1, len - i - 1); \
+		c = data[i]; \
+		break; \
+	} \
+	if (char == 0x0A || char == 0x0D) \
 		break;
 
+// numbers are only copied to the number buffer if they span several
+// chunks, otherwise they are converted straight from the input
+#define APPEND_NUMBER(char) \
+	if (!numberStart) \
+		numBuffer.push_back(char);
+
+// appends the current and all directly following digits to the number
+#define APPEND_DIGIT_RUN \
+	{ \
+		size_t run = 1 + Scanner::digitRun(data + i + 1, len - i - 1); \
+		if (!numberStart) \
+			numBuffer.append(data + i, run); \
+		i += run - 1; \
+		c = data[i]; \
+	}
+
+// appends the current and all following characters up to the next quote,
+// escape or line terminator to the string, which only needs to be copied
+// if it is not a span of persistent input
+#define APPEND_STRING_RUN(quote) \
+	if (c == '\n' || c == '\r') \
+	{ \
+		if (!spanStart) \
+			appendString(c); \
+	} \
+	else \
+	{ \
+		size_t run = 1 + Scanner::stringRun(data + i + 1, len - i - 1, quote); \
+		if (!spanStart) \
+			stringBuffer.append(data + i, run); \
+		i += run - 1; \
+		c = data[i]; \
+	}
+
+// escapes are decoded into the string buffer, so the span read so far
+// has to be copied there first
+#define END_SPAN \
+	if (spanStart) \
+	{ \
+		stringBuffer.assign(spanStart, data + i); \
+		spanStart = NULL; \
+	}
+
+// persistent input is only read into documents, which keep the original
+// text of every value
+#define BEGIN_SOURCE(position) \
+	if (persistentInput) \
+		documentBuilder->beginSource(position);
+
+#define END_SOURCE(position) \
+	if (persistentInput) \
+		documentBuilder->endSource(position);
+
 #define CASE_START_NUMBER \
 	case '-': case '+': case '.': case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9': case 'N': \
 		state = STATE_NUMBER; \
 		numBuffer.clear(); \
+		numberStart = data + i; \
 		i--;
 
 #define CASE_LINE_TERMINATOR \
@@ -81,9 +171,6 @@ void Parser::read(const std::string& data)
 
 void Parser::read(const char* data, size_t len)
 {
-	ValuePtr value;
-	ValuePtr tmp;
-	IdentifierPtr key;
 	lineNumberIndex = -1;
 
 	for (size_t i = 0; i < len; ++i)
@@ -126,31 +213,29 @@ void Parser::read(const char* data, size_t len)
 			break;
 
 			case STATE_READ_VALUE:
+				BEGIN_SOURCE(data + i)
+
 				switch (c)
 				{
 					case '"':
 						state = STATE_STRING_DOUBLE_QUOTE;
-						value.reset(new String());
-						pushValue(value);
+						startString(data + i + 1);
 					break;
 
 					case '\'':
 						state = STATE_STRING_SINGLE_QUOTE;
-						value.reset(new String());
-						pushValue(value);
+						startString(data + i + 1);
 					break;
 
 					case '{':
 						state = STATE_OBJECT;
-						value.reset(new Object());
-						pushValue(value);
+						handler->onObjectStart();
 						init = true;
 					break;
 
 					case '[':
 						state = STATE_ARRAY;
-						value.reset(new Array());
-						pushValue(value);
+						handler->onArrayStart();
 						init = true;
 					break;
 
@@ -178,18 +263,11 @@ void Parser::read(const char* data, size_t len)
 			case STATE_ARRAY:
 				SKIP_WHITESPACE(c);
 
-				if (!init)
-				{
-					// get the value
-					value = values.top();
-					values.pop();
-					// put it in the array
-					boost::dynamic_pointer_cast<Array>(values.top())->push_back(value);
-				}
-
 				switch (c)
 				{
 					case ']':
+						END_SOURCE(data + i + 1)
+						handler->onArrayEnd();
 						state = popState();
 					break;
 
@@ -231,34 +309,12 @@ void Parser::read(const char* data, size_t len)
 					i--;
 					break;
 				}
-				else
-				{
-					// get key and value
-					value = popValue();
-
-					tmp = popValue();
-					if (tmp->getType() == STRING)
-					{
-						key.reset(new Identifier(boost::dynamic_pointer_cast<String>(tmp)));
-					}
-					else if (tmp->getType() == NUMBER)
-					{
-						key.reset(new Identifier(boost::dynamic_pointer_cast<Number>(tmp)));
-					}
-					else
-					{
-						std::string data;
-						tmp->_toJSON(data, "");
-						PARSE_ERROR("Unexpected key type, expecting a string or a number: found '", data, "'");
-					}
-
-					// put it in the object
-					boost::dynamic_pointer_cast<Object>(values.top())->insert(*key, value);
-				}
 
 				switch (c)
 				{
 					case '}':
+						END_SOURCE(data + i + 1)
+						handler->onObjectEnd();
 						state = popState();
 					break;
 
@@ -288,22 +344,20 @@ void Parser::read(const char* data, size_t len)
 					case '$':
 					case '_':
 						state = STATE_IDENTIFIER_STRING;
-						value.reset(new String(c));
-						pushValue(value);
+						startString();
+						appendString(c);
 						pushState(STATE_OBJECT_VALUE);
 					break;
 
 					case '"':
 						state = STATE_STRING_DOUBLE_QUOTE;
-						value.reset(new String());
-						pushValue(value);
+						startString(data + i + 1);
 						pushState(STATE_OBJECT_VALUE);
 					break;
 
 					case '\'':
 						state = STATE_STRING_SINGLE_QUOTE;
-						value.reset(new String());
-						pushValue(value);
+						startString(data + i + 1);
 						pushState(STATE_OBJECT_VALUE);
 					break;
 
@@ -312,6 +366,8 @@ void Parser::read(const char* data, size_t len)
 					break;
 
 					case '}':
+						END_SOURCE(data + i + 1)
+						handler->onObjectEnd();
 						state = popState();
 					break;
 
@@ -319,8 +375,8 @@ void Parser::read(const char* data, size_t len)
 						if (isLetter(c))
 						{
 							state = STATE_IDENTIFIER_STRING;
-							value.reset(new String(c));
-							pushValue(value);
+							startString();
+							appendString(c);
 							pushState(STATE_OBJECT_VALUE);
 						}
 						else
@@ -336,13 +392,6 @@ void Parser::read(const char* data, size_t len)
 			case STATE_OBJECT_VALUE:
 				SKIP_WHITESPACE(c);
 
-				if (values.top()->getType() != STRING && values.top()->getType() != NUMBER)
-				{
-					std::string data;
-					values.top()->_toJSON(data, "");
-					PARSE_ERROR("Unexpected key type, expecting a string or a number: found '", data , "'");
-				}
-
 				if (c != ':')
 				{
 					PARSE_ERROR("Unexpected character data after object key, expecting a colon: found '", std::string(1, c), "'");
@@ -361,16 +410,17 @@ void Parser::read(const char* data, size_t len)
 				{
 					case '$':
 					case '_':
-						topString()->append(c);
+						appendString(c);
 					break;
 
 					default:
 						if (isLetter(c) || isCombiningMark(c) || isDigit(c) || isConnectorPunctuation(c))
 						{
-							topString()->append(c);
+							appendString(c);
 						}
 						else
 						{
+							endString();
 							state = popState();
 							i--;
 						}
@@ -382,10 +432,12 @@ void Parser::read(const char* data, size_t len)
 				switch (c)
 				{
 					case '"':
+						endString(data + i);
 						state = popState();
 					break;
 
 					case '\\':
+						END_SPAN
 						state = STATE_STRING_ESCAPE;
 						pushState(STATE_STRING_DOUBLE_QUOTE);
 					break;
@@ -395,7 +447,7 @@ void Parser::read(const char* data, size_t len)
 					break;*/
 
 					default:
-						topString()->append(c);
+						APPEND_STRING_RUN('"')
 					break;
 				}
 			break;
@@ -404,10 +456,12 @@ void Parser::read(const char* data, size_t len)
 				switch (c)
 				{
 					case '\'':
+						endString(data + i);
 						state = popState();
 					break;
 
 					case '\\':
+						END_SPAN
 						state = STATE_STRING_ESCAPE;
 						pushState(STATE_STRING_SINGLE_QUOTE);
 					break;
@@ -417,7 +471,7 @@ void Parser::read(const char* data, size_t len)
 					break;
 */
 					default:
-						topString()->append(c);
+						APPEND_STRING_RUN('\'')
 					break;
 				}
 			break;
@@ -426,19 +480,19 @@ void Parser::read(const char* data, size_t len)
 				switch (c)
 				{
 					case 'b':
-						topString()->append('\b');
+						appendString('\b');
 					break;
 					case 'f':
-						topString()->append('\f');
+						appendString('\f');
 					break;
 					case 'n':
-						topString()->append('\n');
+						appendString('\n');
 					break;
 					case 'r':
-						topString()->append('\r');
+						appendString('\r');
 					break;
 					case 't':
-						topString()->append('\t');
+						appendString('\t');
 					break;
 /*
 					CASE_LINE_TERMINATOR
@@ -449,12 +503,12 @@ void Parser::read(const char* data, size_t len)
 					case '\"':
 					case '\\':
 					case '/':
-						topString()->append(c);
+						appendString(c);
 					break;
 
 					default:
-						topString()->append('\\');
-						topString()->append(c);
+						appendString('\\');
+						appendString(c);
 					break;
 				}
 
@@ -465,20 +519,20 @@ void Parser::read(const char* data, size_t len)
 				switch (c)
 				{
 					case '0':
-						numBuffer.push_back((char) c);
+						APPEND_NUMBER(c)
 						state = STATE_NUMBER_DECIMAL_ZERO;
 					break;
 
 					// allow a leading -
 					case '-':
 					case '+':
-						if (numBuffer.length() > 1)
+						if (numberLength(data + i) > 1)
 						{
 							PARSE_ERROR("Illegal leading sign, numbers must only be prefixed with a single sign: found '", std::string(1, c), "'");
 						}
 						else
 						{
-							numBuffer.push_back((char) c);
+							APPEND_NUMBER(c)
 						}
 					break;
 
@@ -491,12 +545,12 @@ void Parser::read(const char* data, size_t len)
 					case '7':
 					case '8':
 					case '9':
-						numBuffer.push_back((char) c);
+						APPEND_NUMBER(c)
 						state = STATE_NUMBER_DECIMAL_INTEGER;
 					break;
 
 					case '.':
-						numBuffer.push_back((char) c);
+						APPEND_NUMBER(c)
 						state = STATE_NUMBER_DECIMAL_POINT;
 					break;
 
@@ -514,19 +568,18 @@ void Parser::read(const char* data, size_t len)
 				switch (c)
 				{
 					case '.':
-						numBuffer.push_back('.');
+						APPEND_NUMBER('.')
 						state = STATE_NUMBER_DECIMAL_POINT;
 					break;
 
 					case 'e':
 					case 'E':
-						numBuffer.push_back('E');
+						APPEND_NUMBER('E')
 						state = STATE_NUMBER_EXPONENT;
 					break;
 
 					default:
-						value.reset(new Number(numBuffer));
-						pushValue(value);
+						addNumber(data + i);
 						state = popState();
 						i--;
 					break;
@@ -546,23 +599,22 @@ void Parser::read(const char* data, size_t len)
 					case '7':
 					case '8':
 					case '9':
-						numBuffer.push_back((char) c);
+						APPEND_DIGIT_RUN
 					break;
 
 					case '.':
-						numBuffer.push_back('.');
+						APPEND_NUMBER('.')
 						state = STATE_NUMBER_DECIMAL_POINT;
 					break;
 
 					case 'e':
 					case 'E':
-						numBuffer.push_back('E');
+						APPEND_NUMBER('E')
 						state = STATE_NUMBER_EXPONENT;
 					break;
 
 					default:
-						value.reset(new Number(numBuffer));
-						pushValue(value);
+						addNumber(data + i);
 						state = popState();
 						i--;
 					break;
@@ -582,30 +634,29 @@ void Parser::read(const char* data, size_t len)
 					case '7':
 					case '8':
 					case '9':
-						numBuffer.push_back((char) c);
+						APPEND_DIGIT_RUN
 					break;
 
 					case '.':
-						numBuffer.push_back('.');
+						APPEND_NUMBER('.')
 						state = STATE_NUMBER_DECIMAL_POINT;
 					break;
 
 					case 'e':
 					case 'E':
-						numBuffer.push_back('E');
+						APPEND_NUMBER('E')
 						state = STATE_NUMBER_EXPONENT;
 					break;
 
 					default:
 						// a decimal point alone is not a number
-						if (numBuffer.length() == 1)
+						if (numberLength(data + i) == 1)
 						{
 							PARSE_ERROR("Unexpected character data, expecting digit after decimal point: found '", std::string(1, c), "'");
 						}
 						else
 						{
-							value.reset(new Number(numBuffer));
-							pushValue(value);
+							addNumber(data + i);
 							state = popState();
 							i--;
 						}
@@ -618,7 +669,7 @@ void Parser::read(const char* data, size_t len)
 				{
 					case '-':
 					case '+':
-						numBuffer.push_back((char) c);
+						APPEND_NUMBER(c)
 						state = STATE_NUMBER_EXPONENT_SIGNED;
 					break;
 
@@ -632,7 +683,7 @@ void Parser::read(const char* data, size_t len)
 					case '7':
 					case '8':
 					case '9':
-						numBuffer.push_back((char) c);
+						APPEND_NUMBER(c)
 						state = STATE_NUMBER_EXPONENT_UNSIGNED;
 					break;
 
@@ -655,7 +706,7 @@ void Parser::read(const char* data, size_t len)
 					case '7':
 					case '8':
 					case '9':
-						numBuffer.push_back((char) c);
+						APPEND_NUMBER(c)
 						state = STATE_NUMBER_EXPONENT_UNSIGNED;
 					break;
 
@@ -678,12 +729,11 @@ void Parser::read(const char* data, size_t len)
 					case '7':
 					case '8':
 					case '9':
-						numBuffer.push_back((char) c);
+						APPEND_DIGIT_RUN
 					break;
 
 					default:
-						value.reset(new Number(numBuffer));
-						pushValue(value);
+						addNumber(data + i);
 						state = popState();
 						i--;
 					break;
@@ -704,8 +754,9 @@ void Parser::read(const char* data, size_t len)
 			case STATE_NUMBER_NA:
 				if (c == 'N')
 				{
-					value.reset(new Number(std::string("NaN")));
-					pushValue(value);
+					numBuffer.assign("NaN");
+					numberStart = NULL;
+					addNumber();
 					state = popState();
 				}
 				else
@@ -739,8 +790,8 @@ void Parser::read(const char* data, size_t len)
 			case STATE_NULL_NUL:
 				if (c == 'l')
 				{
-					value.reset(new Null);
-					pushValue(value);
+					END_SOURCE(data + i + 1)
+					handler->onNull();
 					state = popState();
 				}
 				else
@@ -774,8 +825,8 @@ void Parser::read(const char* data, size_t len)
 			case STATE_BOOL_TRU:
 				if (c == 'e')
 				{
-					value.reset(new Bool(true));
-					pushValue(value);
+					END_SOURCE(data + i + 1)
+					handler->onBool(true);
 					state = popState();
 				}
 				else
@@ -820,8 +871,8 @@ void Parser::read(const char* data, size_t len)
 			case STATE_BOOL_FALS:
 				if (c == 'e')
 				{
-					value.reset(new Bool(false));
-					pushValue(value);
+					END_SOURCE(data + i + 1)
+					handler->onBool(false);
 					state = popState();
 				}
 				else
@@ -841,6 +892,19 @@ void Parser::read(const char* data, size_t len)
 			lineNumberIndex = i;
 		}
 	}
+
+	// spans must not outlive the data they point to
+	if (spanStart)
+	{
+		stringBuffer.assign(spanStart, data + len);
+		spanStart = NULL;
+	}
+
+	if (numberStart)
+	{
+		numBuffer.assign(numberStart, data + len);
+		numberStart = NULL;
+	}
 }
 
 inline bool Parser::isLetter(char c)
@@ -880,46 +944,99 @@ inline ParserState Parser::popState()
 	return state;
 }
 
-inline void Parser::pushValue(ValuePtr value)
+inline void Parser::startString(const char* span)
 {
-	values.push(value);
+	stringBuffer.clear();
+	spanStart = (persistentInput) ? span : NULL;
 }
 
-inline ValuePtr Parser::popValue()
+inline void Parser::appendString(char c)
 {
-	if (values.empty())
+	stringBuffer.push_back(c);
+}
+
+inline void Parser::endString(const char* spanEnd)
+{
+	// the state to return to tells whether the string was an object key
+	bool key = (states.top() == STATE_OBJECT_VALUE);
+
+	if (!key)
 	{
-		return ValuePtr();
+		// behind the closing quote
+		END_SOURCE(spanEnd + 1)
 	}
 
-	ValuePtr v = values.top();
-	values.pop();
+	if (spanStart)
+	{
+		if (key)
+		{
+			handler->onKeyReference(spanStart, spanEnd - spanStart);
+		}
+		else
+		{
+			handler->onStringReference(spanStart, spanEnd - spanStart);
+		}
 
-	return v;
+		spanStart = NULL;
+	}
+	else if (key)
+	{
+		handler->onKey(stringBuffer);
+	}
+	else
+	{
+		handler->onString(stringBuffer);
+	}
 }
 
-inline StringPtr Parser::topString()
+inline size_t Parser::numberLength(const char* end)
 {
-	return boost::dynamic_pointer_cast<String>(values.top());
+	return (numberStart) ? end - numberStart : numBuffer.length();
 }
 
-ValuePtr Parser::readFromFile(const std::string& path)
+inline void Parser::addNumber(const char* end)
 {
-	std::ifstream file;
-	std::string line;
+	if (states.top() != STATE_OBJECT_VALUE && numberStart && persistentInput)
+	{
+		// the document converts the number when it is accessed
+		END_SOURCE(end)
+		handler->onNumberReference(numberStart, end - numberStart);
+		numberStart = NULL;
+		return;
+	}
 
-	file.open(path.c_str());
+	Number number = (numberStart) ?
+		Number(numberStart, end - numberStart) :
+		Number(numBuffer.data(), numBuffer.length());
+	numberStart = NULL;
 
-	if (!file.is_open())
+	if (states.top() == STATE_OBJECT_VALUE)
+	{
+		handler->onKey(number);
+	}
+	else
+	{
+		handler->onNumber(number);
+	}
+}
+
+ValuePtr Parser::readFromFile(const std::string& path, FileAccess access)
+{
+	MappedFilePtr file(new MappedFile(path, access));
+
+	if (!file->isOpen())
 			PARSE_ERROR_SIMPLE("file could not be opened");
 
-	while (!file.eof())
+	// a document keeps the file contents so its strings can point into them
+	if (document)
 	{
-		getline(file, line);
-		this->read(line.c_str(), line.size());
+		document->retain(file);
+		persistentInput = true;
 	}
 
-	file.close();
+	this->read(file->data(), file->size());
+
+	persistentInput = false;
 	return this->finish();
 }
 
@@ -934,7 +1051,12 @@ ValuePtr Parser::finish()
 		return ValuePtr();
 	}
 
-	ValuePtr result = popValue();
+	ValuePtr result = valueBuilder.getResult();
+
+	if (documentBuilder)
+	{
+		documentBuilder->finish();
+	}
 
 	// restore initial state
 	reset();
@@ -18,7 +18,11 @@
 #define JSON_PARSER_H
 
 #include "AllValueTypes.h"
+#include "DocumentBuilder.h"
+#include "Handler.h"
+#include "MappedFile.h"
 #include "ParserException.h"
+#include "ValueBuilder.h"
 
 #include <stack>
 #include <string>
@@ -67,7 +71,8 @@ namespace JSON
 	} ParserState;
 
 	/**
-	* A parser that constructs a JSON::Value from the given character data.
+	* A parser that reports the structure of the given character data to a
+	* Handler, by default constructing a JSON::Value from it.
 	*
 	* The parser is used by calling read() and then finish() to retrieve
 	* the result. read() can be called any number of times. The parser
@@ -75,16 +80,32 @@ namespace JSON
 	* previous chunk. While finish() must only be called once as it resets
 	* the parser for the next document. You can also manually reset it with
 	* reset().
+	*
+	* A parser constructed with a Document builds all values inside the
+	* document's arena instead. In this mode finish() and readFromFile()
+	* set the document's root and return an empty ValuePtr. readFromFile()
+	* maps the whole file, or reads it with FILE_COPY, and hands the
+	* document references to strings without escapes instead of copies.
+	* A parser
+	* constructed with a custom Handler only emits events and returns an
+	* empty ValuePtr as well.
+	*
+	* Documents which are part of a larger input, like the records of a
+	* RecordReader, can be given the line they start on with
+	* setLineNumber() so errors point at the right place.
 	*/
 	class Parser
 	{
 	public:
 		Parser();
+		Parser(Document& document);
+		Parser(Handler& handler);
 
 		void reset();
+		void setLineNumber(size_t line);
 		void read(const std::string& data);
 		void read(const char* data, size_t len);
-		ValuePtr readFromFile(const std::string& path);
+		ValuePtr readFromFile(const std::string& path, FileAccess access = FILE_MAP);
 		ValuePtr finish();
 	private:
 		Parser(const Parser&) {}; // do not allow copying
@@ -96,19 +117,34 @@ namespace JSON
 		inline bool isConnectorPunctuation(char c);
 		inline void pushState(ParserState state);
 		inline ParserState popState();
-		inline void pushValue(ValuePtr value);
-		inline ValuePtr popValue();
-		inline StringPtr topString();
+		inline void startString(const char* span = NULL);
+		inline void appendString(char c);
+		inline void endString(const char* spanEnd = NULL);
+		inline size_t numberLength(const char* end);
+		inline void addNumber(const char* end = NULL);
 
-		std::stack<ValuePtr> values;
 		std::stack<ParserState> states;
 
+		Handler* handler;
+		ValueBuilder valueBuilder;
+		boost::shared_ptr<DocumentBuilder> documentBuilder;
+		Document* document;
+
 		ParserState state;
 
 		char c;
 		char lastChar;
 
 		std::string numBuffer;
+		std::string stringBuffer;
+
+		// start of the current string in persistent input, if it is
+		// still a plain span of it
+		const char* spanStart;
+		bool persistentInput;
+
+		// start of the current number if it is within the current chunk
+		const char* numberStart;
 
 		size_t lineNumber;
 		int32_t lineNumberIndex;
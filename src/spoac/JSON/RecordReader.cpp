@@ -0,0 +1,229 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RecordReader.h"
+
+#include <cstring>
+#include <istream>
+
+using namespace JSON;
+
+// the stream is read in blocks of this size
+static const size_t blockSize = 64 * 1024;
+
+// whether the data contains anything but whitespace
+static bool isBlank(const char* data, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+	{
+		if (data[i] != ' ' && data[i] != '\t' && data[i] != '\r' && data[i] != '\n')
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// the length of a line without a trailing carriage return
+static size_t trimmedLength(const char* data, size_t len)
+{
+	if (len > 0 && data[len - 1] == '\r')
+	{
+		return len - 1;
+	}
+
+	return len;
+}
+
+RecordReader::RecordReader(std::istream& in) :
+	in(&in),
+	block(blockSize),
+	position(0),
+	length(0),
+	recordLine(0),
+	line(1),
+	started(false),
+	skipping(false)
+{
+}
+
+RecordReader::RecordReader(std::istream& in, Handler& handler) :
+	in(&in),
+	parser(handler),
+	block(blockSize),
+	position(0),
+	length(0),
+	recordLine(0),
+	line(1),
+	started(false),
+	skipping(false)
+{
+}
+
+/**
+* Reads the next record.
+*
+* @return false if the stream contains no further records.
+*/
+bool RecordReader::next()
+{
+	record.reset();
+
+	while (position < length || fill())
+	{
+		const char* data = &block[position];
+		const char* end = static_cast<const char*>(memchr(data, '\n', length - position));
+		size_t len = end ? end - data + 1 : length - position;
+
+		position += len;
+
+		if (skipping)
+		{
+			if (end)
+			{
+				skipping = false;
+				line++;
+			}
+
+			continue;
+		}
+
+		if (readLine(data, len, end != NULL))
+		{
+			return true;
+		}
+	}
+
+	// the last record need not be terminated
+	return finishRecord();
+}
+
+/**
+* Returns the value of the current record, or an empty ValuePtr if the
+* reader was constructed with a Handler.
+*/
+ValuePtr RecordReader::getRecord() const
+{
+	return record;
+}
+
+/**
+* Returns the line of the current record, counted from 1.
+*/
+size_t RecordReader::getLineNumber() const
+{
+	return recordLine;
+}
+
+bool RecordReader::fill()
+{
+	position = 0;
+	length = 0;
+
+	if (!in->good())
+	{
+		return false;
+	}
+
+	in->read(&block[0], block.size());
+	length = in->gcount();
+
+	if (in->bad())
+	{
+		throw Exception("Unable to read JSON records from stream");
+	}
+
+	return length > 0;
+}
+
+/**
+* Parses a part of the current line.
+*
+* @return true if the part ends the line and a record has been read.
+*/
+bool RecordReader::readLine(const char* data, size_t len, bool terminated)
+{
+	if (terminated)
+	{
+		// the terminator is left to finish(), so errors are reported on
+		// the line of the record
+		len = trimmedLength(data, len - 1);
+	}
+
+	if (!started && !isBlank(data, len))
+	{
+		started = true;
+		recordLine = line;
+		parser.setLineNumber(line);
+	}
+
+	try
+	{
+		if (started)
+		{
+			parser.read(data, len);
+		}
+	}
+	catch (const Exception& e)
+	{
+		parser.reset();
+		started = false;
+
+		// the rest of the line belongs to the broken record
+		if (terminated)
+		{
+			line++;
+		}
+		else
+		{
+			skipping = true;
+		}
+
+		throw;
+	}
+
+	if (!terminated)
+	{
+		return false;
+	}
+
+	line++;
+
+	return finishRecord();
+}
+
+bool RecordReader::finishRecord()
+{
+	if (!started)
+	{
+		return false;
+	}
+
+	started = false;
+
+	try
+	{
+		record = parser.finish();
+	}
+	catch (const Exception& e)
+	{
+		parser.reset();
+		throw;
+	}
+
+	return true;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JSON_RECORDREADER_H
+#define JSON_RECORDREADER_H
+
+#include "Parser.h"
+
+#include <iosfwd>
+#include <vector>
+
+namespace JSON
+{
+	/**
+	* Reads a stream of JSON Lines, one document per line, as written by a
+	* RecordWriter.
+	*
+	* Records are read one at a time with next(), which returns false at
+	* the end of the stream. The stream is read in blocks which are fed to
+	* a Parser as they are, so only a single block and the values of the
+	* current record are held in memory no matter how long the stream is.
+	* This works on files as well as on pipes. Blank lines are skipped, and
+	* so a stream written by several appenders in turn can be read as well.
+	*
+	* By default every record is built into a JSON::Value available from
+	* getRecord(). A reader constructed with a Handler only emits the
+	* events of each record to it instead.
+	*
+	* A record which cannot be parsed raises a ParserException with the
+	* line number of the record in the stream. The rest of its line is
+	* skipped, so reading can continue with the next record.
+	*/
+	class RecordReader
+	{
+	public:
+		RecordReader(std::istream& in);
+		RecordReader(std::istream& in, Handler& handler);
+
+		bool next();
+		ValuePtr getRecord() const;
+		size_t getLineNumber() const;
+	private:
+		RecordReader(const RecordReader&) {}; // do not allow copying
+		RecordReader& operator=(const RecordReader&) { return *this; }; // do not allow assignment
+
+		bool fill();
+		bool readLine(const char* data, size_t len, bool terminated);
+		bool finishRecord();
+
+		std::istream* in;
+		Parser parser;
+
+		std::vector<char> block;
+		size_t position;
+		size_t length;
+
+		ValuePtr record;
+
+		// line of the current record and of the next data in the block
+		size_t recordLine;
+		size_t line;
+
+		// the current line contains data and is being parsed
+		bool started;
+		// the rest of the current line is skipped after an error
+		bool skipping;
+	};
+}
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RecordWriter.h"
+#include "Parser.h"
+
+#include <ostream>
+
+using namespace JSON;
+
+// records are written to the stream in blocks of about this size
+static const size_t flushSize = 64 * 1024;
+
+RecordWriter::RecordWriter(std::ostream& out) :
+	out(&out),
+	writer(buffer, WRITER_COMPACT),
+	complete(0)
+{
+}
+
+RecordWriter::~RecordWriter()
+{
+	flush();
+}
+
+void RecordWriter::write(const Value& value)
+{
+	beginRecord().write(value);
+	endRecord();
+}
+
+void RecordWriter::write(const DocumentValue& value)
+{
+	beginRecord().write(value);
+	endRecord();
+}
+
+/**
+* Appends a document given as JSON text. The text is parsed straight into
+* the record without building any values. Invalid text raises a
+* ParserException and nothing is written.
+*/
+void RecordWriter::writeJSON(const std::string& json)
+{
+	Parser parser(beginRecord());
+
+	try
+	{
+		parser.read(json);
+		parser.finish();
+	}
+	catch (const Exception& e)
+	{
+		discardRecord();
+		throw;
+	}
+
+	endRecord();
+}
+
+/**
+* Starts a record, which has to be written to the returned writer as a
+* single value and ended with endRecord().
+*/
+Writer& RecordWriter::beginRecord()
+{
+	return writer;
+}
+
+void RecordWriter::endRecord()
+{
+	buffer.push_back('\n');
+	complete = buffer.size();
+
+	if (complete >= flushSize)
+	{
+		out->write(buffer.data(), complete);
+		buffer.clear();
+		complete = 0;
+	}
+}
+
+/**
+* Writes all complete records to the stream and flushes it.
+*/
+void RecordWriter::flush()
+{
+	if (complete > 0)
+	{
+		out->write(buffer.data(), complete);
+		buffer.erase(0, complete);
+		complete = 0;
+	}
+
+	out->flush();
+}
+
+void RecordWriter::discardRecord()
+{
+	std::string records(buffer, 0, complete);
+
+	// clearing the writer also resets its state
+	writer.clear();
+	buffer.swap(records);
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JSON_RECORDWRITER_H
+#define JSON_RECORDWRITER_H
+
+#include "Writer.h"
+
+#include <iosfwd>
+#include <string>
+
+namespace JSON
+{
+	class Value;
+	class DocumentValue;
+
+	/**
+	* Appends documents to a stream as JSON Lines, i.e. as compact JSON
+	* with one document per line, which a RecordReader reads back.
+	*
+	* Records are buffered and written to the stream in large blocks, and
+	* on flush() or destruction. A record can be given as a value, as JSON
+	* text, which is reformatted to a single line, or be written as events
+	* between beginRecord() and endRecord():
+	*
+	*   std::ofstream file(path.c_str(), std::ios::app);
+	*   JSON::RecordWriter log(file);
+	*   objects.write(log.beginRecord());
+	*   log.endRecord();
+	*
+	* Only whole records are written to the stream, so a reader following
+	* a file never sees a partial line.
+	*/
+	class RecordWriter
+	{
+	public:
+		RecordWriter(std::ostream& out);
+		~RecordWriter();
+
+		void write(const Value& value);
+		void write(const DocumentValue& value);
+		void writeJSON(const std::string& json);
+
+		Writer& beginRecord();
+		void endRecord();
+
+		void flush();
+	private:
+		RecordWriter(const RecordWriter&) {}; // do not allow copying
+		RecordWriter& operator=(const RecordWriter&) { return *this; }; // do not allow assignment
+
+		void discardRecord();
+
+		std::ostream* out;
+		std::string buffer;
+		Writer writer;
+
+		// length of the buffered complete records
+		size_t complete;
+	};
+}
+
+#endif
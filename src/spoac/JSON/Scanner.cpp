@@ -0,0 +1,360 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "Scanner.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define JSON_SCANNER_X86
+#include <immintrin.h>
+#endif
+
+using namespace JSON;
+
+typedef size_t (*StringRunFunction)(const char*, size_t, char);
+typedef size_t (*RunFunction)(const char*, size_t);
+
+struct ScannerFunctions
+{
+	ScannerImplementation implementation;
+	StringRunFunction stringRun;
+	RunFunction blankRun;
+	RunFunction digitRun;
+};
+
+static inline bool isStringStop(char c, char quote)
+{
+	return c == quote || c == '\\' || c == '\n' || c == '\r';
+}
+
+static inline bool isBlank(char c)
+{
+	return c == ' ' || c == '\t';
+}
+
+static inline bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+static size_t scalarStringRun(const char* data, size_t len, char quote)
+{
+	size_t i = 0;
+
+	while (i < len && !isStringStop(data[i], quote))
+	{
+		++i;
+	}
+
+	return i;
+}
+
+static size_t scalarBlankRun(const char* data, size_t len)
+{
+	size_t i = 0;
+
+	while (i < len && isBlank(data[i]))
+	{
+		++i;
+	}
+
+	return i;
+}
+
+static size_t scalarDigitRun(const char* data, size_t len)
+{
+	size_t i = 0;
+
+	while (i < len && isDigit(data[i]))
+	{
+		++i;
+	}
+
+	return i;
+}
+
+#ifdef JSON_SCANNER_X86
+
+// the vector loops find a block containing a stop character and return
+// the offset of the first one, the remaining tail is handled by the
+// scalar version
+
+__attribute__((target("sse2")))
+static size_t sse2StringRun(const char* data, size_t len, char quote)
+{
+	const __m128i q = _mm_set1_epi8(quote);
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i lf = _mm_set1_epi8('\n');
+	const __m128i cr = _mm_set1_epi8('\r');
+	size_t i = 0;
+
+	for (; i + 16 <= len; i += 16)
+	{
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		__m128i stop = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(block, q), _mm_cmpeq_epi8(block, backslash)),
+			_mm_or_si128(_mm_cmpeq_epi8(block, lf), _mm_cmpeq_epi8(block, cr)));
+		unsigned int mask = _mm_movemask_epi8(stop);
+
+		if (mask)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	return i + scalarStringRun(data + i, len - i, quote);
+}
+
+__attribute__((target("sse2")))
+static size_t sse2BlankRun(const char* data, size_t len)
+{
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i tab = _mm_set1_epi8('\t');
+	size_t i = 0;
+
+	for (; i + 16 <= len; i += 16)
+	{
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		__m128i blank = _mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab));
+		unsigned int mask = ~_mm_movemask_epi8(blank) & 0xFFFF;
+
+		if (mask)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	return i + scalarBlankRun(data + i, len - i);
+}
+
+__attribute__((target("sse2")))
+static size_t sse2DigitRun(const char* data, size_t len)
+{
+	// signed comparison, so bytes >= 0x80 are never digits
+	const __m128i belowZero = _mm_set1_epi8('0' - 1);
+	const __m128i aboveNine = _mm_set1_epi8('9' + 1);
+	size_t i = 0;
+
+	for (; i + 16 <= len; i += 16)
+	{
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		__m128i digit = _mm_and_si128(
+			_mm_cmpgt_epi8(block, belowZero), _mm_cmplt_epi8(block, aboveNine));
+		unsigned int mask = ~_mm_movemask_epi8(digit) & 0xFFFF;
+
+		if (mask)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	return i + scalarDigitRun(data + i, len - i);
+}
+
+__attribute__((target("avx2")))
+static size_t avx2StringRun(const char* data, size_t len, char quote)
+{
+	const __m256i q = _mm256_set1_epi8(quote);
+	const __m256i backslash = _mm256_set1_epi8('\\');
+	const __m256i lf = _mm256_set1_epi8('\n');
+	const __m256i cr = _mm256_set1_epi8('\r');
+	size_t i = 0;
+
+	for (; i + 32 <= len; i += 32)
+	{
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+		__m256i stop = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(block, q), _mm256_cmpeq_epi8(block, backslash)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(block, lf), _mm256_cmpeq_epi8(block, cr)));
+		unsigned int mask = _mm256_movemask_epi8(stop);
+
+		if (mask)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	return i + sse2StringRun(data + i, len - i, quote);
+}
+
+__attribute__((target("avx2")))
+static size_t avx2BlankRun(const char* data, size_t len)
+{
+	const __m256i space = _mm256_set1_epi8(' ');
+	const __m256i tab = _mm256_set1_epi8('\t');
+	size_t i = 0;
+
+	for (; i + 32 <= len; i += 32)
+	{
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+		__m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(block, space), _mm256_cmpeq_epi8(block, tab));
+		unsigned int mask = ~(unsigned int) _mm256_movemask_epi8(blank);
+
+		if (mask)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	return i + sse2BlankRun(data + i, len - i);
+}
+
+__attribute__((target("avx2")))
+static size_t avx2DigitRun(const char* data, size_t len)
+{
+	const __m256i belowZero = _mm256_set1_epi8('0' - 1);
+	const __m256i aboveNine = _mm256_set1_epi8('9' + 1);
+	size_t i = 0;
+
+	for (; i + 32 <= len; i += 32)
+	{
+		__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+		__m256i digit = _mm256_and_si256(
+			_mm256_cmpgt_epi8(block, belowZero), _mm256_cmpgt_epi8(aboveNine, block));
+		unsigned int mask = ~(unsigned int) _mm256_movemask_epi8(digit);
+
+		if (mask)
+		{
+			return i + __builtin_ctz(mask);
+		}
+	}
+
+	return i + sse2DigitRun(data + i, len - i);
+}
+
+#endif
+
+static const ScannerFunctions scalarFunctions =
+	{ SCANNER_SCALAR, scalarStringRun, scalarBlankRun, scalarDigitRun };
+
+#ifdef JSON_SCANNER_X86
+static const ScannerFunctions sse2Functions =
+	{ SCANNER_SSE2, sse2StringRun, sse2BlankRun, sse2DigitRun };
+static const ScannerFunctions avx2Functions =
+	{ SCANNER_AVX2, avx2StringRun, avx2BlankRun, avx2DigitRun };
+#endif
+
+static const ScannerFunctions* selectFunctions(ScannerImplementation implementation)
+{
+	if (implementation == SCANNER_AUTO)
+	{
+		if (Scanner::isSupported(SCANNER_AVX2))
+		{
+			implementation = SCANNER_AVX2;
+		}
+		else if (Scanner::isSupported(SCANNER_SSE2))
+		{
+			implementation = SCANNER_SSE2;
+		}
+		else
+		{
+			implementation = SCANNER_SCALAR;
+		}
+	}
+
+	switch (implementation)
+	{
+#ifdef JSON_SCANNER_X86
+		case SCANNER_AVX2:
+			return &avx2Functions;
+
+		case SCANNER_SSE2:
+			return &sse2Functions;
+#endif
+
+		default:
+			return &scalarFunctions;
+	}
+}
+
+static const ScannerFunctions*& functions()
+{
+	static const ScannerFunctions* selected = selectFunctions(SCANNER_AUTO);
+	return selected;
+}
+
+size_t Scanner::stringRun(const char* data, size_t len, char quote)
+{
+	return functions()->stringRun(data, len, quote);
+}
+
+size_t Scanner::blankRun(const char* data, size_t len)
+{
+	return functions()->blankRun(data, len);
+}
+
+size_t Scanner::digitRun(const char* data, size_t len)
+{
+	return functions()->digitRun(data, len);
+}
+
+bool Scanner::setImplementation(ScannerImplementation implementation)
+{
+	if (!isSupported(implementation))
+	{
+		return false;
+	}
+
+	functions() = selectFunctions(implementation);
+	return true;
+}
+
+ScannerImplementation Scanner::getImplementation()
+{
+	return functions()->implementation;
+}
+
+bool Scanner::isSupported(ScannerImplementation implementation)
+{
+	switch (implementation)
+	{
+		case SCANNER_AUTO:
+		case SCANNER_SCALAR:
+			return true;
+
+#ifdef JSON_SCANNER_X86
+		case SCANNER_SSE2:
+			return __builtin_cpu_supports("sse2");
+
+		case SCANNER_AVX2:
+			return __builtin_cpu_supports("avx2");
+#endif
+
+		default:
+			return false;
+	}
+}
+
+const char* Scanner::getImplementationName(ScannerImplementation implementation)
+{
+	switch (implementation)
+	{
+		case SCANNER_AUTO:
+			return "auto";
+
+		case SCANNER_SCALAR:
+			return "scalar";
+
+		case SCANNER_SSE2:
+			return "sse2";
+
+		case SCANNER_AVX2:
+			return "avx2";
+
+		default:
+			return "unknown";
+	}
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JSON_SCANNER_H
+#define JSON_SCANNER_H
+
+#include <stddef.h>
+
+namespace JSON
+{
+	/**
+	* An enum of the available Scanner implementations.
+	*/
+	typedef enum
+	{
+		SCANNER_AUTO,
+		SCANNER_SCALAR,
+		SCANNER_SSE2,
+		SCANNER_AVX2
+	} ScannerImplementation;
+
+	/**
+	* Finds the end of runs of characters the Parser treats alike.
+	*
+	* Each function returns the number of characters at the start of the
+	* given data which belong to the run, so the parser can skip or append
+	* them in one step instead of going through its state machine for every
+	* single character. On x86 CPUs the data is compared in blocks of 16 or
+	* 32 bytes using SSE2 or AVX2, the best version supported by the CPU is
+	* chosen at runtime. Other platforms use a scalar loop.
+	*
+	* None of the runs include line terminators, so the parser still sees
+	* every line break and can count lines.
+	*/
+	class Scanner
+	{
+	public:
+		static size_t stringRun(const char* data, size_t len, char quote);
+		static size_t blankRun(const char* data, size_t len);
+		static size_t digitRun(const char* data, size_t len);
+
+		static bool setImplementation(ScannerImplementation implementation);
+		static ScannerImplementation getImplementation();
+		static bool isSupported(ScannerImplementation implementation);
+		static const char* getImplementationName(ScannerImplementation implementation);
+	};
+}
+
+#endif
@@ -49,6 +49,34 @@ String::String(const String& s) :
 {
 }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+String::String(std::string&& s) :
+	Value(STRING), string(std::move(s))
+{
+}
+
+String::String(String&& s) :
+	Value(s), string(std::move(s.string))
+{
+}
+
+String& String::operator=(String&& s)
+{
+	string = std::move(s.string);
+	return *this;
+}
+#endif
+
+void String::swap(String& s)
+{
+	string.swap(s.string);
+}
+
+void String::swap(std::string& s)
+{
+	string.swap(s);
+}
+
 void String::append(const char& c)
 {
 	string.append(1, c);
@@ -84,75 +112,6 @@ const std::string& String::toString() const
 	return string;
 }
 
-void String::_toJSON(std::string& json, const std::string& indent) const
-{
-	// escape the string
-	char c;
-	std::string escaped;
-	std::string::const_iterator it;
-	short noDigit = 0;
-
-	for(it = string.begin(); it < string.end(); ++it)
-	{
-		c = *it;
-		
-		if (noDigit) noDigit--;
-
-		switch (c)
-		{
-			case '\\':
-				escaped.append("\\\\");
-			break;
-
-			case '"':
-				escaped.append("\\\"");
-			break;
-
-			case 0:
-				escaped.append("\\0");
-				noDigit = 2;
-			break;
-
-			case '\n':
-				escaped.append("\\n");
-			break;
-
-			case '\r':
-				escaped.append("\\r");
-			break;
-
-			case '0':
-			case '1':
-			case '2':
-			case '3':
-			case '4':
-			case '5':
-			case '6':
-			case '7':
-			case '8':
-			case '9':
-				if (noDigit)
-				{
-					escaped.append("\\u003"); // 0 is U+0030, 1 is U+0031 etc.
-					escaped.push_back(c);
-				}
-				else
-				{
-					escaped.push_back(c);
-				}
-			break;
-
-			default:
-				escaped.push_back(c);
-			break;
-		}
-	}
-
-	json.append("\"");
-	json.append(escaped);
-	json.append("\"");
-}
-
 String& String::operator=(const String& s)
 {
 	if (&s != this)
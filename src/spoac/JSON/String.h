@@ -30,6 +30,9 @@ namespace JSON
 	* be performed on the string itself which can be retrieved using
 	* toString(). The string is automatically escaped correctly when
 	* converted to JSON.
+	*
+	* swap() exchanges the contents with another string without copying
+	* them, C++11 builds can also move strings in.
 	*/
 	class String : public Value
 	{
@@ -40,6 +43,10 @@ namespace JSON
 		String(const char* data);
 		String(const char* data, size_t len);
 		String(const String& s);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+		String(std::string&& s);
+		String(String&& s);
+#endif
 
 		void append(const char& c);
 		void append(const std::string& s);
@@ -48,9 +55,13 @@ namespace JSON
 		void append(const String& s);
 		std::string& toString();
 		const std::string& toString() const;
-		void _toJSON(std::string& json, const std::string& indent) const;
 
 		String& operator=(const String& s);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+		String& operator=(String&& s);
+#endif
+		void swap(String& s);
+		void swap(std::string& s);
 		bool operator==(const Value& v) const;
 		bool operator!=(const Value& v) const;
 		bool operator>(const Value& v) const;
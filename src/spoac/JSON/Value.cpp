@@ -16,6 +16,7 @@
 
 #include "Value.h"
 #include "ValueException.h"
+#include "Writer.h"
 
 using namespace JSON;
 
@@ -96,13 +97,15 @@ const Object& Value::toObject() const
 
 void Value::_toJSON(std::string& json, const std::string& indent) const
 {
-	json.append("undefined");
+	Writer writer(json, WRITER_PRETTY, indent);
+	writer.write(*this);
 }
 
 std::string Value::toJSON() const
 {
 	std::string json;
-	_toJSON(json, "");
+	Writer writer(json);
+	writer.write(*this);
 	return json;
 }
 
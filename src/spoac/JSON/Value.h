@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 #include <string>
+#include <boost/config.hpp>
 #include <boost/shared_ptr.hpp>
 
 namespace JSON
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ValueBuilder.h"
+#include "AllValueTypes.h"
+
+#include <boost/make_shared.hpp>
+
+using namespace JSON;
+
+ValueBuilder::ValueBuilder()
+{
+}
+
+void ValueBuilder::reset()
+{
+	frames.clear();
+	result.reset();
+}
+
+ValuePtr ValueBuilder::getResult() const
+{
+	return result;
+}
+
+void ValueBuilder::onNull()
+{
+	add(boost::make_shared<Null>());
+}
+
+void ValueBuilder::onBool(bool b)
+{
+	add(boost::make_shared<Bool>(b));
+}
+
+void ValueBuilder::onNumber(const Number& n)
+{
+	add(boost::make_shared<Number>(n));
+}
+
+void ValueBuilder::onString(const std::string& s)
+{
+	add(boost::make_shared<String>(s));
+}
+
+void ValueBuilder::onStringReference(const char* data, size_t length)
+{
+	add(boost::make_shared<String>(data, length));
+}
+
+void ValueBuilder::onKey(const std::string& key)
+{
+	frames.back().key = Identifier(key);
+}
+
+void ValueBuilder::onKey(const Number& key)
+{
+	frames.back().key = Identifier(key);
+}
+
+void ValueBuilder::onKeyReference(const char* data, size_t length)
+{
+	frames.back().key = Identifier(data, length);
+}
+
+void ValueBuilder::onArrayStart()
+{
+	frames.push_back(Frame());
+	frames.back().container = boost::make_shared<Array>();
+}
+
+void ValueBuilder::onArrayEnd()
+{
+	ValuePtr array;
+	array.swap(frames.back().container);
+	frames.pop_back();
+	add(array);
+}
+
+void ValueBuilder::onObjectStart()
+{
+	frames.push_back(Frame());
+	frames.back().container = boost::make_shared<Object>();
+}
+
+void ValueBuilder::onObjectEnd()
+{
+	ValuePtr object;
+	object.swap(frames.back().container);
+	frames.pop_back();
+	add(object);
+}
+
+void ValueBuilder::add(const ValuePtr& value)
+{
+	if (frames.empty())
+	{
+		result = value;
+		return;
+	}
+
+	Frame& frame = frames.back();
+
+	if (frame.container->getType() == ARRAY)
+	{
+		boost::static_pointer_cast<Array>(frame.container)->push_back(value);
+	}
+	else
+	{
+		boost::static_pointer_cast<Object>(frame.container)->insert(
+			frame.key, value);
+	}
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JSON_VALUEBUILDER_H
+#define JSON_VALUEBUILDER_H
+
+#include "Handler.h"
+#include "Value.h"
+#include "Identifier.h"
+
+#include <vector>
+
+namespace JSON
+{
+	/**
+	* A Handler which builds a tree of Values from parser events.
+	*
+	* This is what a Parser uses unless it is given a different handler.
+	* The finished tree can be retrieved with getResult(). Values are
+	* allocated together with their reference count, in one allocation
+	* each.
+	*/
+	class ValueBuilder : public Handler
+	{
+	public:
+		ValueBuilder();
+
+		void reset();
+		ValuePtr getResult() const;
+
+		void onNull();
+		void onBool(bool b);
+		void onNumber(const Number& n);
+		void onString(const std::string& s);
+		void onKey(const std::string& key);
+		void onKey(const Number& key);
+		void onStringReference(const char* data, size_t length);
+		void onKeyReference(const char* data, size_t length);
+		void onArrayStart();
+		void onArrayEnd();
+		void onObjectStart();
+		void onObjectEnd();
+	private:
+		struct Frame
+		{
+			ValuePtr container;
+			Identifier key;
+		};
+
+		void add(const ValuePtr& value);
+
+		std::vector<Frame> frames;
+		ValuePtr result;
+	};
+}
+
+#endif
@@ -0,0 +1,497 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "Writer.h"
+#include "AllValueTypes.h"
+#include "DocumentValue.h"
+#include "DocumentArray.h"
+#include "DocumentObject.h"
+#include "NumberConversion.h"
+
+#include <ostream>
+
+using namespace JSON;
+
+// stream output is written in blocks of about this size
+static const size_t flushSize = 64 * 1024;
+
+// characters strings have to escape, other characters are copied as is
+static const bool escapeTable[256] = {
+	true,  false, false, false, false, false, false, false, false, false, true,  false, false, true,  false, false,
+	false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false,
+	false, false, true,  false, false, false, false, false, false, false, false, false, false, false, false, false,
+	false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false,
+	false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false,
+	false, false, false, false, false, false, false, false, false, false, false, false, true,  false, false, false,
+};
+
+Writer::Writer(WriterMode mode) :
+	json(&buffer),
+	out(NULL),
+	mode(mode),
+	afterKey(false)
+{
+}
+
+Writer::Writer(std::string& json, WriterMode mode, const std::string& indent) :
+	json(&json),
+	out(NULL),
+	mode(mode),
+	indent(indent),
+	afterKey(false)
+{
+}
+
+Writer::Writer(std::ostream& out, WriterMode mode) :
+	json(&buffer),
+	out(&out),
+	mode(mode),
+	afterKey(false)
+{
+}
+
+Writer::~Writer()
+{
+	if (out)
+	{
+		flush();
+	}
+}
+
+void Writer::write(const Value& value)
+{
+	switch (value.getType())
+	{
+		case NULLTYPE:
+			if (value.isNull())
+			{
+				onNull();
+			}
+			else
+			{
+				// placeholders created by Object::operator[] and the like
+				beforeValue();
+				json->append("undefined");
+			}
+		break;
+
+		case BOOL:
+			onBool(value.toBool());
+		break;
+
+		case NUMBER:
+			beforeValue();
+			appendNumber(static_cast<const Number&>(value));
+		break;
+
+		case STRING:
+			onString(value.toString());
+		break;
+
+		case ARRAY:
+		{
+			const Array& array = value.toArray();
+			onArrayStart();
+
+			for (Array::const_iterator it = array.begin(); it != array.end(); ++it)
+			{
+				if (*it)
+				{
+					write(**it);
+				}
+				else
+				{
+					onNull();
+				}
+			}
+
+			onArrayEnd();
+		}
+		break;
+
+		case OBJECT:
+		{
+			const Object& object = value.toObject();
+			onObjectStart();
+
+			for (Object::const_iterator it = object.begin(); it != object.end(); ++it)
+			{
+				const Value& key = it->first.getValue();
+
+				beforeKey();
+
+				if (key.getType() == STRING)
+				{
+					appendString(key.toString().data(), key.toString().size());
+				}
+				else
+				{
+					appendNumber(static_cast<const Number&>(key));
+				}
+
+				json->append((mode == WRITER_PRETTY) ? ": " : ":");
+				afterKey = true;
+
+				if (it->second)
+				{
+					write(*it->second);
+				}
+				else
+				{
+					onNull();
+				}
+			}
+
+			onObjectEnd();
+		}
+		break;
+	}
+
+	flushIfFull();
+}
+
+void Writer::write(const DocumentValue& value)
+{
+	switch (value.getType())
+	{
+		case NULLTYPE:
+			onNull();
+		break;
+
+		case BOOL:
+			onBool(value.toBool());
+		break;
+
+		case NUMBER:
+			if (value.isExactInt())
+			{
+				onNumber(value.toInt());
+			}
+			else
+			{
+				onNumber(value.toDouble());
+			}
+		break;
+
+		case STRING:
+			onString(value.data(), value.length());
+		break;
+
+		case ARRAY:
+		{
+			const DocumentArray& array = value.toArray();
+			onArrayStart();
+
+			for (DocumentArray::const_iterator it = array.begin(); it != array.end(); ++it)
+			{
+				write(**it);
+			}
+
+			onArrayEnd();
+		}
+		break;
+
+		case OBJECT:
+		{
+			const DocumentObject& object = value.toObject();
+			onObjectStart();
+
+			for (DocumentObject::const_iterator it = object.begin(); it != object.end(); ++it)
+			{
+				const DocumentValue& key = *it->first;
+
+				if (key.getType() == STRING)
+				{
+					onKey(key.data(), key.length());
+				}
+				else if (key.isExactInt())
+				{
+					onKey(Number(key.toInt()));
+				}
+				else
+				{
+					onKey(Number(key.toDouble()));
+				}
+
+				write(*it->second);
+			}
+
+			onObjectEnd();
+		}
+		break;
+	}
+
+	flushIfFull();
+}
+
+void Writer::onNull()
+{
+	beforeValue();
+	json->append("null");
+}
+
+void Writer::onBool(bool b)
+{
+	beforeValue();
+	json->append((b) ? "true" : "false");
+}
+
+void Writer::onNumber(const Number& n)
+{
+	beforeValue();
+	appendNumber(n);
+}
+
+void Writer::onNumber(int64_t n)
+{
+	char digits[NumberConversion::BUFFER_SIZE];
+
+	beforeValue();
+	json->append(digits, NumberConversion::formatInt(n, digits));
+}
+
+void Writer::onNumber(double n)
+{
+	char digits[NumberConversion::BUFFER_SIZE];
+
+	beforeValue();
+	json->append(digits, NumberConversion::formatDouble(n, digits));
+}
+
+void Writer::onString(const std::string& s)
+{
+	beforeValue();
+	appendString(s.data(), s.size());
+}
+
+void Writer::onString(const char* data, size_t length)
+{
+	beforeValue();
+	appendString(data, length);
+}
+
+void Writer::onStringReference(const char* data, size_t length)
+{
+	onString(data, length);
+}
+
+void Writer::onKey(const std::string& key)
+{
+	onKey(key.data(), key.size());
+}
+
+void Writer::onKey(const char* data, size_t length)
+{
+	beforeKey();
+	appendString(data, length);
+	json->append((mode == WRITER_PRETTY) ? ": " : ":");
+	afterKey = true;
+}
+
+void Writer::onKeyReference(const char* data, size_t length)
+{
+	onKey(data, length);
+}
+
+void Writer::onKey(const Number& key)
+{
+	beforeKey();
+	appendNumber(key);
+	json->append((mode == WRITER_PRETTY) ? ": " : ":");
+	afterKey = true;
+}
+
+void Writer::onArrayStart()
+{
+	beforeValue();
+	json->push_back('[');
+
+	Frame frame = { false, true };
+	frames.push_back(frame);
+}
+
+void Writer::onArrayEnd()
+{
+	endContainer(']');
+}
+
+void Writer::onObjectStart()
+{
+	beforeValue();
+	json->push_back('{');
+
+	Frame frame = { true, true };
+	frames.push_back(frame);
+}
+
+void Writer::onObjectEnd()
+{
+	endContainer('}');
+}
+
+const std::string& Writer::getBuffer() const
+{
+	return *json;
+}
+
+void Writer::clear()
+{
+	json->clear();
+	frames.clear();
+	afterKey = false;
+}
+
+void Writer::flush()
+{
+	if (out && !buffer.empty())
+	{
+		out->write(buffer.data(), buffer.size());
+		out->flush();
+		buffer.clear();
+	}
+}
+
+inline void Writer::beforeValue()
+{
+	if (afterKey)
+	{
+		afterKey = false;
+		return;
+	}
+
+	// array elements are separated like object members
+	if (!frames.empty())
+	{
+		beforeKey();
+	}
+}
+
+inline void Writer::beforeKey()
+{
+	Frame& frame = frames.back();
+
+	if (!frame.empty)
+	{
+		json->push_back(',');
+	}
+
+	frame.empty = false;
+	newLine();
+}
+
+inline void Writer::newLine()
+{
+	if (mode == WRITER_PRETTY)
+	{
+		json->push_back('\n');
+		json->append(indent);
+		json->append(frames.size(), '\t');
+	}
+}
+
+void Writer::endContainer(char close)
+{
+	bool empty = frames.back().empty;
+	frames.pop_back();
+
+	if (!empty)
+	{
+		newLine();
+	}
+
+	json->push_back(close);
+	flushIfFull();
+}
+
+void Writer::appendString(const char* data, size_t length)
+{
+	const char* end = data + length;
+	const char* p = data;
+
+	json->push_back('"');
+
+	while (p != end)
+	{
+		// copy everything up to the next character which needs escaping
+		const char* run = p;
+
+		while (p != end && !escapeTable[(unsigned char) *p])
+		{
+			++p;
+		}
+
+		json->append(run, p - run);
+
+		if (p == end)
+		{
+			break;
+		}
+
+		switch (*p)
+		{
+			case '\\':
+				json->append("\\\\");
+			break;
+
+			case '"':
+				json->append("\\\"");
+			break;
+
+			case '\n':
+				json->append("\\n");
+			break;
+
+			case '\r':
+				json->append("\\r");
+			break;
+
+			case 0:
+				json->append("\\0");
+
+				// a digit directly following would change the escape
+				if (p + 1 != end && p[1] >= '0' && p[1] <= '9')
+				{
+					json->append("\\u003");
+					json->push_back(*++p);
+				}
+			break;
+		}
+
+		++p;
+	}
+
+	json->push_back('"');
+}
+
+void Writer::appendNumber(const Number& n)
+{
+	char digits[NumberConversion::BUFFER_SIZE];
+	size_t length = (n.isExactInt()) ?
+		NumberConversion::formatInt(n.toInt(), digits) :
+		NumberConversion::formatDouble(n.toDouble(), digits);
+
+	json->append(digits, length);
+}
+
+void Writer::flushIfFull()
+{
+	if (out && buffer.size() >= flushSize)
+	{
+		out->write(buffer.data(), buffer.size());
+		buffer.clear();
+	}
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include "Handler.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace JSON
+{
+	class Value;
+	class DocumentValue;
+
+	/**
+	* An enum of the output formats of a Writer.
+	*/
+	typedef enum
+	{
+		WRITER_PRETTY,
+		WRITER_COMPACT
+	} WriterMode;
+
+	/**
+	* Serializes values into JSON text.
+	*
+	* A writer appends to its own buffer, to a given string or streams to
+	* an ostream, which it writes to in large blocks and on flush(). Pretty
+	* output puts every element and member on its own line indented with
+	* tabs, the format Value::toJSON() has always produced. Compact output
+	* contains no whitespace at all.
+	*
+	* Whole values are written with write(). As a Handler a writer can also
+	* be given the events of a Parser directly, e.g. to reformat a file
+	* without building any values. The writer's own buffer can be reused
+	* for several documents by calling clear() in between.
+	*/
+	class Writer : public Handler
+	{
+	public:
+		Writer(WriterMode mode = WRITER_PRETTY);
+		Writer(std::string& json, WriterMode mode = WRITER_PRETTY, const std::string& indent = "");
+		Writer(std::ostream& out, WriterMode mode = WRITER_PRETTY);
+		~Writer();
+
+		void write(const Value& value);
+		void write(const DocumentValue& value);
+
+		void onNull();
+		void onBool(bool b);
+		void onNumber(const Number& n);
+		void onNumber(int64_t n);
+		void onNumber(double n);
+		void onString(const std::string& s);
+		void onString(const char* data, size_t length);
+		void onKey(const std::string& key);
+		void onKey(const char* data, size_t length);
+		void onKey(const Number& key);
+		void onArrayStart();
+		void onArrayEnd();
+		void onObjectStart();
+		void onObjectEnd();
+		void onStringReference(const char* data, size_t length);
+		void onKeyReference(const char* data, size_t length);
+
+		const std::string& getBuffer() const;
+		void clear();
+		void flush();
+	private:
+		Writer(const Writer&) {}; // do not allow copying
+		Writer& operator=(const Writer&) { return *this; }; // do not allow assignment
+
+		struct Frame
+		{
+			bool object;
+			bool empty;
+		};
+
+		inline void beforeValue();
+		inline void beforeKey();
+		inline void newLine();
+		void appendString(const char* data, size_t length);
+		void appendNumber(const Number& n);
+		void endContainer(char close);
+		void flushIfFull();
+
+		std::string buffer;
+		std::string* json;
+		std::ostream* out;
+		WriterMode mode;
+		std::string indent;
+		std::vector<Frame> frames;
+
+		// a key has been written and its value is expected next
+		bool afterKey;
+	};
+}
+
+#endif
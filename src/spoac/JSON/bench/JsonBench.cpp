@@ -0,0 +1,642 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+/**
+* Measures parse and serialize throughput and allocations per document of
+* the JSON library over a corpus, reporting the results as JSON or CSV so
+* they can be compared between revisions.
+*
+* Usage: spoac_json_bench [-t milliseconds] [-n iterations] [-k kilobytes]
+*                         [-s scanner] [-f json|csv] [-o file] [file...]
+*
+* The corpus consists of the given files, e.g. the LTM fixtures, and of
+* generated documents of roughly -k kilobytes each: deeply nested and wide
+* objects, number heavy arrays and escape heavy strings. Every operation
+* runs until -t milliseconds have passed, or exactly -n times. Allocations
+* are counted for a single run of each operation.
+*
+* The spoac_json_bench_report target runs it on the LTM fixtures and
+* writes the results to spoac_json_bench.json in the build directory.
+*/
+
+#include <spoac/JSON/BinaryReader.h>
+#include <spoac/JSON/Codec.h>
+#include <spoac/JSON/Document.h>
+#include <spoac/JSON/Parser.h>
+#include <spoac/JSON/Scanner.h>
+#include <spoac/JSON/Writer.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <vector>
+#include <sys/time.h>
+
+static size_t allocationCount = 0;
+static size_t allocationBytes = 0;
+
+void* operator new(size_t size) throw (std::bad_alloc)
+{
+	allocationCount++;
+	allocationBytes += size;
+
+	void* p = malloc(size ? size : 1);
+
+	if (p == NULL)
+	{
+		throw std::bad_alloc();
+	}
+
+	return p;
+}
+
+void* operator new[](size_t size) throw (std::bad_alloc)
+{
+	return operator new(size);
+}
+
+void operator delete(void* p) throw ()
+{
+	free(p);
+}
+
+void operator delete[](void* p) throw ()
+{
+	free(p);
+}
+
+/**
+* Receives parser events without doing anything, which leaves the cost of
+* the parser itself.
+*/
+class NullHandler : public JSON::Handler
+{
+public:
+	void onNull() {}
+	void onBool(bool b) {}
+	void onNumber(const JSON::Number& n) {}
+	void onString(const std::string& s) {}
+	void onKey(const std::string& key) {}
+	void onKey(const JSON::Number& key) {}
+	void onStringReference(const char* data, size_t length) {}
+	void onKeyReference(const char* data, size_t length) {}
+	void onNumberReference(const char* data, size_t length) {}
+	void onArrayStart() {}
+	void onArrayEnd() {}
+	void onObjectStart() {}
+	void onObjectEnd() {}
+};
+
+struct CorpusEntry
+{
+	std::string name;
+	std::string data;
+};
+
+/**
+* An operation on one document, run repeatedly.
+*/
+class Operation
+{
+public:
+	virtual ~Operation() {}
+	virtual const char* getName() const = 0;
+	virtual void run() = 0;
+
+	/**
+	* Number of bytes one run processes, used for the throughput.
+	*/
+	virtual size_t getBytes() const = 0;
+};
+
+class ParseTree : public Operation
+{
+public:
+	ParseTree(const std::string& data) : data(data) {}
+	const char* getName() const { return "parse_tree"; }
+	size_t getBytes() const { return data.size(); }
+
+	void run()
+	{
+		JSON::Parser parser;
+		parser.read(data);
+		parser.finish();
+	}
+
+private:
+	const std::string& data;
+};
+
+class ParseDocument : public Operation
+{
+public:
+	ParseDocument(const std::string& data) : data(data) {}
+	const char* getName() const { return "parse_document"; }
+	size_t getBytes() const { return data.size(); }
+
+	void run()
+	{
+		JSON::Document document;
+		JSON::Parser parser(document);
+		parser.read(data);
+		parser.finish();
+	}
+
+private:
+	const std::string& data;
+};
+
+class ParseEvents : public Operation
+{
+public:
+	ParseEvents(const std::string& data) : data(data) {}
+	const char* getName() const { return "parse_events"; }
+	size_t getBytes() const { return data.size(); }
+
+	void run()
+	{
+		NullHandler handler;
+		JSON::Parser parser(handler);
+		parser.read(data);
+		parser.finish();
+	}
+
+private:
+	const std::string& data;
+};
+
+class DecodeBinary : public Operation
+{
+public:
+	DecodeBinary(const std::string& binary) : binary(binary) {}
+	const char* getName() const { return "decode_binary"; }
+	size_t getBytes() const { return binary.size(); }
+
+	void run()
+	{
+		JSON::BinaryReader reader;
+		reader.read(binary);
+	}
+
+private:
+	const std::string& binary;
+};
+
+class ToJSON : public Operation
+{
+public:
+	ToJSON(const JSON::Value& value, size_t bytes) : value(value), bytes(bytes) {}
+	const char* getName() const { return "to_json"; }
+	size_t getBytes() const { return bytes; }
+
+	void run()
+	{
+		value.toJSON();
+	}
+
+private:
+	const JSON::Value& value;
+	size_t bytes;
+};
+
+class WriteCompact : public Operation
+{
+public:
+	WriteCompact(const JSON::Value& value, size_t bytes) : value(value), bytes(bytes) {}
+	const char* getName() const { return "write_compact"; }
+	size_t getBytes() const { return bytes; }
+
+	void run()
+	{
+		std::string json;
+		JSON::Codec::encode(value, JSON::CODEC_TEXT, json);
+	}
+
+private:
+	const JSON::Value& value;
+	size_t bytes;
+};
+
+class EncodeBinary : public Operation
+{
+public:
+	EncodeBinary(const JSON::Value& value, size_t bytes) : value(value), bytes(bytes) {}
+	const char* getName() const { return "encode_binary"; }
+	size_t getBytes() const { return bytes; }
+
+	void run()
+	{
+		std::string binary;
+		JSON::Codec::encode(value, JSON::CODEC_BINARY, binary);
+	}
+
+private:
+	const JSON::Value& value;
+	size_t bytes;
+};
+
+struct Result
+{
+	std::string document;
+	std::string operation;
+	size_t bytes;
+	size_t iterations;
+	double nsPerDoc;
+	double mbPerSecond;
+	size_t allocations;
+	size_t allocatedBytes;
+};
+
+static double now()
+{
+	timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static Result measure(const std::string& document, Operation& operation, double minSeconds, size_t iterations)
+{
+	Result result;
+	result.document = document;
+	result.operation = operation.getName();
+	result.bytes = operation.getBytes();
+
+	// the first run also warms up caches and the allocator
+	size_t count = allocationCount;
+	size_t bytes = allocationBytes;
+	operation.run();
+	result.allocations = allocationCount - count;
+	result.allocatedBytes = allocationBytes - bytes;
+
+	double start = now();
+	double elapsed = 0;
+	size_t runs = 0;
+
+	while ((iterations && runs < iterations) || (!iterations && elapsed < minSeconds))
+	{
+		operation.run();
+		runs++;
+
+		// reading the clock is cheap compared to a parse, but not free
+		if (!iterations && (runs & 7) == 0)
+		{
+			elapsed = now() - start;
+		}
+	}
+
+	elapsed = now() - start;
+
+	result.iterations = runs;
+	result.nsPerDoc = elapsed * 1e9 / runs;
+	result.mbPerSecond = result.bytes * (double) runs / elapsed / (1024 * 1024);
+
+	return result;
+}
+
+/**
+* Objects nested in arrays nested in objects, down to the given depth at
+* every other member.
+*/
+static void generateDeep(std::stringstream& ss, int depth)
+{
+	if (depth == 0)
+	{
+		ss << "\"leaf\"";
+		return;
+	}
+
+	ss << "{\"level\": " << depth << ", \"children\": [";
+	generateDeep(ss, depth - 1);
+	ss << ", ";
+	generateDeep(ss, depth / 2);
+	ss << "]}";
+}
+
+static std::string generateDeepObjects(size_t bytes)
+{
+	std::stringstream ss;
+	ss << "[";
+
+	for (size_t n = 0; (size_t) ss.tellp() < bytes; ++n)
+	{
+		ss << (n ? ",\n" : "");
+		generateDeep(ss, 12);
+	}
+
+	ss << "]";
+	return ss.str();
+}
+
+static std::string generateWideObject(size_t bytes)
+{
+	std::stringstream ss;
+	ss << "{";
+
+	for (size_t n = 0; (size_t) ss.tellp() < bytes; ++n)
+	{
+		ss << (n ? ",\n" : "") << "\t\"property_" << n << "\": {\"id\": " << n
+			<< ", \"visible\": " << ((n % 3) ? "true" : "false")
+			<< ", \"owner\": null, \"label\": \"object " << n << "\"}";
+	}
+
+	ss << "}";
+	return ss.str();
+}
+
+static std::string generateNumbers(size_t bytes)
+{
+	std::stringstream ss;
+	ss.precision(17);
+	ss << "[";
+
+	// a deterministic mix of small and large integers, decimals and
+	// exponents, which take different paths through number parsing
+	uint32_t x = 12345;
+
+	for (size_t n = 0; (size_t) ss.tellp() < bytes; ++n)
+	{
+		x = x * 1103515245 + 12345;
+		ss << (n ? ", " : "");
+
+		switch (n % 4)
+		{
+			case 0: ss << (int) (x % 1000); break;
+			case 1: ss << (int64_t) x * 65537 - 2147483648LL; break;
+			case 2: ss << (x % 100000) / 1000.0; break;
+			default: ss << (x % 1000) * 1.5e-7; break;
+		}
+	}
+
+	ss << "]";
+	return ss.str();
+}
+
+static std::string generateEscapes(size_t bytes)
+{
+	std::stringstream ss;
+	ss << "[";
+
+	for (size_t n = 0; (size_t) ss.tellp() < bytes; ++n)
+	{
+		ss << (n ? ",\n" : "")
+			<< "\"line " << n << "\\n\\tquoted \\\"text\\\" with a back\\\\slash, "
+			<< "caf\\u00e9 \\u2603 \\ud83d\\ude00 and a long plain stretch of text after it\"";
+	}
+
+	ss << "]";
+	return ss.str();
+}
+
+static void writeJSON(std::ostream& out, const std::vector<Result>& results, size_t kilobytes)
+{
+	JSON::Writer writer(out);
+
+	writer.onObjectStart();
+	writer.onKey("benchmark");
+	writer.onString("spoac_json_bench");
+	writer.onKey("scanner");
+	writer.onString(JSON::Scanner::getImplementationName(JSON::Scanner::getImplementation()));
+	writer.onKey("generatedKilobytes");
+	writer.onNumber((int64_t) kilobytes);
+	writer.onKey("results");
+	writer.onArrayStart();
+
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const Result& r = results[i];
+
+		writer.onObjectStart();
+		writer.onKey("document");
+		writer.onString(r.document);
+		writer.onKey("operation");
+		writer.onString(r.operation);
+		writer.onKey("bytes");
+		writer.onNumber((int64_t) r.bytes);
+		writer.onKey("iterations");
+		writer.onNumber((int64_t) r.iterations);
+		writer.onKey("nsPerDoc");
+		writer.onNumber(r.nsPerDoc);
+		writer.onKey("mbPerSecond");
+		writer.onNumber(r.mbPerSecond);
+		writer.onKey("allocationsPerDoc");
+		writer.onNumber((int64_t) r.allocations);
+		writer.onKey("allocatedBytesPerDoc");
+		writer.onNumber((int64_t) r.allocatedBytes);
+		writer.onObjectEnd();
+	}
+
+	writer.onArrayEnd();
+	writer.onObjectEnd();
+	writer.flush();
+	out << std::endl;
+}
+
+static void writeCSV(std::ostream& out, const std::vector<Result>& results)
+{
+	out << "document,operation,bytes,iterations,ns_per_doc,mb_per_s,allocs_per_doc,alloc_bytes_per_doc\n";
+
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const Result& r = results[i];
+
+		out << r.document << "," << r.operation << "," << r.bytes << ","
+			<< r.iterations << "," << (int64_t) r.nsPerDoc << ","
+			<< r.mbPerSecond << "," << r.allocations << ","
+			<< r.allocatedBytes << "\n";
+	}
+}
+
+static void benchmark(const CorpusEntry& entry, double minSeconds, size_t iterations, std::vector<Result>& results)
+{
+	JSON::Parser parser;
+	parser.read(entry.data);
+	JSON::ValuePtr value = parser.finish();
+
+	std::string compact = JSON::Codec::encode(*value, JSON::CODEC_TEXT);
+	std::string binary = JSON::Codec::encode(*value, JSON::CODEC_BINARY);
+
+	ParseTree parseTree(entry.data);
+	ParseDocument parseDocument(entry.data);
+	ParseEvents parseEvents(entry.data);
+	DecodeBinary decodeBinary(binary);
+	ToJSON toJSON(*value, entry.data.size());
+	WriteCompact writeCompact(*value, compact.size());
+	EncodeBinary encodeBinary(*value, binary.size());
+
+	Operation* operations[] = {
+		&parseTree, &parseDocument, &parseEvents, &decodeBinary,
+		&toJSON, &writeCompact, &encodeBinary
+	};
+
+	for (size_t i = 0; i < sizeof(operations) / sizeof(operations[0]); ++i)
+	{
+		results.push_back(measure(entry.name, *operations[i], minSeconds, iterations));
+		std::cerr << ".";
+	}
+}
+
+static void usage(const char* name)
+{
+	std::cerr << "Usage: " << name << " [-t milliseconds] [-n iterations] [-k kilobytes]" << std::endl
+		<< "       [-s scanner] [-f json|csv] [-o file] [file...]" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	double minSeconds = 0.2;
+	size_t iterations = 0;
+	size_t kilobytes = 256;
+	std::string format("json");
+	std::string output;
+	std::vector<CorpusEntry> corpus;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+		{
+			minSeconds = atoi(argv[++i]) / 1000.0;
+		}
+		else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+		{
+			iterations = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc)
+		{
+			kilobytes = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+		{
+			format = argv[++i];
+		}
+		else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+		{
+			output = argv[++i];
+		}
+		else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+		{
+			const char* name = argv[++i];
+			bool found = false;
+
+			for (int impl = JSON::SCANNER_AUTO; impl <= JSON::SCANNER_AVX2; ++impl)
+			{
+				JSON::ScannerImplementation implementation = (JSON::ScannerImplementation) impl;
+
+				if (strcmp(name, JSON::Scanner::getImplementationName(implementation)) == 0)
+				{
+					found = JSON::Scanner::setImplementation(implementation);
+				}
+			}
+
+			if (!found)
+			{
+				std::cerr << "Scanner " << name << " is not available" << std::endl;
+				return 1;
+			}
+		}
+		else if (argv[i][0] == '-')
+		{
+			usage(argv[0]);
+			return 1;
+		}
+		else
+		{
+			std::ifstream in(argv[i]);
+
+			if (!in)
+			{
+				std::cerr << "Cannot read " << argv[i] << std::endl;
+				return 1;
+			}
+
+			std::stringstream ss;
+			ss << in.rdbuf();
+
+			CorpusEntry entry;
+			entry.name = argv[i];
+			entry.data = ss.str();
+			corpus.push_back(entry);
+		}
+	}
+
+	if (format != "json" && format != "csv")
+	{
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (kilobytes)
+	{
+		CorpusEntry generated[4];
+		generated[0].name = "generated:deep";
+		generated[0].data = generateDeepObjects(kilobytes * 1024);
+		generated[1].name = "generated:wide";
+		generated[1].data = generateWideObject(kilobytes * 1024);
+		generated[2].name = "generated:numbers";
+		generated[2].data = generateNumbers(kilobytes * 1024);
+		generated[3].name = "generated:escapes";
+		generated[3].data = generateEscapes(kilobytes * 1024);
+
+		corpus.insert(corpus.end(), generated, generated + 4);
+	}
+
+	std::vector<Result> results;
+
+	for (size_t i = 0; i < corpus.size(); ++i)
+	{
+		try
+		{
+			benchmark(corpus[i], minSeconds, iterations, results);
+		}
+		catch (const JSON::Exception& e)
+		{
+			std::cerr << std::endl << corpus[i].name << ": " << e.getMessage() << std::endl;
+			return 1;
+		}
+	}
+
+	std::cerr << std::endl;
+
+	std::ofstream file;
+
+	if (!output.empty())
+	{
+		file.open(output.c_str());
+
+		if (!file)
+		{
+			std::cerr << "Cannot write " << output << std::endl;
+			return 1;
+		}
+	}
+
+	std::ostream& out = output.empty() ? std::cout : file;
+
+	if (format == "csv")
+	{
+		writeCSV(out, results);
+	}
+	else
+	{
+		writeJSON(out, results, kilobytes);
+	}
+
+	return 0;
+}
@@ -0,0 +1,352 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+/**
+* Differential fuzz target for the JSON parser.
+*
+* Every input is parsed in several ways which have to agree: in one piece
+* and split into chunks, into a Value tree, into a Document, from a mapped
+* file and as plain events, and with every Scanner implementation the CPU
+* supports. Accepted inputs also have to survive a round trip through
+* compact text and through CBOR, and BinaryReader has to reject arbitrary
+* bytes with an exception. Any disagreement aborts, so the state machine
+* serves as the reference for new fast paths.
+*
+* Built with -DSPOAC_LIBFUZZER and -fsanitize=fuzzer this is a libFuzzer
+* target. Otherwise main() runs each file given on the command line, or
+* standard input without arguments, which is what AFL expects:
+*   afl-fuzz -i corpus -o findings -- ./spoac_json_fuzz @@
+*/
+
+#include <spoac/JSON/BinaryReader.h>
+#include <spoac/JSON/Codec.h>
+#include <spoac/JSON/Document.h>
+#include <spoac/JSON/Exception.h>
+#include <spoac/JSON/Parser.h>
+#include <spoac/JSON/Scanner.h>
+#include <spoac/JSON/Writer.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <stdint.h>
+#include <unistd.h>
+
+/**
+* How parsing an input one way ended: the compact text of the result or
+* failure.
+*/
+struct Outcome
+{
+	Outcome() : failed(false) {}
+
+	bool failed;
+	std::string text;
+};
+
+static void check(bool condition, const char* what, const Outcome& a, const Outcome& b)
+{
+	if (condition)
+	{
+		return;
+	}
+
+	std::cerr << "Mismatch: " << what << std::endl
+		<< "  " << (a.failed ? "failed" : a.text) << std::endl
+		<< "  " << (b.failed ? "failed" : b.text) << std::endl;
+	abort();
+}
+
+static bool operator==(const Outcome& a, const Outcome& b)
+{
+	return a.failed == b.failed && a.text == b.text;
+}
+
+static Outcome parseTree(const char* data, size_t size, size_t chunk)
+{
+	Outcome outcome;
+
+	try
+	{
+		JSON::Parser parser;
+
+		for (size_t pos = 0; pos < size; pos += chunk)
+		{
+			parser.read(data + pos, std::min(chunk, size - pos));
+		}
+
+		JSON::ValuePtr value = parser.finish();
+
+		if (value)
+		{
+			JSON::Codec::encode(*value, JSON::CODEC_TEXT, outcome.text);
+		}
+	}
+	catch (const JSON::Exception& e)
+	{
+		outcome.failed = true;
+		outcome.text.clear();
+	}
+
+	return outcome;
+}
+
+static Outcome parseEvents(const char* data, size_t size)
+{
+	Outcome outcome;
+
+	try
+	{
+		JSON::Writer writer(outcome.text, JSON::WRITER_COMPACT);
+		JSON::Parser parser(writer);
+
+		parser.read(data, size);
+		parser.finish();
+	}
+	catch (const JSON::Exception& e)
+	{
+		outcome.failed = true;
+		outcome.text.clear();
+	}
+
+	return outcome;
+}
+
+static Outcome parseDocument(const char* data, size_t size)
+{
+	Outcome outcome;
+
+	try
+	{
+		JSON::Document document;
+		JSON::Parser parser(document);
+
+		parser.read(data, size);
+		parser.finish();
+
+		JSON::Codec::encode(document.getRoot(), JSON::CODEC_TEXT, outcome.text);
+	}
+	catch (const JSON::Exception& e)
+	{
+		outcome.failed = true;
+		outcome.text.clear();
+	}
+
+	return outcome;
+}
+
+/**
+* Parses from a mapped file, where the document references strings and
+* numbers in the input instead of copying them. Also returns the raw
+* source of the root value.
+*/
+static Outcome parseFile(const char* data, size_t size, std::string& raw)
+{
+	static std::string path;
+
+	if (path.empty())
+	{
+		char name[] = "/tmp/spoac_json_fuzz_XXXXXX";
+		int fd = mkstemp(name);
+
+		if (fd == -1)
+		{
+			abort();
+		}
+
+		close(fd);
+		path = name;
+	}
+
+	{
+		std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+		out.write(data, size);
+	}
+
+	Outcome outcome;
+
+	try
+	{
+		JSON::Document document;
+		JSON::Parser parser(document);
+
+		parser.readFromFile(path);
+
+		JSON::Codec::encode(document.getRoot(), JSON::CODEC_TEXT, outcome.text);
+		raw = document.getRoot().toRawJSON();
+	}
+	catch (const JSON::Exception& e)
+	{
+		outcome.failed = true;
+		outcome.text.clear();
+	}
+
+	return outcome;
+}
+
+/**
+* Checks whether written text reads back as the same value. Infinities are
+* written as inf and NUL characters as \0, as the stream based output has
+* always done, but the parser reads neither. In compact text an i outside
+* of strings only occurs in inf.
+*/
+static bool readsBack(const std::string& text)
+{
+	bool inString = false;
+
+	for (size_t i = 0; i < text.size(); ++i)
+	{
+		if (inString)
+		{
+			if (text[i] == '\\')
+			{
+				if (++i < text.size() && text[i] == '0')
+				{
+					return false;
+				}
+			}
+			else if (text[i] == '"')
+			{
+				inString = false;
+			}
+		}
+		else if (text[i] == '"')
+		{
+			inString = true;
+		}
+		else if (text[i] == 'i')
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void checkBinary(const char* data, size_t size, const Outcome& tree)
+{
+	// arbitrary bytes may be rejected, but only with an exception
+	try
+	{
+		JSON::BinaryReader reader;
+		reader.read(data, size);
+	}
+	catch (const JSON::Exception& e)
+	{
+	}
+
+	if (tree.failed || !readsBack(tree.text))
+	{
+		return;
+	}
+
+	Outcome decoded;
+	JSON::ValuePtr value = JSON::Codec::decode(tree.text);
+	std::string binary = JSON::Codec::encode(*value, JSON::CODEC_BINARY);
+	JSON::Codec::encode(*JSON::Codec::decode(binary), JSON::CODEC_TEXT, decoded.text);
+
+	check(decoded == tree, "CBOR round trip", decoded, tree);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* bytes, size_t size)
+{
+	const char* data = (const char*) bytes;
+
+	Outcome tree = parseTree(data, size, size ? size : 1);
+	check(parseTree(data, size, 1) == tree, "tree parsed in single bytes", parseTree(data, size, 1), tree);
+	check(parseTree(data, size, 7) == tree, "tree parsed in chunks of 7", parseTree(data, size, 7), tree);
+
+	Outcome events = parseEvents(data, size);
+	check(events.failed == tree.failed, "events and tree accept the input", events, tree);
+
+	// trees drop duplicate keys, so documents are compared to events
+	Outcome document = parseDocument(data, size);
+	check(document == events, "document and events", document, events);
+
+	std::string raw;
+	Outcome file = parseFile(data, size, raw);
+	check(file == events, "file document and events", file, events);
+
+	if (!file.failed && readsBack(file.text))
+	{
+		// the raw source of the root has to parse to the same value
+		Outcome reparsed = parseDocument(raw.data(), raw.size());
+		check(reparsed == file, "raw source of a file document", reparsed, file);
+	}
+
+	JSON::ScannerImplementation current = JSON::Scanner::getImplementation();
+
+	for (int impl = JSON::SCANNER_SCALAR; impl <= JSON::SCANNER_AVX2; ++impl)
+	{
+		if (JSON::Scanner::setImplementation((JSON::ScannerImplementation) impl))
+		{
+			Outcome scanned = parseEvents(data, size);
+			check(scanned == events, JSON::Scanner::getImplementationName((JSON::ScannerImplementation) impl), scanned, events);
+		}
+	}
+
+	JSON::Scanner::setImplementation(current);
+
+	if (!tree.failed && readsBack(tree.text))
+	{
+		Outcome reparsed = parseTree(tree.text.data(), tree.text.size(), tree.text.size());
+		check(reparsed == tree, "compact text round trip", reparsed, tree);
+	}
+
+	checkBinary(data, size, tree);
+
+	return 0;
+}
+
+#ifndef SPOAC_LIBFUZZER
+static int runInput(std::istream& in)
+{
+	std::stringstream ss;
+	ss << in.rdbuf();
+	std::string input = ss.str();
+
+	return LLVMFuzzerTestOneInput((const uint8_t*) input.data(), input.size());
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		return runInput(std::cin);
+	}
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::ifstream in(argv[i], std::ios::binary);
+
+		if (!in)
+		{
+			std::cerr << "Cannot read " << argv[i] << std::endl;
+			return 1;
+		}
+
+		runInput(in);
+	}
+
+	return 0;
+}
+#endif
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define BOOST_TEST_MODULE spoac_JSON_Binary
+#include <spoactest/test.h>
+
+#include <spoac/JSON/BinaryReader.h>
+#include <spoac/JSON/BinaryWriter.h>
+#include <spoac/JSON/Codec.h>
+#include <spoac/JSON/Document.h>
+#include <spoac/JSON/Parser.h>
+
+#include <limits>
+
+using namespace JSON;
+
+static const char* samples[] = {
+	"null",
+	"true",
+	"[false, null, 0, 23, 24, 255, 256, 65535, 65536, 4294967296]",
+	"[-1, -24, -25, -256, -257, -9223372036854775808, 9223372036854775807]",
+	"[0.5, 0.1, -2.75, 1e300, 1.5e-300, 18446744073709551616]",
+	"[\"\", \"a\", \"quote \\\" backslash \\\\ tab \\t\", \"\\u00e4\\u20ac\"]",
+	"{\"name\": \"SampleOAC\", \"params\": [\"x\", \"y\"], \"match\": [{\"x\": {\"isLocation\": true}}]}",
+	"{\"empty\": {}, \"list\": [], \"nested\": [[[]], {\"a\": {\"b\": {}}}], 1: \"number key\"}",
+};
+
+static ValuePtr parse(const std::string& json)
+{
+	Parser parser;
+	parser.read(json);
+	return parser.finish();
+}
+
+static std::string bytes(const char* data, size_t len)
+{
+	return std::string(data, len);
+}
+
+BOOST_AUTO_TEST_CASE(testRoundTrip)
+{
+	for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); ++i)
+	{
+		ValuePtr value = parse(samples[i]);
+
+		std::string data = Codec::encode(*value, CODEC_BINARY);
+		BOOST_CHECK(BinaryReader::isBinary(data));
+
+		BinaryReader reader;
+		BOOST_CHECK_EQUAL(reader.read(data)->toJSON(), value->toJSON());
+
+		// parser events are written with indefinite lengths
+		std::string streamed;
+		BinaryWriter writer(streamed);
+		Parser streamParser(writer);
+		streamParser.read(samples[i]);
+		streamParser.finish();
+
+		BOOST_CHECK_EQUAL(reader.read(streamed)->toJSON(), value->toJSON());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(testEncoding)
+{
+	// examples from RFC 7049 appendix A behind the self-describe tag
+	std::string tag("\xd9\xd9\xf7");
+
+	BOOST_CHECK_EQUAL(Codec::encode(Number(10), CODEC_BINARY), tag + "\x0a");
+	BOOST_CHECK_EQUAL(Codec::encode(Number(1000), CODEC_BINARY), tag + "\x19\x03\xe8");
+	BOOST_CHECK_EQUAL(Codec::encode(Number(-1000), CODEC_BINARY), tag + "\x39\x03\xe7");
+	BOOST_CHECK_EQUAL(Codec::encode(Number(100000.0), CODEC_BINARY), tag + bytes("\x1a\x00\x01\x86\xa0", 5));
+	BOOST_CHECK_EQUAL(Codec::encode(Number(1.1), CODEC_BINARY), tag + "\xfb\x3f\xf1\x99\x99\x99\x99\x99\x9a");
+	BOOST_CHECK_EQUAL(Codec::encode(Number(0.5), CODEC_BINARY), tag + bytes("\xfa\x3f\x00\x00\x00", 5));
+	BOOST_CHECK_EQUAL(Codec::encode(*parse("[1, [2, 3]]"), CODEC_BINARY), tag + "\x82\x01\x82\x02\x03");
+	BOOST_CHECK_EQUAL(Codec::encode(*parse("{\"a\": \"b\"}"), CODEC_BINARY), tag + "\xa1\x61\x61\x61\x62");
+
+	// half precision floats are read as well
+	BinaryReader reader;
+	BOOST_CHECK_EQUAL(reader.read(bytes("\xf9\x3e\x00", 3))->toDouble(), 1.5);
+	BOOST_CHECK_EQUAL(reader.read(bytes("\xf9\xc4\x00", 3))->toDouble(), -4.0);
+	BOOST_CHECK_EQUAL(reader.read(bytes("\xf9\x7c\x00", 3))->toDouble(), std::numeric_limits<double>::infinity());
+	BOOST_CHECK(reader.read("\xf7")->isNull());
+}
+
+BOOST_AUTO_TEST_CASE(testDocument)
+{
+	ValuePtr value = parse(samples[6]);
+
+	Document document;
+	Parser parser(document);
+	parser.read(samples[6]);
+	parser.finish();
+
+	std::string data;
+	Codec::encode(document.getRoot(), CODEC_BINARY, data);
+	BOOST_CHECK_EQUAL(data, Codec::encode(*value, CODEC_BINARY));
+
+	Document decoded;
+	BinaryReader reader(decoded);
+	BOOST_CHECK(!reader.read(data));
+	BOOST_CHECK_EQUAL(decoded.getRoot().toObject()["name"]->toString(), "SampleOAC");
+	BOOST_CHECK_EQUAL(decoded.getRoot().toJSON(), value->toJSON());
+}
+
+BOOST_AUTO_TEST_CASE(testCodec)
+{
+	ValuePtr value = parse(samples[7]);
+
+	std::string text = Codec::encode(*value, CODEC_TEXT);
+	BOOST_CHECK(!BinaryReader::isBinary(text));
+	BOOST_CHECK_EQUAL(text, "{\"empty\":{},\"list\":[],\"nested\":[[[]],{\"a\":{\"b\":{}}}],1:\"number key\"}");
+
+	BOOST_CHECK_EQUAL(Codec::decode(text)->toJSON(), value->toJSON());
+	BOOST_CHECK_EQUAL(Codec::decode(Codec::encode(*value, CODEC_BINARY))->toJSON(), value->toJSON());
+
+	BOOST_CHECK_EQUAL(Codec::getFormat("text"), CODEC_TEXT);
+	BOOST_CHECK_EQUAL(Codec::getFormat("binary"), CODEC_BINARY);
+	BOOST_CHECK_THROW(Codec::getFormat("xml"), Exception);
+}
+
+BOOST_AUTO_TEST_CASE(testMalformed)
+{
+	BinaryReader reader;
+
+	BOOST_CHECK_THROW(reader.read(""), ParserException);
+	BOOST_CHECK_THROW(reader.read("\x82\x01"), ParserException);
+	BOOST_CHECK_THROW(reader.read("\x63" "ab"), ParserException);
+	BOOST_CHECK_THROW(reader.read("\x01\x02"), ParserException);
+	BOOST_CHECK_THROW(reader.read("\x41" "a"), ParserException);
+	BOOST_CHECK_THROW(reader.read("\xff"), ParserException);
+	BOOST_CHECK_THROW(reader.read("\xbf\x61" "a\xff"), ParserException);
+	BOOST_CHECK_THROW(reader.read("\xa1\x80\x01"), ParserException);
+
+	// the reader can be used again after an error
+	BOOST_CHECK_EQUAL(reader.read("\x9f\x01\xff")->toJSON(), "[\n\t1\n]");
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define BOOST_TEST_MODULE spoac_JSON_Binding
+#include <spoactest/test.h>
+
+#include <spoac/JSON/Binding.h>
+#include <spoac/JSON/BindingException.h>
+#include <spoac/JSON/Parser.h>
+
+#include <cstdlib>
+#include <unistd.h>
+
+struct Parameter
+{
+	std::string name;
+	std::string type;
+};
+
+struct Definition
+{
+	std::string name;
+	short arguments;
+	double weight;
+	bool enabled;
+	std::vector<Parameter> params;
+	std::vector<std::string> tags;
+	std::map<std::string, std::string> goals;
+	std::vector<Definition> children;
+};
+
+namespace JSON
+{
+	template <>
+	struct Mapping<Parameter>
+	{
+		static void describe(FieldList<Parameter>& fields)
+		{
+			fields.add("name", &Parameter::name, BIND_REQUIRED);
+			fields.add("type", &Parameter::type);
+			fields.setShorthand(&Parameter::name);
+		}
+	};
+
+	template <>
+	struct Mapping<Definition>
+	{
+		static void describe(FieldList<Definition>& fields)
+		{
+			fields.add("name", &Definition::name, BIND_REQUIRED);
+			fields.add("arguments", &Definition::arguments);
+			fields.add("weight", &Definition::weight);
+			fields.add("enabled", &Definition::enabled);
+			fields.add("params", &Definition::params);
+			fields.add("tags", &Definition::tags);
+			fields.add("goals", &Definition::goals);
+			fields.add("children", &Definition::children);
+		}
+	};
+}
+
+template <class T>
+void bindDocument(const std::string& json, T& target)
+{
+	JSON::Binding<T> binding(target);
+	JSON::Parser parser(binding);
+
+	parser.read(json);
+	parser.finish();
+}
+
+std::string bindError(const std::string& json)
+{
+	Definition definition;
+
+	try
+	{
+		bindDocument(json, definition);
+	}
+	catch (const JSON::BindingException& e)
+	{
+		return e.getPath();
+	}
+
+	return "";
+}
+
+BOOST_AUTO_TEST_CASE(testBindStruct)
+{
+	Definition d;
+	d.arguments = 0;
+	d.enabled = false;
+
+	bindDocument(std::string("{\"name\": \"move\", \"arguments\": 2, \"weight\": 0.5, "
+		"\"enabled\": true, \"unknown\": {\"deep\": [1, {\"name\": 3}]}, "
+		"\"params\": [\"x\", {\"name\": \"y\", \"type\": \"location\"}], "
+		"\"tags\": [\"a\", \"b\"], \"goals\": {\"g\": \"K(p)\"}, "
+		"\"children\": [{\"name\": \"child\", \"arguments\": 1.0}]}"), d);
+
+	BOOST_CHECK_EQUAL(d.name, "move");
+	BOOST_CHECK_EQUAL(d.arguments, 2);
+	BOOST_CHECK_EQUAL(d.weight, 0.5);
+	BOOST_CHECK(d.enabled);
+
+	BOOST_REQUIRE_EQUAL(d.params.size(), 2u);
+	BOOST_CHECK_EQUAL(d.params[0].name, "x");
+	BOOST_CHECK(d.params[0].type.empty());
+	BOOST_CHECK_EQUAL(d.params[1].name, "y");
+	BOOST_CHECK_EQUAL(d.params[1].type, "location");
+
+	BOOST_REQUIRE_EQUAL(d.tags.size(), 2u);
+	BOOST_CHECK_EQUAL(d.tags[1], "b");
+	BOOST_CHECK_EQUAL(d.goals["g"], "K(p)");
+
+	BOOST_REQUIRE_EQUAL(d.children.size(), 1u);
+	BOOST_CHECK_EQUAL(d.children[0].name, "child");
+	BOOST_CHECK_EQUAL(d.children[0].arguments, 1);
+}
+
+BOOST_AUTO_TEST_CASE(testBindFile)
+{
+	std::vector<std::string> strings;
+	JSON::Binding<std::vector<std::string> > binding(strings);
+	JSON::Parser parser(binding);
+
+	// strings without escapes are bound straight from the mapped file
+	std::string contents("[\"a\", \"b\\nc\", \"d\"]");
+	char path[] = "/tmp/spoac_JSON_BindingTest_XXXXXX";
+	int fd = mkstemp(path);
+	BOOST_REQUIRE(fd != -1);
+	BOOST_REQUIRE_EQUAL(write(fd, contents.data(), contents.size()), (ssize_t) contents.size());
+	close(fd);
+
+	parser.readFromFile(path);
+	unlink(path);
+
+	BOOST_REQUIRE_EQUAL(strings.size(), 3u);
+	BOOST_CHECK_EQUAL(strings[0], "a");
+	BOOST_CHECK_EQUAL(strings[1], "b\nc");
+	BOOST_CHECK_EQUAL(strings[2], "d");
+}
+
+BOOST_AUTO_TEST_CASE(testErrorPaths)
+{
+	BOOST_CHECK_EQUAL(bindError("[]"), "$");
+	BOOST_CHECK_EQUAL(bindError("{\"name\": 1}"), "$.name");
+	BOOST_CHECK_EQUAL(bindError("{\"arguments\": 1}"), "$");
+	BOOST_CHECK_EQUAL(bindError("{\"name\": \"a\", \"arguments\": 1.5}"), "$.arguments");
+	BOOST_CHECK_EQUAL(bindError("{\"name\": \"a\", \"arguments\": 40000}"), "$.arguments");
+	BOOST_CHECK_EQUAL(bindError("{\"name\": \"a\", \"tags\": [\"x\", null]}"), "$.tags[1]");
+	BOOST_CHECK_EQUAL(bindError("{\"name\": \"a\", \"params\": [\"x\", 3]}"), "$.params[1]");
+	BOOST_CHECK_EQUAL(bindError("{\"name\": \"a\", \"params\": [{\"type\": \"t\"}]}"), "$.params[0]");
+	BOOST_CHECK_EQUAL(bindError("{\"name\": \"a\", \"goals\": {\"g\": []}}"), "$.goals.g");
+	BOOST_CHECK_EQUAL(bindError(
+		"{\"name\": \"a\", \"children\": [{\"name\": \"b\"}, {\"name\": \"c\", \"enabled\": 1}]}"),
+		"$.children[1].enabled");
+
+	BOOST_CHECK_EQUAL(bindError("{\"name\": \"a\", \"unknown\": [1, {}]}"), "");
+}
+
+BOOST_AUTO_TEST_CASE(testErrorMessage)
+{
+	Definition d;
+
+	try
+	{
+		bindDocument(std::string("{\"name\": \"a\", \"tags\": [\"x\", 2]}"), d);
+		BOOST_FAIL("no exception thrown");
+	}
+	catch (const JSON::BindingException& e)
+	{
+		BOOST_CHECK_EQUAL(e.getMessage(),
+			"BindingException ($.tags[1]): ValueException: Cannot convert Value from Number to String");
+	}
+}
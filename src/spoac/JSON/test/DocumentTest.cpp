@@ -0,0 +1,157 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define BOOST_TEST_MODULE spoac_JSON_Document
+#include <spoactest/test.h>
+
+#include <spoac/JSON/Parser.h>
+#include <spoac/JSON/Document.h>
+#include <spoac/JSON/ValueException.h>
+#include <spoac/JSON/Writer.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <unistd.h>
+
+BOOST_AUTO_TEST_CASE(testScalars)
+{
+	JSON::Document document;
+	JSON::Parser parser(document);
+
+	parser.read("[null, true, false, 42, -1.5, \"foo\\n\"]");
+	BOOST_CHECK(!parser.finish());
+
+	const JSON::DocumentArray& array = document.getRoot().toArray();
+
+	BOOST_CHECK_EQUAL(array.size(), 6);
+	BOOST_CHECK(array[0]->isNull());
+	BOOST_CHECK_EQUAL(array[1]->toBool(), true);
+	BOOST_CHECK_EQUAL(array[2]->toBool(), false);
+	BOOST_CHECK_EQUAL(array[3]->toInt(), 42);
+	BOOST_CHECK(array[3]->isExactInt());
+	BOOST_CHECK_EQUAL(array[4]->toDouble(), -1.5);
+	BOOST_CHECK_EQUAL(array[5]->toString(), "foo\n");
+	BOOST_CHECK_EQUAL(array[5]->length(), 4);
+
+	BOOST_CHECK_THROW(array[5]->toInt(), JSON::ValueException);
+	BOOST_CHECK_THROW(array[0]->toObject(), JSON::ValueException);
+}
+
+BOOST_AUTO_TEST_CASE(testNested)
+{
+	JSON::Document document;
+	JSON::Parser parser(document);
+
+	parser.read("{\"name\": \"abc\", predicates: [{\"name\": \"p\", ");
+	parser.read("\"arguments\": 1}, {\"name\": \"q\", \"arguments\": 2}], 3: []}");
+	parser.finish();
+
+	const JSON::DocumentObject& object = document.getRoot().toObject();
+
+	BOOST_CHECK_EQUAL(object.size(), 3);
+	BOOST_CHECK_EQUAL(object["name"]->toString(), "abc");
+	BOOST_CHECK(object["missing"]->isNull());
+	BOOST_CHECK(object.find("missing") == object.end());
+	BOOST_CHECK(object.find(3) != object.end());
+
+	const JSON::DocumentArray& predicates = object["predicates"]->toArray();
+	BOOST_CHECK_EQUAL(predicates.size(), 2);
+
+	int arguments = 0;
+	JSON::DocumentArray::const_iterator it;
+	for (it = predicates.begin(); it != predicates.end(); ++it)
+	{
+		arguments += (*it)->toObject()["arguments"]->toInt();
+	}
+	BOOST_CHECK_EQUAL(arguments, 3);
+
+	// members keep their input order
+	BOOST_CHECK_EQUAL(object.begin()->first->toString(), "name");
+}
+
+BOOST_AUTO_TEST_CASE(testMatchesTreeParser)
+{
+	std::string json("{\"a\": [1, 2.5, \"x\"], \"b\": {\"c\": null, \"d\": true}}");
+
+	JSON::Parser treeParser;
+	treeParser.read(json);
+	JSON::ValuePtr tree = treeParser.finish();
+
+	JSON::Document document;
+	JSON::Parser documentParser(document);
+	documentParser.read(json);
+	documentParser.finish();
+
+	BOOST_CHECK_EQUAL(document.getRoot().toJSON(), tree->toJSON());
+}
+
+BOOST_AUTO_TEST_CASE(testClear)
+{
+	JSON::Document document;
+	JSON::Parser parser(document);
+
+	parser.read("{\"key\": \"value\"}");
+	parser.finish();
+
+	BOOST_CHECK(document.getMemoryUsage() > 0);
+
+	document.clear();
+
+	BOOST_CHECK(document.getRoot().isNull());
+	BOOST_CHECK_EQUAL(document.getMemoryUsage(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testEmit)
+{
+	std::string json("{\"a\": [1, 2.5, \"x\", \"esc\\\"aped\"], 7: {\"c\": null, \"d\": true}, \"e\": {}}");
+
+	JSON::Parser treeParser;
+	treeParser.read(json);
+	std::string expected = treeParser.finish()->toJSON();
+
+	// built values
+	JSON::Document document;
+	JSON::Parser documentParser(document);
+	documentParser.read(json);
+	documentParser.finish();
+
+	std::string emitted;
+	JSON::Writer writer(emitted);
+	document.getRoot().emit(writer);
+
+	BOOST_CHECK_EQUAL(emitted, expected);
+
+	// references into a file
+	char path[] = "/tmp/spoac_json_emit_XXXXXX";
+	close(mkstemp(path));
+	{
+		std::ofstream file(path);
+		file << json;
+	}
+
+	JSON::Document fileDocument;
+	JSON::Parser fileParser(fileDocument);
+	fileParser.readFromFile(path, JSON::FILE_COPY);
+	remove(path);
+
+	emitted.clear();
+	JSON::Writer fileWriter(emitted);
+	fileDocument.getRoot().emit(fileWriter);
+
+	BOOST_CHECK_EQUAL(emitted, expected);
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define BOOST_TEST_MODULE spoac_JSON_Handler
+#include <spoactest/test.h>
+
+#include <spoac/JSON/Parser.h>
+
+#include <sstream>
+
+/**
+* Records all events as a compact string.
+*/
+class RecordingHandler : public JSON::Handler
+{
+public:
+	std::stringstream events;
+
+	void onNull() { events << "null "; }
+	void onBool(bool b) { events << (b ? "true " : "false "); }
+	void onNumber(const JSON::Number& n) { events << "num:" << n.toDouble() << " "; }
+	void onString(const std::string& s) { events << "str:" << s << " "; }
+	void onKey(const std::string& key) { events << "key:" << key << " "; }
+	void onKey(const JSON::Number& key) { events << "numkey:" << key.toInt() << " "; }
+	void onArrayStart() { events << "[ "; }
+	void onArrayEnd() { events << "] "; }
+	void onObjectStart() { events << "{ "; }
+	void onObjectEnd() { events << "} "; }
+};
+
+BOOST_AUTO_TEST_CASE(testEvents)
+{
+	RecordingHandler handler;
+	JSON::Parser parser(handler);
+
+	parser.read("{\"a\": [1, \"b\", null], c: {}, 2: true, 'd': [], e: 1.5}");
+	BOOST_CHECK(!parser.finish());
+
+	BOOST_CHECK_EQUAL(handler.events.str(),
+		"{ key:a [ num:1 str:b null ] key:c { } numkey:2 true key:d [ ] key:e num:1.5 } ");
+}
+
+BOOST_AUTO_TEST_CASE(testChunkedEvents)
+{
+	std::string json("{\"name\": \"value\", \"list\": [10, 20]}");
+
+	RecordingHandler handler;
+	JSON::Parser parser(handler);
+
+	for (size_t i = 0; i < json.size(); ++i)
+	{
+		parser.read(json.c_str() + i, 1);
+	}
+	parser.finish();
+
+	BOOST_CHECK_EQUAL(handler.events.str(),
+		"{ key:name str:value key:list [ num:10 num:20 ] } ");
+}
+
+BOOST_AUTO_TEST_CASE(testParseError)
+{
+	RecordingHandler handler;
+	JSON::Parser parser(handler);
+
+	BOOST_CHECK_THROW(parser.read("[1 2]"), JSON::ParserException);
+}
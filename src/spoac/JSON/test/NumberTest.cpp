@@ -0,0 +1,121 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define BOOST_TEST_MODULE spoac_JSON_Number
+#include <spoactest/test.h>
+
+#include <spoac/JSON/Number.h>
+#include <spoac/JSON/NumberConversion.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+using namespace JSON;
+
+static std::string format(double d)
+{
+	char buffer[NumberConversion::BUFFER_SIZE];
+	return std::string(buffer, NumberConversion::formatDouble(d, buffer));
+}
+
+BOOST_AUTO_TEST_CASE(testParseIntegers)
+{
+	BOOST_CHECK_EQUAL(Number("0").toInt(), 0);
+	BOOST_CHECK_EQUAL(Number("-17").toInt(), -17);
+	BOOST_CHECK_EQUAL(Number("+17").toInt(), 17);
+	BOOST_CHECK_EQUAL(Number("9223372036854775807").toInt(), std::numeric_limits<int64_t>::max());
+	BOOST_CHECK_EQUAL(Number("-9223372036854775808").toInt(), std::numeric_limits<int64_t>::min());
+	BOOST_CHECK(Number("42").isExactInt());
+
+	// too large for 64 bit
+	Number large("12345678901234567890123");
+	BOOST_CHECK(!large.isExactInt());
+	BOOST_CHECK_EQUAL(large.toDouble(), 1.2345678901234568e22);
+	BOOST_CHECK(!Number("9223372036854775808").isExactInt());
+}
+
+BOOST_AUTO_TEST_CASE(testParseDoubles)
+{
+	BOOST_CHECK_EQUAL(Number("0.1").toDouble(), 0.1);
+	BOOST_CHECK_EQUAL(Number("-1.5E-7").toDouble(), -1.5e-7);
+	BOOST_CHECK_EQUAL(Number("1e5").toDouble(), 1e5);
+	BOOST_CHECK_EQUAL(Number(".5").toDouble(), 0.5);
+	BOOST_CHECK_EQUAL(Number("2.5").toInt(), 2);
+	BOOST_CHECK(Number("2.0").isExactInt());
+	BOOST_CHECK(!Number("2.5").isExactInt());
+
+	// beyond the exact fast path
+	BOOST_CHECK_EQUAL(Number("2.2250738585072014e-308").toDouble(), 2.2250738585072014e-308);
+	BOOST_CHECK_EQUAL(Number("0.30000000000000004441").toDouble(), 0.30000000000000004);
+	BOOST_CHECK_EQUAL(Number("123456789012345678901234567890e-10").toDouble(), 1.2345678901234568e19);
+	BOOST_CHECK_EQUAL(Number("1e400").toDouble(), std::numeric_limits<double>::infinity());
+
+	double nan = Number("NaN").toDouble();
+	BOOST_CHECK(nan != nan);
+
+	const char* span = "3.25,";
+	BOOST_CHECK_EQUAL(Number(span, 4).toDouble(), 3.25);
+}
+
+BOOST_AUTO_TEST_CASE(testFormat)
+{
+	BOOST_CHECK_EQUAL(Number(0.23).toJSON(), "0.23");
+	BOOST_CHECK_EQUAL(Number(-17).toJSON(), "-17");
+	BOOST_CHECK_EQUAL(Number(std::numeric_limits<int64_t>::min()).toJSON(), "-9223372036854775808");
+	BOOST_CHECK_EQUAL(format(0.1 + 0.2), "0.30000000000000004");
+	BOOST_CHECK_EQUAL(format(123456.789), "123456.789");
+	BOOST_CHECK_EQUAL(format(1.5e-6), "0.0000015");
+	BOOST_CHECK_EQUAL(format(1.5e-7), "1.5e-7");
+	BOOST_CHECK_EQUAL(format(1e21), "1e21");
+	BOOST_CHECK_EQUAL(format(1e20), "100000000000000000000");
+	BOOST_CHECK_EQUAL(format(5e-324), "5e-324");
+	BOOST_CHECK_EQUAL(format(1.7976931348623157e308), "1.7976931348623157e308");
+	BOOST_CHECK_EQUAL(format(-0.0), "-0");
+	BOOST_CHECK_EQUAL(format(std::numeric_limits<double>::quiet_NaN()), "NaN");
+	BOOST_CHECK_EQUAL(format(-std::numeric_limits<double>::infinity()), "-inf");
+}
+
+BOOST_AUTO_TEST_CASE(testRoundTrip)
+{
+	uint64_t state = 88172645463325252ULL;
+
+	for (int i = 0; i < 100000; ++i)
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+
+		double d;
+		memcpy(&d, &state, sizeof(d));
+
+		if (d != d || d - d != 0)
+		{
+			continue;
+		}
+
+		std::string json = format(d);
+		Number n(json);
+
+		if (n.toDouble() != d)
+		{
+			BOOST_ERROR("round trip failed for " + json);
+		}
+
+		BOOST_CHECK_EQUAL(strtod(json.c_str(), NULL), d);
+	}
+}
@@ -0,0 +1,253 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#define BOOST_TEST_MODULE spoac_JSON_Object
+#include <spoactest/test.h>
+
+#include <spoac/JSON/AllValueTypes.h>
+#include <spoac/JSON/Parser.h>
+#include <spoac/JSON/Document.h>
+
+#include <sstream>
+
+BOOST_AUTO_TEST_CASE(testIdentifierInterning)
+{
+	JSON::Identifier a("name");
+	JSON::Identifier b(std::string("name"));
+	JSON::Identifier c(JSON::String("name"));
+
+	BOOST_CHECK(a == b);
+	BOOST_CHECK(a == c);
+	BOOST_CHECK(a != JSON::Identifier("other"));
+	BOOST_CHECK_EQUAL(a.getType(), JSON::STRING);
+	BOOST_CHECK_EQUAL(a.getString()->toString(), "name");
+
+	// numbers are keys by value
+	JSON::Identifier one(JSON::Number(1));
+	BOOST_CHECK(one == JSON::Identifier(JSON::Number(1.0)));
+	BOOST_CHECK(one != JSON::Identifier(JSON::Number(1.5)));
+	BOOST_CHECK(one != JSON::Identifier("1"));
+	BOOST_CHECK_EQUAL(one.getNumber()->toInt(), 1);
+
+	// ordering still compares the keys themselves
+	BOOST_CHECK(JSON::Identifier("a") < JSON::Identifier("b"));
+	BOOST_CHECK(JSON::Identifier(JSON::Number(2)) < JSON::Identifier(JSON::Number(10)));
+}
+
+BOOST_AUTO_TEST_CASE(testLookupDoesNotIntern)
+{
+	JSON::Object object;
+	object["present"] = JSON::ValuePtr(new JSON::Number(1));
+
+	size_t count = JSON::Identifier::internedCount();
+
+	BOOST_CHECK(object.find("never seen before") == object.end());
+	BOOST_CHECK(object.find(std::string("nor this")) == object.end());
+	object.erase("nor that");
+
+	BOOST_CHECK_EQUAL(JSON::Identifier::internedCount(), count);
+
+	// looked up keys equal interned ones, even those interned later
+	JSON::Identifier later = JSON::Identifier::lookup("interned later");
+	BOOST_CHECK(later == JSON::Identifier::lookup("interned later"));
+	BOOST_CHECK(later == JSON::Identifier("interned later"));
+	BOOST_CHECK(later != JSON::Identifier("other"));
+	BOOST_CHECK(object.find("present") != object.end());
+}
+
+BOOST_AUTO_TEST_CASE(testInternLimit)
+{
+	JSON::Object object;
+
+	// more distinct keys than are ever interned
+	for (size_t i = 0; i < JSON::Identifier::INTERN_LIMIT + 100; i++)
+	{
+		std::ostringstream key;
+		key << "key" << i;
+		object[key.str()] = JSON::ValuePtr(new JSON::Number((int64_t) i));
+	}
+
+	BOOST_CHECK_EQUAL(JSON::Identifier::internedCount(), JSON::Identifier::INTERN_LIMIT);
+
+	// keys past the limit still work as keys
+	std::ostringstream last;
+	last << "key" << JSON::Identifier::INTERN_LIMIT + 99;
+
+	BOOST_CHECK(JSON::Identifier(last.str()) == JSON::Identifier(last.str()));
+	BOOST_REQUIRE(object.find(last.str()) != object.end());
+	BOOST_CHECK_EQUAL(object.find(last.str())->second->toInt(), (int64_t) JSON::Identifier::INTERN_LIMIT + 99);
+	BOOST_CHECK(!object.insert(last.str(), JSON::ValuePtr(new JSON::Null)).second);
+	BOOST_CHECK_EQUAL(object.size(), JSON::Identifier::INTERN_LIMIT + 100);
+}
+
+BOOST_AUTO_TEST_CASE(testInsertionOrder)
+{
+	JSON::Object object;
+	object["z"] = JSON::ValuePtr(new JSON::Number(1));
+	object["a"] = JSON::ValuePtr(new JSON::Number(2));
+	object.insert("m", JSON::ValuePtr(new JSON::Number(3)));
+
+	BOOST_CHECK(!object.insert("z", JSON::ValuePtr(new JSON::Null)).second);
+	BOOST_CHECK_EQUAL(object.size(), 3);
+
+	JSON::Object::const_iterator it = object.begin();
+	BOOST_CHECK_EQUAL(it->first.getString()->toString(), "z");
+	BOOST_CHECK_EQUAL((++it)->first.getString()->toString(), "a");
+	BOOST_CHECK_EQUAL((++it)->first.getString()->toString(), "m");
+
+	object.erase("a");
+	BOOST_CHECK_EQUAL(object.size(), 2);
+	BOOST_CHECK(object.find("a") == object.end());
+	BOOST_CHECK_EQUAL(object["m"]->toInt(), 3);
+
+	BOOST_CHECK_EQUAL(object.toJSON(), "{\n\t\"z\": 1,\n\t\"m\": 3\n}");
+}
+
+BOOST_AUTO_TEST_CASE(testLargeObject)
+{
+	const int count = 1000;
+	JSON::Object object;
+
+	for (int i = 0; i < count; i++)
+	{
+		std::ostringstream key;
+		key << "key" << i;
+		object[key.str()] = JSON::ValuePtr(new JSON::Number(i));
+		object[i] = JSON::ValuePtr(new JSON::Number(-i));
+	}
+
+	BOOST_CHECK_EQUAL(object.size(), 2 * count);
+
+	for (int i = 0; i < count; i += 2)
+	{
+		std::ostringstream key;
+		key << "key" << i;
+		object.erase(key.str());
+	}
+
+	BOOST_CHECK_EQUAL(object.size(), count + count / 2);
+
+	JSON::Object copy(object);
+
+	for (int i = 0; i < count; i++)
+	{
+		std::ostringstream key;
+		key << "key" << i;
+
+		if (i % 2 == 0)
+		{
+			BOOST_CHECK(copy.find(key.str()) == copy.end());
+		}
+		else
+		{
+			BOOST_REQUIRE(copy.find(key.str()) != copy.end());
+			BOOST_CHECK_EQUAL(copy.find(key.str())->second->toInt(), i);
+		}
+
+		BOOST_CHECK_EQUAL(copy[i]->toInt(), -i);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(testPrecomputedKeys)
+{
+	static const JSON::Identifier nameKey("name");
+	static const JSON::Identifier idKey(JSON::Number(7));
+
+	std::string json("{\"name\": \"abc\", \"7\": 1, \"x\": {\"name\": \"def\"}}");
+
+	JSON::Parser parser;
+	parser.read(json);
+	JSON::ValuePtr tree = parser.finish();
+	JSON::Object& object = tree->toObject();
+
+	BOOST_CHECK_EQUAL(object[nameKey]->toString(), "abc");
+	BOOST_CHECK_EQUAL(object["x"]->toObject()[nameKey]->toString(), "def");
+	BOOST_CHECK(object.find(idKey) == object.end());
+
+	JSON::Document document;
+	JSON::Parser documentParser(document);
+	documentParser.read("{\"name\": \"abc\", \"x\": 1}");
+	documentParser.finish();
+
+	const JSON::DocumentObject& root = document.getRoot().toObject();
+	BOOST_CHECK_EQUAL(root[nameKey]->toString(), "abc");
+	BOOST_CHECK(root[JSON::Identifier("missing")]->isNull());
+}
+
+BOOST_AUTO_TEST_CASE(testSwap)
+{
+	JSON::Object a;
+	JSON::Object b;
+
+	// large enough for a to be indexed, which has to move along
+	for (int i = 0; i < 20; ++i)
+	{
+		a.insert(i, JSON::ValuePtr(new JSON::Number(i)));
+	}
+
+	b.insert("only", JSON::ValuePtr(new JSON::Bool(true)));
+	a.swap(b);
+
+	BOOST_CHECK_EQUAL(a.size(), 1u);
+	BOOST_CHECK(a["only"]->toBool());
+	BOOST_REQUIRE_EQUAL(b.size(), 20u);
+	BOOST_CHECK_EQUAL(b[15]->toInt(), 15);
+
+	JSON::Array array;
+	JSON::Array other;
+	array.push_back(JSON::ValuePtr(new JSON::Null));
+	array.swap(other);
+
+	BOOST_CHECK(array.empty());
+	BOOST_CHECK_EQUAL(other.size(), 1u);
+
+	JSON::String s("text");
+	std::string buffer("other text");
+	s.swap(buffer);
+
+	BOOST_CHECK_EQUAL(s.toString(), "other text");
+	BOOST_CHECK_EQUAL(buffer, "text");
+}
+
+#ifndef BOOST_NO_CXX11_VARIADIC_TEMPLATES
+BOOST_AUTO_TEST_CASE(testMoveAndEmplace)
+{
+	JSON::Object object;
+	BOOST_CHECK(object.emplace<JSON::String>("name", "abc").second);
+	BOOST_CHECK(!object.emplace<JSON::String>("name", "def").second);
+	BOOST_CHECK(object.emplace<JSON::Number>("size", (int64_t) 3).second);
+	BOOST_CHECK_EQUAL(object["name"]->toString(), "abc");
+
+	JSON::Object moved(std::move(object));
+	BOOST_CHECK_EQUAL(moved.size(), 2u);
+	BOOST_CHECK_EQUAL(moved["size"]->toInt(), 3);
+
+	JSON::Array array;
+	array.emplace_back<JSON::Bool>(true);
+	array.push_back(JSON::ValuePtr(new JSON::Null));
+
+	JSON::Array other;
+	other = std::move(array);
+	BOOST_REQUIRE_EQUAL(other.size(), 2u);
+	BOOST_CHECK(other[0]->toBool());
+
+	JSON::String s(std::string("moved"));
+	JSON::String t(std::move(s));
+	BOOST_CHECK_EQUAL(t.toString(), "moved");
+}
+#endif
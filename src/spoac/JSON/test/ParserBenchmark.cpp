@@ -0,0 +1,316 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+* Compares the cost of parsing files into a Value tree, into an arena
+* backed Document and through a Handler which only extracts a few fields.
+* It also measures serializing the tree again, encoding it as CBOR with a
+* BinaryWriter and decoding that compared to parsing compact text, and for
+* files, reading them into a Document from disk.
+*
+* Usage: ParserBenchmark [-n iterations] [-s scanner] [-g kilobytes] file...
+*
+* -s selects the Scanner implementation (scalar, sse2, avx2 or auto) and
+* -g additionally benchmarks a generated action config of the given size.
+*
+* For example on the LTM fixtures:
+*   ParserBenchmark -n 10000 \
+*       $(find src/spoac/ltm/test/cognition/memory/ltm_db -name '*.json')
+*
+* or on a large generated config with each scanner:
+*   ParserBenchmark -n 20 -g 4096 -s scalar
+*   ParserBenchmark -n 20 -g 4096 -s avx2
+*/
+
+#include <spoac/JSON/BinaryReader.h>
+#include <spoac/JSON/Codec.h>
+#include <spoac/JSON/Parser.h>
+#include <spoac/JSON/Document.h>
+#include <spoac/JSON/Scanner.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <sys/time.h>
+
+/**
+* Extracts the fields LTM::getAction needs and skips everything else.
+*/
+class FieldHandler : public JSON::Handler
+{
+public:
+	FieldHandler() : depth(0), inParams(false) {}
+
+	void onNull() {}
+	void onBool(bool b) {}
+	void onNumber(const JSON::Number& n) {}
+
+	void onString(const std::string& s)
+	{
+		if (depth == 1 && (key == "name" || key == "precondition" || key == "effect"))
+		{
+			fields.push_back(s);
+		}
+		else if (depth == 2 && inParams)
+		{
+			fields.push_back(s);
+		}
+	}
+
+	void onKey(const std::string& k) { if (depth == 1) key = k; }
+	void onKey(const JSON::Number& k) { if (depth == 1) key.clear(); }
+	void onArrayStart() { inParams = (depth == 1 && key == "params"); depth++; }
+	void onArrayEnd() { depth--; if (depth == 1) inParams = false; }
+	void onObjectStart() { depth++; }
+	void onObjectEnd() { depth--; }
+
+	std::vector<std::string> fields;
+private:
+	std::string key;
+	int depth;
+	bool inParams;
+};
+
+static double now()
+{
+	timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void report(const std::string& mode, double seconds, size_t iterations, size_t bytes)
+{
+	std::cout << std::setw(10) << mode
+		<< std::setw(12) << std::fixed << std::setprecision(3)
+		<< (seconds * 1e6 / iterations) << " us/doc"
+		<< std::setw(12) << std::setprecision(2)
+		<< (bytes * (double) iterations / seconds / (1024 * 1024)) << " MB/s"
+		<< std::endl;
+}
+
+/**
+* Generates a pretty printed action config of roughly the given size with
+* long descriptions, many parameters and numeric tables.
+*/
+static std::string generateConfig(size_t bytes)
+{
+	std::stringstream ss;
+	ss << "{\n    \"actions\": [\n";
+
+	for (size_t n = 0; (size_t) ss.tellp() < bytes; ++n)
+	{
+		ss << (n ? ",\n" : "")
+			<< "        {\n"
+			<< "            \"name\": \"action_" << n << "\",\n"
+			<< "            \"description\": \"Moves the end effector along a precomputed trajectory "
+			<< "while keeping the grasped object level, retries up to three times.\",\n"
+			<< "            \"params\": [\"object_" << n << "\", \"location_" << n << "\", \"hand\"],\n"
+			<< "            \"timeout\": " << (1000 + n) << ",\n"
+			<< "            \"trajectory\": [";
+
+		for (int k = 0; k < 16; ++k)
+		{
+			ss << (k ? ", " : "") << (n * 16 + k) * 0.123456789;
+		}
+
+		ss << "]\n        }";
+	}
+
+	ss << "\n    ]\n}\n";
+	return ss.str();
+}
+
+static void benchmark(const std::string& name, const std::string& data, size_t iterations, bool isFile)
+{
+	std::cout << name << " (" << data.size() << " bytes, "
+		<< iterations << " iterations, "
+		<< JSON::Scanner::getImplementationName(JSON::Scanner::getImplementation())
+		<< " scanner)" << std::endl;
+
+	double start = now();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		JSON::Parser parser;
+		parser.read(data);
+		parser.finish();
+	}
+	report("tree", now() - start, iterations, data.size());
+
+	start = now();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		JSON::Document document;
+		JSON::Parser parser(document);
+		parser.read(data);
+		parser.finish();
+	}
+	report("document", now() - start, iterations, data.size());
+
+	start = now();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		FieldHandler handler;
+		JSON::Parser parser(handler);
+		parser.read(data);
+		parser.finish();
+	}
+	report("handler", now() - start, iterations, data.size());
+
+	JSON::Parser parser;
+	parser.read(data);
+	JSON::ValuePtr value = parser.finish();
+
+	start = now();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		value->toJSON();
+	}
+	report("toJSON", now() - start, iterations, data.size());
+
+	std::string compact = JSON::Codec::encode(*value, JSON::CODEC_TEXT);
+	std::string binary = JSON::Codec::encode(*value, JSON::CODEC_BINARY);
+	std::cout << std::setw(10) << "size" << std::setw(12) << compact.size()
+		<< " compact" << std::setw(12) << binary.size() << " binary" << std::endl;
+
+	start = now();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		std::string encoded;
+		JSON::Codec::encode(*value, JSON::CODEC_BINARY, encoded);
+	}
+	report("toBinary", now() - start, iterations, binary.size());
+
+	start = now();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		JSON::Parser parser;
+		parser.read(compact);
+		parser.finish();
+	}
+	report("compact", now() - start, iterations, compact.size());
+
+	start = now();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		JSON::BinaryReader reader;
+		reader.read(binary);
+	}
+	report("binary", now() - start, iterations, binary.size());
+
+	start = now();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		JSON::Document document;
+		JSON::Parser parser(document);
+		parser.read(compact);
+		parser.finish();
+	}
+	report("compactDoc", now() - start, iterations, compact.size());
+
+	start = now();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		JSON::Document document;
+		JSON::BinaryReader reader(document);
+		reader.read(binary);
+	}
+	report("binaryDoc", now() - start, iterations, binary.size());
+
+	if (!isFile)
+	{
+		return;
+	}
+
+	start = now();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		JSON::Document document;
+		JSON::Parser parser(document);
+		parser.readFromFile(name);
+	}
+	report("file", now() - start, iterations, data.size());
+}
+
+int main(int argc, char* argv[])
+{
+	size_t iterations = 1000;
+	size_t generate = 0;
+	std::vector<std::string> files;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+		{
+			iterations = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc)
+		{
+			generate = atoi(argv[++i]) * 1024;
+		}
+		else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+		{
+			const char* name = argv[++i];
+			bool found = false;
+
+			for (int impl = JSON::SCANNER_AUTO; impl <= JSON::SCANNER_AVX2; ++impl)
+			{
+				JSON::ScannerImplementation implementation = (JSON::ScannerImplementation) impl;
+
+				if (strcmp(name, JSON::Scanner::getImplementationName(implementation)) == 0)
+				{
+					found = JSON::Scanner::setImplementation(implementation);
+				}
+			}
+
+			if (!found)
+			{
+				std::cerr << "Scanner " << name << " is not available" << std::endl;
+				return 1;
+			}
+		}
+		else
+		{
+			files.push_back(argv[i]);
+		}
+	}
+
+	if (files.empty() && !generate)
+	{
+		std::cerr << "Usage: " << argv[0] << " [-n iterations] [-s scanner] [-g kilobytes] file..." << std::endl;
+		return 1;
+	}
+
+	if (generate)
+	{
+		benchmark("generated", generateConfig(generate), iterations, false);
+	}
+
+	for (std::vector<std::string>::const_iterator file = files.begin(); file != files.end(); ++file)
+	{
+		std::ifstream in(file->c_str());
+		std::stringstream ss;
+		ss << in.rdbuf();
+
+		benchmark(*file, ss.str(), iterations, true);
+	}
+
+	return 0;
+}
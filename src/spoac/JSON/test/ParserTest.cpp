@@ -0,0 +1,145 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define BOOST_TEST_MODULE spoac_JSON_Parser
+#include <spoactest/test.h>
+
+#include <spoac/JSON/Parser.h>
+#include <spoac/JSON/Document.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+using namespace JSON;
+
+/**
+* Writes the given contents to a temporary file which is removed again on
+* destruction.
+*/
+class TemporaryFile
+{
+public:
+	TemporaryFile(const std::string& contents)
+	{
+		char name[] = "/tmp/spoac_JSON_ParserTest_XXXXXX";
+		int fd = mkstemp(name);
+		BOOST_REQUIRE(fd != -1);
+		BOOST_REQUIRE_EQUAL(write(fd, contents.data(), contents.size()), (ssize_t) contents.size());
+		close(fd);
+		path = name;
+	}
+
+	~TemporaryFile()
+	{
+		unlink(path.c_str());
+	}
+
+	std::string path;
+};
+
+BOOST_AUTO_TEST_CASE(testReadFromFileKeepsLineBreaks)
+{
+	TemporaryFile file("{\n\t\"text\": \"first\nsecond\",\n\t\"number\": 1\n}\n");
+
+	Parser parser;
+	ValuePtr value = parser.readFromFile(file.path);
+
+	BOOST_CHECK_EQUAL(value->toObject()["text"]->toString(), "first\nsecond");
+	BOOST_CHECK_EQUAL(value->toObject()["number"]->toInt(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(testReadFromFileReportsLineNumbers)
+{
+	TemporaryFile file("{\n\t\"a\": 1,\n\t\"b\": \"x\ny\",\n\t\"c\": nul\n}\n");
+
+	Parser parser;
+
+	try
+	{
+		parser.readFromFile(file.path);
+		BOOST_FAIL("Expected ParserException");
+	}
+	catch (ParserException& e)
+	{
+		BOOST_CHECK_EQUAL(e.getLineNumber(), (size_t) 5);
+	}
+
+	BOOST_CHECK_THROW(parser.readFromFile(file.path + ".missing"), ParserException);
+}
+
+BOOST_AUTO_TEST_CASE(testDocumentReferencesFile)
+{
+	Document document;
+
+	{
+		TemporaryFile file("{\"plain\": \"value\", \"escaped\": \"a\\tb\", 'single': 'it\\'s'}");
+		Parser parser(document);
+		parser.readFromFile(file.path);
+	}
+
+	// the document keeps the contents after the file and parser are gone
+	const DocumentObject& object = document.getRoot().toObject();
+	BOOST_REQUIRE_EQUAL(object.size(), (size_t) 3);
+	BOOST_CHECK_EQUAL(object.begin()->first->toString(), "plain");
+	BOOST_CHECK_EQUAL(object["plain"]->toString(), "value");
+	BOOST_CHECK_EQUAL(object["plain"]->length(), (size_t) 5);
+	BOOST_CHECK_EQUAL(object["escaped"]->toString(), "a\tb");
+	BOOST_CHECK_EQUAL(object["single"]->toString(), "it's");
+
+	document.clear();
+	BOOST_CHECK(document.getRoot().isNull());
+}
+
+BOOST_AUTO_TEST_CASE(testDocumentKeepsSource)
+{
+	TemporaryFile file(
+		"{\n"
+		"\t\"action\": \"Grasp\",\n"
+		"\t\"config\": {\"speed\": 0.5, \"hands\" : [ 1, 2 ]},\n"
+		"\t\"count\": 12e1,\n"
+		"\t\"flags\": [true, null]\n"
+		"}");
+
+	Document document;
+	Parser parser(document);
+	parser.readFromFile(file.path);
+
+	const DocumentObject& object = document.getRoot().toObject();
+
+	// subtrees can be passed on in their original form
+	BOOST_CHECK_EQUAL(object["config"]->toRawJSON(), "{\"speed\": 0.5, \"hands\" : [ 1, 2 ]}");
+	BOOST_CHECK_EQUAL(object["action"]->toRawJSON(), "\"Grasp\"");
+	BOOST_CHECK_EQUAL(object["flags"]->toArray()[0]->toRawJSON(), "true");
+	BOOST_CHECK_EQUAL(object["flags"]->toArray()[1]->toRawJSON(), "null");
+	BOOST_CHECK_EQUAL(object["config"]->getSourceLength(), (size_t) 34);
+
+	// numbers are kept as text until they are accessed
+	BOOST_CHECK_EQUAL(object["count"]->toRawJSON(), "12e1");
+	BOOST_CHECK_EQUAL(object["count"]->toInt(), 120);
+	BOOST_CHECK(object["count"]->isExactInt());
+	BOOST_CHECK_EQUAL(object["config"]->toObject()["speed"]->toDouble(), 0.5);
+
+	// values not read from a file are written compactly instead
+	Document parsed;
+	Parser stringParser(parsed);
+	stringParser.read("{\"a\": [1, 2]}");
+	stringParser.finish();
+	BOOST_CHECK(parsed.getRoot().getSource() == NULL);
+	BOOST_CHECK_EQUAL(parsed.getRoot().toRawJSON(), "{\"a\":[1,2]}");
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define BOOST_TEST_MODULE spoac_JSON_Record
+#include <spoactest/test.h>
+
+#include <spoac/JSON/Parser.h>
+#include <spoac/JSON/RecordReader.h>
+#include <spoac/JSON/RecordWriter.h>
+
+#include <sstream>
+#include <vector>
+
+using namespace JSON;
+
+static ValuePtr parse(const std::string& json)
+{
+	Parser parser;
+	parser.read(json);
+	return parser.finish();
+}
+
+static std::vector<std::string> readAll(const std::string& lines)
+{
+	std::istringstream in(lines);
+	RecordReader reader(in);
+	std::vector<std::string> records;
+
+	while (reader.next())
+	{
+		records.push_back(reader.getRecord()->toJSON());
+	}
+
+	return records;
+}
+
+BOOST_AUTO_TEST_CASE(testRoundTrip)
+{
+	const char* samples[] = {
+		"{\"id\": \"cup\", \"position\": [0.5, -1, 2e10], \"open\": true}",
+		"[\"line\\nbreak\", {}, [], null]",
+		"42",
+		"\"text\"",
+	};
+	size_t count = sizeof(samples) / sizeof(samples[0]);
+
+	std::ostringstream out;
+	{
+		RecordWriter writer(out);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			writer.write(*parse(samples[i]));
+		}
+	}
+
+	BOOST_CHECK_EQUAL(out.str().substr(0, out.str().find('\n')),
+		"{\"id\":\"cup\",\"position\":[0.5,-1,20000000000],\"open\":true}");
+
+	std::vector<std::string> records = readAll(out.str());
+
+	BOOST_REQUIRE_EQUAL(records.size(), count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		BOOST_CHECK_EQUAL(records[i], parse(samples[i])->toJSON());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(testLines)
+{
+	// blank lines, carriage returns and an unterminated last record
+	std::vector<std::string> records = readAll("\n  \n1\r\n\t[2]\n\r\n{\"a\": 3}");
+
+	BOOST_REQUIRE_EQUAL(records.size(), 3u);
+	BOOST_CHECK_EQUAL(records[0], "1");
+	BOOST_CHECK_EQUAL(records[1], parse("[2]")->toJSON());
+	BOOST_CHECK_EQUAL(records[2], parse("{\"a\": 3}")->toJSON());
+
+	BOOST_CHECK(readAll("").empty());
+	BOOST_CHECK(readAll("\n\n").empty());
+}
+
+BOOST_AUTO_TEST_CASE(testLongRecords)
+{
+	// records spanning several blocks of the reader
+	std::string text(200000, 'x');
+	std::string lines;
+
+	for (size_t i = 0; i < 3; ++i)
+	{
+		lines += "{\"text\": \"" + text + "\", \"n\": 123456}\n";
+	}
+
+	std::istringstream in(lines);
+	RecordReader reader(in);
+	size_t count = 0;
+
+	while (reader.next())
+	{
+		BOOST_CHECK_EQUAL(reader.getLineNumber(), count + 1);
+		BOOST_CHECK_EQUAL(reader.getRecord()->toObject()["text"]->toString(), text);
+		BOOST_CHECK_EQUAL(reader.getRecord()->toObject()["n"]->toInt(), 123456);
+		count++;
+	}
+
+	BOOST_CHECK_EQUAL(count, 3u);
+}
+
+BOOST_AUTO_TEST_CASE(testErrors)
+{
+	std::istringstream in("[1]\n\n{\"a\": ]\n[2]\n[3, \n[4]\n");
+	RecordReader reader(in);
+
+	BOOST_REQUIRE(reader.next());
+	BOOST_CHECK_EQUAL(reader.getLineNumber(), 1u);
+
+	try
+	{
+		reader.next();
+		BOOST_FAIL("Expected ParserException");
+	}
+	catch (const ParserException& e)
+	{
+		BOOST_CHECK_EQUAL(e.getLineNumber(), 3u);
+	}
+
+	// reading continues after the broken record
+	BOOST_REQUIRE(reader.next());
+	BOOST_CHECK_EQUAL(reader.getLineNumber(), 4u);
+	BOOST_CHECK_EQUAL(reader.getRecord()->toArray()[0]->toInt(), 2);
+
+	try
+	{
+		reader.next();
+		BOOST_FAIL("Expected ParserException");
+	}
+	catch (const ParserException& e)
+	{
+		BOOST_CHECK_EQUAL(e.getLineNumber(), 5u);
+	}
+
+	BOOST_REQUIRE(reader.next());
+	BOOST_CHECK_EQUAL(reader.getLineNumber(), 6u);
+	BOOST_CHECK(!reader.next());
+}
+
+BOOST_AUTO_TEST_CASE(testHandler)
+{
+	// records are reformatted by passing their events to a writer
+	std::string json;
+	Writer writer(json, WRITER_COMPACT);
+	std::istringstream in("{\"a\": [1, 2]}\n[true]\n");
+	RecordReader reader(in, writer);
+
+	BOOST_REQUIRE(reader.next());
+	BOOST_CHECK(!reader.getRecord());
+	BOOST_CHECK_EQUAL(json, "{\"a\":[1,2]}");
+
+	writer.clear();
+	BOOST_REQUIRE(reader.next());
+	BOOST_CHECK_EQUAL(json, "[true]");
+	BOOST_CHECK(!reader.next());
+}
+
+BOOST_AUTO_TEST_CASE(testWriteJSON)
+{
+	std::ostringstream out;
+	RecordWriter writer(out);
+
+	writer.writeJSON("{\n\t\"a\": [\n\t\t1,\n\t\t2\n\t]\n}");
+
+	BOOST_CHECK_THROW(writer.writeJSON("{\"b\": [1, "), ParserException);
+
+	writer.beginRecord().onNull();
+	writer.endRecord();
+
+	// records stay buffered until flushed
+	BOOST_CHECK(out.str().empty());
+
+	writer.flush();
+	BOOST_CHECK_EQUAL(out.str(), "{\"a\":[1,2]}\nnull\n");
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define BOOST_TEST_MODULE spoac_JSON_Scanner
+#include <spoactest/test.h>
+
+#include <spoac/JSON/Parser.h>
+#include <spoac/JSON/Scanner.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace JSON;
+
+static std::vector<ScannerImplementation> supportedImplementations()
+{
+	std::vector<ScannerImplementation> implementations;
+	implementations.push_back(SCANNER_SCALAR);
+
+	if (Scanner::isSupported(SCANNER_SSE2))
+	{
+		implementations.push_back(SCANNER_SSE2);
+	}
+
+	if (Scanner::isSupported(SCANNER_AVX2))
+	{
+		implementations.push_back(SCANNER_AVX2);
+	}
+
+	return implementations;
+}
+
+BOOST_AUTO_TEST_CASE(testRunsStopAtEveryPosition)
+{
+	std::vector<ScannerImplementation> implementations = supportedImplementations();
+	const char stops[] = { '"', '\'', '\\', '\n', '\r', '\t', 'x', '5', (char) 0xC3 };
+
+	for (size_t impl = 0; impl < implementations.size(); ++impl)
+	{
+		BOOST_REQUIRE(Scanner::setImplementation(implementations[impl]));
+
+		for (size_t len = 0; len < 80; ++len)
+		{
+			for (size_t pos = 0; pos <= len; ++pos)
+			{
+				for (size_t s = 0; s < sizeof(stops); ++s)
+				{
+					std::string text(len, 'a');
+					std::string blanks(len, ' ');
+					std::string digits(len, '7');
+
+					if (pos < len)
+					{
+						text[pos] = stops[s];
+						blanks[pos] = stops[s];
+						digits[pos] = stops[s];
+					}
+
+					bool textStop = (pos < len) && stops[s] != '\'' && stops[s] != '\t' && stops[s] != 'x' && stops[s] != '5' && stops[s] != (char) 0xC3;
+					bool blankStop = (pos < len) && stops[s] != '\t';
+					bool digitStop = (pos < len) && stops[s] != '5';
+
+					BOOST_CHECK_EQUAL(Scanner::stringRun(text.data(), len, '"'), textStop ? pos : len);
+					BOOST_CHECK_EQUAL(Scanner::blankRun(blanks.data(), len), blankStop ? pos : len);
+					BOOST_CHECK_EQUAL(Scanner::digitRun(digits.data(), len), digitStop ? pos : len);
+				}
+			}
+		}
+	}
+
+	Scanner::setImplementation(SCANNER_AUTO);
+}
+
+BOOST_AUTO_TEST_CASE(testParseWithEveryImplementation)
+{
+	std::vector<ScannerImplementation> implementations = supportedImplementations();
+	std::string json =
+		"{\n"
+		"    \"name\": \"a rather long string value which spans several blocks\",\n"
+		"    'single': 'it\\'s \\\"quoted\\\" and \\u00e4scaped',\n"
+		"    \"numbers\": [12345678901234567, 3.14159265358979, 1234e-12, -0.5],\n"
+		"    \"multi\": \"line\nbreak\"\n"
+		"}\n";
+	std::string expected;
+
+	for (size_t impl = 0; impl < implementations.size(); ++impl)
+	{
+		BOOST_REQUIRE(Scanner::setImplementation(implementations[impl]));
+
+		// feed the input in every chunk size so runs cross chunk boundaries
+		for (size_t chunk = 1; chunk <= json.size(); chunk += 3)
+		{
+			Parser parser;
+
+			for (size_t i = 0; i < json.size(); i += chunk)
+			{
+				parser.read(json.data() + i, std::min(chunk, json.size() - i));
+			}
+
+			std::string result = parser.finish()->toJSON();
+
+			if (expected.empty())
+			{
+				expected = result;
+			}
+
+			BOOST_CHECK_EQUAL(result, expected);
+		}
+
+		Parser parser;
+		std::string broken = json;
+		broken.replace(broken.find("-0.5"), 4, "-0.x");
+
+		try
+		{
+			parser.read(broken);
+			BOOST_FAIL("Expected ParserException");
+		}
+		catch (ParserException& e)
+		{
+			BOOST_CHECK_EQUAL(e.getLineNumber(), (size_t) 4);
+		}
+	}
+
+	Scanner::setImplementation(SCANNER_AUTO);
+}
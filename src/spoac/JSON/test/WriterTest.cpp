@@ -0,0 +1,119 @@
+/*
+ * Copyright 2008 Nils Adermann
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define BOOST_TEST_MODULE spoac_JSON_Writer
+#include <spoactest/test.h>
+
+#include <spoac/JSON/Parser.h>
+#include <spoac/JSON/Document.h>
+#include <spoac/JSON/Writer.h>
+
+#include <sstream>
+
+using namespace JSON;
+
+static const char* input =
+	"{\"name\": \"a \\\"quoted\\\" name\", \"list\": [1, 2.5, true, null, [], {}],"
+	" \"nested\": {\"x\": -3, \"y\": [\"a\\nb\"]}}";
+
+static ValuePtr parse(const std::string& json)
+{
+	Parser parser;
+	parser.read(json);
+	return parser.finish();
+}
+
+BOOST_AUTO_TEST_CASE(testPretty)
+{
+	std::string json;
+	Writer writer(json);
+	writer.write(*parse(input));
+
+	BOOST_CHECK_EQUAL(json,
+		"{\n"
+		"\t\"name\": \"a \\\"quoted\\\" name\",\n"
+		"\t\"list\": [\n"
+		"\t\t1,\n"
+		"\t\t2.5,\n"
+		"\t\ttrue,\n"
+		"\t\tnull,\n"
+		"\t\t[],\n"
+		"\t\t{}\n"
+		"\t],\n"
+		"\t\"nested\": {\n"
+		"\t\t\"x\": -3,\n"
+		"\t\t\"y\": [\n"
+		"\t\t\t\"a\\nb\"\n"
+		"\t\t]\n"
+		"\t}\n"
+		"}");
+	BOOST_CHECK_EQUAL(json, parse(input)->toJSON());
+}
+
+BOOST_AUTO_TEST_CASE(testCompact)
+{
+	Writer writer(WRITER_COMPACT);
+	writer.write(*parse(input));
+
+	BOOST_CHECK_EQUAL(writer.getBuffer(),
+		"{\"name\":\"a \\\"quoted\\\" name\",\"list\":[1,2.5,true,null,[],{}],"
+		"\"nested\":{\"x\":-3,\"y\":[\"a\\nb\"]}}");
+
+	// the buffer can be reused
+	writer.clear();
+	writer.write(*parse("[1, {\"a\": []}]"));
+	BOOST_CHECK_EQUAL(writer.getBuffer(), "[1,{\"a\":[]}]");
+}
+
+BOOST_AUTO_TEST_CASE(testIndent)
+{
+	std::string json("\t\"value\": ");
+	parse("[1, 2]")->_toJSON(json, "\t");
+
+	BOOST_CHECK_EQUAL(json, "\t\"value\": [\n\t\t1,\n\t\t2\n\t]");
+}
+
+BOOST_AUTO_TEST_CASE(testDocument)
+{
+	Document document;
+	Parser parser(document);
+	parser.read(input);
+	parser.finish();
+
+	// documents keep the input order of members
+	Writer writer(WRITER_COMPACT);
+	writer.write(document.getRoot());
+
+	BOOST_CHECK_EQUAL(writer.getBuffer(),
+		"{\"name\":\"a \\\"quoted\\\" name\",\"list\":[1,2.5,true,null,[],{}],"
+		"\"nested\":{\"x\":-3,\"y\":[\"a\\nb\"]}}");
+}
+
+BOOST_AUTO_TEST_CASE(testStreamFromParser)
+{
+	std::stringstream out;
+
+	{
+		// reformat without building any values
+		Writer writer(out, WRITER_COMPACT);
+		Parser parser(writer);
+		parser.read("[ 1, 'two', { 3: 4 } ]");
+		parser.finish();
+	}
+
+	BOOST_CHECK_EQUAL(out.str(), "[1,\"two\",{3:4}]");
+}
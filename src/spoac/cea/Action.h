@@ -57,7 +57,9 @@ namespace spoac
         * Prepares an action for execution with a vector of parameter objects.
         *
         * @param objects The objects this action should be applied on.
-        * @param config  A JSON configuration object retrieved from LTM.
+        * @param config  A JSON configuration object retrieved from LTM. It
+        *                is shared with other actions of the same OAC and
+        *                must not be modified.
         */
         virtual void setup(
             const ObjectVector& objects,
@@ -22,7 +22,7 @@
 */
 
 #include <spoac/cea/CEA.h>
-#include <spoac/LTM.h>
+#include <spoac/stm/LTMClient.h>
 
 using namespace spoac;
 
@@ -222,10 +222,7 @@ void CEA::setScenario(const std::string& scenario)
 {
     if (DependencyManagerPtr manager = weakDependencyManager.lock())
     {
-        ice::IceHelperPtr iceHelper = manager->getService<ice::IceHelper>();
-
-        LTMSlice::LTMPrx ltm =
-            iceHelper->getProxy<LTMSlice::LTMPrx>("LTM:tcp -p 10099");
+        LTMSlice::LTMPrx ltm = manager->getService<LTMClient>()->getProxy();
         LTMSlice::Scenario s = ltm->getScenario(scenario);
 
         setActivityControllers(s.activityControllers, manager);
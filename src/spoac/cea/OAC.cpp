@@ -23,9 +23,7 @@
 
 #include <spoac/cea/OAC.h>
 #include <spoac/cea/ActionException.h>
-#include <spoac/ice/IceHelper.h>
-#include <spoac/LTM.h>
-#include <spoac/JSON/Parser.h>
+#include <spoac/stm/LTMClient.h>
 
 using namespace spoac;
 
@@ -47,45 +45,25 @@ std::vector<std::string> OAC::getObjectIds() const
 ActionPtr OAC::setupAction(DependencyManagerPtr manager) const
 {
     STMPtr stm = manager->getService<STM>();
-    ice::IceHelperPtr iceHelper = manager->getService<ice::IceHelper>();
+    LTMClientPtr ltm = manager->getService<LTMClient>();
 
     ObjectVector objects = stm->vectorFromIds(getObjectIds());
 
-    LTMSlice::LTMPrx ltm =
-        iceHelper->getProxy<LTMSlice::LTMPrx>("LTM:tcp -p 10099");
+    // repeated setups with unchanged objects are answered by the client
+    LTMClient::ActionConfigPtr actionConfig =
+        ltm->getActionConfig(getName(), objects);
 
-    LTMSlice::OAC oac;
-    oac.name = getName();
-
-    std::vector<ObjectPtr> objectVec = objects.getVector();
-    std::vector<ObjectPtr> ::const_iterator it;
-    for (it = objectVec.begin(); it != objectVec.end(); ++it)
-    {
-        oac.objects.push_back((*it)->toLTMObj());
-    }
-
-    LTMSlice::ActionConfig actionConfig = ltm->getActionConfig(oac);
-
-    ActionPtr action = Action::fromName(actionConfig.name, manager);
+    ActionPtr action = Action::fromName(actionConfig->name, manager);
 
     if (action.get() == NULL)
     {
         throw ActionException(
             std::string("Cannot create unregistered action: '") +
-            actionConfig.name + std::string("'")
+            actionConfig->name + std::string("'")
         );
     }
 
-    JSON::ValuePtr jsonConfig;
-
-    if (!actionConfig.config.empty())
-    {
-        JSON::Parser jsonParser;
-        jsonParser.read(actionConfig.config);
-        jsonConfig = jsonParser.finish();
-    }
-
-    action->setup(objects, jsonConfig);
+    action->setup(objects, actionConfig->config);
 
     return action;
 }
@@ -27,6 +27,9 @@ using namespace spoac;
 
 SuperAction::Register<SuperAction> SuperAction::r;
 
+static const JSON::Identifier nameKey("name");
+static const JSON::Identifier paramsKey("params");
+
 SuperAction::SuperAction(CEAControlWeakPtr cea) :
     yielded(false),
     weakCEA(cea)
@@ -58,9 +61,9 @@ void SuperAction::setup(
         }
 
         JSON::Object& object = (*it)->toObject();
-        oacName = object["name"]->toString();
+        oacName = object[nameKey]->toString();
         oacObjIds.clear();
-        oacParams = object["params"];
+        oacParams = object[paramsKey];
 
         if (oacParams->getType() != JSON::ARRAY)
         {
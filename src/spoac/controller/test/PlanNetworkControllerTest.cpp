@@ -103,8 +103,9 @@ BOOST_AUTO_TEST_CASE(testEmpty)
     boost::shared_ptr<spoactest::CountingCEA> cea(new spoactest::CountingCEA);
     spoac::ice::IceHelperPtr iceHelper(new spoac::ice::IceHelper);
     spoac::STMPtr stm(new spoac::STM);
+    spoac::LTMClientPtr ltmClient(new spoac::LTMClient(iceHelper));
     spoac::PKSServicePtr pks(new spoac::PKSService(
-        stm, iceHelper));
+        stm, iceHelper, ltmClient));
 
     PlanNetworkControllerPtr controller(
         new PlanNetworkController(
@@ -0,0 +1,284 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#include <spoac/ltm/Catalog.h>
+
+#include <iostream>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <IceUtil/Time.h>
+
+using namespace spoac;
+namespace fs = boost::filesystem;
+
+// events which add files to or remove them from the catalog
+static const uint32_t structureEvents = IN_CREATE | IN_DELETE |
+    IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+// events which only change the contents of a file
+static const uint32_t watchedEvents = structureEvents | IN_CLOSE_WRITE;
+
+Catalog::Catalog(const fs::path& root, const IceUtil::Time& missInterval) :
+    root(root),
+    inotify(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+    watching(inotify != -1),
+    stale(true),
+    generation(0),
+    missInterval(missInterval)
+{
+}
+
+Catalog::~Catalog()
+{
+    if (inotify != -1)
+    {
+        close(inotify);
+    }
+}
+
+bool Catalog::find(
+    const std::string& dir,
+    const std::string& fileName,
+    fs::path& path)
+{
+    IceUtil::Mutex::Lock lock(mutex);
+
+    if (changed() || stale)
+    {
+        build();
+    }
+
+    if (lookup(dir, fileName, path))
+    {
+        return true;
+    }
+
+    // the file may have been added without an event, which is checked
+    // at most once per interval
+    if (IceUtil::Time::now() - lastBuild < missInterval)
+    {
+        return false;
+    }
+
+    build();
+
+    return lookup(dir, fileName, path);
+}
+
+bool Catalog::findIndexed(
+    const std::string& dir,
+    const std::string& fileName,
+    fs::path& path)
+{
+    IceUtil::Mutex::Lock lock(mutex);
+
+    // the events are consumed, the next find() has to rebuild
+    if (changed())
+    {
+        stale = true;
+    }
+
+    return !stale && lookup(dir, fileName, path);
+}
+
+Catalog::FileMap Catalog::getFiles()
+{
+    IceUtil::Mutex::Lock lock(mutex);
+
+    if (changed() || stale)
+    {
+        build();
+    }
+
+    return files;
+}
+
+uint64_t Catalog::getGeneration()
+{
+    IceUtil::Mutex::Lock lock(mutex);
+
+    // changes are only noticed in directories which are watched
+    if (changed() || stale)
+    {
+        build();
+    }
+
+    return generation;
+}
+
+bool Catalog::isWatching()
+{
+    IceUtil::Mutex::Lock lock(mutex);
+
+    if (changed() || stale)
+    {
+        build();
+    }
+
+    return watching;
+}
+
+size_t Catalog::size()
+{
+    IceUtil::Mutex::Lock lock(mutex);
+
+    if (changed() || stale)
+    {
+        build();
+    }
+
+    return files.size();
+}
+
+const fs::path& Catalog::getRoot() const
+{
+    return root;
+}
+
+void Catalog::build()
+{
+    IceUtil::Time start = IceUtil::Time::now();
+    bool first = (lastBuild == IceUtil::Time());
+    size_t previousSize = files.size();
+
+    files.clear();
+    stale = false;
+    watching = (inotify != -1);
+
+    // directories which are already watched keep their watch, those of
+    // removed directories are dropped by the kernel
+    watch(root);
+
+    if (fs::exists(root))
+    {
+        fs::directory_iterator endItr;
+
+        for (fs::directory_iterator itr(root); itr != endItr; ++itr)
+        {
+            if (fs::is_directory(itr->status()))
+            {
+                addDirectory(itr->path(), itr->leaf());
+            }
+        }
+    }
+
+    lastBuild = IceUtil::Time::now();
+
+    // rebuilds are frequent, only those which add or remove files are
+    // logged
+    if (first || files.size() != previousSize)
+    {
+        std::cout << "Catalog of " << root.string() << ": " << files.size() <<
+            " files in " << (lastBuild - start).toMilliSecondsDouble() <<
+            " ms" << std::endl;
+    }
+}
+
+void Catalog::addDirectory(const fs::path& dirPath, const std::string& dir)
+{
+    // watched before it is read, so no file added meanwhile is missed
+    watch(dirPath);
+
+    fs::directory_iterator endItr;
+
+    for (fs::directory_iterator itr(dirPath); itr != endItr; ++itr)
+    {
+        if (fs::is_directory(itr->status()))
+        {
+            addDirectory(itr->path(), dir);
+        }
+        else
+        {
+            // the first file of a name is used, like the directory walk
+            // before the catalog did
+            files.insert(FileMap::value_type(dir + "/" + itr->leaf(),
+                itr->path()));
+        }
+    }
+}
+
+void Catalog::watch(const fs::path& dirPath)
+{
+    // without a watch, e.g. past the watch limit of the user, changes
+    // in the directory go unnoticed
+    if (inotify != -1 &&
+        inotify_add_watch(inotify, dirPath.string().c_str(),
+            watchedEvents) == -1)
+    {
+        watching = false;
+    }
+}
+
+bool Catalog::changed()
+{
+    if (inotify == -1)
+    {
+        return false;
+    }
+
+    char buffer[4096]
+        __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    bool structureChanged = false;
+    ssize_t length;
+
+    while ((length = read(inotify, buffer, sizeof(buffer))) > 0)
+    {
+        const char* event = buffer;
+
+        while (event < buffer + length)
+        {
+            const struct inotify_event* info =
+                reinterpret_cast<const struct inotify_event*>(event);
+
+            // once the queue overflowed, events were lost and any file
+            // may have been added or removed
+            if ((info->mask & structureEvents) ||
+                (info->mask & IN_Q_OVERFLOW))
+            {
+                structureChanged = true;
+            }
+
+            generation++;
+            event += sizeof(struct inotify_event) + info->len;
+        }
+    }
+
+    return structureChanged;
+}
+
+bool Catalog::lookup(
+    const std::string& dir,
+    const std::string& fileName,
+    fs::path& path)
+{
+    FileMap::const_iterator it = files.find(dir + "/" + fileName);
+
+    if (it == files.end())
+    {
+        return false;
+    }
+
+    path = it->second;
+    return true;
+}
@@ -0,0 +1,179 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#ifndef SPOAC_LTM_CATALOG_H
+#define SPOAC_LTM_CATALOG_H
+
+#include <map>
+#include <string>
+#include <stdint.h>
+
+#include <boost/filesystem.hpp>
+#include <IceUtil/Mutex.h>
+#include <IceUtil/Time.h>
+
+namespace spoac
+{
+    /**
+    * An index of the files in the LTM database.
+    *
+    * The database directory contains a directory per kind of file, e.g.
+    * scenarios and oacs, in which files can be arranged in any number of
+    * subdirectories. The catalog is built by walking the whole database
+    * once, on the first lookup, after which a file is found by its
+    * directory and name without touching the filesystem.
+    *
+    * The catalog watches all directories with inotify and is rebuilt
+    * before the next lookup once files have been added, removed or
+    * renamed. It also counts changes to the files, so users can tell
+    * whether anything has changed at all.
+    *
+    * Changes inotify cannot report, such as those made by other clients
+    * of a network filesystem, are picked up by rebuilding the catalog
+    * when a file is not found, at most once per miss interval so clients
+    * asking for a missing file again and again do not walk the database
+    * every time.
+    */
+    class Catalog
+    {
+    public:
+        /**
+        * Paths by directory and file name, joined by a slash.
+        */
+        typedef std::map<std::string, boost::filesystem::path> FileMap;
+
+        /**
+        * Creates the catalog of a database directory, which need not
+        * exist yet. The directory is walked on first use.
+        *
+        * @param root         The database directory.
+        * @param missInterval The time after a rebuild during which files
+        *                     which are not found do not rebuild the
+        *                     catalog again.
+        */
+        Catalog(
+            const boost::filesystem::path& root,
+            const IceUtil::Time& missInterval = IceUtil::Time::seconds(1));
+        ~Catalog();
+
+        /**
+        * Looks up a file.
+        *
+        * @param dir      The directory the file belongs to, e.g. "oacs".
+        * @param fileName The name of the file including its extension.
+        * @param path     Set to the path of the file if it is found.
+        * @return         Whether the file exists.
+        */
+        bool find(
+            const std::string& dir,
+            const std::string& fileName,
+            boost::filesystem::path& path);
+
+        /**
+        * Looks up a file without rebuilding the catalog, so the lookup
+        * never has to read a directory.
+        *
+        * @return Whether the file is in the catalog and the catalog is
+        *         up to date. A file missing from it may still exist.
+        */
+        bool findIndexed(
+            const std::string& dir,
+            const std::string& fileName,
+            boost::filesystem::path& path);
+
+        /**
+        * @return All files of the database.
+        */
+        FileMap getFiles();
+
+        /**
+        * @return The number of changes to the database noticed since the
+        *         catalog was created. Changes are only noticed once the
+        *         catalog has been built, which this does if necessary.
+        */
+        uint64_t getGeneration();
+
+        /**
+        * @return Whether inotify watches all directories of the catalog,
+        *         so changes made on this machine are noticed.
+        */
+        bool isWatching();
+
+        /**
+        * @return The number of files in the catalog.
+        */
+        size_t size();
+
+        /**
+        * @return The database directory.
+        */
+        const boost::filesystem::path& getRoot() const;
+
+    protected:
+        /**
+        * Walks the database, replacing the current catalog.
+        */
+        void build();
+
+        void addDirectory(
+            const boost::filesystem::path& dirPath,
+            const std::string& dir);
+
+        void watch(const boost::filesystem::path& dirPath);
+
+        /**
+        * Reads the pending inotify events and counts them.
+        *
+        * @return Whether any files have been added, removed or renamed.
+        */
+        bool changed();
+
+        bool lookup(
+            const std::string& dir,
+            const std::string& fileName,
+            boost::filesystem::path& path);
+
+        boost::filesystem::path root;
+        FileMap files;
+
+        // the inotify instance watching all directories of the catalog, -1
+        // if inotify is not available
+        int inotify;
+
+        // no directory failed to be watched in the last build
+        bool watching;
+
+        // the catalog has not been built yet or files have changed since
+        bool stale;
+
+        // inotify events read so far
+        uint64_t generation;
+
+        IceUtil::Time missInterval;
+        IceUtil::Time lastBuild;
+
+        IceUtil::Mutex mutex;
+    };
+}
+
+#endif
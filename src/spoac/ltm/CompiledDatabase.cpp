@@ -0,0 +1,417 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#include <spoac/ltm/CompiledDatabase.h>
+#include <spoac/ltm/Mappings.h>
+#include <spoac/common/Exception.h>
+#include <spoac/JSON/BinaryReader.h>
+#include <spoac/JSON/BinaryWriter.h>
+#include <spoac/JSON/Document.h>
+#include <spoac/JSON/DocumentObject.h>
+#include <spoac/JSON/Parser.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+#include <sys/stat.h>
+
+#include <boost/lexical_cast.hpp>
+
+using namespace spoac;
+namespace fs = boost::filesystem;
+
+static const char magic[8] = {'S', 'P', 'O', 'A', 'C', 'L', 'T', 'M'};
+
+const uint32_t CompiledDatabase::FORMAT_VERSION;
+
+namespace
+{
+    /**
+    * Strings of the entry table, each stored once.
+    */
+    class StringTable
+    {
+    public:
+        uint32_t add(const std::string& s)
+        {
+            std::map<std::string, uint32_t>::iterator it = offsets.find(s);
+
+            if (it != offsets.end())
+            {
+                return it->second;
+            }
+
+            uint32_t offset = data.size();
+            data += s;
+            offsets[s] = offset;
+
+            return offset;
+        }
+
+        std::string data;
+
+    protected:
+        std::map<std::string, uint32_t> offsets;
+    };
+
+    /**
+    * Writes the members of an object which the Mapping of T binds,
+    * skipping all others.
+    */
+    template <class T>
+    void writeBoundMembers(
+        const JSON::DocumentValue& value,
+        JSON::BinaryWriter& writer)
+    {
+        const JSON::FieldList<T>& fields = JSON::FieldList<T>::get();
+        const JSON::DocumentObject& object = value.toObject();
+        JSON::DocumentObject::const_iterator it;
+
+        writer.onObjectStart();
+
+        for (it = object.begin(); it != object.end(); ++it)
+        {
+            std::string key = it->first->toString();
+
+            if (fields.find(key.data(), key.size()) != fields.size())
+            {
+                writer.onKey(key);
+                it->second->emit(writer);
+            }
+        }
+
+        writer.onObjectEnd();
+    }
+
+    /**
+    * Binds a record, so files the LTM could not return are found by
+    * ltmcompile already.
+    */
+    template <class T>
+    void checkBinding(const std::string& record)
+    {
+        T target;
+        JSON::Binding<T> binding(target);
+        JSON::BinaryReader reader(binding);
+        reader.read(record);
+    }
+
+    /**
+    * Whether a range lies within a block of the given size, without
+    * overflowing for corrupt offsets.
+    */
+    bool inBounds(uint64_t offset, uint64_t length, uint64_t size)
+    {
+        return offset <= size && length <= size - offset;
+    }
+
+    /**
+    * Adds data to the FNV-1a hash of the database version.
+    */
+    void hash(uint64_t& version, const void* data, size_t length)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+        for (size_t i = 0; i < length; i++)
+        {
+            version ^= bytes[i];
+            version *= 1099511628211ULL;
+        }
+    }
+}
+
+size_t CompiledDatabase::compile(Catalog& catalog, const fs::path& output)
+{
+    Catalog::FileMap files = catalog.getFiles();
+    Catalog::FileMap::const_iterator it;
+
+    StringTable strings;
+    std::vector<Entry> entries;
+    std::string records;
+    uint64_t version = 14695981039346656037ULL;
+
+    hash(version, &FORMAT_VERSION, sizeof(FORMAT_VERSION));
+
+    for (it = files.begin(); it != files.end(); ++it)
+    {
+        std::string dir = it->first.substr(0, it->first.find('/'));
+        std::string path = it->second.string();
+
+        if ((dir != "scenarios" && dir != "oacs") ||
+            fs::extension(it->second) != ".json")
+        {
+            continue;
+        }
+
+        struct stat info;
+
+        if (stat(path.c_str(), &info) != 0)
+        {
+            continue;
+        }
+
+        std::string record;
+        std::string document;
+
+        try
+        {
+            JSON::Document file;
+            JSON::Parser parser(file);
+            parser.readFromFile(path, JSON::FILE_COPY);
+
+            JSON::BinaryWriter recordWriter(record);
+
+            if (dir == "scenarios")
+            {
+                writeBoundMembers<LTMSlice::Scenario>(file.getRoot(),
+                    recordWriter);
+                checkBinding<LTMSlice::Scenario>(record);
+            }
+            else
+            {
+                writeBoundMembers<PlanningSlice::ActionDefinition>(
+                    file.getRoot(), recordWriter);
+                checkBinding<PlanningSlice::ActionDefinition>(record);
+
+                JSON::BinaryWriter documentWriter(document);
+                documentWriter.write(file.getRoot());
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Skipping " << path << ": " << e.what() <<
+                std::endl;
+            continue;
+        }
+
+        Entry entry;
+        entry.keyOffset = strings.add(it->first);
+        entry.keyLength = it->first.size();
+        entry.pathOffset = strings.add(path);
+        entry.pathLength = path.size();
+        entry.inode = info.st_ino;
+        entry.fileSize = info.st_size;
+        entry.modified = info.st_mtim.tv_sec;
+        entry.modifiedNanoSeconds = info.st_mtim.tv_nsec;
+
+        // offsets relative to the records for now
+        entry.recordOffset = records.size();
+        entry.recordLength = record.size();
+        records += record;
+        entry.documentOffset = records.size();
+        entry.documentLength = document.size();
+        records += document;
+
+        hash(version, it->first.data(), it->first.size());
+        hash(version, &entry.inode, sizeof(entry.inode));
+        hash(version, &entry.fileSize, sizeof(entry.fileSize));
+        hash(version, &entry.modified, sizeof(entry.modified));
+        hash(version, &entry.modifiedNanoSeconds,
+            sizeof(entry.modifiedNanoSeconds));
+
+        entries.push_back(entry);
+    }
+
+    Header header;
+    memcpy(header.magic, magic, sizeof(magic));
+    header.formatVersion = FORMAT_VERSION;
+    header.entryCount = entries.size();
+    header.version = version;
+    header.stringsOffset = sizeof(Header) + entries.size() * sizeof(Entry);
+    header.stringsLength = strings.data.size();
+
+    uint64_t recordsOffset = header.stringsOffset + header.stringsLength;
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        entries[i].recordOffset += recordsOffset;
+        entries[i].documentOffset += recordsOffset;
+    }
+
+    std::string tmp = output.string() + ".tmp";
+
+    {
+        std::ofstream out(tmp.c_str(), std::ios::binary | std::ios::trunc);
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        if (!entries.empty())
+        {
+            out.write(reinterpret_cast<const char*>(&entries[0]),
+                entries.size() * sizeof(Entry));
+        }
+
+        out.write(strings.data.data(), strings.data.size());
+        out.write(records.data(), records.size());
+        out.close();
+
+        if (!out)
+        {
+            remove(tmp.c_str());
+            throw Exception(std::string("Could not write ") + tmp);
+        }
+    }
+
+    if (rename(tmp.c_str(), output.string().c_str()) != 0)
+    {
+        remove(tmp.c_str());
+        throw Exception(std::string("Could not replace ") + output.string());
+    }
+
+    return entries.size();
+}
+
+CompiledDatabase::CompiledDatabase(const fs::path& path) :
+    file(path.string(), JSON::FILE_MAP_LAZY),
+    header(NULL),
+    entries(NULL),
+    strings(NULL)
+{
+    if (!file.isOpen())
+    {
+        throw Exception(std::string("Could not read ") + path.string());
+    }
+
+    if (file.size() < sizeof(Header) ||
+        memcmp(file.data(), magic, sizeof(magic)) != 0)
+    {
+        throw Exception(path.string() + " is not a compiled LTM database");
+    }
+
+    header = reinterpret_cast<const Header*>(file.data());
+
+    if (header->formatVersion != FORMAT_VERSION)
+    {
+        throw Exception(path.string() + " has format version " +
+            boost::lexical_cast<std::string>(header->formatVersion) +
+            " instead of " +
+            boost::lexical_cast<std::string>(FORMAT_VERSION) +
+            ", it has to be compiled again");
+    }
+
+    if (header->stringsOffset !=
+            sizeof(Header) + header->entryCount * sizeof(Entry) ||
+        !inBounds(header->stringsOffset, header->stringsLength, file.size()))
+    {
+        throw Exception(path.string() + " is truncated");
+    }
+
+    entries = reinterpret_cast<const Entry*>(file.data() + sizeof(Header));
+    strings = file.data() + header->stringsOffset;
+}
+
+bool CompiledDatabase::find(
+    const std::string& dir,
+    const std::string& fileName,
+    Record& record) const
+{
+    std::string key = dir + "/" + fileName;
+
+    // entries are sorted like the keys of a std::map
+    size_t begin = 0;
+    size_t end = header->entryCount;
+
+    while (begin < end)
+    {
+        size_t middle = begin + (end - begin) / 2;
+        const Entry& entry = entries[middle];
+
+        // the entries are only checked when they are used, so opening the
+        // file does not have to read the whole table
+        if (!inBounds(entry.keyOffset, entry.keyLength, header->stringsLength))
+        {
+            return false;
+        }
+
+        int order = memcmp(strings + entry.keyOffset, key.data(),
+            std::min<size_t>(entry.keyLength, key.size()));
+
+        if (order == 0)
+        {
+            order = (entry.keyLength < key.size()) ? -1 :
+                (entry.keyLength > key.size()) ? 1 : 0;
+        }
+
+        if (order < 0)
+        {
+            begin = middle + 1;
+        }
+        else if (order > 0)
+        {
+            end = middle;
+        }
+        else
+        {
+            if (!inBounds(entry.recordOffset, entry.recordLength,
+                    file.size()) ||
+                !inBounds(entry.documentOffset, entry.documentLength,
+                    file.size()) ||
+                !isCurrent(entry))
+            {
+                return false;
+            }
+
+            record.data = file.data() + entry.recordOffset;
+            record.length = entry.recordLength;
+            record.document = entry.documentLength ?
+                file.data() + entry.documentOffset : NULL;
+            record.documentLength = entry.documentLength;
+            record.path = strings + entry.pathOffset;
+            record.pathLength = entry.pathLength;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint64_t CompiledDatabase::getVersion() const
+{
+    return header->version;
+}
+
+size_t CompiledDatabase::size() const
+{
+    return header->entryCount;
+}
+
+bool CompiledDatabase::isCurrent(const Entry& entry) const
+{
+    if (!inBounds(entry.pathOffset, entry.pathLength, header->stringsLength))
+    {
+        return false;
+    }
+
+    std::string path(strings + entry.pathOffset, entry.pathLength);
+    struct stat info;
+
+    return stat(path.c_str(), &info) == 0 &&
+        entry.inode == (uint64_t) info.st_ino &&
+        entry.fileSize == (uint64_t) info.st_size &&
+        entry.modified == (int64_t) info.st_mtim.tv_sec &&
+        entry.modifiedNanoSeconds == (int64_t) info.st_mtim.tv_nsec;
+}
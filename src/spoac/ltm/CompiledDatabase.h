@@ -0,0 +1,185 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#ifndef SPOAC_LTM_COMPILEDDATABASE_H
+#define SPOAC_LTM_COMPILEDDATABASE_H
+
+#include <string>
+#include <stdint.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
+#include <spoac/ltm/Catalog.h>
+#include <spoac/JSON/MappedFile.h>
+
+namespace spoac
+{
+    /**
+    * The LTM database compiled into a single binary file by ltmcompile,
+    * which the LTM maps into memory to answer requests without reading
+    * or parsing any JSON.
+    *
+    * The file starts with a header and a table of entries sorted by the
+    * directory and name of their source file, followed by the interned
+    * strings of the table and the records. Each scenario and OAC has a
+    * record holding only the members bound to the Scenario or
+    * ActionDefinition struct, encoded as CBOR, so it is bound without
+    * skipping anything. OACs additionally keep the whole file as CBOR,
+    * from which action configs are selected by the match rules.
+    *
+    * The JSON files remain the source of truth. Every entry records the
+    * inode, size and modification time of the file it was compiled from,
+    * and find() ignores entries whose file has changed since, so the LTM
+    * falls back to the file. Opening the file takes constant time, as it
+    * is mapped lazily and only the header is checked.
+    *
+    * The file is written in the byte order of the compiling machine and
+    * rejected by machines of the other byte order.
+    */
+    class CompiledDatabase
+    {
+    public:
+        /**
+        * Version of the file layout, files of other versions are
+        * rejected.
+        */
+        static const uint32_t FORMAT_VERSION = 1;
+
+        /**
+        * The compiled data of one file.
+        */
+        struct Record
+        {
+            // members of the file bound to the struct the LTM returns
+            const char* data;
+            size_t length;
+
+            // the whole file, NULL unless it is an OAC
+            const char* document;
+            size_t documentLength;
+
+            // the file the record was compiled from
+            const char* path;
+            size_t pathLength;
+        };
+
+        /**
+        * Compiles all scenarios and OACs of a database.
+        *
+        * The file is written next to the output path first and then
+        * renamed, so servers which have the old file open keep using it.
+        * Files which cannot be parsed or bound are reported and left out,
+        * the LTM reads them from the JSON tree instead.
+        *
+        * @param catalog The files of the database.
+        * @param output  The path of the compiled database.
+        * @return        The number of files compiled.
+        * @throws Exception if the output cannot be written.
+        */
+        static size_t compile(Catalog& catalog,
+            const boost::filesystem::path& output);
+
+        /**
+        * Maps a compiled database into memory.
+        *
+        * @throws Exception if the file cannot be read, is not a compiled
+        *         database or has a different format version.
+        */
+        CompiledDatabase(const boost::filesystem::path& path);
+
+        /**
+        * Looks up the record of a file, unless the file has changed since
+        * it was compiled.
+        *
+        * @param dir      The directory the file belongs to, e.g. "oacs".
+        * @param fileName The name of the file including its extension.
+        * @param record   Set to the record if it is found.
+        * @return         Whether a current record was found.
+        */
+        bool find(
+            const std::string& dir,
+            const std::string& fileName,
+            Record& record) const;
+
+        /**
+        * @return A fingerprint of the files the database was compiled
+        *         from, which changes whenever it is compiled from changed
+        *         files.
+        */
+        uint64_t getVersion() const;
+
+        /**
+        * @return The number of compiled files.
+        */
+        size_t size() const;
+
+    protected:
+        struct Header
+        {
+            char magic[8];
+            uint32_t formatVersion;
+            uint32_t entryCount;
+            uint64_t version;
+            uint64_t stringsOffset;
+            uint64_t stringsLength;
+        };
+
+        struct Entry
+        {
+            // offsets into the strings, the key is dir/fileName
+            uint32_t keyOffset;
+            uint32_t keyLength;
+            uint32_t pathOffset;
+            uint32_t pathLength;
+
+            // state of the source file when it was compiled
+            uint64_t inode;
+            uint64_t fileSize;
+            int64_t modified;
+            int64_t modifiedNanoSeconds;
+
+            // offsets from the start of the file
+            uint64_t recordOffset;
+            uint64_t recordLength;
+            uint64_t documentOffset;
+            uint64_t documentLength;
+        };
+
+        /**
+        * @return Whether the source file of an entry is unchanged.
+        */
+        bool isCurrent(const Entry& entry) const;
+
+        JSON::MappedFile file;
+        const Header* header;
+        const Entry* entries;
+        const char* strings;
+    };
+
+    /**
+    * Pointer type to reduce typing for shared pointers.
+    */
+    typedef boost::shared_ptr<CompiledDatabase> CompiledDatabasePtr;
+}
+
+#endif
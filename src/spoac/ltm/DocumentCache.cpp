@@ -0,0 +1,243 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#include <spoac/ltm/DocumentCache.h>
+#include <spoac/JSON/BinaryReader.h>
+#include <spoac/JSON/Parser.h>
+
+#include <iostream>
+#include <sys/stat.h>
+
+using namespace spoac;
+namespace fs = boost::filesystem;
+
+DocumentCache::DocumentCache(size_t memoryLimit) :
+    memoryLimit(memoryLimit),
+    memoryUsage(0),
+    hits(0),
+    misses(0),
+    evictions(0)
+{
+}
+
+ConstDocumentPtr DocumentCache::get(const fs::path& path)
+{
+    Entry entry;
+    entry.path = path.string();
+
+    bool exists = stat(entry);
+    ConstDocumentPtr cached = find(entry, exists, "Reading file");
+
+    if (cached)
+    {
+        return cached;
+    }
+
+    // parsed without holding the lock, so requests for other documents
+    // are not held up by a large file
+    boost::shared_ptr<JSON::Document> document(new JSON::Document);
+    JSON::Parser parser(*document);
+    parser.readFromFile(entry.path, JSON::FILE_COPY);
+
+    entry.memoryUsage = document->getMemoryUsage() + entry.fileSize;
+    entry.document = document;
+
+    if (exists)
+    {
+        insert(entry);
+    }
+
+    return entry.document;
+}
+
+ConstDocumentPtr DocumentCache::get(
+    const fs::path& path,
+    const char* data,
+    size_t length)
+{
+    Entry entry;
+    entry.path = path.string();
+
+    bool exists = stat(entry);
+    ConstDocumentPtr cached = find(entry, exists, "Decoding compiled file");
+
+    if (cached)
+    {
+        return cached;
+    }
+
+    // the decoded document copies all strings out of the data
+    boost::shared_ptr<JSON::Document> document(new JSON::Document);
+    JSON::BinaryReader reader(*document);
+    reader.read(data, length);
+
+    entry.memoryUsage = document->getMemoryUsage();
+    entry.document = document;
+
+    if (exists)
+    {
+        insert(entry);
+    }
+
+    return entry.document;
+}
+
+bool DocumentCache::contains(const fs::path& path)
+{
+    Entry entry;
+    entry.path = path.string();
+
+    if (!stat(entry))
+    {
+        return false;
+    }
+
+    IceUtil::Mutex::Lock lock(mutex);
+
+    EntryMap::iterator it = index.find(entry.path);
+
+    return it != index.end() && isCurrent(*it->second, entry);
+}
+
+size_t DocumentCache::getHits()
+{
+    IceUtil::Mutex::Lock lock(mutex);
+    return hits;
+}
+
+size_t DocumentCache::getMisses()
+{
+    IceUtil::Mutex::Lock lock(mutex);
+    return misses;
+}
+
+size_t DocumentCache::getEvictions()
+{
+    IceUtil::Mutex::Lock lock(mutex);
+    return evictions;
+}
+
+size_t DocumentCache::getMemoryUsage()
+{
+    IceUtil::Mutex::Lock lock(mutex);
+    return memoryUsage;
+}
+
+size_t DocumentCache::size()
+{
+    IceUtil::Mutex::Lock lock(mutex);
+    return entries.size();
+}
+
+bool DocumentCache::stat(Entry& entry)
+{
+    struct stat info;
+
+    if (::stat(entry.path.c_str(), &info) != 0)
+    {
+        return false;
+    }
+
+    entry.inode = info.st_ino;
+    entry.fileSize = info.st_size;
+    entry.modified = info.st_mtim.tv_sec;
+    entry.modifiedNanoSeconds = info.st_mtim.tv_nsec;
+
+    return true;
+}
+
+bool DocumentCache::isCurrent(const Entry& cached, const Entry& current)
+{
+    return cached.inode == current.inode &&
+        cached.fileSize == current.fileSize &&
+        cached.modified == current.modified &&
+        cached.modifiedNanoSeconds == current.modifiedNanoSeconds;
+}
+
+ConstDocumentPtr DocumentCache::find(
+    const Entry& entry,
+    bool exists,
+    const char* source)
+{
+    IceUtil::Mutex::Lock lock(mutex);
+
+    EntryMap::iterator it = index.find(entry.path);
+
+    if (it != index.end())
+    {
+        const Entry& cached = *it->second;
+
+        if (exists && isCurrent(cached, entry))
+        {
+            hits++;
+            entries.splice(entries.begin(), entries, it->second);
+            return cached.document;
+        }
+
+        remove(it);
+    }
+
+    misses++;
+
+    std::cout << source << ": " << entry.path << " (cache: " <<
+        entries.size() << " files, " << memoryUsage << " bytes, " <<
+        hits << " hits, " << misses << " misses, " << evictions <<
+        " evictions)" << std::endl;
+
+    return ConstDocumentPtr();
+}
+
+void DocumentCache::insert(const Entry& entry)
+{
+    if (entry.memoryUsage > memoryLimit)
+    {
+        return;
+    }
+
+    IceUtil::Mutex::Lock lock(mutex);
+
+    // another request may have read the file meanwhile
+    EntryMap::iterator it = index.find(entry.path);
+
+    if (it != index.end())
+    {
+        remove(it);
+    }
+
+    entries.push_front(entry);
+    index[entry.path] = entries.begin();
+    memoryUsage += entry.memoryUsage;
+
+    while (memoryUsage > memoryLimit)
+    {
+        remove(index.find(entries.back().path));
+        evictions++;
+    }
+}
+
+void DocumentCache::remove(EntryMap::iterator it)
+{
+    memoryUsage -= it->second->memoryUsage;
+    entries.erase(it->second);
+    index.erase(it);
+}
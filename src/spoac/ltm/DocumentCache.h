@@ -0,0 +1,182 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#ifndef SPOAC_LTM_DOCUMENTCACHE_H
+#define SPOAC_LTM_DOCUMENTCACHE_H
+
+#include <list>
+#include <map>
+#include <string>
+#include <sys/types.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
+#include <IceUtil/Mutex.h>
+#include <spoac/JSON/Document.h>
+
+namespace spoac
+{
+    /**
+    * Pointer type for documents shared by the cache and its users.
+    */
+    typedef boost::shared_ptr<const JSON::Document> ConstDocumentPtr;
+
+    /**
+    * A cache of parsed LTM files.
+    *
+    * Files are parsed into documents once and then shared by all lookups
+    * until the file changes. A cached document is never modified, so
+    * concurrent requests read it without locking, and a document evicted
+    * or replaced while in use stays valid until its last user releases
+    * it. Documents copy their file instead of mapping it, so rewriting
+    * the file in place cannot change them either.
+    *
+    * Every lookup compares the file's inode, size and modification time
+    * to those it was parsed from, which also notices changes made by
+    * other clients of a network filesystem. The least recently used
+    * documents are evicted once the cached documents and their file
+    * contents take up more than the memory limit.
+    */
+    class DocumentCache
+    {
+    public:
+        /**
+        * Creates an empty cache.
+        *
+        * @param memoryLimit Memory in bytes the cached documents may use,
+        *                    0 disables caching.
+        */
+        DocumentCache(size_t memoryLimit);
+
+        /**
+        * Returns the parsed contents of a file, reading it if it is not
+        * cached or has changed since.
+        *
+        * @param path The file to read.
+        * @return     The document, never NULL.
+        * @throws JSON::ParserException if the file cannot be read or
+        *         parsed.
+        */
+        ConstDocumentPtr get(const boost::filesystem::path& path);
+
+        /**
+        * Returns the contents of a file compiled into CBOR, decoding them
+        * if the file is not cached or has changed since. The document is
+        * cached like one read from the file itself.
+        *
+        * @param path   The file the data was compiled from.
+        * @param data   The CBOR encoded contents of the file.
+        * @param length The length of the data in bytes.
+        * @return       The document, never NULL.
+        * @throws JSON::ParserException if the data cannot be decoded.
+        */
+        ConstDocumentPtr get(
+            const boost::filesystem::path& path,
+            const char* data,
+            size_t length);
+
+        /**
+        * Checks whether get() would return a document without reading the
+        * file. Does not count as a hit or miss.
+        */
+        bool contains(const boost::filesystem::path& path);
+
+        size_t getHits();
+        size_t getMisses();
+        size_t getEvictions();
+
+        /**
+        * @return The memory in bytes used by the cached documents.
+        */
+        size_t getMemoryUsage();
+
+        /**
+        * @return The number of cached documents.
+        */
+        size_t size();
+
+    protected:
+        /**
+        * A cached document and the state of the file it was read from.
+        */
+        struct Entry
+        {
+            std::string path;
+            ino_t inode;
+            off_t fileSize;
+            time_t modified;
+            long modifiedNanoSeconds;
+            size_t memoryUsage;
+            ConstDocumentPtr document;
+        };
+
+        typedef std::list<Entry> EntryList;
+        typedef std::map<std::string, EntryList::iterator> EntryMap;
+
+        /**
+        * Fills in the state of the entry's file.
+        *
+        * @return Whether the file exists.
+        */
+        static bool stat(Entry& entry);
+
+        /**
+        * @return Whether a cached entry was read from the file described
+        *         by the current entry.
+        */
+        static bool isCurrent(const Entry& cached, const Entry& current);
+
+        /**
+        * Looks up the current document of the entry's file, counting a
+        * hit or miss.
+        *
+        * @param source Describes how a missing document is read.
+        * @return       The document or NULL if it has to be read.
+        */
+        ConstDocumentPtr find(const Entry& entry, bool exists,
+            const char* source);
+
+        /**
+        * Caches a document which has just been read, unless it exceeds
+        * the memory limit on its own.
+        */
+        void insert(const Entry& entry);
+
+        void remove(EntryMap::iterator it);
+
+        size_t memoryLimit;
+        size_t memoryUsage;
+
+        // most recently used first
+        EntryList entries;
+        EntryMap index;
+
+        size_t hits;
+        size_t misses;
+        size_t evictions;
+
+        IceUtil::Mutex mutex;
+    };
+}
+
+#endif
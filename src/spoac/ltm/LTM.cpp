@@ -22,370 +22,796 @@
 */
 
 #include <spoac/ltm/LTM.h>
+#include <spoac/ltm/Mappings.h>
 #include <spoac/common/Exception.h>
+#include <spoac/JSON/BinaryReader.h>
+#include <spoac/JSON/BindingException.h>
 #include <iostream>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/functional/hash.hpp>
+#include <sys/stat.h>
 
 using namespace spoac;
 namespace fs = boost::filesystem;
 
-LTMSlice::Scenario LTM::getScenario(
-    const std::string& name,
-    const Ice::Current& c)
+// member names looked up on every request, interned once
+static const JSON::Identifier actionKey("action");
+static const JSON::Identifier configKey("config");
+
+namespace
 {
-    LTMSlice::Scenario scenario;
+    /**
+    * Calls one of the synchronous LTM methods and passes its result or
+    * exception to the AMD callback of the request.
+    */
+    template <class Callback, class Argument, class Result>
+    class Request : public WorkItem
+    {
+    public:
+        typedef Result (LTM::*Method)(const Argument&, const Ice::Current&);
+
+        Request(
+            LTM* ltm,
+            Method method,
+            const Callback& callback,
+            const Argument& argument,
+            const Ice::Current& current) :
+            ltm(ltm),
+            method(method),
+            callback(callback),
+            argument(argument),
+            current(current)
+        {
+        }
 
-    JSON::ValuePtr value = findAndParseFile("scenarios", name);
+        void execute()
+        {
+            try
+            {
+                callback->ice_response((ltm->*method)(argument, current));
+            }
+            catch (const std::exception& e)
+            {
+                callback->ice_exception(e);
+            }
+            catch (...)
+            {
+                callback->ice_exception();
+            }
+        }
 
-    if (value->getType() != JSON::OBJECT)
+    protected:
+        LTM* ltm;
+        Method method;
+        Callback callback;
+        Argument argument;
+        Ice::Current current;
+    };
+
+    /**
+    * Combines the inode, size and modification time of all files, which
+    * tells about changes inotify cannot report, such as those made by
+    * other clients of a network filesystem.
+    */
+    uint64_t getStatVersion(const Catalog::FileMap& files)
     {
-        throw Exception(std::string("Scenario ") + name +
-            " is not a JSON object");
-    }
+        size_t seed = 0;
+        Catalog::FileMap::const_iterator it;
 
-    JSON::Object& document = value->toObject();
+        for (it = files.begin(); it != files.end(); ++it)
+        {
+            struct stat info;
 
-    scenario.name = document["name"]->toString();
+            boost::hash_combine(seed, it->first);
 
-    scenario.activityControllers = vectorFromArray(
-        document["activityControllers"]);
-    scenario.perceptionHandlers = vectorFromArray(
-        document["perceptionHandlers"]);
-    scenario.oacs = vectorFromArray(
-        document["oacs"]);
+            if (stat(it->second.string().c_str(), &info) != 0)
+            {
+                continue;
+            }
 
-    scenario.goals = mapFromObject(
-        document["goals"]);
+            boost::hash_combine(seed, info.st_ino);
+            boost::hash_combine(seed, info.st_size);
+            boost::hash_combine(seed, info.st_mtim.tv_sec);
+            boost::hash_combine(seed, info.st_mtim.tv_nsec);
+        }
+
+        return seed;
+    }
 
-    if (document["predicates"]->getType() == JSON::ARRAY)
+    template <class Callback, class Argument, class Result>
+    WorkItemPtr makeRequest(
+        LTM* ltm,
+        Result (LTM::*method)(const Argument&, const Ice::Current&),
+        const Callback& callback,
+        const Argument& argument,
+        const Ice::Current& current)
     {
-        JSON::Array& array = document["predicates"]->toArray();
-        JSON::Array::const_iterator it;
+        return WorkItemPtr(new Request<Callback, Argument, Result>(
+            ltm, method, callback, argument, current));
+    }
+}
 
-        for (it = array.begin(); it != array.end(); ++it)
+LTM::LTM(
+    JSON::CodecFormat configFormat,
+    size_t cacheSize,
+    WorkQueuePtr workQueue,
+    const fs::path& compiledPath) :
+    configFormat(configFormat),
+    catalog(getDatabasePath()),
+    cache(cacheSize),
+    workQueue(workQueue),
+    startTime(static_cast<uint64_t>(IceUtil::Time::now().toMicroSeconds())),
+    statVersion(0),
+    statInterval(IceUtil::Time::seconds(60))
+{
+    if (!compiledPath.empty() && fs::exists(compiledPath))
+    {
+        try
         {
-            PlanningSlice::PredicateDefinition p;
-            JSON::Object& def = (*it)->toObject();
-            p.name = def["name"]->toString();
-            p.arguments = (short) def["arguments"]->toInt();
+            database.reset(new CompiledDatabase(compiledPath));
 
-            scenario.predicates.push_back(p);
+            std::cout << "Using compiled database " << compiledPath.string() <<
+                " (" << database->size() << " files)" << std::endl;
+        }
+        catch (const Exception& e)
+        {
+            std::cout << "Ignoring compiled database: " << e.what() <<
+                std::endl;
         }
     }
+}
 
-    if (document["functions"]->getType() == JSON::ARRAY)
+LTM::~LTM()
+{
+    stopReloading();
+}
+
+void LTM::startReloading(
+    const IceUtil::Time& interval,
+    const IceUtil::Time& statInterval)
+{
+    IceUtil::Mutex::Lock lock(reloaderMutex);
+
+    if (reloader)
     {
-        JSON::Array& array = document["functions"]->toArray();
-        JSON::Array::const_iterator it;
+        return;
+    }
 
-        for (it = array.begin(); it != array.end(); ++it)
-        {
-            PlanningSlice::FunctionDefinition f;
-            JSON::Object& def = (*it)->toObject();
-            f.name = def["name"]->toString();
-            f.arguments = (short) def["arguments"]->toInt();
+    {
+        IceUtil::Mutex::Lock statLock(reloadMutex);
+        this->statInterval = statInterval;
+    }
 
-            scenario.functions.push_back(f);
-        }
+    reloader = new Reloader(*this, interval);
+    reloaderThread = reloader->start();
+}
+
+void LTM::stopReloading()
+{
+    ReloaderPtr stopped;
+
+    {
+        // requests waking the reloader meanwhile no longer find it
+        IceUtil::Mutex::Lock lock(reloaderMutex);
+
+        stopped = reloader;
+        reloader = 0;
     }
 
-    return scenario;
+    if (!stopped)
+    {
+        return;
+    }
+
+    stopped->destroy();
+    reloaderThread.join();
 }
 
-LTMSlice::ActionConfig LTM::getActionConfig(
-    const LTMSlice::OAC& oacInstance,
-    const Ice::Current& c)
+bool LTM::reload()
 {
-    bool found = false;
-    LTMSlice::ActionConfig actionConfig;
+    // concurrent reloads would only load the same files twice
+    IceUtil::Mutex::Lock lock(reloadMutex);
+
+    // read before the files, so changes made while they are read give
+    // another version and are loaded by the next reload
+    Catalog::FileMap files = catalog.getFiles();
+    IceUtil::Time now = IceUtil::Time::now();
+
+    // a stat of every file is slow on a network filesystem, which is why
+    // inotify is relied upon between checks as long as it watches
+    // everything
+    if (!catalog.isWatching() || now - lastStatCheck >= statInterval)
+    {
+        statVersion = getStatVersion(files);
+        lastStatCheck = now;
+    }
 
-    JSON::ValuePtr value = findAndParseFile("oacs", oacInstance.name);
+    uint64_t version = getDatabaseVersion() + statVersion;
+    SnapshotPtr current = getSnapshot();
 
-    if (value->getType() != JSON::OBJECT)
+    if (current && current->getVersion() == version)
     {
-        throw Exception(std::string("OAC ") + oacInstance.name +
-            " is not a JSON object");
+        return false;
     }
 
-    JSON::Object& document = value->toObject();
+    IceUtil::Time start = IceUtil::Time::now();
 
-    std::map<std::string, int> isParam;
+    boost::shared_ptr<Snapshot> next(new Snapshot(version));
+    Catalog::FileMap::const_iterator it;
 
-    if (document["params"]->getType() == JSON::ARRAY)
+    for (it = files.begin(); it != files.end(); ++it)
     {
-        JSON::Array& params = document["params"]->toArray();
-        JSON::Array::iterator param;
-        int i = 0;
+        // keyed by the top level directory and the file name
+        std::string::size_type slash = it->first.find('/');
 
-        for (param = params.begin(); param != params.end(); ++param, ++i)
+        if (!boost::algorithm::ends_with(it->first, ".json"))
         {
-            if ((*param)->getType() == JSON::STRING)
-            {
-                isParam[(*param)->toString()] = i;
-            }
+            continue;
         }
-    }
 
-    if (document["match"]->getType() == JSON::ARRAY)
-    {
-        JSON::Array& matches = document["match"]->toArray();
-        JSON::Array::const_iterator match;
+        std::string dir = it->first.substr(0, slash);
+        std::string name = it->first.substr(slash + 1,
+            it->first.size() - slash - 1 - 5);
+
+        Snapshot::File file;
 
-        for (match = matches.begin(); match != matches.end(); ++match)
+        try
         {
-            if (checkOACMatch(oacInstance, *match, isParam))
+            // unchanged files come from the document cache or the
+            // compiled database, their rules from the current snapshot
+            file.document = getDocument(dir, name);
+
+            if (dir == "oacs")
             {
-                actionConfig.name = (*match)->toObject()["action"]->toString();
+                const Snapshot::File* previous =
+                    (current) ? current->find(dir, name) : NULL;
 
-                if ((*match)->toObject()["config"]->getType() != JSON::NULLTYPE)
+                if (previous && previous->matchIndex &&
+                    previous->matchIndex->isCompiledFrom(file.document))
                 {
-                    actionConfig.config =
-                        (*match)->toObject()["config"]->toJSON();
+                    file.matchIndex = previous->matchIndex;
+                }
+                else
+                {
+                    file.matchIndex.reset(new MatchIndex(file.document));
                 }
-
-                found = true;
-                break;
             }
         }
-    }
-
-    if (!found && document["action"]->getType() == JSON::STRING)
-    {
-        actionConfig.name = document["action"]->toString();
-
-        if (document["config"]->getType() != JSON::NULLTYPE)
+        catch (const std::exception& e)
         {
-            actionConfig.config = document["config"]->toJSON();
+            file.document.reset();
+            file.error = it->second.string() + ": " + e.what();
+
+            std::cerr << "Snapshot: " << file.error << std::endl;
         }
+
+        next->add(dir, name, file);
     }
 
-    return actionConfig;
+    boost::atomic_store(&snapshot, SnapshotPtr(next));
+
+    std::cout << "Loaded snapshot " << version << " of " <<
+        catalog.getRoot().string() << ": " << next->size() << " files in " <<
+        (IceUtil::Time::now() - start).toMilliSecondsDouble() << " ms" <<
+        std::endl;
+
+    return true;
 }
 
-PlanningSlice::ActionDefinition LTM::getAction(
+SnapshotPtr LTM::getSnapshot() const
+{
+    return boost::atomic_load(&snapshot);
+}
+
+void LTM::getScenario_async(
+    const LTMSlice::AMD_LTM_getScenarioPtr& callback,
+    const std::string& name,
+    const Ice::Current& c)
+{
+    dispatch(makeRequest(this, &LTM::getScenario, callback, name, c),
+        isCached("scenarios", name));
+}
+
+void LTM::getAction_async(
+    const LTMSlice::AMD_LTM_getActionPtr& callback,
     const std::string& oac,
     const Ice::Current& c)
 {
-    PlanningSlice::ActionDefinition action;
+    dispatch(makeRequest(this, &LTM::getAction, callback, oac, c),
+        isCached("oacs", oac));
+}
 
-    JSON::ValuePtr value = findAndParseFile("oacs", oac);
+void LTM::getActionConfig_async(
+    const LTMSlice::AMD_LTM_getActionConfigPtr& callback,
+    const LTMSlice::OAC& oacInstance,
+    const Ice::Current& c)
+{
+    dispatch(makeRequest(this, &LTM::getActionConfig, callback, oacInstance,
+        c), isCached("oacs", oacInstance.name));
+}
 
-    if (value->getType() != JSON::OBJECT)
+void LTM::getActions_async(
+    const LTMSlice::AMD_LTM_getActionsPtr& callback,
+    const LTMSlice::NameList& oacs,
+    const Ice::Current& c)
+{
+    bool cached = true;
+    LTMSlice::NameList::const_iterator it;
+
+    for (it = oacs.begin(); cached && it != oacs.end(); ++it)
     {
-        throw Exception(std::string("OAC ") + oac +
-            " is not a JSON object");
+        cached = isCached("oacs", *it);
     }
 
-    JSON::Object& document = value->toObject();
+    dispatch(makeRequest(this, &LTM::getActions, callback, oacs, c), cached);
+}
+
+void LTM::getActionConfigs_async(
+    const LTMSlice::AMD_LTM_getActionConfigsPtr& callback,
+    const LTMSlice::OACList& oacInstances,
+    const Ice::Current& c)
+{
+    bool cached = true;
+    LTMSlice::OACList::const_iterator it;
 
-    action.name = document["name"]->toString();
+    for (it = oacInstances.begin(); cached && it != oacInstances.end(); ++it)
+    {
+        cached = isCached("oacs", it->name);
+    }
 
-    if (document["precondition"]->getType() == JSON::STRING)
+    dispatch(makeRequest(this, &LTM::getActionConfigs, callback,
+        oacInstances, c), cached);
+}
+
+void LTM::getVersion_async(
+    const LTMSlice::AMD_LTM_getVersionPtr& callback,
+    const Ice::Current& c)
+{
+    // the catalog only has to be built once, which is cheap enough to
+    // answer on the dispatch thread, a snapshot knows its version
+    try
     {
-        action.precondition = document["precondition"]->toString();
+        callback->ice_response(getVersion(c));
     }
-    if (document["effect"]->getType() == JSON::STRING)
+    catch (const std::exception& e)
     {
-        action.effect = document["effect"]->toString();
+        callback->ice_exception(e);
     }
+    catch (...)
+    {
+        callback->ice_exception();
+    }
+}
 
-    if (document["params"]->getType() == JSON::ARRAY)
+void LTM::dispatch(const WorkItemPtr& request, bool cached)
+{
+    if (cached || !workQueue)
     {
-        JSON::Array& array = document["params"]->toArray();
-        JSON::Array::const_iterator it;
+        request->execute();
+    }
+    else
+    {
+        workQueue->add(request);
+    }
+}
 
-        for (it = array.begin(); it != array.end(); ++it)
-        {
-            PlanningSlice::ActionParameter p;
-            p.name = (*it)->toString();
+bool LTM::isCached(const std::string& dir, const std::string& name)
+{
+    if (getSnapshot())
+    {
+        return true;
+    }
 
-            action.parameters.push_back(p);
-        }
+    CompiledDatabase::Record record;
+
+    if (database && database->find(dir, name + ".json", record))
+    {
+        return true;
     }
 
-    return action;
+    fs::path path;
+
+    return catalog.findIndexed(dir, name + ".json", path) &&
+        cache.contains(path);
 }
 
-std::vector<std::string> LTM::vectorFromArray(JSON::ValuePtr value)
+Ice::Long LTM::getVersion(const Ice::Current& c)
 {
-    std::vector<std::string> result;
+    SnapshotPtr current = getSnapshot();
 
-    if (value->getType() == JSON::ARRAY)
+    if (current)
     {
-        JSON::Array& array = value->toArray();
-        JSON::Array::const_iterator it;
-
-        for (it = array.begin(); it != array.end(); ++it)
-        {
-            result.push_back((*it)->toString());
-        }
+        return static_cast<Ice::Long>(current->getVersion());
     }
 
-    return result;
+    return static_cast<Ice::Long>(getDatabaseVersion());
 }
 
-std::map<std::string, std::string> LTM::mapFromObject(JSON::ValuePtr value)
+uint64_t LTM::getDatabaseVersion()
 {
-    std::map<std::string, std::string> result;
+    // a restarted server or another compiled database give a new version
+    // even if no file has changed since, the parts wrap around
+    uint64_t version = startTime;
 
-    if (value->getType() == JSON::OBJECT)
+    if (database)
     {
-        JSON::Object& object = value->toObject();
-        JSON::Object::const_iterator it;
+        version ^= database->getVersion();
+    }
+
+    return version + catalog.getGeneration();
+}
+
+LTMSlice::Scenario LTM::getScenario(
+    const std::string& name,
+    const Ice::Current& c)
+{
+    // the document is decoded straight into the scenario, see Mappings.h
+    LTMSlice::Scenario scenario;
+    JSON::Binding<LTMSlice::Scenario> binding(scenario);
+    CompiledDatabase::Record record;
+    SnapshotPtr current = getSnapshot();
 
-        for (it = object.begin(); it != object.end(); ++it)
+    try
+    {
+        if (current)
         {
-            result[it->first.getString()->toString()] = it->second->toString();
+            getFile(current, "scenarios", name).document->getRoot().emit(
+                binding);
+        }
+        else if (database &&
+            database->find("scenarios", name + ".json", record))
+        {
+            JSON::BinaryReader reader(binding);
+            reader.read(record.data, record.length);
+        }
+        else
+        {
+            getDocument("scenarios", name)->getRoot().emit(binding);
         }
     }
+    catch (const JSON::BindingException& e)
+    {
+        throw Exception(std::string("Scenario ") + name + ": " +
+            e.getMessage());
+    }
 
-    return result;
+    return scenario;
 }
 
-bool LTM::checkOACMatch(
-    const LTMSlice::OAC& oac,
-    JSON::ValuePtr match,
-    const std::map<std::string, int>& isParam)
+LTMSlice::ActionConfig LTM::getActionConfig(
+    const LTMSlice::OAC& oacInstance,
+    const Ice::Current& c)
 {
-    if (match->getType() != JSON::OBJECT)
+    SnapshotPtr current = getSnapshot();
+
+    if (current)
     {
-        return false;
+        Snapshot::File file = getFile(current, "oacs", oacInstance.name);
+
+        return selectActionConfig(oacInstance, file.document,
+            *file.matchIndex);
     }
 
-    JSON::Object& object = match->toObject();
-    JSON::Object::const_iterator it;
-    std::map<std::string, int>::const_iterator param;
+    ConstDocumentPtr file = getDocument("oacs", oacInstance.name);
+
+    return selectActionConfig(oacInstance, file,
+        *getMatchIndex(oacInstance.name, file));
+}
 
-    for (it = object.begin(); it != object.end(); ++it)
+LTMSlice::ActionConfigList LTM::getActionConfigs(
+    const LTMSlice::OACList& oacInstances,
+    const Ice::Current& c)
+{
+    LTMSlice::ActionConfigList actionConfigs;
+    actionConfigs.reserve(oacInstances.size());
+
+    // all instances are answered from the same snapshot
+    SnapshotPtr current = getSnapshot();
+
+    // instances of the same OAC share one lookup of its file and rules
+    typedef std::map<std::string, std::pair<ConstDocumentPtr, MatchIndexPtr> >
+        FileMap;
+    FileMap files;
+
+    LTMSlice::OACList::const_iterator it;
+
+    for (it = oacInstances.begin(); it != oacInstances.end(); ++it)
     {
-        param = isParam.find(it->first.getString()->toString());
-        if (param == isParam.end())
+        if (current)
         {
-            return false;
+            Snapshot::File file = getFile(current, "oacs", it->name);
+
+            actionConfigs.push_back(selectActionConfig(*it, file.document,
+                *file.matchIndex));
+            continue;
         }
 
-        size_t offset = param->second;
+        FileMap::iterator file = files.find(it->name);
 
-        if (offset >= oac.objects.size())
+        if (file == files.end())
         {
-            return false;
+            ConstDocumentPtr document = getDocument("oacs", it->name);
+            file = files.insert(FileMap::value_type(it->name,
+                std::make_pair(document, getMatchIndex(it->name, document)))).first;
         }
 
-        LTMSlice::Obj obj = oac.objects[offset];
+        actionConfigs.push_back(selectActionConfig(*it, file->second.first,
+            *file->second.second));
+    }
 
-        if (it->second->getType() == JSON::STRING)
+    return actionConfigs;
+}
+
+LTMSlice::ActionConfig LTM::selectActionConfig(
+    const LTMSlice::OAC& oacInstance,
+    const ConstDocumentPtr& file,
+    const MatchIndex& index)
+{
+    bool found = false;
+    LTMSlice::ActionConfig actionConfig;
+
+    // only a few fields are read, a text config is passed on as it is
+    // written in the file, so nothing else has to be converted
+    if (file->getRoot().getType() != JSON::OBJECT)
+    {
+        throw Exception(std::string("OAC ") + oacInstance.name +
+            " is not a JSON object");
+    }
+
+    const JSON::DocumentObject& document = file->getRoot().toObject();
+    const JSON::DocumentObject* match = index.find(oacInstance);
+
+    if (match)
+    {
+        actionConfig.name = (*match)[actionKey]->toString();
+
+        if ((*match)[configKey]->getType() != JSON::NULLTYPE)
         {
-            if (it->second->toString() != obj.id)
-            {
-                return false;
-            }
+            encodeConfig(*(*match)[configKey], actionConfig.config);
         }
-        else if (it->second->getType() == JSON::OBJECT)
+
+        found = true;
+    }
+
+    if (!found && document[actionKey]->getType() == JSON::STRING)
+    {
+        actionConfig.name = document[actionKey]->toString();
+
+        if (document[configKey]->getType() != JSON::NULLTYPE)
         {
-            if (!checkObjectMatch(obj, it->second->toObject()))
-            {
-                return false;
-            }
+            encodeConfig(*document[configKey], actionConfig.config);
         }
     }
 
-    return true;
+    return actionConfig;
+}
+
+PlanningSlice::ActionDefinition LTM::getAction(
+    const std::string& oac,
+    const Ice::Current& c)
+{
+    return readAction(getSnapshot(), oac);
 }
 
-bool LTM::checkObjectMatch(
-    const LTMSlice::Obj& object,
-    const JSON::Object& match)
+PlanningSlice::ActionDefinition LTM::readAction(
+    const SnapshotPtr& current,
+    const std::string& oac)
 {
-    JSON::Object::const_iterator it;
+    // only a few fields are needed, everything else in the file is skipped
+    PlanningSlice::ActionDefinition action;
+    JSON::Binding<PlanningSlice::ActionDefinition> binding(action);
+    CompiledDatabase::Record record;
 
-    for (it = match.begin(); it != match.end(); ++it)
+    try
     {
-        LTMSlice::PropertyMap::const_iterator prop =
-            object.properties.find(it->first.getString()->toString());
-
-        if (prop == object.properties.end())
+        if (current)
         {
-            return false;
+            getFile(current, "oacs", oac).document->getRoot().emit(binding);
         }
-
-        if (it->second->getType() == JSON::STRING)
+        else if (database && database->find("oacs", oac + ".json", record))
         {
-            if (prop->second !=
-                std::string("\"") + it->second->toString() + "\"")
-            {
-                return false;
-            }
+            JSON::BinaryReader reader(binding);
+            reader.read(record.data, record.length);
         }
-        /*else if (it->second->getType() == JSON::NUMBER)
+        else
         {
-        }*/
+            getDocument("oacs", oac)->getRoot().emit(binding);
+        }
+    }
+    catch (const JSON::BindingException& e)
+    {
+        throw Exception(std::string("OAC ") + oac + ": " + e.getMessage());
     }
 
-    return true;
+    return action;
+}
+
+PlanningSlice::ActionDefinitionList LTM::getActions(
+    const LTMSlice::NameList& oacs,
+    const Ice::Current& c)
+{
+    PlanningSlice::ActionDefinitionList actions;
+    actions.reserve(oacs.size());
+
+    // all definitions are read from the same snapshot
+    SnapshotPtr current = getSnapshot();
+    LTMSlice::NameList::const_iterator it;
+
+    for (it = oacs.begin(); it != oacs.end(); ++it)
+    {
+        actions.push_back(readAction(current, *it));
+    }
+
+    return actions;
 }
 
-JSON::ValuePtr LTM::findAndParseFile(
+void LTM::encodeConfig(
+    const JSON::DocumentValue& config,
+    std::string& data)
+{
+    if (configFormat == JSON::CODEC_BINARY)
+    {
+        JSON::Codec::encode(config, JSON::CODEC_BINARY, data);
+    }
+    else
+    {
+        data = config.toRawJSON();
+    }
+}
+
+Snapshot::File LTM::getFile(
+    const SnapshotPtr& current,
     const std::string& dir,
     const std::string& name)
 {
-    JSON::ValuePtr result(new JSON::Value);
+    const Snapshot::File* file = current->find(dir, name);
 
-    const char* home = getenv("MCAPROJECTHOME");
+    if (file && file->document)
+    {
+        return *file;
+    }
 
-    if (home == NULL)
+    Snapshot::File read;
+    read.document = getDocument(dir, name);
+
+    if (dir == "oacs")
     {
-        home = "./";
+        read.matchIndex = getMatchIndex(name, read.document);
     }
 
-    fs::path base(home);
-    base /= "cognition/memory/ltm_db";
-    base /= dir;
+    ReloaderPtr running;
 
-    fs::path path;
+    {
+        IceUtil::Mutex::Lock lock(reloaderMutex);
+        running = reloader;
+    }
 
-    if (findFile(base, name + ".json", path))
+    if (running)
     {
-        std::cout << "Reading file: " << path.string() << std::endl;
-        JSON::Parser jsonParser;
-        result = jsonParser.readFromFile(path.string());
+        running->wake();
     }
-    else
+
+    return read;
+}
+
+ConstDocumentPtr LTM::getDocument(
+    const std::string& dir,
+    const std::string& name)
+{
+    CompiledDatabase::Record record;
+
+    if (database && database->find(dir, name + ".json", record) &&
+        record.document)
+    {
+        return cache.get(std::string(record.path, record.pathLength),
+            record.document, record.documentLength);
+    }
+
+    return cache.get(findPath(dir, name));
+}
+
+MatchIndexPtr LTM::getMatchIndex(
+    const std::string& oac,
+    const ConstDocumentPtr& document)
+{
+    IceUtil::Mutex::Lock lock(matchIndexMutex);
+
+    MatchIndexPtr& index = matchIndexes[oac];
+
+    if (!index || !index->isCompiledFrom(document))
+    {
+        index.reset(new MatchIndex(document));
+    }
+
+    return index;
+}
+
+fs::path LTM::findPath(
+    const std::string& dir,
+    const std::string& name)
+{
+    fs::path path;
+
+    if (!catalog.find(dir, name + ".json", path))
     {
         throw Exception(std::string("Could not find file ") + name + ".json" +
-            " in " + base.string());
+            " in " + (catalog.getRoot() / dir).string());
     }
 
-    return result;
+    return path;
 }
 
-bool LTM::findFile(
-    const fs::path& dirPath,
-    const std::string& fileName,
-    fs::path& pathFound)
+fs::path LTM::getDatabasePath()
 {
-    if (!fs::exists(dirPath))
+    const char* home = getenv("MCAPROJECTHOME");
+
+    if (home == NULL)
     {
-        return false;
+        home = "./";
     }
 
-    fs::directory_iterator endItr;
+    fs::path base(home);
+    base /= "cognition/memory/ltm_db";
+
+    return base;
+}
+
+fs::path LTM::getCompiledDatabasePath()
+{
+    return getDatabasePath().string() + ".bin";
+}
+
+LTM::Reloader::Reloader(LTM& ltm, const IceUtil::Time& interval) :
+    ltm(ltm),
+    interval(interval),
+    destroyed(false),
+    woken(false)
+{
+}
+
+void LTM::Reloader::run()
+{
+    IceUtil::Monitor<IceUtil::Mutex>::Lock lock(monitor);
 
-    for (fs::directory_iterator itr(dirPath); itr != endItr; ++itr)
+    while (!destroyed)
     {
-        if (fs::is_directory(itr->status()))
+        woken = false;
+
+        // requests waking the thread are not held up by a reload
+        lock.release();
+
+        try
         {
-            if (findFile(itr->path(), fileName, pathFound))
-            {
-                return true;
-            }
+            ltm.reload();
         }
-        else if (itr->leaf() == fileName)
+        catch (const std::exception& e)
         {
-            pathFound = itr->path();
-            return true;
+            // the current snapshot is kept
+            std::cerr << "Reloading the LTM failed: " << e.what() <<
+                std::endl;
+        }
+
+        lock.acquire();
+
+        if (!destroyed && !woken)
+        {
+            monitor.timedWait(interval);
         }
     }
+}
 
-    return false;
+void LTM::Reloader::wake()
+{
+    IceUtil::Monitor<IceUtil::Mutex>::Lock lock(monitor);
+
+    woken = true;
+    monitor.notify();
 }
 
+void LTM::Reloader::destroy()
+{
+    IceUtil::Monitor<IceUtil::Mutex>::Lock lock(monitor);
 
+    destroyed = true;
+    monitor.notify();
+}
@@ -25,19 +25,138 @@
 #define SPOAC_LTM_LTM_H
 
 #include <spoac/LTM.h>
+#include <spoac/ltm/Catalog.h>
+#include <spoac/ltm/CompiledDatabase.h>
+#include <spoac/ltm/DocumentCache.h>
+#include <spoac/ltm/MatchIndex.h>
+#include <spoac/ltm/Snapshot.h>
+#include <spoac/ltm/WorkQueue.h>
 #include <spoac/JSON/Parser.h>
+#include <spoac/JSON/Document.h>
+#include <spoac/JSON/Codec.h>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/filesystem.hpp>
+#include <IceUtil/Monitor.h>
+#include <IceUtil/Thread.h>
 
 namespace spoac
 {
     /**
     * Representation of the robot's short term memory.
+    *
+    * Requests are dispatched asynchronously. Those which can be answered
+    * from the document cache are answered on the Ice dispatch thread,
+    * all others are handed to the work queue, if there is one, so a slow
+    * file read does not hold up lookups of cached files.
+    *
+    * Once reloading has been started, the whole database is loaded into
+    * a snapshot, from which all requests are answered without reading
+    * any file. Changes to the database are loaded into a new snapshot in
+    * the background, which replaces the current one when it is complete,
+    * so every request sees either the old or the new database, never a
+    * mix of both.
     */
     class LTM : public LTMSlice::LTM
     {
     public:
+        /**
+        * Creates the long term memory.
+        *
+        * @param configFormat Encoding of the action configs returned by
+        *                     getActionConfig(). Binary configs save the
+        *                     OAC parsing them, both are decoded by
+        *                     JSON::Codec::decode().
+        * @param cacheSize    Memory in bytes parsed files may take up in
+        *                     the document cache, 0 disables it.
+        * @param workQueue    Threads reading and parsing files, without a
+        *                     queue every request is answered on the
+        *                     dispatch thread. It has to be destroyed
+        *                     before the LTM.
+        * @param compiledPath A database compiled by ltmcompile, which is
+        *                     used for all files which have not changed
+        *                     since. Without one, or if it cannot be read,
+        *                     all files are read from the database
+        *                     directory.
+        */
+        LTM(JSON::CodecFormat configFormat = JSON::CODEC_TEXT,
+            size_t cacheSize = 64 * 1024 * 1024,
+            WorkQueuePtr workQueue = WorkQueuePtr(),
+            const boost::filesystem::path& compiledPath =
+                boost::filesystem::path());
+
+        /**
+        * Stops reloading.
+        */
+        ~LTM();
+
+        /**
+        * Loads the database into a snapshot and keeps loading it again on
+        * a separate thread whenever it has changed. Requests are answered
+        * by reading files until the first snapshot has been loaded.
+        *
+        * Changes are noticed through the inotify events of the catalog.
+        * Changes it cannot report, such as those made by other clients of
+        * a network filesystem, are found by comparing the stat data of
+        * all files, which is only done every stat interval unless inotify
+        * does not watch the whole database.
+        *
+        * @param interval     Time between checks for changes.
+        * @param statInterval Time between checks of the stat data.
+        */
+        void startReloading(
+            const IceUtil::Time& interval,
+            const IceUtil::Time& statInterval = IceUtil::Time::seconds(60));
+
+        /**
+        * Stops the reloading thread, the current snapshot is kept.
+        */
+        void stopReloading();
+
+        /**
+        * Loads the database into a new snapshot and makes it the current
+        * one, unless the database has not changed since the current one
+        * was loaded.
+        *
+        * @return Whether a new snapshot has been loaded.
+        */
+        bool reload();
+
+        /**
+        * @return The snapshot requests are answered from, NULL if there
+        *         is none.
+        */
+        SnapshotPtr getSnapshot() const;
+
+        void getScenario_async(
+            const LTMSlice::AMD_LTM_getScenarioPtr& callback,
+            const std::string& name,
+            const Ice::Current& c);
+
+        void getAction_async(
+            const LTMSlice::AMD_LTM_getActionPtr& callback,
+            const std::string& oac,
+            const Ice::Current& c);
+
+        void getActionConfig_async(
+            const LTMSlice::AMD_LTM_getActionConfigPtr& callback,
+            const LTMSlice::OAC& oacInstance,
+            const Ice::Current& c);
+
+        void getActions_async(
+            const LTMSlice::AMD_LTM_getActionsPtr& callback,
+            const LTMSlice::NameList& oacs,
+            const Ice::Current& c);
+
+        void getActionConfigs_async(
+            const LTMSlice::AMD_LTM_getActionConfigsPtr& callback,
+            const LTMSlice::OACList& oacInstances,
+            const Ice::Current& c);
+
+        void getVersion_async(
+            const LTMSlice::AMD_LTM_getVersionPtr& callback,
+            const Ice::Current& c);
+
         /**
         * Retrieves a scenario definition from the filesystem
         */
@@ -60,27 +179,171 @@ namespace spoac
             const LTMSlice::OAC& oacInstance,
             const Ice::Current& c);
 
-        bool checkOACMatch(
-            const LTMSlice::OAC& oac,
-            JSON::ValuePtr match,
-            const std::map<std::string, int>& isParam);
+        /**
+        * Retrieves the action definitions of several OACs in one call.
+        */
+        PlanningSlice::ActionDefinitionList getActions(
+            const LTMSlice::NameList& oacs,
+            const Ice::Current& c);
 
-        bool checkObjectMatch(
-            const LTMSlice::Obj& object,
-            const JSON::Object& match);
+        /**
+        * Retrieves the action configurations of several OAC instances in
+        * one call, reading the file of each OAC only once.
+        */
+        LTMSlice::ActionConfigList getActionConfigs(
+            const LTMSlice::OACList& oacInstances,
+            const Ice::Current& c);
+
+        /**
+        * @return A version of the database, which changes whenever a file
+        *         has been written, added or removed, and when the server
+        *         is restarted. With a snapshot it is the version of the
+        *         snapshot.
+        */
+        Ice::Long getVersion(const Ice::Current& c);
+
+        /**
+        * @return The database directory below MCAPROJECTHOME.
+        */
+        static boost::filesystem::path getDatabasePath();
+
+        /**
+        * @return The default path of the compiled database, next to the
+        *         database directory.
+        */
+        static boost::filesystem::path getCompiledDatabasePath();
 
     protected:
-        std::vector<std::string> vectorFromArray(JSON::ValuePtr value);
-        std::map<std::string, std::string> mapFromObject(JSON::ValuePtr value);
+        /**
+        * Checks for changes of the database on a separate thread.
+        */
+        class Reloader : public IceUtil::Thread
+        {
+        public:
+            Reloader(LTM& ltm, const IceUtil::Time& interval);
+            virtual void run();
+
+            /**
+            * Reloads right away, or once more after a reload in progress.
+            */
+            void wake();
+
+            /**
+            * Lets the thread return once a reload in progress is done.
+            */
+            void destroy();
+
+        protected:
+            LTM& ltm;
+            IceUtil::Time interval;
+            bool destroyed;
+            bool woken;
 
-        JSON::ValuePtr findAndParseFile(
+            IceUtil::Monitor<IceUtil::Mutex> monitor;
+        };
+
+        typedef IceUtil::Handle<Reloader> ReloaderPtr;
+
+        /**
+        * @return The version of the files currently in the database.
+        */
+        uint64_t getDatabaseVersion();
+
+        /**
+        * Returns a file from a snapshot. A file the snapshot lacks or
+        * could not read is read from the database instead, since it may
+        * have been added or fixed without an inotify event, and the
+        * database is reloaded.
+        */
+        Snapshot::File getFile(
+            const SnapshotPtr& current,
             const std::string& dir,
             const std::string& name);
 
-        bool findFile(
-            const boost::filesystem::path& dirPath,
-            const std::string& fileName,
-            boost::filesystem::path& pathFound);
+        /**
+        * Reads the action definition of an OAC from a snapshot if there
+        * is one, from the database otherwise.
+        */
+        PlanningSlice::ActionDefinition readAction(
+            const SnapshotPtr& current,
+            const std::string& oac);
+
+        /**
+        * Executes a request right away if all files it needs are cached
+        * or there is no work queue, queues it otherwise.
+        */
+        void dispatch(const WorkItemPtr& request, bool cached);
+
+        /**
+        * Checks whether a file can be read from the document cache
+        * without touching the filesystem beyond a stat.
+        */
+        bool isCached(const std::string& dir, const std::string& name);
+
+        /**
+        * Picks the action config of an OAC instance from its file.
+        */
+        LTMSlice::ActionConfig selectActionConfig(
+            const LTMSlice::OAC& oacInstance,
+            const ConstDocumentPtr& file,
+            const MatchIndex& index);
+
+        /**
+        * Encodes an action config in the configured format.
+        */
+        void encodeConfig(
+            const JSON::DocumentValue& config,
+            std::string& data);
+
+        /**
+        * Returns the parsed contents of a file from the document cache,
+        * which avoids an allocation per value and reading the file again
+        * for later requests. OACs in the compiled database are decoded
+        * from their record instead of being parsed.
+        */
+        ConstDocumentPtr getDocument(
+            const std::string& dir,
+            const std::string& name);
+
+        /**
+        * Returns the compiled match rules of an OAC file, compiling them
+        * again whenever the file has been read again.
+        */
+        MatchIndexPtr getMatchIndex(
+            const std::string& oac,
+            const ConstDocumentPtr& document);
+
+        boost::filesystem::path findPath(
+            const std::string& dir,
+            const std::string& name);
+
+        JSON::CodecFormat configFormat;
+        Catalog catalog;
+        DocumentCache cache;
+        WorkQueuePtr workQueue;
+        uint64_t startTime;
+
+        CompiledDatabasePtr database;
+
+        std::map<std::string, MatchIndexPtr> matchIndexes;
+        IceUtil::Mutex matchIndexMutex;
+
+        // only accessed with boost::atomic_load() and atomic_store()
+        SnapshotPtr snapshot;
+
+        // held while a snapshot is loaded
+        IceUtil::Mutex reloadMutex;
+
+        // the stat data of all files at the last check, guarded by the
+        // reload mutex
+        uint64_t statVersion;
+        IceUtil::Time lastStatCheck;
+        IceUtil::Time statInterval;
+
+        // the reloader is woken by requests while it may be stopped
+        ReloaderPtr reloader;
+        IceUtil::Mutex reloaderMutex;
+        IceUtil::ThreadControl reloaderThread;
     };
 
     /**
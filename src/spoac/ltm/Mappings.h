@@ -0,0 +1,108 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#ifndef SPOAC_LTM_MAPPINGS_H
+#define SPOAC_LTM_MAPPINGS_H
+
+#include <spoac/LTM.h>
+#include <spoac/JSON/Binding.h>
+
+/**
+* Declares how the scenario and OAC files on disk map to the Slice structs
+* the LTM returns, so they can be bound while the files are parsed.
+* Members of the files which are not listed are skipped.
+*/
+namespace JSON
+{
+    template <>
+    struct Mapping<spoac::PlanningSlice::PredicateDefinition>
+    {
+        static void describe(
+            FieldList<spoac::PlanningSlice::PredicateDefinition>& fields)
+        {
+            typedef spoac::PlanningSlice::PredicateDefinition T;
+            fields.add("name", &T::name, BIND_REQUIRED);
+            fields.add("arguments", &T::arguments, BIND_REQUIRED);
+        }
+    };
+
+    template <>
+    struct Mapping<spoac::PlanningSlice::FunctionDefinition>
+    {
+        static void describe(
+            FieldList<spoac::PlanningSlice::FunctionDefinition>& fields)
+        {
+            typedef spoac::PlanningSlice::FunctionDefinition T;
+            fields.add("name", &T::name, BIND_REQUIRED);
+            fields.add("arguments", &T::arguments, BIND_REQUIRED);
+        }
+    };
+
+    template <>
+    struct Mapping<spoac::LTMSlice::Scenario>
+    {
+        static void describe(FieldList<spoac::LTMSlice::Scenario>& fields)
+        {
+            typedef spoac::LTMSlice::Scenario T;
+            fields.add("name", &T::name, BIND_REQUIRED);
+            fields.add("activityControllers", &T::activityControllers);
+            fields.add("perceptionHandlers", &T::perceptionHandlers);
+            fields.add("oacs", &T::oacs);
+            fields.add("predicates", &T::predicates);
+            fields.add("functions", &T::functions);
+            fields.add("goals", &T::goals);
+        }
+    };
+
+    /**
+    * OAC files list parameters by name only, e.g. "params": ["x", "y"].
+    */
+    template <>
+    struct Mapping<spoac::PlanningSlice::ActionParameter>
+    {
+        static void describe(
+            FieldList<spoac::PlanningSlice::ActionParameter>& fields)
+        {
+            typedef spoac::PlanningSlice::ActionParameter T;
+            fields.add("name", &T::name, BIND_REQUIRED);
+            fields.add("type", &T::type);
+            fields.setShorthand(&T::name);
+        }
+    };
+
+    template <>
+    struct Mapping<spoac::PlanningSlice::ActionDefinition>
+    {
+        static void describe(
+            FieldList<spoac::PlanningSlice::ActionDefinition>& fields)
+        {
+            typedef spoac::PlanningSlice::ActionDefinition T;
+            fields.add("name", &T::name, BIND_REQUIRED);
+            fields.add("params", &T::parameters);
+            fields.add("precondition", &T::precondition);
+            fields.add("effect", &T::effect);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,375 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#include <spoac/ltm/MatchIndex.h>
+#include <spoac/JSON/BinaryReader.h>
+#include <spoac/JSON/Codec.h>
+#include <spoac/JSON/NumberConversion.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+using namespace spoac;
+
+// member names looked up in every file, interned once
+static const JSON::Identifier paramsKey("params");
+static const JSON::Identifier matchKey("match");
+
+// whether a key of a rule is one of the members which are not parameters
+static bool isReserved(const JSON::DocumentValue& key)
+{
+    return (key.length() == 6 && memcmp(key.data(), "action", 6) == 0) ||
+        (key.length() == 6 && memcmp(key.data(), "config", 6) == 0);
+}
+
+// reads a numeric property, text is parsed in place instead of being
+// decoded to a Value
+static bool parseNumber(const std::string& property, double& number)
+{
+    if (JSON::BinaryReader::isBinary(property))
+    {
+        try
+        {
+            JSON::ValuePtr value = JSON::Codec::decode(property);
+
+            if (value->getType() != JSON::NUMBER)
+            {
+                return false;
+            }
+
+            number = value->toDouble();
+            return true;
+        }
+        catch (const JSON::Exception&)
+        {
+            return false;
+        }
+    }
+
+    const char* begin = property.data();
+    const char* end = begin + property.size();
+
+    while (begin != end && isspace(static_cast<unsigned char>(*begin)))
+    {
+        ++begin;
+    }
+
+    while (end != begin && isspace(static_cast<unsigned char>(end[-1])))
+    {
+        --end;
+    }
+
+    int64_t intValue;
+    bool isDouble;
+
+    return JSON::NumberConversion::parse(begin, end - begin, intValue,
+        number, isDouble);
+}
+
+MatchIndex::MatchIndex(const ConstDocumentPtr& document) :
+    document(document)
+{
+    if (document->getRoot().getType() != JSON::OBJECT)
+    {
+        return;
+    }
+
+    const JSON::DocumentObject& file = document->getRoot().toObject();
+    std::map<std::string, size_t> params;
+
+    if (file[paramsKey]->getType() == JSON::ARRAY)
+    {
+        const JSON::DocumentArray& array = file[paramsKey]->toArray();
+
+        for (size_t i = 0; i < array.size(); i++)
+        {
+            if (array[i]->getType() == JSON::STRING)
+            {
+                params[array[i]->toString()] = i;
+            }
+        }
+    }
+
+    if (file[matchKey]->getType() == JSON::ARRAY)
+    {
+        const JSON::DocumentArray& matches = file[matchKey]->toArray();
+        JSON::DocumentArray::const_iterator match;
+
+        for (match = matches.begin(); match != matches.end(); ++match)
+        {
+            if ((*match)->getType() == JSON::OBJECT)
+            {
+                compile((*match)->toObject(), params);
+            }
+        }
+    }
+}
+
+const JSON::DocumentObject* MatchIndex::find(const LTMSlice::OAC& oac) const
+{
+    std::vector<size_t> indexed;
+
+    for (size_t i = 0; i < idIndexes.size(); i++)
+    {
+        const IdIndex& index = idIndexes[i];
+
+        if (index.param >= oac.objects.size())
+        {
+            continue;
+        }
+
+        IdMap::const_iterator it = index.rules.find(oac.objects[index.param].id);
+
+        if (it != index.rules.end())
+        {
+            indexed.insert(indexed.end(), it->second.begin(), it->second.end());
+        }
+    }
+
+    // every rule is in at most one list, so the candidates only have to
+    // be checked in the order of the file
+    std::sort(indexed.begin(), indexed.end());
+
+    std::vector<size_t>::const_iterator nextIndexed = indexed.begin();
+    std::vector<size_t>::const_iterator nextUnindexed = unindexed.begin();
+    NumberMap numbers;
+
+    while (nextIndexed != indexed.end() || nextUnindexed != unindexed.end())
+    {
+        size_t rule;
+
+        if (nextUnindexed == unindexed.end() ||
+            (nextIndexed != indexed.end() && *nextIndexed < *nextUnindexed))
+        {
+            rule = *nextIndexed++;
+        }
+        else
+        {
+            rule = *nextUnindexed++;
+        }
+
+        if (matches(rules[rule], oac, numbers))
+        {
+            return rules[rule].object;
+        }
+    }
+
+    return NULL;
+}
+
+bool MatchIndex::isCompiledFrom(const ConstDocumentPtr& document) const
+{
+    return this->document.lock() == document;
+}
+
+size_t MatchIndex::size() const
+{
+    return rules.size();
+}
+
+void MatchIndex::compile(
+    const JSON::DocumentObject& object,
+    const std::map<std::string, size_t>& params)
+{
+    Rule rule;
+    rule.object = &object;
+
+    JSON::DocumentObject::const_iterator it;
+
+    for (it = object.begin(); it != object.end(); ++it)
+    {
+        if (it->first->getType() != JSON::STRING)
+        {
+            return;
+        }
+
+        if (isReserved(*it->first))
+        {
+            continue;
+        }
+
+        // rules naming something other than a parameter never match
+        std::map<std::string, size_t>::const_iterator param =
+            params.find(it->first->toString());
+
+        if (param == params.end())
+        {
+            return;
+        }
+
+        ParameterCondition condition;
+        condition.param = param->second;
+        condition.byId = (it->second->getType() == JSON::STRING);
+
+        if (condition.byId)
+        {
+            condition.id = it->second->toString();
+        }
+        else if (it->second->getType() == JSON::OBJECT)
+        {
+            const JSON::DocumentObject& match = it->second->toObject();
+            JSON::DocumentObject::const_iterator property;
+
+            for (property = match.begin(); property != match.end(); ++property)
+            {
+                if (property->first->getType() != JSON::STRING)
+                {
+                    return;
+                }
+
+                PropertyCondition propertyCondition;
+                const JSON::DocumentValue& value = *property->second;
+
+                propertyCondition.name = property->first->toString();
+                propertyCondition.type = value.getType();
+                propertyCondition.number = 0;
+
+                if (value.getType() == JSON::NUMBER)
+                {
+                    propertyCondition.number = value.toDouble();
+                }
+                else if (value.getType() != JSON::ARRAY &&
+                    value.getType() != JSON::OBJECT)
+                {
+                    JSON::Codec::encode(value, JSON::CODEC_TEXT,
+                        propertyCondition.text);
+                    JSON::Codec::encode(value, JSON::CODEC_BINARY,
+                        propertyCondition.binary);
+                }
+
+                condition.properties.push_back(propertyCondition);
+            }
+        }
+
+        rule.conditions.push_back(condition);
+    }
+
+    size_t index = rules.size();
+    rules.push_back(rule);
+
+    for (size_t i = 0; i < rule.conditions.size(); i++)
+    {
+        const ParameterCondition& condition = rule.conditions[i];
+
+        if (!condition.byId)
+        {
+            continue;
+        }
+
+        // indexed by the first id it requires
+        size_t j = 0;
+
+        while (j < idIndexes.size() && idIndexes[j].param != condition.param)
+        {
+            j++;
+        }
+
+        if (j == idIndexes.size())
+        {
+            idIndexes.push_back(IdIndex());
+            idIndexes[j].param = condition.param;
+        }
+
+        idIndexes[j].rules[condition.id].push_back(index);
+        return;
+    }
+
+    unindexed.push_back(index);
+}
+
+bool MatchIndex::matches(
+    const Rule& rule,
+    const LTMSlice::OAC& oac,
+    NumberMap& numbers) const
+{
+    for (size_t i = 0; i < rule.conditions.size(); i++)
+    {
+        const ParameterCondition& condition = rule.conditions[i];
+
+        if (condition.param >= oac.objects.size())
+        {
+            return false;
+        }
+
+        const LTMSlice::Obj& object = oac.objects[condition.param];
+
+        if (condition.byId && object.id != condition.id)
+        {
+            return false;
+        }
+
+        for (size_t j = 0; j < condition.properties.size(); j++)
+        {
+            LTMSlice::PropertyMap::const_iterator property =
+                object.properties.find(condition.properties[j].name);
+
+            if (property == object.properties.end() ||
+                !matches(condition.properties[j], property->second, numbers))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool MatchIndex::matches(
+    const PropertyCondition& condition,
+    const std::string& property,
+    NumberMap& numbers) const
+{
+    switch (condition.type)
+    {
+        case JSON::STRING:
+        case JSON::BOOL:
+        case JSON::NULLTYPE:
+            if (JSON::BinaryReader::isBinary(property))
+            {
+                return property == condition.binary;
+            }
+
+            return property == condition.text;
+
+        case JSON::NUMBER:
+        {
+            NumberMap::iterator number = numbers.find(&property);
+
+            if (number == numbers.end())
+            {
+                std::pair<bool, double> parsed(false, 0);
+                parsed.first = parseNumber(property, parsed.second);
+
+                number = numbers.insert(
+                    NumberMap::value_type(&property, parsed)).first;
+            }
+
+            return number->second.first &&
+                number->second.second == condition.number;
+        }
+
+        default:
+            return true;
+    }
+}
@@ -0,0 +1,157 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#ifndef SPOAC_LTM_MATCHINDEX_H
+#define SPOAC_LTM_MATCHINDEX_H
+
+#include <spoac/LTM.h>
+#include <spoac/ltm/DocumentCache.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/weak_ptr.hpp>
+
+namespace spoac
+{
+    /**
+    * The match rules of an OAC file, compiled for selecting the action
+    * config of an OAC instance.
+    *
+    * Every member of a rule apart from "action" and "config" names a
+    * parameter of the OAC and matches the object passed for it, either
+    * by its id if the member is a string or by its properties if it is
+    * an object. Properties match strings, booleans and null by their
+    * encoding, which is prepared once for text and binary properties,
+    * and numbers by value. Properties matched by an array or object only
+    * have to exist.
+    *
+    * Rules matching an object by id are indexed by that id, so only
+    * those rules naming the ids of the instance and the rules without
+    * any id are checked. The first matching rule in the file wins.
+    */
+    class MatchIndex
+    {
+    public:
+        /**
+        * Compiles the rules of an OAC file.
+        */
+        MatchIndex(const ConstDocumentPtr& document);
+
+        /**
+        * Finds the first rule matching an OAC instance.
+        *
+        * @return The rule, which is part of the document the index was
+        *         compiled from, or NULL if none matches.
+        */
+        const JSON::DocumentObject* find(const LTMSlice::OAC& oac) const;
+
+        /**
+        * @return Whether the index belongs to the given document.
+        */
+        bool isCompiledFrom(const ConstDocumentPtr& document) const;
+
+        /**
+        * @return The number of rules.
+        */
+        size_t size() const;
+
+    protected:
+        struct PropertyCondition
+        {
+            std::string name;
+            JSON::ValueType type;
+
+            // the encodings of strings, booleans and null
+            std::string text;
+            std::string binary;
+
+            double number;
+        };
+
+        struct ParameterCondition
+        {
+            size_t param;
+            bool byId;
+            std::string id;
+            std::vector<PropertyCondition> properties;
+        };
+
+        struct Rule
+        {
+            const JSON::DocumentObject* object;
+            std::vector<ParameterCondition> conditions;
+        };
+
+        typedef boost::unordered_map<std::string, std::vector<size_t> > IdMap;
+
+        /**
+        * The numeric values of the properties of an instance, parsed at
+        * most once while its rules are checked, and whether they are
+        * numbers at all.
+        */
+        typedef std::map<const std::string*, std::pair<bool, double> >
+            NumberMap;
+
+        /**
+        * Rules matching a parameter by id, by the id they require.
+        */
+        struct IdIndex
+        {
+            size_t param;
+            IdMap rules;
+        };
+
+        void compile(
+            const JSON::DocumentObject& object,
+            const std::map<std::string, size_t>& params);
+
+        bool matches(
+            const Rule& rule,
+            const LTMSlice::OAC& oac,
+            NumberMap& numbers) const;
+
+        bool matches(
+            const PropertyCondition& condition,
+            const std::string& property,
+            NumberMap& numbers) const;
+
+        std::vector<Rule> rules;
+        std::vector<IdIndex> idIndexes;
+
+        // rules which do not match any object by id, in order
+        std::vector<size_t> unindexed;
+
+        boost::weak_ptr<const JSON::Document> document;
+    };
+
+    /**
+    * Pointer type to reduce typing for shared pointers.
+    */
+    typedef boost::shared_ptr<const MatchIndex> MatchIndexPtr;
+}
+
+#endif
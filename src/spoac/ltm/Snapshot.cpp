@@ -0,0 +1,63 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#include <spoac/ltm/Snapshot.h>
+
+using namespace spoac;
+
+Snapshot::Snapshot(uint64_t version) :
+    version(version)
+{
+}
+
+void Snapshot::add(
+    const std::string& dir,
+    const std::string& name,
+    const File& file)
+{
+    files[dir + "/" + name] = file;
+}
+
+const Snapshot::File* Snapshot::find(
+    const std::string& dir,
+    const std::string& name) const
+{
+    FileMap::const_iterator it = files.find(dir + "/" + name);
+
+    if (it == files.end())
+    {
+        return NULL;
+    }
+
+    return &it->second;
+}
+
+uint64_t Snapshot::getVersion() const
+{
+    return version;
+}
+
+size_t Snapshot::size() const
+{
+    return files.size();
+}
@@ -0,0 +1,112 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#ifndef SPOAC_LTM_SNAPSHOT_H
+#define SPOAC_LTM_SNAPSHOT_H
+
+#include <map>
+#include <string>
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+#include <spoac/ltm/DocumentCache.h>
+#include <spoac/ltm/MatchIndex.h>
+
+namespace spoac
+{
+    /**
+    * All files of the LTM database at one version, parsed and with the
+    * match rules of every OAC compiled.
+    *
+    * A snapshot is filled once and not modified after it has been
+    * published, so any number of requests can read it without locking.
+    * A request reads all files it needs from the same snapshot, it does
+    * not see a file changed while it is answered.
+    */
+    class Snapshot
+    {
+    public:
+        /**
+        * A file of the database. Files which could not be read have no
+        * document and an error instead.
+        */
+        struct File
+        {
+            ConstDocumentPtr document;
+
+            // only compiled for OACs
+            MatchIndexPtr matchIndex;
+
+            std::string error;
+        };
+
+        /**
+        * Creates an empty snapshot.
+        *
+        * @param version The version of the database the files are read
+        *                at.
+        */
+        Snapshot(uint64_t version);
+
+        /**
+        * Adds a file, only called before the snapshot is published.
+        *
+        * @param dir  The top level directory of the file, for example
+        *             "oacs".
+        * @param name The name of the file without the .json extension.
+        */
+        void add(
+            const std::string& dir,
+            const std::string& name,
+            const File& file);
+
+        /**
+        * @return The file or NULL if it is not part of the snapshot.
+        */
+        const File* find(
+            const std::string& dir,
+            const std::string& name) const;
+
+        uint64_t getVersion() const;
+
+        /**
+        * @return The number of files.
+        */
+        size_t size() const;
+
+    protected:
+        typedef std::map<std::string, File> FileMap;
+
+        uint64_t version;
+
+        // keyed by the directory and name separated by a slash
+        FileMap files;
+    };
+
+    /**
+    * Pointer type to reduce typing for shared pointers.
+    */
+    typedef boost::shared_ptr<const Snapshot> SnapshotPtr;
+}
+
+#endif
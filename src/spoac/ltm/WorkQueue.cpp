@@ -0,0 +1,129 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#include <spoac/ltm/WorkQueue.h>
+#include <spoac/common/Exception.h>
+
+using namespace spoac;
+
+WorkQueue::WorkQueue(size_t threadCount) :
+    destroyed(false)
+{
+    if (threadCount == 0)
+    {
+        threadCount = 1;
+    }
+
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        IceUtil::ThreadPtr worker = new Worker(*this);
+        threads.push_back(worker->start());
+    }
+}
+
+WorkQueue::~WorkQueue()
+{
+    destroy();
+}
+
+void WorkQueue::add(const WorkItemPtr& item)
+{
+    IceUtil::Monitor<IceUtil::Mutex>::Lock lock(monitor);
+
+    if (destroyed)
+    {
+        throw Exception("The work queue has been destroyed");
+    }
+
+    items.push_back(item);
+    monitor.notify();
+}
+
+void WorkQueue::destroy()
+{
+    {
+        IceUtil::Monitor<IceUtil::Mutex>::Lock lock(monitor);
+
+        if (destroyed)
+        {
+            return;
+        }
+
+        destroyed = true;
+        monitor.notifyAll();
+    }
+
+    std::vector<IceUtil::ThreadControl>::iterator it;
+
+    for (it = threads.begin(); it != threads.end(); ++it)
+    {
+        it->join();
+    }
+}
+
+size_t WorkQueue::getThreadCount() const
+{
+    return threads.size();
+}
+
+size_t WorkQueue::size()
+{
+    IceUtil::Monitor<IceUtil::Mutex>::Lock lock(monitor);
+
+    return items.size();
+}
+
+WorkItemPtr WorkQueue::next()
+{
+    IceUtil::Monitor<IceUtil::Mutex>::Lock lock(monitor);
+
+    while (items.empty() && !destroyed)
+    {
+        monitor.wait();
+    }
+
+    if (items.empty())
+    {
+        return WorkItemPtr();
+    }
+
+    WorkItemPtr item = items.front();
+    items.pop_front();
+
+    return item;
+}
+
+WorkQueue::Worker::Worker(WorkQueue& queue) :
+    queue(queue)
+{
+}
+
+void WorkQueue::Worker::run()
+{
+    WorkItemPtr item;
+
+    while ((item = queue.next()))
+    {
+        item->execute();
+    }
+}
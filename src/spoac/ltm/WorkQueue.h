@@ -0,0 +1,137 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#ifndef SPOAC_LTM_WORKQUEUE_H
+#define SPOAC_LTM_WORKQUEUE_H
+
+#include <deque>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <IceUtil/Monitor.h>
+#include <IceUtil/Mutex.h>
+#include <IceUtil/Thread.h>
+
+namespace spoac
+{
+    /**
+    * A task executed by a WorkQueue.
+    */
+    class WorkItem
+    {
+    public:
+        virtual ~WorkItem() {}
+
+        /**
+        * Does the work, called on one of the worker threads. Must not
+        * throw.
+        */
+        virtual void execute() = 0;
+    };
+
+    /**
+    * Pointer type to reduce typing for shared pointers.
+    */
+    typedef boost::shared_ptr<WorkItem> WorkItemPtr;
+
+    /**
+    * A fixed number of threads executing work items in the order they
+    * were added.
+    *
+    * The LTM server hands requests which have to read files to the queue,
+    * so the Ice dispatch threads remain free for requests answered from
+    * memory.
+    */
+    class WorkQueue
+    {
+    public:
+        /**
+        * Starts the worker threads.
+        *
+        * @param threadCount The number of worker threads, at least one
+        *                    is started.
+        */
+        WorkQueue(size_t threadCount);
+
+        /**
+        * Destroys the queue if that has not been done yet.
+        */
+        ~WorkQueue();
+
+        /**
+        * Queues an item to be executed by the next idle thread.
+        *
+        * @throws Exception if the queue has been destroyed.
+        */
+        void add(const WorkItemPtr& item);
+
+        /**
+        * Executes the remaining items and stops the worker threads.
+        */
+        void destroy();
+
+        /**
+        * @return The number of worker threads.
+        */
+        size_t getThreadCount() const;
+
+        /**
+        * @return The number of items waiting for a thread.
+        */
+        size_t size();
+
+    protected:
+        class Worker : public IceUtil::Thread
+        {
+        public:
+            Worker(WorkQueue& queue);
+            virtual void run();
+
+        protected:
+            WorkQueue& queue;
+        };
+
+        /**
+        * Waits for the next item.
+        *
+        * @return The item or NULL once the queue has been destroyed and
+        *         all items have been executed.
+        */
+        WorkItemPtr next();
+
+        std::deque<WorkItemPtr> items;
+        std::vector<IceUtil::ThreadControl> threads;
+        bool destroyed;
+
+        IceUtil::Monitor<IceUtil::Mutex> monitor;
+
+        WorkQueue(const WorkQueue&) {}; // do not allow copying
+    };
+
+    /**
+    * Pointer type to reduce typing for shared pointers.
+    */
+    typedef boost::shared_ptr<WorkQueue> WorkQueuePtr;
+}
+
+#endif
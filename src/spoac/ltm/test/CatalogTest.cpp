@@ -0,0 +1,123 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#define BOOST_TEST_MODULE spoac_LTM_Catalog
+#include <spoactest/test.h>
+#include <spoactest/TemporaryDirectory.h>
+
+#include <spoac/ltm/Catalog.h>
+
+namespace fs = boost::filesystem;
+
+struct DatabaseFixture : spoactest::TemporaryDirectory
+{
+    DatabaseFixture() : TemporaryDirectory("spoac_catalog")
+    {
+        fs::create_directories(root / "oacs" / "nested" / "deeper");
+        fs::create_directories(root / "scenarios");
+        write(root / "oacs" / "Top.json", "{}");
+        write(root / "oacs" / "nested" / "deeper" / "Deep.json", "{}");
+        write(root / "scenarios" / "abc.json", "{}");
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE(testFind, DatabaseFixture)
+{
+    spoac::Catalog catalog(root);
+    fs::path path;
+
+    BOOST_CHECK_EQUAL(3u, catalog.size());
+    BOOST_CHECK(catalog.isWatching());
+
+    BOOST_REQUIRE(catalog.find("oacs", "Deep.json", path));
+    BOOST_CHECK(path == root / "oacs" / "nested" / "deeper" / "Deep.json");
+
+    BOOST_CHECK(catalog.find("scenarios", "abc.json", path));
+    BOOST_CHECK( ! catalog.find("scenarios", "Top.json", path));
+    BOOST_CHECK( ! catalog.find("oacs", "Missing.json", path));
+}
+
+BOOST_FIXTURE_TEST_CASE(testChanges, DatabaseFixture)
+{
+    spoac::Catalog catalog(root);
+    fs::path path;
+
+    // files in new directories are found as well
+    fs::create_directories(root / "oacs" / "added");
+    write(root / "oacs" / "added" / "New.json", "{}");
+
+    BOOST_REQUIRE(catalog.find("oacs", "New.json", path));
+    BOOST_CHECK(path == root / "oacs" / "added" / "New.json");
+    BOOST_CHECK_EQUAL(4u, catalog.size());
+
+    fs::rename(root / "oacs" / "nested", root / "oacs" / "moved");
+
+    BOOST_REQUIRE(catalog.find("oacs", "Deep.json", path));
+    BOOST_CHECK(path == root / "oacs" / "moved" / "deeper" / "Deep.json");
+
+    fs::remove(root / "oacs" / "Top.json");
+
+    BOOST_CHECK( ! catalog.find("oacs", "Top.json", path));
+    BOOST_CHECK_EQUAL(3u, catalog.size());
+}
+
+BOOST_FIXTURE_TEST_CASE(testFindIndexed, DatabaseFixture)
+{
+    spoac::Catalog catalog(root);
+    fs::path path;
+
+    // the database is only walked by the first find()
+    BOOST_CHECK( ! catalog.findIndexed("oacs", "Top.json", path));
+    BOOST_CHECK(catalog.find("oacs", "Top.json", path));
+    BOOST_CHECK(catalog.findIndexed("oacs", "Top.json", path));
+
+    // an unknown file does not make the catalog read the database
+    write(root / "oacs" / "New.json", "{}");
+
+    BOOST_CHECK( ! catalog.findIndexed("oacs", "New.json", path));
+    BOOST_CHECK( ! catalog.findIndexed("oacs", "Top.json", path));
+
+    BOOST_CHECK(catalog.find("oacs", "New.json", path));
+    BOOST_CHECK(catalog.findIndexed("oacs", "Top.json", path));
+}
+
+BOOST_FIXTURE_TEST_CASE(testGeneration, DatabaseFixture)
+{
+    spoac::Catalog catalog(root);
+    fs::path path;
+
+    uint64_t generation = catalog.getGeneration();
+    BOOST_CHECK_EQUAL(generation, catalog.getGeneration());
+
+    // writing a file changes the generation, but keeps the catalog
+    write(root / "oacs" / "nested" / "deeper" / "Deep.json", "{}");
+
+    uint64_t written = catalog.getGeneration();
+    BOOST_CHECK(written != generation);
+    BOOST_CHECK(catalog.findIndexed("oacs", "Deep.json", path));
+
+    write(root / "scenarios" / "new.json", "{}");
+
+    BOOST_CHECK(catalog.getGeneration() != written);
+    BOOST_CHECK(catalog.find("scenarios", "new.json", path));
+}
@@ -0,0 +1,205 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#define BOOST_TEST_MODULE spoac_LTM_CompiledDatabase
+#include <spoactest/test.h>
+#include <spoactest/TemporaryDirectory.h>
+
+#include <fstream>
+#include <spoac/ltm/CompiledDatabase.h>
+#include <spoac/ltm/LTM.h>
+#include <spoac/ltm/Mappings.h>
+#include <spoac/common/Exception.h>
+#include <spoac/JSON/BinaryReader.h>
+#include <spoac/JSON/Document.h>
+#include <spoac/JSON/DocumentObject.h>
+
+#include <stdlib.h>
+
+namespace fs = boost::filesystem;
+
+struct DatabaseFixture : spoactest::TemporaryDirectory
+{
+    DatabaseFixture() : TemporaryDirectory("spoac_compiled")
+    {
+        setenv("MCAPROJECTHOME", root.string().c_str(), 1);
+
+        databasePath = spoac::LTM::getDatabasePath();
+        output = root / "ltm_db.bin";
+
+        fs::create_directories(databasePath / "oacs" / "nested");
+        fs::create_directories(databasePath / "scenarios");
+
+        write(databasePath / "scenarios" / "abc.json",
+            "{\"name\": \"abc\", \"oacs\": [\"Move\"], \"comment\": \"x\"}");
+        write(databasePath / "oacs" / "nested" / "Move.json",
+            "{\"name\": \"Move\", \"params\": [\"x\"], "
+            "\"action\": \"MoveAction\", \"config\": {\"speed\": 2}, "
+            "\"match\": [{\"x\": \"table\", \"action\": \"Slow\"}]}");
+        // lacks the required name, so it is left out
+        write(databasePath / "oacs" / "Broken.json", "{\"params\": []}");
+    }
+
+    ~DatabaseFixture()
+    {
+        setenv("MCAPROJECTHOME", "./", 1);
+    }
+
+    fs::path databasePath;
+    fs::path output;
+};
+
+BOOST_FIXTURE_TEST_CASE(testCompile, DatabaseFixture)
+{
+    spoac::Catalog catalog(databasePath);
+
+    BOOST_CHECK_EQUAL(2u, spoac::CompiledDatabase::compile(catalog, output));
+
+    spoac::CompiledDatabase database(output);
+    spoac::CompiledDatabase::Record record;
+
+    BOOST_CHECK_EQUAL(2u, database.size());
+    BOOST_CHECK( ! database.find("oacs", "Broken.json", record));
+    BOOST_CHECK( ! database.find("oacs", "Missing.json", record));
+    BOOST_CHECK( ! database.find("scenarios", "Move.json", record));
+
+    BOOST_REQUIRE(database.find("scenarios", "abc.json", record));
+    BOOST_CHECK(record.document == NULL);
+
+    spoac::LTMSlice::Scenario scenario;
+    JSON::Binding<spoac::LTMSlice::Scenario> scenarioBinding(scenario);
+    JSON::BinaryReader scenarioReader(scenarioBinding);
+    scenarioReader.read(record.data, record.length);
+
+    BOOST_CHECK_EQUAL(std::string("abc"), scenario.name);
+    BOOST_REQUIRE_EQUAL(1u, scenario.oacs.size());
+    BOOST_CHECK_EQUAL(std::string("Move"), scenario.oacs[0]);
+
+    BOOST_REQUIRE(database.find("oacs", "Move.json", record));
+
+    spoac::PlanningSlice::ActionDefinition action;
+    JSON::Binding<spoac::PlanningSlice::ActionDefinition> actionBinding(action);
+    JSON::BinaryReader actionReader(actionBinding);
+    actionReader.read(record.data, record.length);
+
+    BOOST_CHECK_EQUAL(std::string("Move"), action.name);
+    BOOST_REQUIRE_EQUAL(1u, action.parameters.size());
+    BOOST_CHECK_EQUAL(std::string("x"), action.parameters[0].name);
+
+    // the whole OAC is kept for its config and match rules
+    BOOST_REQUIRE(record.document != NULL);
+
+    JSON::Document document;
+    JSON::BinaryReader documentReader(document);
+    documentReader.read(record.document, record.documentLength);
+
+    BOOST_CHECK_EQUAL(std::string("MoveAction"),
+        document.getRoot().toObject()["action"]->toString());
+    BOOST_CHECK_EQUAL(1u, document.getRoot().toObject()["match"]->toArray().size());
+}
+
+BOOST_FIXTURE_TEST_CASE(testActionConfig, DatabaseFixture)
+{
+    spoac::Catalog catalog(databasePath);
+    spoac::CompiledDatabase::compile(catalog, output);
+
+    // without a cache every document comes from the compiled database
+    spoac::LTM ltm(JSON::CODEC_TEXT, 0, spoac::WorkQueuePtr(), output);
+
+    spoac::LTMSlice::OAC oac;
+    oac.name = "Move";
+    oac.objects.resize(1);
+
+    oac.objects[0].id = "table";
+    BOOST_CHECK_EQUAL(std::string("Slow"),
+        ltm.getActionConfig(oac, Ice::Current()).name);
+
+    oac.objects[0].id = "chair";
+    spoac::LTMSlice::ActionConfig config =
+        ltm.getActionConfig(oac, Ice::Current());
+
+    // the config is written from the decoded document, without the
+    // whitespace of the file
+    BOOST_CHECK_EQUAL(std::string("MoveAction"), config.name);
+    BOOST_CHECK_EQUAL(std::string("{\"speed\":2}"), config.config);
+}
+
+BOOST_FIXTURE_TEST_CASE(testChangedFiles, DatabaseFixture)
+{
+    spoac::Catalog catalog(databasePath);
+    spoac::CompiledDatabase::compile(catalog, output);
+
+    spoac::CompiledDatabase database(output);
+    spoac::CompiledDatabase::Record record;
+    uint64_t version = database.getVersion();
+
+    // a changed file is read from the JSON tree until it is compiled again
+    write(databasePath / "scenarios" / "abc.json", "{\"name\": \"new\"}");
+
+    BOOST_CHECK( ! database.find("scenarios", "abc.json", record));
+    BOOST_CHECK(database.find("oacs", "Move.json", record));
+
+    spoac::CompiledDatabase::compile(catalog, output);
+
+    // the open database keeps the file it mapped
+    BOOST_CHECK_EQUAL(version, database.getVersion());
+
+    spoac::CompiledDatabase compiled(output);
+
+    BOOST_CHECK(compiled.getVersion() != version);
+    BOOST_CHECK(compiled.find("scenarios", "abc.json", record));
+}
+
+BOOST_FIXTURE_TEST_CASE(testInvalidFiles, DatabaseFixture)
+{
+    write(output, "{\"not\": \"compiled\"}");
+
+    BOOST_CHECK_THROW(spoac::CompiledDatabase database(output),
+        spoac::Exception);
+    BOOST_CHECK_THROW(spoac::CompiledDatabase database(root / "missing.bin"),
+        spoac::Exception);
+}
+
+BOOST_FIXTURE_TEST_CASE(testCorruptEntries, DatabaseFixture)
+{
+    spoac::Catalog catalog(databasePath);
+    spoac::CompiledDatabase::compile(catalog, output);
+
+    // the key offset of the first entry, oacs/Move.json, right after the
+    // 40 byte header
+    {
+        std::fstream file(output.string().c_str(),
+            std::ios::in | std::ios::out | std::ios::binary);
+        uint32_t keyOffset = 0xFFFFFFFF;
+
+        file.seekp(40);
+        file.write(reinterpret_cast<const char*>(&keyOffset),
+            sizeof(keyOffset));
+    }
+
+    spoac::CompiledDatabase database(output);
+    spoac::CompiledDatabase::Record record;
+
+    BOOST_CHECK( ! database.find("oacs", "Move.json", record));
+    BOOST_CHECK(database.find("scenarios", "abc.json", record));
+}
@@ -0,0 +1,167 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#define BOOST_TEST_MODULE spoac_LTM_DocumentCache
+#include <spoactest/test.h>
+#include <spoactest/TemporaryDirectory.h>
+
+#include <spoac/ltm/DocumentCache.h>
+#include <spoac/JSON/Codec.h>
+#include <spoac/JSON/ParserException.h>
+
+namespace fs = boost::filesystem;
+
+struct FileFixture : spoactest::TemporaryDirectory
+{
+    FileFixture() : TemporaryDirectory("spoac_cache")
+    {
+        write(root / "a.json", "{\"name\": \"a\"}");
+        write(root / "b.json", "{\"name\": \"b\"}");
+        write(root / "c.json", "{\"name\": \"c\"}");
+    }
+};
+
+static std::string name(spoac::ConstDocumentPtr document)
+{
+    return document->getRoot().toObject()["name"]->toString();
+}
+
+BOOST_FIXTURE_TEST_CASE(testHits, FileFixture)
+{
+    spoac::DocumentCache cache(1024 * 1024);
+
+    spoac::ConstDocumentPtr first = cache.get(root / "a.json");
+    spoac::ConstDocumentPtr second = cache.get(root / "a.json");
+
+    BOOST_CHECK_EQUAL("a", name(first));
+    BOOST_CHECK(first == second);
+    BOOST_CHECK_EQUAL(1u, cache.getHits());
+    BOOST_CHECK_EQUAL(1u, cache.getMisses());
+    BOOST_CHECK_EQUAL(1u, cache.size());
+    BOOST_CHECK(cache.getMemoryUsage() > 0);
+
+    BOOST_CHECK_THROW(cache.get(root / "missing.json"), JSON::ParserException);
+    BOOST_CHECK_EQUAL(1u, cache.size());
+}
+
+BOOST_FIXTURE_TEST_CASE(testContains, FileFixture)
+{
+    spoac::DocumentCache cache(1024 * 1024);
+
+    BOOST_CHECK( ! cache.contains(root / "a.json"));
+
+    cache.get(root / "a.json");
+
+    BOOST_CHECK(cache.contains(root / "a.json"));
+    BOOST_CHECK( ! cache.contains(root / "b.json"));
+    BOOST_CHECK_EQUAL(0u, cache.getHits());
+
+    write(root / "a.json", "{\"name\": \"changed\"}");
+
+    BOOST_CHECK( ! cache.contains(root / "a.json"));
+}
+
+BOOST_FIXTURE_TEST_CASE(testInvalidation, FileFixture)
+{
+    spoac::DocumentCache cache(1024 * 1024);
+
+    spoac::ConstDocumentPtr old = cache.get(root / "a.json");
+
+    // a rewrite of the same size within the same second is noticed too
+    write(root / "a.json", "{\"name\": \"x\"}");
+
+    spoac::ConstDocumentPtr current = cache.get(root / "a.json");
+
+    BOOST_CHECK_EQUAL("x", name(current));
+    BOOST_CHECK_EQUAL(2u, cache.getMisses());
+    BOOST_CHECK_EQUAL(1u, cache.size());
+
+    // documents in use stay valid
+    BOOST_CHECK_EQUAL("a", name(old));
+
+    fs::remove(root / "a.json");
+    write(root / "a.json", "{\"name\": \"replaced\"}");
+
+    BOOST_CHECK_EQUAL("replaced", name(cache.get(root / "a.json")));
+}
+
+BOOST_FIXTURE_TEST_CASE(testCompiled, FileFixture)
+{
+    spoac::DocumentCache cache(1024 * 1024);
+    std::string compiled = JSON::Codec::encode(
+        *JSON::Codec::decode("{\"name\": \"compiled\"}"), JSON::CODEC_BINARY);
+
+    spoac::ConstDocumentPtr first =
+        cache.get(root / "a.json", compiled.data(), compiled.size());
+    spoac::ConstDocumentPtr second =
+        cache.get(root / "a.json", compiled.data(), compiled.size());
+
+    BOOST_CHECK_EQUAL("compiled", name(first));
+    BOOST_CHECK(first == second);
+    BOOST_CHECK_EQUAL(1u, cache.getHits());
+    BOOST_CHECK_EQUAL(1u, cache.size());
+
+    // decoded again once the file it was compiled from changes
+    write(root / "a.json", "{\"name\": \"x\"}");
+    cache.get(root / "a.json", compiled.data(), compiled.size());
+
+    BOOST_CHECK_EQUAL(2u, cache.getMisses());
+}
+
+BOOST_FIXTURE_TEST_CASE(testEviction, FileFixture)
+{
+    spoac::DocumentCache measure(1024 * 1024);
+    measure.get(root / "a.json");
+    size_t entrySize = measure.getMemoryUsage();
+
+    // room for two documents
+    spoac::DocumentCache cache(2 * entrySize + entrySize / 2);
+
+    cache.get(root / "a.json");
+    cache.get(root / "b.json");
+    cache.get(root / "a.json");
+    cache.get(root / "c.json");
+
+    BOOST_CHECK_EQUAL(2u, cache.size());
+    BOOST_CHECK_EQUAL(1u, cache.getEvictions());
+
+    // b was the least recently used
+    cache.get(root / "a.json");
+    cache.get(root / "c.json");
+    BOOST_CHECK_EQUAL(3u, cache.getHits());
+
+    cache.get(root / "b.json");
+    BOOST_CHECK_EQUAL(4u, cache.getMisses());
+}
+
+BOOST_FIXTURE_TEST_CASE(testDisabled, FileFixture)
+{
+    spoac::DocumentCache cache(0);
+
+    BOOST_CHECK_EQUAL("a", name(cache.get(root / "a.json")));
+    BOOST_CHECK_EQUAL("a", name(cache.get(root / "a.json")));
+
+    BOOST_CHECK_EQUAL(0u, cache.getHits());
+    BOOST_CHECK_EQUAL(0u, cache.size());
+    BOOST_CHECK_EQUAL(0u, cache.getMemoryUsage());
+}
@@ -23,11 +23,47 @@
 
 #define BOOST_TEST_MODULE spoac_LTM
 #include <spoactest/test.h>
+#include <spoactest/TemporaryDirectory.h>
 
 #include <iostream>
 #include <spoac/ltm/LTM.h>
+#include <spoac/common/Exception.h>
 #include <spoac/ice/IceHelper.h>
 
+#include <stdlib.h>
+
+namespace fs = boost::filesystem;
+
+/**
+* A database of its own, which tests can change.
+*/
+struct DatabaseFixture : spoactest::TemporaryDirectory
+{
+    DatabaseFixture() : TemporaryDirectory("spoac_ltm")
+    {
+        setenv("MCAPROJECTHOME", root.string().c_str(), 1);
+
+        fs::path database = spoac::LTM::getDatabasePath();
+        fs::create_directories(database / "oacs");
+        fs::create_directories(database / "scenarios");
+
+        write(database / "scenarios" / "abc.json", "{\"name\": \"abc\"}");
+        writeOAC("FirstAction");
+    }
+
+    ~DatabaseFixture()
+    {
+        setenv("MCAPROJECTHOME", "./", 1);
+    }
+
+    void writeOAC(const std::string& action)
+    {
+        write(spoac::LTM::getDatabasePath() / "oacs" / "Move.json",
+            "{\"name\": \"Move\", \"params\": [\"x\"], "
+            "\"action\": \"" + action + "\"}");
+    }
+};
+
 BOOST_AUTO_TEST_CASE(testGetScenario)
 {
     spoac::ice::IceHelperPtr iceHelper(new spoac::ice::IceHelper);
@@ -52,68 +88,259 @@ BOOST_AUTO_TEST_CASE(testGetScenario)
     BOOST_CHECK_EQUAL(std::string("f"), scenario.functions[0].name);
 }
 
-BOOST_AUTO_TEST_CASE(testParameterMatching)
+BOOST_AUTO_TEST_CASE(testGetAction)
+{
+    setenv("MCAPROJECTHOME", "./", 1);
+
+    spoac::LTMPtr ltm(new spoac::LTM);
+
+    spoac::PlanningSlice::ActionDefinition action =
+        ltm->getAction("SampleOAC", Ice::Current());
+
+    BOOST_CHECK_EQUAL(std::string("SampleOAC"), action.name);
+    BOOST_CHECK_EQUAL(std::string("p(x)"), action.precondition);
+    BOOST_CHECK_EQUAL(std::string("add(Kf, p(y))"), action.effect);
+
+    BOOST_CHECK_EQUAL(2, action.parameters.size());
+    BOOST_CHECK_EQUAL(std::string("x"), action.parameters[0].name);
+    BOOST_CHECK_EQUAL(std::string("y"), action.parameters[1].name);
+
+    action = ltm->getAction("CountTwo", Ice::Current());
+
+    BOOST_CHECK_EQUAL(std::string("CountTwo"), action.name);
+    BOOST_CHECK(action.precondition.empty());
+    BOOST_CHECK_EQUAL(0, action.parameters.size());
+}
+
+BOOST_AUTO_TEST_CASE(testBatches)
 {
+    setenv("MCAPROJECTHOME", "./", 1);
+
     spoac::LTMPtr ltm(new spoac::LTM);
 
-    spoac::LTMSlice::Obj object1;
-    object1.id = "obj1";
-    object1.properties.insert(
-        std::pair<std::string, std::string>("p1", "\"val1\"")); // value is JSON
+    spoac::LTMSlice::NameList names;
+    names.push_back("SampleOAC");
+    names.push_back("CountTwo");
+
+    spoac::PlanningSlice::ActionDefinitionList actions =
+        ltm->getActions(names, Ice::Current());
 
-    spoac::LTMSlice::Obj object2;
-    object2.id = "obj2";
-    object2.properties.insert(
-        std::pair<std::string, std::string>("p1", "\"val2\""));
-    object2.properties.insert(
-        std::pair<std::string, std::string>("p2", "\"val1\""));
+    BOOST_REQUIRE_EQUAL(2, actions.size());
+    BOOST_CHECK_EQUAL(std::string("SampleOAC"), actions[0].name);
+    BOOST_CHECK_EQUAL(std::string("CountTwo"), actions[1].name);
 
-    std::map<std::string, int> isParam;
-    isParam.insert(std::pair<std::string, int>("x", 0));
-    isParam.insert(std::pair<std::string, int>("y", 1));
+    spoac::LTMSlice::Obj object;
+    spoac::LTMSlice::OAC oac;
+    oac.name = "SampleOAC";
+    oac.objects.push_back(object);
 
-    JSON::Object match1;
-    JSON::ValuePtr val1(new JSON::String("val1"));
-    match1["p1"] = val1;
-    BOOST_CHECK(ltm->checkObjectMatch(object1, match1));
+    spoac::LTMSlice::OACList oacs;
+    oacs.push_back(oac);
+    oac.objects[0].id = "abc";
+    oacs.push_back(oac);
+    oac.objects[0].id = "";
+    oac.objects[0].properties["isLocation"] = "true";
+    oacs.push_back(oac);
+
+    spoac::LTMSlice::ActionConfigList configs =
+        ltm->getActionConfigs(oacs, Ice::Current());
+
+    BOOST_REQUIRE_EQUAL(3, configs.size());
+    BOOST_CHECK_EQUAL(std::string("SampleAction"), configs[0].name);
+    BOOST_CHECK_EQUAL(std::string("ABCAction"), configs[1].name);
+    BOOST_CHECK_EQUAL(std::string("\"anything\""), configs[1].config);
+    BOOST_CHECK_EQUAL(std::string("LocationAction"), configs[2].name);
+}
+
+BOOST_AUTO_TEST_CASE(testQueuedRequests)
+{
+    spoac::ice::IceHelperPtr iceHelper(new spoac::ice::IceHelper);
+
+    setenv("MCAPROJECTHOME", "./", 1);
 
-    JSON::Object match2;
-    JSON::ValuePtr val2(new JSON::String("wrong"));
-    match2["p1"] = val2;
-    BOOST_CHECK( ! ltm->checkObjectMatch(object1, match2));
+    // nothing is cached, so every request is answered by the work queue
+    spoac::WorkQueuePtr workQueue(new spoac::WorkQueue(2));
+    Ice::ObjectPtr ltmObject =
+        new spoac::LTM(JSON::CODEC_TEXT, 0, workQueue);
+    iceHelper->registerAdapter(ltmObject, "QueuedLTM", "tcp -p 10098");
+
+    spoac::LTMSlice::LTMPrx ltm;
+    ltm = iceHelper->getProxy<spoac::LTMSlice::LTMPrx>(
+        "QueuedLTM:tcp -p 10098");
+
+    spoac::LTMSlice::Scenario scenario = ltm->getScenario("abc");
+    BOOST_CHECK_EQUAL(std::string("abc"), scenario.name);
+
+    spoac::PlanningSlice::ActionDefinition action = ltm->getAction("CountTwo");
+    BOOST_CHECK_EQUAL(std::string("CountTwo"), action.name);
+
+    spoac::LTMSlice::OAC oac;
+    oac.name = "CountTwo";
+    BOOST_CHECK_EQUAL(std::string("CountTwo"),
+        ltm->getActionConfig(oac).name);
+
+    // errors of queued requests reach the client as well
+    BOOST_CHECK_THROW(ltm->getAction("MissingOAC"), Ice::UnknownException);
+
+    workQueue->destroy();
+}
 
-    JSON::Object match3;
-    match3["non-existent"] = val1;
-    BOOST_CHECK( ! ltm->checkObjectMatch(object1, match3));
+BOOST_AUTO_TEST_CASE(testCompiledDatabase)
+{
+    setenv("MCAPROJECTHOME", "./", 1);
+
+    boost::filesystem::path compiledPath = "LTMTest.bin";
+    spoac::Catalog catalog(spoac::LTM::getDatabasePath());
+    spoac::CompiledDatabase::compile(catalog, compiledPath);
+
+    spoac::LTMPtr ltm(new spoac::LTM(JSON::CODEC_TEXT, 0,
+        spoac::WorkQueuePtr(), compiledPath));
+
+    BOOST_CHECK_EQUAL(std::string("abc"),
+        ltm->getScenario("abc", Ice::Current()).name);
+
+    spoac::PlanningSlice::ActionDefinition action =
+        ltm->getAction("SampleOAC", Ice::Current());
+    BOOST_CHECK_EQUAL(std::string("SampleOAC"), action.name);
+    BOOST_CHECK_EQUAL(2, action.parameters.size());
+
+    spoac::LTMSlice::Obj object;
+    object.id = "abc";
+    spoac::LTMSlice::OAC oac;
+    oac.name = "SampleOAC";
+    oac.objects.push_back(object);
+
+    spoac::LTMSlice::ActionConfig config =
+        ltm->getActionConfig(oac, Ice::Current());
+    BOOST_CHECK_EQUAL(std::string("ABCAction"), config.name);
+    BOOST_CHECK_EQUAL(std::string("\"anything\""), config.config);
+
+    boost::filesystem::remove(compiledPath);
+}
+
+BOOST_AUTO_TEST_CASE(testGetVersion)
+{
+    setenv("MCAPROJECTHOME", "./", 1);
+
+    spoac::LTMPtr ltm(new spoac::LTM);
+
+    // nothing changes in the database while the test runs
+    Ice::Long version = ltm->getVersion(Ice::Current());
+    ltm->getScenario("abc", Ice::Current());
+    BOOST_CHECK_EQUAL(version, ltm->getVersion(Ice::Current()));
+
+    // another server has another version
+    IceUtil::ThreadControl::sleep(IceUtil::Time::milliSeconds(1));
+    spoac::LTMPtr restarted(new spoac::LTM);
+    BOOST_CHECK(version != restarted->getVersion(Ice::Current()));
+}
+
+BOOST_FIXTURE_TEST_CASE(testSnapshots, DatabaseFixture)
+{
+    spoac::LTMPtr ltm(new spoac::LTM(JSON::CODEC_TEXT, 0));
+    spoac::LTMSlice::OAC oac;
+    oac.name = "Move";
+
+    BOOST_CHECK( ! ltm->getSnapshot());
+    BOOST_REQUIRE(ltm->reload());
+    BOOST_CHECK( ! ltm->reload());
+
+    spoac::SnapshotPtr snapshot = ltm->getSnapshot();
+    BOOST_REQUIRE(snapshot);
+    BOOST_CHECK_EQUAL(2u, snapshot->size());
+
+    Ice::Long version = ltm->getVersion(Ice::Current());
+    BOOST_CHECK_EQUAL(static_cast<Ice::Long>(snapshot->getVersion()),
+        version);
+
+    // changes are only seen once the next snapshot has been loaded
+    writeOAC("SecondAction");
+
+    BOOST_CHECK_EQUAL(std::string("FirstAction"),
+        ltm->getActionConfig(oac, Ice::Current()).name);
+    BOOST_CHECK_EQUAL(version, ltm->getVersion(Ice::Current()));
+
+    BOOST_REQUIRE(ltm->reload());
+
+    BOOST_CHECK_EQUAL(std::string("SecondAction"),
+        ltm->getActionConfig(oac, Ice::Current()).name);
+    BOOST_CHECK(version != ltm->getVersion(Ice::Current()));
+
+    // the old snapshot is left as it was for requests still reading it
+    BOOST_CHECK_EQUAL(std::string("FirstAction"),
+        snapshot->find("oacs", "Move")->document->getRoot().toObject()
+            [JSON::Identifier("action")]->toString());
+
+    BOOST_CHECK_THROW(ltm->getAction("Missing", Ice::Current()),
+        spoac::Exception);
+}
+
+BOOST_FIXTURE_TEST_CASE(testSnapshotMisses, DatabaseFixture)
+{
+    spoac::LTMPtr ltm(new spoac::LTM(JSON::CODEC_TEXT, 0));
+    BOOST_REQUIRE(ltm->reload());
+
+    spoac::SnapshotPtr snapshot = ltm->getSnapshot();
+
+    write(spoac::LTM::getDatabasePath() / "oacs" / "Grasp.json",
+        "{\"name\": \"Grasp\", \"params\": [\"x\"], "
+        "\"action\": \"GraspAction\"}");
+
+    // files the snapshot lacks are read from the database until the
+    // next reload
+    spoac::LTMSlice::OAC oac;
+    oac.name = "Grasp";
+
+    BOOST_CHECK_EQUAL(std::string("GraspAction"),
+        ltm->getActionConfig(oac, Ice::Current()).name);
+    BOOST_CHECK_EQUAL(std::string("Grasp"),
+        ltm->getAction("Grasp", Ice::Current()).name);
+    BOOST_CHECK(ltm->getSnapshot() == snapshot);
+
+    BOOST_CHECK_THROW(ltm->getAction("Missing", Ice::Current()),
+        spoac::Exception);
+
+    BOOST_REQUIRE(ltm->reload());
+    BOOST_CHECK(ltm->getSnapshot()->find("oacs", "Grasp") != NULL);
+}
+
+BOOST_FIXTURE_TEST_CASE(testReloading, DatabaseFixture)
+{
+    spoac::LTMPtr ltm(new spoac::LTM(JSON::CODEC_TEXT, 0));
+    spoac::LTMSlice::OAC oac;
+    oac.name = "Move";
 
-    spoac::LTMSlice::OAC oac1;
-    oac1.name = "test-oac";
-    oac1.objects.push_back(object1);
-    oac1.objects.push_back(object2);
+    ltm->startReloading(IceUtil::Time::milliSeconds(10));
 
-    JSON::ValuePtr oacMatch1(new JSON::Object());
-    JSON::ValuePtr match4(new JSON::String("obj1"));
-    oacMatch1->toObject().insert("x", match4);
+    for (int i = 0; i < 100 && !ltm->getSnapshot(); i++)
+    {
+        IceUtil::ThreadControl::sleep(IceUtil::Time::milliSeconds(10));
+    }
 
-    BOOST_CHECK(ltm->checkOACMatch(oac1, oacMatch1, isParam));
+    spoac::SnapshotPtr snapshot = ltm->getSnapshot();
+    BOOST_REQUIRE(snapshot);
 
-    JSON::ValuePtr oacMatch2(new JSON::Object());
-    JSON::ValuePtr match5(new JSON::String("obj2"));
-    oacMatch2->toObject().insert("x", match4);
-    oacMatch2->toObject().insert("y", match5);
+    writeOAC("SecondAction");
 
-    BOOST_CHECK(ltm->checkOACMatch(oac1, oacMatch2, isParam));
+    // a snapshot loaded while the file is written may not have all of
+    // it, the write is loaded by the next one
+    std::string action;
 
-    JSON::ValuePtr oacMatch3(new JSON::Object());
-    JSON::ValuePtr match6(new JSON::Object(match1));
-    oacMatch3->toObject().insert("x", match6);
-    oacMatch3->toObject().insert("y", match5);
+    for (int i = 0; i < 100 && action != "SecondAction"; i++)
+    {
+        IceUtil::ThreadControl::sleep(IceUtil::Time::milliSeconds(10));
 
-    BOOST_CHECK(ltm->checkOACMatch(oac1, oacMatch3, isParam));
+        try
+        {
+            action = ltm->getActionConfig(oac, Ice::Current()).name;
+        }
+        catch (const spoac::Exception& e)
+        {
+        }
+    }
 
-    JSON::ValuePtr oacMatch4(new JSON::Object());
-    oacMatch4->toObject().insert("x", match6);
-    oacMatch4->toObject().insert("y", match4);
+    BOOST_CHECK_EQUAL(std::string("SecondAction"), action);
+    BOOST_CHECK(ltm->getSnapshot() != snapshot);
 
-    BOOST_CHECK( ! ltm->checkOACMatch(oac1, oacMatch4, isParam));
+    ltm->stopReloading();
 }
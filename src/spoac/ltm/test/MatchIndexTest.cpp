@@ -0,0 +1,195 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#define BOOST_TEST_MODULE spoac_LTM_MatchIndex
+#include <spoactest/test.h>
+
+#include <sstream>
+#include <spoac/ltm/MatchIndex.h>
+#include <spoac/JSON/Codec.h>
+#include <spoac/JSON/Parser.h>
+
+static spoac::ConstDocumentPtr parse(const std::string& json)
+{
+    boost::shared_ptr<JSON::Document> document(new JSON::Document);
+    JSON::Parser parser(*document);
+
+    parser.read(json);
+    parser.finish();
+
+    return document;
+}
+
+static spoac::LTMSlice::Obj object(
+    const std::string& id,
+    const std::string& property = "",
+    const std::string& value = "")
+{
+    spoac::LTMSlice::Obj obj;
+    obj.id = id;
+
+    if (!property.empty())
+    {
+        obj.properties[property] = value;
+    }
+
+    return obj;
+}
+
+static std::string match(
+    const spoac::MatchIndex& index,
+    const spoac::LTMSlice::Obj& x,
+    const spoac::LTMSlice::Obj& y = spoac::LTMSlice::Obj())
+{
+    spoac::LTMSlice::OAC oac;
+    oac.objects.push_back(x);
+    oac.objects.push_back(y);
+
+    const JSON::DocumentObject* rule = index.find(oac);
+
+    return rule ? (*rule)["action"]->toString() : "";
+}
+
+BOOST_AUTO_TEST_CASE(testIds)
+{
+    spoac::ConstDocumentPtr document = parse("{\"params\": [\"x\", \"y\"], "
+        "\"match\": ["
+        "{\"x\": \"a\", \"y\": \"b\", \"action\": \"AB\"}, "
+        "{\"x\": \"a\", \"action\": \"A\", \"config\": 1}, "
+        "{\"y\": \"b\", \"action\": \"B\"}, "
+        "{\"z\": \"a\", \"action\": \"Unknown\"}, "
+        "{\"action\": \"Any\"}]}");
+    spoac::MatchIndex index(document);
+
+    BOOST_CHECK(index.isCompiledFrom(document));
+    BOOST_CHECK( ! index.isCompiledFrom(parse("{}")));
+
+    // the rule naming an unknown parameter is dropped
+    BOOST_CHECK_EQUAL(4u, index.size());
+
+    BOOST_CHECK_EQUAL("AB", match(index, object("a"), object("b")));
+    BOOST_CHECK_EQUAL("A", match(index, object("a"), object("c")));
+    BOOST_CHECK_EQUAL("B", match(index, object("c"), object("b")));
+    BOOST_CHECK_EQUAL("Any", match(index, object("c"), object("c")));
+}
+
+BOOST_AUTO_TEST_CASE(testProperties)
+{
+    spoac::MatchIndex index(parse("{\"params\": [\"x\"], \"match\": ["
+        "{\"x\": {\"color\": \"red\"}, \"action\": \"Red\"}, "
+        "{\"x\": {\"open\": true}, \"action\": \"Open\"}, "
+        "{\"x\": {\"size\": 2}, \"action\": \"Two\"}, "
+        "{\"x\": {\"owner\": null}, \"action\": \"Unowned\"}, "
+        "{\"x\": {\"shape\": [1, 2]}, \"action\": \"Shaped\"}]}"));
+
+    BOOST_CHECK_EQUAL("Red", match(index, object("o", "color", "\"red\"")));
+    BOOST_CHECK_EQUAL("", match(index, object("o", "color", "\"blue\"")));
+    BOOST_CHECK_EQUAL("Red", match(index, object("o", "color",
+        JSON::Codec::encode(JSON::String("red"), JSON::CODEC_BINARY))));
+
+    BOOST_CHECK_EQUAL("Open", match(index, object("o", "open", "true")));
+    BOOST_CHECK_EQUAL("", match(index, object("o", "open", "false")));
+
+    // numbers are compared by value in either encoding
+    BOOST_CHECK_EQUAL("Two", match(index, object("o", "size", "2.0")));
+    BOOST_CHECK_EQUAL("Two", match(index, object("o", "size",
+        JSON::Codec::encode(JSON::Number(2), JSON::CODEC_BINARY))));
+    BOOST_CHECK_EQUAL("", match(index, object("o", "size", "3")));
+    BOOST_CHECK_EQUAL("", match(index, object("o", "size", "\"2\"")));
+
+    BOOST_CHECK_EQUAL("Unowned", match(index, object("o", "owner", "null")));
+    BOOST_CHECK_EQUAL("Shaped", match(index, object("o", "shape", "[]")));
+    BOOST_CHECK_EQUAL("", match(index, object("o", "weight", "1")));
+}
+
+BOOST_AUTO_TEST_CASE(testNumbers)
+{
+    spoac::MatchIndex index(parse("{\"params\": [\"x\"], \"match\": ["
+        "{\"x\": {\"size\": 1}, \"action\": \"One\"}, "
+        "{\"x\": {\"size\": 2.5}, \"action\": \"Half\"}, "
+        "{\"x\": {\"size\": 1e3}, \"action\": \"Thousand\"}]}"));
+
+    // later rules compare the value parsed for the first one
+    BOOST_CHECK_EQUAL("One", match(index, object("o", "size", "1")));
+    BOOST_CHECK_EQUAL("Half", match(index, object("o", "size", " 2.5 ")));
+    BOOST_CHECK_EQUAL("Thousand", match(index, object("o", "size", "1000")));
+    BOOST_CHECK_EQUAL("", match(index, object("o", "size", "1000x")));
+    BOOST_CHECK_EQUAL("", match(index, object("o", "size", "true")));
+}
+
+BOOST_AUTO_TEST_CASE(testParameterMatching)
+{
+    spoac::LTMSlice::Obj object1 = object("obj1", "p1", "\"val1\"");
+    spoac::LTMSlice::Obj object2 = object("obj2", "p1", "\"val2\"");
+    object2.properties["p2"] = "\"val1\"";
+
+    spoac::MatchIndex objectIndex(parse("{\"params\": [\"x\"], \"match\": ["
+        "{\"x\": {\"p1\": \"val1\"}, \"action\": \"Val1\"}, "
+        "{\"x\": {\"p1\": \"wrong\"}, \"action\": \"Wrong\"}, "
+        "{\"x\": {\"non-existent\": \"val1\"}, \"action\": \"Missing\"}]}"));
+
+    BOOST_CHECK_EQUAL("Val1", match(objectIndex, object1));
+    BOOST_CHECK_EQUAL("",
+        match(objectIndex, object("obj1", "p1", "\"other\"")));
+
+    spoac::MatchIndex oacIndex(parse("{\"params\": [\"x\", \"y\"], \"match\": ["
+        "{\"x\": {\"p1\": \"val1\"}, \"y\": \"obj1\", \"action\": \"Wrong\"}, "
+        "{\"x\": {\"p1\": \"val1\"}, \"y\": \"obj2\", "
+        "\"action\": \"Properties\"}, "
+        "{\"x\": \"obj1\", \"y\": \"obj2\", \"action\": \"Ids\"}, "
+        "{\"x\": \"obj1\", \"action\": \"Id\"}]}"));
+
+    BOOST_CHECK_EQUAL("Properties", match(oacIndex, object1, object2));
+    BOOST_CHECK_EQUAL("Ids", match(oacIndex, object("obj1"), object2));
+    BOOST_CHECK_EQUAL("Id", match(oacIndex, object("obj1"), object("obj3")));
+    BOOST_CHECK_EQUAL("", match(oacIndex, object2, object1));
+}
+
+BOOST_AUTO_TEST_CASE(testMissingObjects)
+{
+    spoac::MatchIndex index(parse("{\"params\": [\"x\", \"y\", \"z\"], "
+        "\"match\": [{\"z\": {}, \"action\": \"Z\"}, {\"x\": \"a\", \"action\": \"A\"}]}"));
+
+    // only two objects are passed
+    BOOST_CHECK_EQUAL("A", match(index, object("a"), object("b")));
+}
+
+BOOST_AUTO_TEST_CASE(testManyRules)
+{
+    std::ostringstream json;
+    json << "{\"params\": [\"x\", \"y\"], \"match\": [";
+
+    for (int i = 0; i < 500; i++)
+    {
+        json << "{\"x\": \"o" << i << "\", \"action\": \"A" << i << "\"}, ";
+    }
+
+    json << "{\"y\": {\"n\": 7}, \"action\": \"Seven\"}]}";
+
+    spoac::MatchIndex index(parse(json.str()));
+
+    BOOST_CHECK_EQUAL("A0", match(index, object("o0")));
+    BOOST_CHECK_EQUAL("A499", match(index, object("o499")));
+    BOOST_CHECK_EQUAL("Seven", match(index, object("none"), object("p", "n", "7")));
+    BOOST_CHECK_EQUAL("", match(index, object("none"), object("p", "n", "8")));
+}
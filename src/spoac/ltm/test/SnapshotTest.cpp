@@ -0,0 +1,60 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#define BOOST_TEST_MODULE spoac_LTM_Snapshot
+#include <spoactest/test.h>
+
+#include <spoac/ltm/Snapshot.h>
+#include <spoac/JSON/Parser.h>
+
+BOOST_AUTO_TEST_CASE(testGet)
+{
+    boost::shared_ptr<JSON::Document> document(new JSON::Document);
+    JSON::Parser parser(*document);
+    parser.read("{\"name\": \"Move\", \"params\": [\"x\"]}");
+    parser.finish();
+
+    spoac::Snapshot::File move;
+    move.document = document;
+    move.matchIndex.reset(new spoac::MatchIndex(move.document));
+
+    spoac::Snapshot::File broken;
+    broken.error = "Move.json: parse error";
+
+    spoac::Snapshot snapshot(42);
+    snapshot.add("oacs", "Move", move);
+    snapshot.add("oacs", "Broken", broken);
+
+    BOOST_CHECK_EQUAL(42u, snapshot.getVersion());
+    BOOST_CHECK_EQUAL(2u, snapshot.size());
+
+    BOOST_REQUIRE(snapshot.find("oacs", "Move") != NULL);
+    BOOST_CHECK(snapshot.find("oacs", "Move")->document == move.document);
+    BOOST_CHECK(snapshot.find("scenarios", "Move") == NULL);
+
+    // files which could not be read are kept with their error
+    BOOST_REQUIRE(snapshot.find("oacs", "Broken") != NULL);
+    BOOST_CHECK( ! snapshot.find("oacs", "Broken")->document);
+    BOOST_CHECK_EQUAL(snapshot.find("oacs", "Broken")->error,
+        "Move.json: parse error");
+}
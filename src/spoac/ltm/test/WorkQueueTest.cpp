@@ -0,0 +1,85 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#define BOOST_TEST_MODULE spoac_LTM_WorkQueue
+#include <spoactest/test.h>
+
+#include <spoac/ltm/WorkQueue.h>
+#include <spoac/common/Exception.h>
+
+class CountItem : public spoac::WorkItem
+{
+public:
+    CountItem(IceUtil::Mutex& mutex, int& count) :
+        mutex(mutex),
+        count(count)
+    {
+    }
+
+    void execute()
+    {
+        IceUtil::Mutex::Lock lock(mutex);
+        count++;
+    }
+
+protected:
+    IceUtil::Mutex& mutex;
+    int& count;
+};
+
+BOOST_AUTO_TEST_CASE(testExecute)
+{
+    IceUtil::Mutex mutex;
+    int count = 0;
+
+    spoac::WorkQueue queue(4);
+    BOOST_CHECK_EQUAL(4, queue.getThreadCount());
+
+    for (int i = 0; i < 1000; i++)
+    {
+        queue.add(spoac::WorkItemPtr(new CountItem(mutex, count)));
+    }
+
+    // the queued items are still executed
+    queue.destroy();
+
+    BOOST_CHECK_EQUAL(1000, count);
+    BOOST_CHECK_EQUAL(0, queue.size());
+}
+
+BOOST_AUTO_TEST_CASE(testDestroyed)
+{
+    IceUtil::Mutex mutex;
+    int count = 0;
+
+    spoac::WorkQueue queue(0);
+    BOOST_CHECK_EQUAL(1, queue.getThreadCount());
+
+    queue.destroy();
+    queue.destroy();
+
+    BOOST_CHECK_THROW(
+        queue.add(spoac::WorkItemPtr(new CountItem(mutex, count))),
+        spoac::Exception);
+    BOOST_CHECK_EQUAL(0, count);
+}
@@ -0,0 +1,698 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+/**
+* Measures the throughput and latency of the LTM for a mix of requests
+* over a generated database.
+*
+* Usage: ltmbench [-n scenarios] [-m oacs] [-k rules] [-d home] [-g]
+*                 [-p proxy] [-x scenario,action,config] [-t seconds]
+*                 [-c callers[,callers...]] [-f text|binary] [-z cache MB]
+*                 [-w worker threads] [-b] [-s] [Ice options]
+*
+* A database of n scenarios listing up to ten OACs each and m OACs with
+* k match rules each is written to cognition/memory/ltm_db below the
+* home directory, a temporary directory removed afterwards unless one is
+* given with -d. With -g the database is only generated.
+*
+* The database is served by an LTM in this process, which is called over
+* the loopback interface like a separate server. Alternatively requests
+* are sent to the server at -p, which has to be started with the
+* generated database as its MCAPROJECTHOME. The in-process LTM caches
+* -z megabytes of parsed files, answers requests reading files with -w
+* worker threads, uses a database compiled first with -b and answers all
+* requests from a snapshot with -s.
+*
+* Every caller sends getScenario, getAction and getActionConfig requests
+* picked at random in the ratio given with -x, 1,4,5 by default, for -t
+* seconds. Every scenario and OAC is requested once before measuring.
+* This is done for 1, 4 and 16 callers unless other numbers are given
+* with -c, printing the requests per second and the 50th, 99th and 99.9th
+* percentile of the latency of each operation.
+*/
+
+#include <spoac/ltm/CompiledDatabase.h>
+#include <spoac/ltm/LTM.h>
+#include <spoac/common/Exception.h>
+#include <spoac/LTM.h>
+
+#include <Ice/Ice.h>
+#include <IceUtil/Thread.h>
+#include <IceUtil/Time.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace spoac;
+namespace fs = boost::filesystem;
+
+enum Operation
+{
+    GET_SCENARIO,
+    GET_ACTION,
+    GET_ACTION_CONFIG,
+    OPERATION_COUNT
+};
+
+static const char* operationNames[] =
+{
+    "getScenario",
+    "getAction",
+    "getActionConfig"
+};
+
+/**
+* Sizes of the generated database, every request is picked from it.
+*/
+struct Database
+{
+    size_t scenarios;
+    size_t oacs;
+    size_t rules;
+};
+
+static std::string toString(size_t i)
+{
+    std::ostringstream s;
+    s << i;
+    return s.str();
+}
+
+static void write(const fs::path& path, const std::string& json)
+{
+    std::ofstream file(path.string().c_str());
+    file << json;
+
+    if (!file)
+    {
+        throw Exception("Could not write " + path.string());
+    }
+}
+
+/**
+* Writes the scenarios and OACs. Even rules match the object passed for
+* x by id and odd rules its color and the type of y, requests pick rules
+* which do not exist as well, so some fall through to the default.
+*/
+static void generate(const fs::path& root, const Database& database)
+{
+    fs::create_directories(root / "scenarios");
+    fs::create_directories(root / "oacs");
+
+    for (size_t s = 0; s < database.scenarios; s++)
+    {
+        std::string oacs;
+
+        for (size_t j = 0; j < 10 && j < database.oacs; j++)
+        {
+            oacs += std::string((j > 0) ? ", " : "") + "\"Oac" +
+                toString((s * 10 + j) % database.oacs) + "\"";
+        }
+
+        write(root / "scenarios" / ("Scenario" + toString(s) + ".json"),
+            "{\n"
+            "    \"name\": \"Scenario" + toString(s) + "\",\n"
+            "    \"activityControllers\": [\"IceNetwork\"],\n"
+            "    \"perceptionHandlers\": [],\n"
+            "    \"oacs\": [" + oacs + "],\n"
+            "    \"goals\": {\"hold\": \"K(holding(cup0))\"},\n"
+            "    \"predicates\": [{\"name\": \"at\", \"arguments\": 2}, "
+            "{\"name\": \"holding\", \"arguments\": 1}],\n"
+            "    \"functions\": [{\"name\": \"distance\", \"arguments\": 2}]\n"
+            "}\n");
+    }
+
+    for (size_t o = 0; o < database.oacs; o++)
+    {
+        std::string rules;
+
+        for (size_t r = 0; r < database.rules; r++)
+        {
+            std::string condition = (r % 2 == 0) ?
+                "\"x\": \"obj" + toString(r) + "\"" :
+                "\"x\": {\"color\": \"c" + toString(r) + "\"}, "
+                "\"y\": {\"type\": \"cup\"}";
+
+            rules += std::string((r > 0) ? ",\n" : "") + "        {" +
+                condition + ", \"action\": \"Rule" + toString(r) +
+                "Action\", \"config\": {\"rule\": " + toString(r) +
+                ", \"speed\": 0.5, \"grip\": [1, 2, 3]}}";
+        }
+
+        write(root / "oacs" / ("Oac" + toString(o) + ".json"),
+            "{\n"
+            "    \"name\": \"Oac" + toString(o) + "\",\n"
+            "    \"params\": [\"x\", \"y\"],\n"
+            "    \"match\": [\n" + rules + "\n    ],\n"
+            "    \"action\": \"DefaultAction\",\n"
+            "    \"config\": {\"speed\": 1.0, \"retries\": 3},\n"
+            "    \"precondition\": \"at(x, y)\",\n"
+            "    \"effect\": \"add(Kf, holding(x))\"\n"
+            "}\n");
+    }
+}
+
+class Caller : public IceUtil::Thread
+{
+public:
+    Caller(
+        const LTMSlice::LTMPrx& ltm,
+        const Database& database,
+        const std::vector<unsigned int>& mix,
+        unsigned int seed,
+        const IceUtil::Time& end) :
+        ltm(ltm),
+        database(database),
+        mix(mix),
+        seed(seed),
+        end(end),
+        latencies(OPERATION_COUNT),
+        failed(false)
+    {
+    }
+
+    virtual void run()
+    {
+        unsigned int total = 0;
+
+        for (size_t i = 0; i < mix.size(); i++)
+        {
+            total += mix[i];
+        }
+
+        try
+        {
+            IceUtil::Time now = IceUtil::Time::now();
+
+            while (now < end)
+            {
+                unsigned int pick = rand_r(&seed) % total;
+                size_t operation = 0;
+
+                while (pick >= mix[operation])
+                {
+                    pick -= mix[operation++];
+                }
+
+                call(static_cast<Operation>(operation));
+
+                IceUtil::Time done = IceUtil::Time::now();
+                latencies[operation].push_back((done - now).toMicroSeconds());
+                now = done;
+            }
+        }
+        catch (const Ice::Exception& e)
+        {
+            std::cerr << e << std::endl;
+            failed = true;
+        }
+    }
+
+    void call(Operation operation)
+    {
+        switch (operation)
+        {
+            case GET_SCENARIO:
+                ltm->getScenario("Scenario" +
+                    toString(rand_r(&seed) % database.scenarios));
+                break;
+
+            case GET_ACTION:
+                ltm->getAction("Oac" + toString(rand_r(&seed) % database.oacs));
+                break;
+
+            default:
+                ltm->getActionConfig(makeInstance());
+                break;
+        }
+    }
+
+    /**
+    * An instance of a random OAC matching a random rule, or none of them
+    * for rule numbers the OAC does not have.
+    */
+    LTMSlice::OAC makeInstance()
+    {
+        size_t rule = rand_r(&seed) % (database.rules * 2 + 1);
+
+        LTMSlice::OAC oac;
+        oac.name = "Oac" + toString(rand_r(&seed) % database.oacs);
+
+        LTMSlice::Obj x;
+        x.id = "obj" + toString(rule);
+        x.properties["color"] = "\"c" + toString(rule) + "\"";
+        x.properties["type"] = "\"box\"";
+
+        LTMSlice::Obj y;
+        y.id = "cup0";
+        y.properties["type"] = "\"cup\"";
+
+        oac.objects.push_back(x);
+        oac.objects.push_back(y);
+
+        return oac;
+    }
+
+    const std::vector<Ice::Long>& getLatencies(Operation operation) const
+    {
+        return latencies[operation];
+    }
+
+    bool hasFailed() const
+    {
+        return failed;
+    }
+
+protected:
+    LTMSlice::LTMPrx ltm;
+    Database database;
+    std::vector<unsigned int> mix;
+    unsigned int seed;
+    IceUtil::Time end;
+
+    // in microseconds, by operation
+    std::vector<std::vector<Ice::Long> > latencies;
+    bool failed;
+};
+
+typedef IceUtil::Handle<Caller> CallerPtr;
+
+/**
+* @param sorted Latencies in ascending order.
+* @return The latency not exceeded by the given fraction of requests.
+*/
+static Ice::Long percentile(const std::vector<Ice::Long>& sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+
+    size_t i = static_cast<size_t>(p * sorted.size());
+
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+static void printLatencies(
+    const std::string& name,
+    std::vector<Ice::Long>& latencies)
+{
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << std::setw(20) << name << std::setw(12) <<
+        latencies.size() << std::setw(10) << percentile(latencies, 0.5) <<
+        std::setw(10) << percentile(latencies, 0.99) << std::setw(10) <<
+        percentile(latencies, 0.999) << std::setw(10) <<
+        ((latencies.empty()) ? 0 : latencies.back()) << std::endl;
+}
+
+static std::vector<unsigned int> parseList(const char* list)
+{
+    std::vector<unsigned int> values;
+    std::istringstream stream(list);
+    std::string value;
+
+    while (std::getline(stream, value, ','))
+    {
+        values.push_back(atoi(value.c_str()));
+    }
+
+    return values;
+}
+
+class LTMBench : virtual public Ice::Application
+{
+public:
+    virtual int run(int argc, char* argv[])
+    {
+        Database database;
+        database.scenarios = 10;
+        database.oacs = 100;
+        database.rules = 10;
+
+        fs::path home;
+        bool generateOnly = false;
+        std::string proxy;
+        std::vector<unsigned int> mix;
+        int seconds = 5;
+        std::vector<unsigned int> callerCounts;
+        std::string configFormat("text");
+        size_t cacheSize = 64;
+        size_t workerThreads = 4;
+        bool compile = false;
+        bool snapshot = false;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            {
+                database.scenarios = atoi(argv[++i]);
+            }
+            else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc)
+            {
+                database.oacs = atoi(argv[++i]);
+            }
+            else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc)
+            {
+                database.rules = atoi(argv[++i]);
+            }
+            else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+            {
+                home = argv[++i];
+            }
+            else if (strcmp(argv[i], "-g") == 0)
+            {
+                generateOnly = true;
+            }
+            else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+            {
+                proxy = argv[++i];
+            }
+            else if (strcmp(argv[i], "-x") == 0 && i + 1 < argc)
+            {
+                mix = parseList(argv[++i]);
+            }
+            else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            {
+                seconds = atoi(argv[++i]);
+            }
+            else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+            {
+                callerCounts = parseList(argv[++i]);
+            }
+            else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+            {
+                configFormat = argv[++i];
+            }
+            else if (strcmp(argv[i], "-z") == 0 && i + 1 < argc)
+            {
+                cacheSize = atoi(argv[++i]);
+            }
+            else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+            {
+                workerThreads = atoi(argv[++i]);
+            }
+            else if (strcmp(argv[i], "-b") == 0)
+            {
+                compile = true;
+            }
+            else if (strcmp(argv[i], "-s") == 0)
+            {
+                snapshot = true;
+            }
+            else
+            {
+                std::cerr << "Usage: " << argv[0] << " [-n scenarios] " <<
+                    "[-m oacs] [-k rules] [-d home] [-g] [-p proxy] " <<
+                    "[-x scenario,action,config] [-t seconds] " <<
+                    "[-c callers[,callers...]] [-f text|binary] " <<
+                    "[-z cache MB] [-w worker threads] [-b] [-s]" <<
+                    std::endl;
+                return 1;
+            }
+        }
+
+        if (mix.size() != OPERATION_COUNT)
+        {
+            mix.clear();
+            mix.push_back(1);
+            mix.push_back(4);
+            mix.push_back(5);
+        }
+
+        if (callerCounts.empty())
+        {
+            callerCounts.push_back(1);
+            callerCounts.push_back(4);
+            callerCounts.push_back(16);
+        }
+
+        if (database.scenarios == 0 || database.oacs == 0 ||
+            mix[0] + mix[1] + mix[2] == 0)
+        {
+            std::cerr << "Nothing to request" << std::endl;
+            return 1;
+        }
+
+        // a database generated for a separate server is kept
+        bool temporary = home.empty() && !generateOnly;
+
+        if (home.empty())
+        {
+            char dir[] = "/tmp/spoac_ltmbench_XXXXXX";
+
+            if (mkdtemp(dir) == NULL)
+            {
+                std::cerr << "Could not create a temporary directory" <<
+                    std::endl;
+                return 1;
+            }
+
+            home = dir;
+        }
+
+        setenv("MCAPROJECTHOME", home.string().c_str(), 1);
+
+        int status;
+
+        try
+        {
+            // a running server reads the database itself
+            if (proxy.empty() || generateOnly)
+            {
+                generate(LTM::getDatabasePath(), database);
+
+                std::cout << "Generated " << database.scenarios <<
+                    " scenarios and " << database.oacs << " OACs with " <<
+                    database.rules << " rules in " <<
+                    LTM::getDatabasePath().string() << std::endl;
+            }
+
+            if (generateOnly)
+            {
+                status = 0;
+            }
+            else if (proxy.empty())
+            {
+                status = runLocal(database, mix, seconds, callerCounts,
+                    JSON::Codec::getFormat(configFormat), cacheSize,
+                    workerThreads, compile, snapshot);
+            }
+            else
+            {
+                status = runRemote(proxy, database, mix, seconds,
+                    callerCounts);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            status = 1;
+        }
+
+        if (temporary)
+        {
+            fs::remove_all(home);
+        }
+
+        return status;
+    }
+
+protected:
+    int runLocal(
+        const Database& database,
+        const std::vector<unsigned int>& mix,
+        int seconds,
+        const std::vector<unsigned int>& callerCounts,
+        JSON::CodecFormat configFormat,
+        size_t cacheSize,
+        size_t workerThreads,
+        bool compile,
+        bool snapshot)
+    {
+        fs::path compiledPath;
+
+        if (compile)
+        {
+            Catalog catalog(LTM::getDatabasePath());
+            compiledPath = LTM::getCompiledDatabasePath();
+            CompiledDatabase::compile(catalog, compiledPath);
+        }
+
+        Ice::PropertiesPtr properties = communicator()->getProperties();
+
+        if (properties->getProperty("LTMBench.ThreadPool.Size").empty())
+        {
+            properties->setProperty("LTMBench.ThreadPool.Size", "4");
+        }
+
+        // only reachable from this machine
+        Ice::ObjectAdapterPtr adapter =
+            communicator()->createObjectAdapterWithEndpoints("LTMBench",
+                "tcp -h 127.0.0.1 -p 0");
+
+        WorkQueuePtr workQueue(new WorkQueue(workerThreads));
+
+        LTM* ltm = new LTM(configFormat, cacheSize * 1024 * 1024, workQueue,
+            compiledPath);
+        Ice::ObjectPtr object = ltm;
+
+        if (snapshot)
+        {
+            ltm->reload();
+        }
+
+        // requests go through the network stack like those of a separate
+        // client instead of being dispatched directly
+        Ice::ObjectPrx base = adapter->add(object,
+            communicator()->stringToIdentity("LTM"));
+        adapter->activate();
+
+        int status = measure(LTMSlice::LTMPrx::uncheckedCast(
+            base->ice_collocationOptimized(false)), database, mix, seconds,
+            callerCounts);
+
+        adapter->destroy();
+        workQueue->destroy();
+
+        return status;
+    }
+
+    int runRemote(
+        const std::string& proxy,
+        const Database& database,
+        const std::vector<unsigned int>& mix,
+        int seconds,
+        const std::vector<unsigned int>& callerCounts)
+    {
+        LTMSlice::LTMPrx ltm = LTMSlice::LTMPrx::checkedCast(
+            communicator()->stringToProxy(proxy));
+
+        if (!ltm)
+        {
+            std::cerr << "Invalid proxy " << proxy << std::endl;
+            return 1;
+        }
+
+        return measure(ltm, database, mix, seconds, callerCounts);
+    }
+
+    int measure(
+        const LTMSlice::LTMPrx& ltm,
+        const Database& database,
+        const std::vector<unsigned int>& mix,
+        int seconds,
+        const std::vector<unsigned int>& callerCounts)
+    {
+        // the first requests read the files, they are not measured
+        for (size_t s = 0; s < database.scenarios; s++)
+        {
+            ltm->getScenario("Scenario" + toString(s));
+        }
+
+        for (size_t o = 0; o < database.oacs; o++)
+        {
+            LTMSlice::OAC oac;
+            oac.name = "Oac" + toString(o);
+
+            ltm->getAction(oac.name);
+            ltm->getActionConfig(oac);
+        }
+
+        std::vector<unsigned int>::const_iterator count;
+
+        for (count = callerCounts.begin(); count != callerCounts.end();
+            ++count)
+        {
+            IceUtil::Time start = IceUtil::Time::now();
+            IceUtil::Time end = start + IceUtil::Time::seconds(seconds);
+
+            std::vector<CallerPtr> callers;
+            std::vector<IceUtil::ThreadControl> threads;
+
+            for (size_t i = 0; i < *count; i++)
+            {
+                callers.push_back(new Caller(ltm, database, mix, i + 1, end));
+                threads.push_back(callers.back()->start());
+            }
+
+            std::vector<std::vector<Ice::Long> > latencies(OPERATION_COUNT);
+            std::vector<Ice::Long> all;
+            bool failed = false;
+
+            for (size_t i = 0; i < *count; i++)
+            {
+                threads[i].join();
+                failed = failed || callers[i]->hasFailed();
+
+                for (size_t o = 0; o < OPERATION_COUNT; o++)
+                {
+                    const std::vector<Ice::Long>& measured =
+                        callers[i]->getLatencies(static_cast<Operation>(o));
+
+                    latencies[o].insert(latencies[o].end(), measured.begin(),
+                        measured.end());
+                    all.insert(all.end(), measured.begin(), measured.end());
+                }
+            }
+
+            if (failed)
+            {
+                return 1;
+            }
+
+            double elapsed =
+                (IceUtil::Time::now() - start).toSecondsDouble();
+
+            std::cout << std::endl << *count << " callers: " <<
+                std::fixed << std::setprecision(0) << all.size() / elapsed <<
+                " req/s" << std::endl;
+            std::cout << std::setw(20) << "operation" << std::setw(12) <<
+                "requests" << std::setw(10) << "p50 us" << std::setw(10) <<
+                "p99 us" << std::setw(10) << "p999 us" << std::setw(10) <<
+                "max us" << std::endl;
+
+            for (size_t o = 0; o < OPERATION_COUNT; o++)
+            {
+                printLatencies(operationNames[o], latencies[o]);
+            }
+
+            printLatencies("all", all);
+        }
+
+        return 0;
+    }
+};
+
+int
+main(int argc, char* argv[])
+{
+    LTMBench app;
+    return app.main(argc, argv);
+}
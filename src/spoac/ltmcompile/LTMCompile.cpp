@@ -0,0 +1,96 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+/**
+* Compiles the LTM database into a single binary file, which the LTM
+* server maps into memory on startup instead of parsing the JSON files.
+*
+* Usage: ltmcompile [-d database directory] [-o output file]
+*
+* Both default to the locations the server uses, below MCAPROJECTHOME.
+* The database has to be compiled again after files have been changed,
+* until then the server reads the changed files from the JSON tree.
+*/
+
+#include <spoac/ltm/CompiledDatabase.h>
+#include <spoac/ltm/LTM.h>
+
+#include <IceUtil/Time.h>
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+using namespace spoac;
+
+int
+main(int argc, char* argv[])
+{
+    boost::filesystem::path root = LTM::getDatabasePath();
+    boost::filesystem::path output;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+        {
+            root = argv[++i];
+        }
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            output = argv[++i];
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] <<
+                " [-d database directory] [-o output file]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (output.empty())
+    {
+        output = root.string() + ".bin";
+    }
+
+    try
+    {
+        IceUtil::Time start = IceUtil::Time::now();
+
+        Catalog catalog(root);
+        size_t files = CompiledDatabase::compile(catalog, output);
+        CompiledDatabase database(output);
+
+        std::cout << "Compiled " << files << " files into " <<
+            output.string() << " in " <<
+            (IceUtil::Time::now() - start).toMilliSecondsDouble() <<
+            " ms, version " << std::hex << std::setw(16) <<
+            std::setfill('0') << database.getVersion() << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
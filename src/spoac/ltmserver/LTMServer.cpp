@@ -25,25 +25,110 @@
 #include <spoac/common/DependencyManager.h>
 
 #include <Ice/Ice.h>
+#include <iostream>
 
 using namespace spoac;
 
+/**
+* Reads a property which must not be negative, using the default with a
+* warning if it is.
+*/
+static size_t getSizeProperty(
+    const Ice::PropertiesPtr& properties,
+    const std::string& name,
+    int defaultValue)
+{
+    int value = properties->getPropertyAsIntWithDefault(name, defaultValue);
+
+    if (value < 0)
+    {
+        std::cerr << "Ignoring negative " << name << " " << value <<
+            ", using " << defaultValue << std::endl;
+        return defaultValue;
+    }
+
+    return value;
+}
+
 class LTMServer : virtual public Ice::Application
 {
 public:
     virtual int run(int, char*[])
     {
         DependencyManagerPtr manager(new DependencyManager());
+        Ice::PropertiesPtr properties = communicator()->getProperties();
+
+        // the adapter listens on LTM.Endpoints and dispatches requests
+        // with LTM.ThreadPool.Size threads, requests reading files are
+        // answered by LTM.WorkerThreads further threads
+        std::string endpoints = properties->getPropertyWithDefault(
+            "LTM.Endpoints", "tcp -p 10099");
+
+        if (properties->getProperty("LTM.ThreadPool.Size").empty())
+        {
+            properties->setProperty("LTM.ThreadPool.Size", "4");
+        }
+
+        size_t workerThreads = getSizeProperty(
+            properties, "LTM.WorkerThreads", 4);
 
         Ice::ObjectAdapterPtr adapter =
             communicator()->createObjectAdapterWithEndpoints(
-                "LTM", "tcp -p 10099");
-        Ice::ObjectPtr object = new LTM;
+                "LTM", endpoints);
+        // action configs are sent as JSON text unless LTM.ConfigFormat is
+        // set to binary, receivers detect the format either way
+        JSON::CodecFormat configFormat = JSON::Codec::getFormat(
+            properties->getPropertyWithDefault("LTM.ConfigFormat", "text"));
+
+        // parsed files are cached up to LTM.CacheSize megabytes, 0
+        // disables the cache
+        size_t cacheSize = getSizeProperty(properties, "LTM.CacheSize", 64);
+
+        // files compiled by ltmcompile are answered from the compiled
+        // database as long as they have not changed since
+        std::string compiledPath = properties->getPropertyWithDefault(
+            "LTM.CompiledDatabase", LTM::getCompiledDatabasePath().string());
+
+        // the database is loaded into a snapshot, which is replaced once
+        // it has changed, checking every LTM.ReloadInterval milliseconds,
+        // 0 reads files on demand instead
+        int reloadInterval = properties->getPropertyAsIntWithDefault(
+            "LTM.ReloadInterval", 1000);
+
+        // changes inotify misses, made by other clients of a network
+        // filesystem, are found by a stat of every file every
+        // LTM.StatInterval seconds
+        size_t statInterval = getSizeProperty(
+            properties, "LTM.StatInterval", 60);
+
+        WorkQueuePtr workQueue(new WorkQueue(workerThreads));
+
+        LTM* ltm = new LTM(configFormat, cacheSize * 1024 * 1024, workQueue,
+            compiledPath);
+        Ice::ObjectPtr object = ltm;
+
+        if (reloadInterval > 0)
+        {
+            ltm->startReloading(IceUtil::Time::milliSeconds(reloadInterval),
+                IceUtil::Time::seconds(statInterval));
+        }
+
         adapter->add(object, communicator()->stringToIdentity("LTM"));
         adapter->activate();
 
+        std::cout << "LTM listening on " << endpoints << " with " <<
+            properties->getProperty("LTM.ThreadPool.Size") <<
+            " dispatch and " << workQueue->getThreadCount() <<
+            " worker threads, caching up to " << cacheSize << " MB" <<
+            std::endl;
+
         communicator()->waitForShutdown();
 
+        // all requests have been answered once the communicator is shut
+        // down, the LTM is destroyed with it
+        ltm->stopReloading();
+        workQueue->destroy();
+
         return 0;
     }
 };
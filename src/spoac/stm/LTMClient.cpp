@@ -0,0 +1,217 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+
+#include <spoac/stm/LTMClient.h>
+#include <spoac/JSON/Codec.h>
+
+using namespace spoac;
+
+LTMClient::RegisterService LTMClient::r;
+
+boost::shared_ptr<void> LTMClient::createService(DependencyManagerPtr manager)
+{
+    boost::shared_ptr<void> ltmClient(new LTMClient(
+        manager->getService<ice::IceHelper>()
+    ));
+    return ltmClient;
+}
+
+LTMClient::LTMClient(
+    ice::IceHelperPtr iceHelper,
+    const std::string& proxyString,
+    const IceUtil::Time& checkInterval,
+    size_t maxEntries) :
+    iceHelper(iceHelper),
+    proxyString(proxyString),
+    checkInterval(checkInterval),
+    maxEntries(maxEntries),
+    version(0),
+    checked(false),
+    hits(0),
+    misses(0)
+{
+}
+
+LTMSlice::LTMPrx LTMClient::getProxy()
+{
+    {
+        IceUtil::Mutex::Lock lock(mutex);
+
+        if (proxy)
+        {
+            return proxy;
+        }
+    }
+
+    // checking the proxy takes a round trip, so it is only done once and
+    // without holding up other threads
+    LTMSlice::LTMPrx checkedProxy =
+        iceHelper->getProxy<LTMSlice::LTMPrx>(proxyString);
+
+    IceUtil::Mutex::Lock lock(mutex);
+
+    // another thread may have checked it meanwhile
+    if (!proxy)
+    {
+        proxy = checkedProxy;
+    }
+
+    return proxy;
+}
+
+LTMClient::ActionConfigPtr LTMClient::getActionConfig(
+    const std::string& oac,
+    const ObjectVector& objects)
+{
+    std::string key;
+    JSON::BinaryWriter writer(key);
+    writer.onString(oac);
+
+    for (ObjectVector::size_type i = 0; i < objects.size(); i++)
+    {
+        objects[i]->appendKey(key);
+    }
+
+    LTMSlice::LTMPrx ltm = getProxy();
+    Ice::Long requestVersion;
+
+    checkVersion(ltm);
+
+    {
+        IceUtil::Mutex::Lock lock(mutex);
+
+        std::map<std::string, ActionConfigPtr>::const_iterator it =
+            actionConfigs.find(key);
+
+        if (it != actionConfigs.end())
+        {
+            hits++;
+            return it->second;
+        }
+
+        misses++;
+        requestVersion = version;
+    }
+
+    // other OACs can be set up while this one is retrieved
+    LTMSlice::OAC oacInstance;
+    oacInstance.name = oac;
+
+    for (ObjectVector::size_type i = 0; i < objects.size(); i++)
+    {
+        oacInstance.objects.push_back(objects[i]->toLTMObj());
+    }
+
+    LTMSlice::ActionConfig actionConfig = ltm->getActionConfig(oacInstance);
+
+    boost::shared_ptr<ActionConfig> result(new ActionConfig);
+    result->name = actionConfig.name;
+
+    if (!actionConfig.config.empty())
+    {
+        result->config = JSON::Codec::decode(actionConfig.config);
+    }
+
+    IceUtil::Mutex::Lock lock(mutex);
+
+    // a config retrieved while the database changed may be outdated
+    if (version == requestVersion)
+    {
+        if (actionConfigs.size() >= maxEntries &&
+            actionConfigs.find(key) == actionConfigs.end())
+        {
+            // the neighbour of the new key is dropped, which is as good
+            // as any other entry without keeping track of their use
+            std::map<std::string, ActionConfigPtr>::iterator evicted =
+                actionConfigs.upper_bound(key);
+
+            if (evicted == actionConfigs.end())
+            {
+                evicted = actionConfigs.begin();
+            }
+
+            actionConfigs.erase(evicted);
+        }
+
+        actionConfigs[key] = result;
+    }
+
+    return result;
+}
+
+void LTMClient::clear()
+{
+    IceUtil::Mutex::Lock lock(mutex);
+
+    actionConfigs.clear();
+    checked = false;
+}
+
+size_t LTMClient::getHits()
+{
+    IceUtil::Mutex::Lock lock(mutex);
+
+    return hits;
+}
+
+size_t LTMClient::getMisses()
+{
+    IceUtil::Mutex::Lock lock(mutex);
+
+    return misses;
+}
+
+void LTMClient::checkVersion(const LTMSlice::LTMPrx& ltm)
+{
+    IceUtil::Time now = IceUtil::Time::now();
+
+    {
+        IceUtil::Mutex::Lock lock(mutex);
+
+        if (checked && now - lastCheck < checkInterval)
+        {
+            return;
+        }
+    }
+
+    // other threads keep answering from the cache during the round trip
+    Ice::Long current = ltm->getVersion();
+
+    IceUtil::Mutex::Lock lock(mutex);
+
+    // a check started later has already been stored
+    if (checked && now < lastCheck)
+    {
+        return;
+    }
+
+    if (!checked || current != version)
+    {
+        actionConfigs.clear();
+    }
+
+    version = current;
+    lastCheck = now;
+    checked = true;
+}
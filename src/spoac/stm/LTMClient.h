@@ -0,0 +1,168 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+
+#ifndef SPOAC_STM_LTMCLIENT_H
+#define SPOAC_STM_LTMCLIENT_H
+
+#include <spoac/common/DependencyManager.h>
+#include <spoac/stm/ObjectVector.h>
+#include <spoac/ice/IceHelper.h>
+#include <spoac/JSON/Value.h>
+#include <spoac/LTM.h>
+
+#include <map>
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include <IceUtil/Mutex.h>
+#include <IceUtil/Time.h>
+
+namespace spoac
+{
+    /**
+    * Client side access to the long term memory.
+    *
+    * The proxy is only checked once and reused afterwards. Action configs
+    * are kept along with their decoded config, so an OAC which is set up
+    * with unchanged objects again, as in a pick and place loop, does not
+    * need any call to the long term memory. All of them are dropped once
+    * the version of the long term memory changes, which is checked at
+    * most once per check interval. Once the maximum number of action
+    * configs is kept, one of them is dropped for every new one.
+    */
+    class LTMClient
+    {
+    public:
+        /**
+        * An action config with its config already decoded.
+        *
+        * Configs are shared by everyone setting up the same OAC instance
+        * and must not be modified.
+        */
+        struct ActionConfig
+        {
+            std::string name;
+            JSON::ValuePtr config;
+        };
+
+        typedef boost::shared_ptr<const ActionConfig> ActionConfigPtr;
+
+        /**
+        * Creates an instance of this class with the right dependencies.
+        *
+        * @param manager The DependencyManager providing necessary dependencies.
+        */
+        static boost::shared_ptr<void> createService(
+            DependencyManagerPtr manager);
+
+        /**
+        * Constructor storing dependencies
+        *
+        * @param iceHelper     Used to connect to the long term memory.
+        * @param proxyString   Identity and endpoints of the long term
+        *                      memory.
+        * @param checkInterval Time for which the version of the long term
+        *                      memory is assumed to be unchanged, changes
+        *                      made meanwhile are only seen afterwards.
+        * @param maxEntries    Number of action configs kept, one of them
+        *                      is dropped for every further one.
+        */
+        LTMClient(
+            ice::IceHelperPtr iceHelper,
+            const std::string& proxyString = "LTM:tcp -p 10099",
+            const IceUtil::Time& checkInterval = IceUtil::Time::seconds(1),
+            size_t maxEntries = 1024);
+
+        /**
+        * @return The proxy of the long term memory, which is only checked
+        *         on the first call.
+        */
+        LTMSlice::LTMPrx getProxy();
+
+        /**
+        * Retrieves the action config of an OAC instance, from the long
+        * term memory only if it has not been retrieved for equal objects
+        * before.
+        *
+        * @param oac     Name of the OAC.
+        * @param objects The objects the OAC is executed with.
+        */
+        ActionConfigPtr getActionConfig(
+            const std::string& oac,
+            const ObjectVector& objects);
+
+        /**
+        * Drops all action configs.
+        */
+        void clear();
+
+        /**
+        * @return Number of action configs which did not need a call to the
+        *         long term memory.
+        */
+        size_t getHits();
+
+        /**
+        * @return Number of action configs retrieved from the long term
+        *         memory.
+        */
+        size_t getMisses();
+
+    protected:
+        /**
+        * Drops all action configs if the long term memory has changed,
+        * unless it has been checked within the check interval. The mutex
+        * must not be locked, it is released while the version is
+        * retrieved.
+        */
+        void checkVersion(const LTMSlice::LTMPrx& ltm);
+
+        ice::IceHelperPtr iceHelper;
+        std::string proxyString;
+        IceUtil::Time checkInterval;
+        size_t maxEntries;
+
+        LTMSlice::LTMPrx proxy;
+
+        // keyed by the OAC name followed by the key of every object
+        std::map<std::string, ActionConfigPtr> actionConfigs;
+        Ice::Long version;
+        IceUtil::Time lastCheck;
+        bool checked;
+
+        size_t hits;
+        size_t misses;
+
+        IceUtil::Mutex mutex;
+
+        typedef DependencyManager::RegisterService<LTMClient> RegisterService;
+        static RegisterService r;
+    };
+
+    /**
+    * Pointer type to reduce typing for shared pointers.
+    */
+    typedef boost::shared_ptr<LTMClient> LTMClientPtr;
+}
+
+#endif
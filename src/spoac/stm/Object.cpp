@@ -22,6 +22,7 @@
 */
 
 #include <spoac/stm/Object.h>
+#include <spoac/stm/STMException.h>
 
 using namespace spoac;
 
@@ -31,6 +32,31 @@ Object::Object(const std::string& name, const std::string& id) :
 {
 }
 
+Object::Object(const Object& object) :
+    PropertyMap(object),
+    name(object.name),
+    id(object.id)
+{
+}
+
+Object& Object::operator=(const Object& object)
+{
+    // sets find their objects by id, which is why it must not change
+    // while anyone is listening
+    if (id != object.id && !listeners.empty())
+    {
+        throw STMException("Cannot change the id of object '" + id +
+            "' to '" + object.id + "' while it is in a set");
+    }
+
+    name = object.name;
+    id = object.id;
+
+    PropertyMap::operator=(object);
+
+    return *this;
+}
+
 std::string Object::getName()
 {
     return name;
@@ -43,9 +69,28 @@ std::string Object::getId()
 
 std::string Object::toJSONString()
 {
-    JSON::ObjectPtr object = toJSON();
+    std::string json;
+    JSON::Writer writer(json);
+
+    write(writer);
+
+    return json;
+}
+
+void Object::write(JSON::Writer& writer)
+{
+    WriterVisitor<JSON::Writer> visitor(writer);
+    iterator it;
+
+    writer.onObjectStart();
 
-    return object->toJSON();
+    for (it = begin(); it != end(); ++it)
+    {
+        writer.onKey(it->first);
+        boost::apply_visitor(visitor, it->second);
+    }
+
+    writer.onObjectEnd();
 }
 
 JSON::ObjectPtr Object::toJSON()
@@ -62,23 +107,105 @@ JSON::ObjectPtr Object::toJSON()
     return object;
 }
 
-LTMSlice::Obj Object::toLTMObj()
+template <class WriterType>
+void Object::writeProperties(WriterType& writer, const std::string& buffer,
+    LTMSlice::Obj& obj)
+{
+    WriterVisitor<WriterType> visitor(writer);
+    iterator it;
+
+    for (it = begin(); it != end(); ++it)
+    {
+        writer.clear();
+        boost::apply_visitor(visitor, it->second);
+
+        obj.properties.insert(
+            std::pair<std::string, std::string>(it->first, buffer)
+        );
+    }
+}
+
+LTMSlice::Obj Object::toLTMObj(JSON::CodecFormat format)
 {
     LTMSlice::Obj obj;
 
     obj.id = getId();
 
-    JSONVisitor visitor;
+    // one buffer is reused for all properties
+    std::string buffer;
+
+    if (format == JSON::CODEC_BINARY)
+    {
+        JSON::BinaryWriter writer(buffer);
+        writeProperties(writer, buffer, obj);
+    }
+    else
+    {
+        JSON::Writer writer(buffer);
+        writeProperties(writer, buffer, obj);
+    }
+
+    return obj;
+}
+
+void Object::appendKey(std::string& key)
+{
+    JSON::BinaryWriter writer(key);
+    WriterVisitor<JSON::BinaryWriter> visitor(writer);
     iterator it;
 
+    // every value is self-delimiting, so keys of several objects can be
+    // appended to each other
+    writer.onArrayStart();
+    writer.onString(getId());
+    writer.onObjectStart();
+
     for (it = begin(); it != end(); ++it)
     {
-        obj.properties.insert(
-            std::pair<std::string, std::string>(
-                it->first, boost::apply_visitor(visitor, it->second)->toJSON()
-            )
-        );
+        writer.onKey(it->first);
+        boost::apply_visitor(visitor, it->second);
     }
 
-    return obj;
+    writer.onObjectEnd();
+    writer.onArrayEnd();
+}
+
+void Object::addListener(ObjectListener* listener)
+{
+    listeners.push_back(listener);
+}
+
+void Object::removeListener(ObjectListener* listener)
+{
+    std::vector<ObjectListener*>::iterator it =
+        std::find(listeners.begin(), listeners.end(), listener);
+
+    if (it != listeners.end())
+    {
+        listeners.erase(it);
+    }
+}
+
+void Object::keyInserted(const std::string& key)
+{
+    for (size_t i = 0; i < listeners.size(); i++)
+    {
+        listeners[i]->keyInserted(*this, key);
+    }
+}
+
+void Object::keyErased(const std::string& key)
+{
+    for (size_t i = 0; i < listeners.size(); i++)
+    {
+        listeners[i]->keyErased(*this, key);
+    }
+}
+
+void Object::keyWritten(const std::string& key)
+{
+    for (size_t i = 0; i < listeners.size(); i++)
+    {
+        listeners[i]->keyWritten(*this, key);
+    }
 }
@@ -25,14 +25,46 @@
 #define SPOAC_STM_OBJECT_H
 
 #include <spoac/JSON/AllValueTypes.h>
+#include <spoac/JSON/BinaryWriter.h>
+#include <spoac/JSON/Codec.h>
+#include <spoac/JSON/Writer.h>
 #include <spoac/stm/VariantMap.h>
 #include <spoac/LTM.h>
 
 #include <string>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 
 namespace spoac
 {
+    class Object;
+
+    /**
+    * Interface of classes which are told about properties being added to,
+    * written or removed from objects, e.g. to keep an index of them.
+    */
+    class ObjectListener
+    {
+    public:
+        virtual ~ObjectListener() {}
+
+        /**
+        * Called after a property was added to an object.
+        */
+        virtual void keyInserted(Object& object, const std::string& key) = 0;
+
+        /**
+        * Called after a property was removed from an object.
+        */
+        virtual void keyErased(Object& object, const std::string& key) = 0;
+
+        /**
+        * Called when a property of an object may have been written, see
+        * VariantMap::keyWritten().
+        */
+        virtual void keyWritten(Object& object, const std::string& key) = 0;
+    };
+
     /**
     * Abstract base class for all objects any action can deal with.
     */
@@ -43,6 +75,15 @@ namespace spoac
     >
     {
     public:
+        /**
+        * The map of properties an object is made of.
+        */
+        typedef VariantMap<
+            std::string,
+            std::string, bool, int, double, JSON::ValuePtr,
+            std::pair<bool, std::string>
+        > PropertyMap;
+
         /**
         * Creates an empty object with a name.
         *
@@ -52,6 +93,20 @@ namespace spoac
         */
         Object(const std::string& name, const std::string& id);
 
+        /**
+        * Copies name, id and properties but none of the listeners.
+        */
+        Object(const Object& object);
+
+        /**
+        * Copies name, id and properties, telling the listeners of this
+        * object about the properties being replaced.
+        *
+        * @throws STMException if the id would change while the object
+        *         has listeners, such as an ObjectSet holding it.
+        */
+        Object& operator=(const Object& object);
+
         /**
         * Getter for object (type) name.
         * @return Object's name.
@@ -78,12 +133,47 @@ namespace spoac
         */
         std::string toJSONString();
 
+        /**
+        * Writes all data as a JSON object without copying it into a
+        * JSON::Object first.
+        *
+        * @param writer The writer to write the object to.
+        */
+        void write(JSON::Writer& writer);
+
         /**
         * Encodes the object for use with long term memory.
+        *
+        * @param format Encoding of the property values, binary values
+        *               save the long term memory parsing them.
+        */
+        LTMSlice::Obj toLTMObj(JSON::CodecFormat format = JSON::CODEC_TEXT);
+
+        /**
+        * Appends the id and all properties in binary encoding, so two
+        * objects append the same bytes only if they are equal.
+        *
+        * @param key The string to append to.
         */
-        LTMSlice::Obj toLTMObj();
+        void appendKey(std::string& key);
+
+        /**
+        * Registers a listener to be told about properties being added,
+        * written or removed until it is removed again. The listener is not
+        * owned.
+        */
+        void addListener(ObjectListener* listener);
+
+        /**
+        * Removes a listener added with addListener().
+        */
+        void removeListener(ObjectListener* listener);
 
     protected:
+        void keyInserted(const std::string& key);
+        void keyErased(const std::string& key);
+        void keyWritten(const std::string& key);
+
         /**
         * A visitor which encodes the variant as a JSON object.
         */
@@ -130,8 +220,73 @@ namespace spoac
             }
         };
 
+        /**
+        * Encodes every property with its own reset writer into the
+        * properties of an LTM object.
+        */
+        template <class WriterType>
+        void writeProperties(WriterType& writer, const std::string& buffer,
+            LTMSlice::Obj& obj);
+
+        /**
+        * A visitor which writes the variant with a JSON::Writer or
+        * JSON::BinaryWriter, producing the same output as encoding the
+        * result of JSONVisitor.
+        */
+        template <class WriterType>
+        struct WriterVisitor : boost::static_visitor<void>
+        {
+            WriterVisitor(WriterType& writer) : writer(writer) {}
+
+            void operator()(const bool& x) const
+            {
+                writer.onBool(x);
+            }
+
+            void operator()(const int& x) const
+            {
+                writer.onNumber(JSON::Number(x));
+            }
+
+            void operator()(const double& x) const
+            {
+                writer.onNumber(JSON::Number(x));
+            }
+
+            void operator()(const JSON::ValuePtr& x) const
+            {
+                if (x)
+                {
+                    writer.write(*x);
+                }
+                else
+                {
+                    writer.onNull();
+                }
+            }
+
+            void operator()(const std::string& x) const
+            {
+                writer.onString(x);
+            }
+
+            void operator()(const std::pair<bool, std::string>& rel) const
+            {
+                writer.onObjectStart();
+                writer.onKey("related");
+                writer.onBool(rel.first);
+                writer.onKey("to");
+                writer.onString(rel.second);
+                writer.onObjectEnd();
+            }
+
+            WriterType& writer;
+        };
+
         std::string name;
         std::string id;
+
+        std::vector<ObjectListener*> listeners;
     };
 
     /**
@@ -23,8 +23,55 @@
 
 #include <spoac/stm/ObjectSet.h>
 
+#include <boost/functional/hash.hpp>
+
 using namespace spoac;
 
+const ObjectSet::size_type ObjectSet::npos;
+
+ObjectSet::ObjectSet() :
+    tracking(false)
+{
+}
+
+ObjectSet::ObjectSet(const ObjectSet& set) :
+    ObjectListener(),
+    objects(set.objects),
+    entries(set.entries),
+    hashes(set.hashes),
+    buckets(set.buckets),
+    indexes(set.indexes),
+    tracking(set.tracking),
+    changes(set.changes)
+{
+    listen();
+}
+
+ObjectSet& ObjectSet::operator=(const ObjectSet& set)
+{
+    if (this != &set)
+    {
+        unlisten();
+
+        objects = set.objects;
+        entries = set.entries;
+        hashes = set.hashes;
+        buckets = set.buckets;
+        indexes = set.indexes;
+        tracking = set.tracking;
+        changes = set.changes;
+
+        listen();
+    }
+
+    return *this;
+}
+
+ObjectSet::~ObjectSet()
+{
+    unlisten();
+}
+
 ObjectSet::size_type ObjectSet::size() const
 {
     return objects.size();
@@ -32,25 +79,53 @@ ObjectSet::size_type ObjectSet::size() const
 
 void ObjectSet::insert(ObjectPtr object)
 {
-    std::pair<ObjectSet::SetType::iterator, bool> result =
-        objects.insert(object);
+    const std::string& id = object->getId();
+    size_t hash = boost::hash<std::string>()(id);
 
-    if (result.second)
+    if (buckets.size() < 2 * (objects.size() + 1))
     {
-        objectMap[object->getId()] = result.first;
+        grow();
     }
+
+    size_type bucket = findBucket(id, hash);
+
+    if (buckets[bucket] != 0)
+    {
+        size_type slot = buckets[bucket] - 1;
+
+        unindexSlot(slot);
+        objects[slot]->removeListener(this);
+        objectChanged(slot, *objects[slot]);
+
+        objects[slot] = object;
+        entries[slot].second = ObjectRef(object);
+
+        object->addListener(this);
+        indexSlot(slot);
+        objectChanged(slot, *object);
+        return;
+    }
+
+    buckets[bucket] = objects.size() + 1;
+    objects.push_back(object);
+    entries.push_back(std::make_pair(id, ObjectRef(object)));
+    hashes.push_back(hash);
+
+    object->addListener(this);
+    indexSlot(objects.size() - 1);
+    objectChanged(objects.size() - 1, *object);
 }
 
 ObjectPtr ObjectSet::operator[](const std::string& id)
 {
-    ObjectSet::MapType::iterator objIt = objectMap.find(id);
+    size_type slot = find(id);
 
-    if (objIt == objectMap.end())
+    if (slot == npos)
     {
         throw STMException(std::string("Object not found: ") + id);
     }
 
-    return *(objIt->second);
+    return objects[slot];
 }
 
 ObjectPtr ObjectSet::get(const std::string& id)
@@ -60,19 +135,267 @@ ObjectPtr ObjectSet::get(const std::string& id)
 
 bool ObjectSet::exists(const std::string& id) const
 {
-    if (objectMap.find(id) == objectMap.end())
+    return find(id) != npos;
+}
+
+ObjectSet::size_type ObjectSet::find(const std::string& id) const
+{
+    if (buckets.empty())
+    {
+        return npos;
+    }
+
+    size_type bucket = findBucket(id, boost::hash<std::string>()(id));
+
+    // an empty bucket holds 0, which gives npos
+    return buckets[bucket] - 1;
+}
+
+ObjectSet::size_type ObjectSet::findBucket(
+    const std::string& id,
+    size_t hash) const
+{
+    size_type mask = buckets.size() - 1;
+    size_type bucket = hash & mask;
+
+    // linear probing, there is always an empty bucket to stop at
+    while (buckets[bucket] != 0)
+    {
+        size_type slot = buckets[bucket] - 1;
+
+        if (hashes[slot] == hash && entries[slot].first == id)
+        {
+            break;
+        }
+
+        bucket = (bucket + 1) & mask;
+    }
+
+    return bucket;
+}
+
+void ObjectSet::grow()
+{
+    size_type count = (buckets.empty()) ? 16 : buckets.size() * 2;
+    size_type mask = count - 1;
+
+    buckets.assign(count, 0);
+
+    for (size_type slot = 0; slot < objects.size(); slot++)
     {
-        return false;
+        size_type bucket = hashes[slot] & mask;
+
+        while (buckets[bucket] != 0)
+        {
+            bucket = (bucket + 1) & mask;
+        }
+
+        buckets[bucket] = slot + 1;
     }
+}
 
-    return true;
+void ObjectSet::addIndex(const std::string& key)
+{
+    if (hasIndex(key))
+    {
+        return;
+    }
+
+    SlotSet& index = indexes[key];
+
+    for (size_type slot = 0; slot < objects.size(); slot++)
+    {
+        if (objects[slot]->has_key(key))
+        {
+            index.insert(index.end(), slot);
+        }
+    }
+}
+
+void ObjectSet::removeIndex(const std::string& key)
+{
+    indexes.erase(key);
+}
+
+bool ObjectSet::hasIndex(const std::string& key) const
+{
+    return indexes.find(key) != indexes.end();
+}
+
+const ObjectSet::SlotSet& ObjectSet::findWithKey(const std::string& key) const
+{
+    IndexMap::const_iterator index = indexes.find(key);
+
+    if (index == indexes.end())
+    {
+        throw STMException(std::string("Property not indexed: ") + key);
+    }
+
+    return index->second;
+}
+
+void ObjectSet::drainChanges(ChangeMap& changes)
+{
+    ChangeMap::iterator it;
+
+    for (it = this->changes.begin(); it != this->changes.end(); ++it)
+    {
+        changes[it->first].insert(it->second.begin(), it->second.end());
+    }
+
+    this->changes.clear();
+    tracking = true;
+}
+
+void ObjectSet::indexSlot(size_type slot)
+{
+    IndexMap::iterator index;
+
+    for (index = indexes.begin(); index != indexes.end(); ++index)
+    {
+        if (objects[slot]->has_key(index->first))
+        {
+            index->second.insert(slot);
+        }
+    }
+}
+
+void ObjectSet::unindexSlot(size_type slot)
+{
+    IndexMap::iterator index;
+
+    for (index = indexes.begin(); index != indexes.end(); ++index)
+    {
+        index->second.erase(slot);
+    }
+}
+
+void ObjectSet::keyInserted(Object& object, const std::string& key)
+{
+    IndexMap::iterator index = indexes.find(key);
+
+    if (index == indexes.end())
+    {
+        return;
+    }
+
+    size_type slot = findObject(object);
+
+    if (slot != npos)
+    {
+        index->second.insert(slot);
+    }
+}
+
+void ObjectSet::keyErased(Object& object, const std::string& key)
+{
+    IndexMap::iterator index = indexes.find(key);
+
+    if (index == indexes.end() && ! tracking)
+    {
+        return;
+    }
+
+    size_type slot = findObject(object);
+
+    if (slot == npos)
+    {
+        return;
+    }
+
+    if (index != indexes.end())
+    {
+        index->second.erase(slot);
+    }
+
+    if (tracking)
+    {
+        changes[slot].insert(key);
+    }
+}
+
+void ObjectSet::keyWritten(Object& object, const std::string& key)
+{
+    if ( ! tracking)
+    {
+        return;
+    }
+
+    size_type slot = findObject(object);
+
+    if (slot != npos)
+    {
+        changes[slot].insert(key);
+    }
+}
+
+void ObjectSet::objectChanged(size_type slot, Object& object)
+{
+    if ( ! tracking)
+    {
+        return;
+    }
+
+    std::set<std::string>& keys = changes[slot];
+    Object::const_iterator it;
+
+    for (it = object.begin(); it != object.end(); ++it)
+    {
+        keys.insert(it->first);
+    }
+}
+
+ObjectSet::size_type ObjectSet::findObject(Object& object) const
+{
+    size_type slot = find(object.getId());
+
+    if (slot != npos && objects[slot].get() != &object)
+    {
+        return npos;
+    }
+
+    return slot;
+}
+
+void ObjectSet::listen()
+{
+    for (size_type slot = 0; slot < objects.size(); slot++)
+    {
+        objects[slot]->addListener(this);
+    }
+}
+
+void ObjectSet::unlisten()
+{
+    for (size_type slot = 0; slot < objects.size(); slot++)
+    {
+        objects[slot]->removeListener(this);
+    }
 }
 
 std::string ObjectSet::toJSONString()
 {
-    JSON::ObjectPtr object = toJSON();
+    std::string json;
+    JSON::Writer writer(json);
+
+    write(writer);
+
+    return json;
+}
+
+void ObjectSet::write(JSON::Writer& writer)
+{
+    iterator_map it;
+
+    writer.onObjectStart();
+
+    for (it = beginMap(); it != endMap(); ++it)
+    {
+        writer.onKey(it->first);
+        (*(it->second))->write(writer);
+    }
 
-    return object->toJSON();
+    writer.onObjectEnd();
 }
 
 JSON::ObjectPtr ObjectSet::toJSON()
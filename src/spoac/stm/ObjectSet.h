@@ -24,7 +24,11 @@
 #ifndef SPOAC_STM_OBJECTSET_H
 #define SPOAC_STM_OBJECTSET_H
 
+#include <map>
 #include <set>
+#include <string>
+#include <utility>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 
 #include <spoac/stm/Object.h>
@@ -33,47 +37,99 @@
 namespace spoac
 {
     /**
-    * A wrapper around std::set< ObjectPtr > and a STL map to look the objects
-    * up by id.
+    * A set of objects with unique ids.
+    *
+    * The objects are kept in a vector in the order they were inserted,
+    * each in a slot which does not change while the set exists. An open
+    * addressing hash table maps ids to slots, so looking an object up by
+    * id takes constant time and iterating only walks the vector.
+    *
+    * Optionally the set keeps indexes of the objects which have a given
+    * property, updated whenever properties are added to or removed from
+    * the objects in it, and records which properties of which objects
+    * changed until the changes are drained.
     */
-    class ObjectSet
+    class ObjectSet : protected ObjectListener
     {
     public:
         /**
-        * Convenience typedef of the underlying STL set.
+        * An object in the id view, dereferenced to its pointer like the
+        * set iterator the view used to hold.
         */
-        typedef std::set<ObjectPtr> SetType;
+        class ObjectRef
+        {
+        public:
+            ObjectRef(const ObjectPtr& object) : object(object) {}
+
+            const ObjectPtr& operator*() const { return object; }
+            const ObjectPtr* operator->() const { return &object; }
+
+        protected:
+            ObjectPtr object;
+        };
+
+        /**
+        * Convenience typedef of the underlying vector of objects.
+        */
+        typedef std::vector<ObjectPtr> VectorType;
 
         /**
-        * Convenience typedef of the underlying STL map.
+        * Convenience typedef of the id view, in the same order.
         */
-        typedef std::map<std::string, SetType::iterator> MapType;
+        typedef std::vector<std::pair<std::string, ObjectRef> > MapType;
 
         /**
         * Vector size type.
         */
-        typedef SetType::size_type size_type;
+        typedef VectorType::size_type size_type;
 
         /**
-        * Set iterator type.
+        * Object iterator type, objects are replaced through insert() only.
         */
-        typedef SetType::iterator iterator;
+        typedef VectorType::const_iterator iterator;
 
         /**
-        * Constant set iterator type.
+        * Constant object iterator type.
         */
-        typedef SetType::const_iterator const_iterator;
+        typedef VectorType::const_iterator const_iterator;
 
         /**
-        * Map iterator type.
+        * Id view iterator type.
         */
-        typedef MapType::iterator iterator_map;
+        typedef MapType::const_iterator iterator_map;
 
         /**
-        * Constant map iterator type.
+        * Constant id view iterator type.
         */
         typedef MapType::const_iterator const_iterator_map;
 
+        /**
+        * Returned by find() for ids not in the set.
+        */
+        static const size_type npos = static_cast<size_type>(-1);
+
+        /**
+        * Ordered slots of the objects in an index, so iterating over them
+        * visits the objects in the same order as begin() to end().
+        */
+        typedef std::set<size_type> SlotSet;
+
+        /**
+        * The names of the changed properties by slot of the object.
+        */
+        typedef std::map<size_type, std::set<std::string> > ChangeMap;
+
+        ObjectSet();
+
+        /**
+        * Copies the objects and indexes of another set.
+        */
+        ObjectSet(const ObjectSet& set);
+
+        ObjectSet& operator=(const ObjectSet& set);
+
+        virtual ~ObjectSet();
+
         /**
         * Return size
         *
@@ -82,7 +138,8 @@ namespace spoac
         size_type size() const;
 
         /**
-        * Inserts a new object into the set.
+        * Inserts a new object into the set. An object with the same id
+        * is replaced, keeping its slot.
         */
         void insert(ObjectPtr object);
 
@@ -113,15 +170,76 @@ namespace spoac
         */
         bool exists(const std::string& id) const;
 
+        /**
+        * Looks up the slot of an object, which can be kept to access the
+        * object with at() later on.
+        *
+        * @param id The id of the object to be looked up
+        * @return   The slot or npos if there is no such object.
+        */
+        size_type find(const std::string& id) const;
+
+        /**
+        * @param slot A slot returned by find(), less than size().
+        * @return     The object in the slot.
+        */
+        const ObjectPtr& at(size_type slot) const { return objects[slot]; }
+
+        /**
+        * Starts indexing the objects which have a property, so they can be
+        * found with findWithKey(). Does nothing if there already is an
+        * index of the property.
+        *
+        * @param key The name of the property.
+        */
+        void addIndex(const std::string& key);
+
+        /**
+        * Stops indexing the objects which have a property. Does nothing if
+        * there is no index of the property.
+        *
+        * @param key The name of the property.
+        */
+        void removeIndex(const std::string& key);
+
+        /**
+        * @param key The name of the property.
+        * @return    True if addIndex() was called for the property.
+        */
+        bool hasIndex(const std::string& key) const;
+
+        /**
+        * Returns the slots of all objects which have a property. Throws a
+        * STMException if the property is not indexed.
+        *
+        * @param key The name of an indexed property.
+        * @return    The slots of the objects, valid until the next change.
+        */
+        const SlotSet& findWithKey(const std::string& key) const;
+
+        /**
+        * Adds the properties written or removed since the last call to
+        * changes and forgets about them. Inserting an object counts as a
+        * change of all its properties, replacing one as a change of the
+        * properties of both objects.
+        *
+        * Changes are only recorded from the first call on and there is a
+        * single set of them, so there should be a single caller which
+        * drains them regularly.
+        *
+        * @param changes The map to add the changes to.
+        */
+        void drainChanges(ChangeMap& changes);
+
         iterator           begin()          { return objects.begin(); }
         const_iterator     begin()    const { return objects.begin(); }
         iterator           end()            { return objects.end();   }
         const_iterator     end()      const { return objects.end();   }
 
-        iterator_map       beginMap()       { return objectMap.begin(); }
-        const_iterator_map beginMap() const { return objectMap.begin(); }
-        iterator_map       endMap()         { return objectMap.end();   }
-        const_iterator_map endMap()   const { return objectMap.end();   }
+        iterator_map       beginMap()       { return entries.begin(); }
+        const_iterator_map beginMap() const { return entries.begin(); }
+        iterator_map       endMap()         { return entries.end();   }
+        const_iterator_map endMap()   const { return entries.end();   }
 
         /**
         * Copies all data into a JSON::Object representation.
@@ -137,9 +255,74 @@ namespace spoac
         */
         std::string toJSONString();
 
+        /**
+        * Writes all data as a JSON object keyed by object id without
+        * copying it into a JSON::Object first, e.g. as a record of a
+        * JSON::RecordWriter.
+        *
+        * @param writer The writer to write the objects to.
+        */
+        void write(JSON::Writer& writer);
+
     protected:
-        SetType objects;
-        MapType objectMap;
+        /**
+        * Finds the bucket holding an id or the empty bucket it would be
+        * inserted into.
+        */
+        size_type findBucket(const std::string& id, size_t hash) const;
+
+        /**
+        * Doubles the number of buckets and inserts all slots again.
+        */
+        void grow();
+
+        /**
+        * Adds the object in a slot to the indexes of its properties.
+        */
+        void indexSlot(size_type slot);
+
+        /**
+        * Removes the object in a slot from all indexes.
+        */
+        void unindexSlot(size_type slot);
+
+        void keyInserted(Object& object, const std::string& key);
+        void keyErased(Object& object, const std::string& key);
+        void keyWritten(Object& object, const std::string& key);
+
+        /**
+        * Records all properties of an object in a slot as changed.
+        */
+        void objectChanged(size_type slot, Object& object);
+
+        /**
+        * Returns the slot of an object in the set or npos if the object
+        * with its id is a different one.
+        */
+        size_type findObject(Object& object) const;
+
+        /**
+        * Registers or removes the set as listener of all its objects.
+        */
+        void listen();
+        void unlisten();
+
+        VectorType objects;
+        MapType entries;
+
+        // the hash of the id in each slot, so growing does not hash again
+        std::vector<size_t> hashes;
+
+        // slot + 1 of the object in each bucket, 0 for empty buckets, the
+        // number of buckets is a power of two and at least twice the
+        // number of objects
+        std::vector<size_type> buckets;
+
+        typedef std::map<std::string, SlotSet> IndexMap;
+        IndexMap indexes;
+
+        bool tracking;
+        ChangeMap changes;
     };
 
     /**
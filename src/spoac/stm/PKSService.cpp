@@ -32,14 +32,17 @@ boost::shared_ptr<void> PKSService::createService(DependencyManagerPtr manager)
 {
     boost::shared_ptr<void> pksService(new PKSService(
         manager->getService<STM>(),
-        manager->getService<ice::IceHelper>()
+        manager->getService<ice::IceHelper>(),
+        manager->getService<LTMClient>()
     ));
     return pksService;
 }
 
-PKSService::PKSService(STMPtr stm, ice::IceHelperPtr iceHelper):
+PKSService::PKSService(STMPtr stm, ice::IceHelperPtr iceHelper,
+    LTMClientPtr ltmClient):
     stm(stm),
-    iceHelper(iceHelper)
+    iceHelper(iceHelper),
+    ltmClient(ltmClient)
 {
     if (iceHelper.get() != NULL)
     {
@@ -62,8 +65,7 @@ void PKSService::setGoal(const PlanningSlice::Goal& goal)
 
 void PKSService::sendScenario()
 {
-    LTMSlice::LTMPrx ltm =
-    iceHelper->getProxy<LTMSlice::LTMPrx>("LTM:tcp -p 10099");
+    LTMSlice::LTMPrx ltm = ltmClient->getProxy();
 
     SymbolDefinition symbols;
     symbols.predicates = currentScenario.predicates;
@@ -73,19 +75,17 @@ void PKSService::sendScenario()
 
     planner->setSymbolDefinitions(symbols);
 
+    // all definitions are retrieved in a single call
+    ActionDefinitionList definitions = ltm->getActions(currentScenario.oacs);
     ActionDefinitionList actions;
 
-    LTMSlice::NameList::const_iterator it;
+    ActionDefinitionList::const_iterator it;
 
-    for (it = currentScenario.oacs.begin();
-        it != currentScenario.oacs.end();
-        ++it)
+    for (it = definitions.begin(); it != definitions.end(); ++it)
     {
-        PlanningSlice::ActionDefinition action = ltm->getAction(*it);
-
-        if (!action.effect.empty() && !action.precondition.empty())
+        if (!it->effect.empty() && !it->precondition.empty())
         {
-            actions.push_back(action);
+            actions.push_back(*it);
         }
     }
 
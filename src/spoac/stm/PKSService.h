@@ -26,6 +26,7 @@
 
 #include <spoac/common/DependencyManager.h>
 #include <spoac/stm/STM.h>
+#include <spoac/stm/LTMClient.h>
 #include <spoac/ice/IceHelper.h>
 #include <spoac/LTM.h>
 
@@ -52,8 +53,13 @@ namespace spoac
         *
         * @param stm                   A pointer to the robot's short term
         *                              memory
+        * @param ltmClient             Provides the proxy of the long term
+        *                              memory
         */
-        PKSService(STMPtr stm, ice::IceHelperPtr iceHelper);
+        PKSService(STMPtr stm, ice::IceHelperPtr iceHelper,
+            LTMClientPtr ltmClient);
+
+        virtual ~PKSService() {}
 
         void setScenario(const LTMSlice::Scenario& scenario);
         void setGoal(const PlanningSlice::Goal& goal);
@@ -61,11 +67,17 @@ namespace spoac
         void sendScenario();
         void sendGoal();
 
-        void updateState(const PlanningSlice::StateUpdate& state);
+        /**
+        * Sends a state update to the planner, preceded by the scenario if
+        * the objects in the STM changed and by the goal if it has not
+        * been sent yet.
+        */
+        virtual void updateState(const PlanningSlice::StateUpdate& state);
 
     protected:
         STMPtr stm;
         ice::IceHelperPtr iceHelper;
+        LTMClientPtr ltmClient;
 
         size_t stmSize;
         bool sentGoal;
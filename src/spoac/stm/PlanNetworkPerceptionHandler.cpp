@@ -34,14 +34,19 @@ PerceptionHandlerPtr PlanNetworkPerceptionHandler::createInstance(
 {
     PerceptionHandlerPtr handler(new PlanNetworkPerceptionHandler(
         m->getService<ice::IceHelper>(),
-        m->getService<PKSService>()
+        m->getService<PKSService>(),
+        m->getService<STM>()
     ));
 
     return handler;
 }
 
 PlanNetworkPerceptionHandler::PlanNetworkPerceptionHandler(
-    ice::IceHelperPtr iceHelper, PKSServicePtr pksService) :
+    ice::IceHelperPtr iceHelper, PKSServicePtr pksService, STMPtr stm) :
+    weakSTM(stm),
+    sendFullState(true),
+    fullStateInterval(50),
+    statesUntilFullState(0),
     iceHelper(iceHelper),
     pksService(pksService),
     wait(5)
@@ -54,6 +59,14 @@ PlanNetworkPerceptionHandler::PlanNetworkPerceptionHandler(
     }
 }
 
+PlanNetworkPerceptionHandler::~PlanNetworkPerceptionHandler()
+{
+    predicates.clear();
+    functions.clear();
+
+    updateIndexes();
+}
+
 void PlanNetworkPerceptionHandler::setScenario(
     const spoac::LTMSlice::Scenario& scenario)
 {
@@ -61,82 +74,386 @@ void PlanNetworkPerceptionHandler::setScenario(
 
     predicates = scenario.predicates;
     functions = scenario.functions;
+
+    PlanningSlice::PredicateDefinitionList::const_iterator pred;
+    PlanningSlice::FunctionDefinitionList::const_iterator func;
+
+    predicatesByName.clear();
+    functionsByName.clear();
+
+    for (pred = predicates.begin(); pred != predicates.end(); ++pred)
+    {
+        predicatesByName[pred->name] = *pred;
+    }
+
+    for (func = functions.begin(); func != functions.end(); ++func)
+    {
+        functionsByName[func->name] = *func;
+    }
+
+    updateIndexes();
+
+    // the planner learns about the new scenario from a full state
+    sentPredicates.clear();
+    sentFunctions.clear();
+    changes.clear();
+    sendFullState = true;
+}
+
+void PlanNetworkPerceptionHandler::setFullStateInterval(int interval)
+{
+    fullStateInterval = interval;
+    statesUntilFullState = interval;
 }
 
 void PlanNetworkPerceptionHandler::update(spoac::STMPtr stm)
 {
-    if (wait <= 0)
+    // draining every update keeps the changes recorded by the stm small
+    stm->drainChanges(changes);
+
+    if (wait > 0)
     {
-        pksService->updateState(getState(stm));
+        wait--;
+        return;
+    }
+
+    PlanningSlice::StateUpdate state;
+
+    if (sendFullState || --statesUntilFullState <= 0)
+    {
+        state = getFullState(stm);
+
+        sendFullState = false;
+        statesUntilFullState = fullStateInterval;
     }
     else
     {
-        wait--;
+        state = getStateChanges(stm, changes);
+    }
+
+    changes.clear();
+
+    if (state.knownPredicates.empty() && state.unknownPredicates.empty() &&
+        state.knownFunctionValues.empty() &&
+        state.unknownFunctionValues.empty())
+    {
+        return;
     }
-}
 
+    try
+    {
+        pksService->updateState(state);
+    }
+    catch (...)
+    {
+        // the planner may have missed the changes, so it gets all of them
+        sendFullState = true;
+        throw;
+    }
+}
 
 PlanningSlice::StateUpdate PlanNetworkPerceptionHandler::getState(
     spoac::STMPtr stm)
+{
+    PredicateMap predicateValues;
+    FunctionMap functionValues;
+
+    return getState(stm, predicateValues, functionValues);
+}
+
+PlanningSlice::StateUpdate PlanNetworkPerceptionHandler::getState(
+    spoac::STMPtr stm,
+    PredicateMap& predicateValues,
+    FunctionMap& functionValues)
 {
     PlanningSlice::PredicateDefinitionList::const_iterator pred;
     PlanningSlice::FunctionDefinitionList::const_iterator func;
-    STM::iterator_map obj;
+    STM::SlotSet::const_iterator slot;
 
     PlanningSlice::StateUpdate state;
 
     for (pred = predicates.begin(); pred != predicates.end(); ++pred)
     {
-        for (obj = stm->beginMap(); obj != stm->endMap(); ++obj)
+        // the index only holds the objects which have the predicate, so
+        // the other objects are never visited
+        const STM::SlotSet& slots = stm->findWithKey(pred->name);
+
+        for (slot = slots.begin(); slot != slots.end(); ++slot)
         {
-            ObjectPtr object = *(obj->second);
+            const ObjectPtr& object = stm->at(*slot);
+            PlanningSlice::PredicateInstance p;
 
-            if (object->has_key(pred->name))
+            if (getPredicate(*pred, object, p))
             {
-                PlanningSlice::PredicateInstance p;
-                p.name = pred->name;
-
-                if (pred->arguments == 1)
-                {
-                    p.parameters.push_back(object->getId());
-                    p.value = object->get<bool>(pred->name);
-                    state.knownPredicates.push_back(p);
-                }
-                else if (pred->arguments == 2)
-                {
-                    std::pair<bool, std::string> relation =
-                        object->get<std::pair<bool, std::string> >(pred->name);
-
-                    p.parameters.push_back(object->getId());
-                    p.parameters.push_back(relation.second);
-                    p.value = relation.first;
-
-                    state.knownPredicates.push_back(p);
-                }
+                state.knownPredicates.push_back(p);
+                predicateValues[ValueKey(pred->name, object->getId())] = p;
             }
         }
     }
 
     for (func = functions.begin(); func != functions.end(); ++func)
     {
-        for (obj = stm->beginMap(); obj != stm->endMap(); ++obj)
+        const STM::SlotSet& slots = stm->findWithKey(func->name);
+
+        for (slot = slots.begin(); slot != slots.end(); ++slot)
         {
-            ObjectPtr object = *(obj->second);
+            const ObjectPtr& object = stm->at(*slot);
+            PlanningSlice::FunctionValue f;
 
-            if (object->has_key(func->name))
+            if (getFunctionValue(*func, object, f))
             {
-                PlanningSlice::FunctionValue f;
-                f.name = func->name;
-
-                if (func->arguments == 0)
-                {
-                    f.constantValue = object->get<std::string>(func->name);
-                    f.realValue = object->get<double>(func->name);
-                    state.knownFunctionValues.push_back(f);
-                }
+                state.knownFunctionValues.push_back(f);
+                functionValues[ValueKey(func->name, object->getId())] = f;
             }
         }
     }
 
     return state;
 }
+
+void PlanNetworkPerceptionHandler::updateIndexes()
+{
+    STMPtr stm = weakSTM.lock();
+
+    // the STM is being destroyed along with its handlers
+    if (!stm)
+    {
+        return;
+    }
+
+    std::set<std::string> keys;
+    PlanningSlice::PredicateDefinitionList::const_iterator pred;
+    PlanningSlice::FunctionDefinitionList::const_iterator func;
+    std::set<std::string>::const_iterator key;
+
+    for (pred = predicates.begin(); pred != predicates.end(); ++pred)
+    {
+        keys.insert(pred->name);
+    }
+
+    for (func = functions.begin(); func != functions.end(); ++func)
+    {
+        keys.insert(func->name);
+    }
+
+    for (key = indexedKeys.begin(); key != indexedKeys.end(); ++key)
+    {
+        if (keys.find(*key) == keys.end())
+        {
+            stm->removeIndex(*key);
+        }
+    }
+
+    std::set<std::string> added;
+
+    for (key = keys.begin(); key != keys.end(); ++key)
+    {
+        if (indexedKeys.find(*key) != indexedKeys.end() ||
+            ! stm->hasIndex(*key))
+        {
+            stm->addIndex(*key);
+            added.insert(*key);
+        }
+    }
+
+    indexedKeys.swap(added);
+}
+
+PlanningSlice::StateUpdate PlanNetworkPerceptionHandler::getStateChanges(
+    spoac::STMPtr stm,
+    const ObjectSet::ChangeMap& changes)
+{
+    ObjectSet::ChangeMap::const_iterator change;
+    std::set<std::string>::const_iterator key;
+
+    PlanningSlice::StateUpdate state;
+
+    for (change = changes.begin(); change != changes.end(); ++change)
+    {
+        const ObjectPtr& object = stm->at(change->first);
+
+        for (key = change->second.begin(); key != change->second.end(); ++key)
+        {
+            std::map<std::string, PlanningSlice::PredicateDefinition>::
+                const_iterator pred = predicatesByName.find(*key);
+
+            if (pred != predicatesByName.end())
+            {
+                addPredicateChange(pred->second, object, state);
+            }
+
+            std::map<std::string, PlanningSlice::FunctionDefinition>::
+                const_iterator func = functionsByName.find(*key);
+
+            if (func != functionsByName.end())
+            {
+                addFunctionChange(func->second, object, state);
+            }
+        }
+    }
+
+    return state;
+}
+
+PlanningSlice::StateUpdate PlanNetworkPerceptionHandler::getFullState(
+    spoac::STMPtr stm)
+{
+    PredicateMap predicateValues;
+    FunctionMap functionValues;
+
+    PlanningSlice::StateUpdate state =
+        getState(stm, predicateValues, functionValues);
+
+    // values the planner was told about before which are gone now
+    PredicateMap::const_iterator sentPredicate;
+    FunctionMap::const_iterator sentFunction;
+
+    for (sentPredicate = sentPredicates.begin();
+        sentPredicate != sentPredicates.end(); ++sentPredicate)
+    {
+        if (predicateValues.find(sentPredicate->first) == predicateValues.end())
+        {
+            state.unknownPredicates.push_back(sentPredicate->second);
+        }
+    }
+
+    for (sentFunction = sentFunctions.begin();
+        sentFunction != sentFunctions.end(); ++sentFunction)
+    {
+        if (functionValues.find(sentFunction->first) == functionValues.end())
+        {
+            state.unknownFunctionValues.push_back(sentFunction->second);
+        }
+    }
+
+    sentPredicates.swap(predicateValues);
+    sentFunctions.swap(functionValues);
+
+    return state;
+}
+
+bool PlanNetworkPerceptionHandler::getPredicate(
+    const PlanningSlice::PredicateDefinition& pred,
+    const ObjectPtr& object,
+    PlanningSlice::PredicateInstance& p)
+{
+    if ( ! object->has_key(pred.name))
+    {
+        return false;
+    }
+
+    p.name = pred.name;
+
+    if (pred.arguments == 1)
+    {
+        p.parameters.push_back(object->getId());
+        p.value = object->get<bool>(pred.name);
+        return true;
+    }
+    else if (pred.arguments == 2)
+    {
+        std::pair<bool, std::string> relation =
+            object->get<std::pair<bool, std::string> >(pred.name);
+
+        p.parameters.push_back(object->getId());
+        p.parameters.push_back(relation.second);
+        p.value = relation.first;
+        return true;
+    }
+
+    return false;
+}
+
+bool PlanNetworkPerceptionHandler::getFunctionValue(
+    const PlanningSlice::FunctionDefinition& func,
+    const ObjectPtr& object,
+    PlanningSlice::FunctionValue& f)
+{
+    if ( ! object->has_key(func.name) || func.arguments != 0)
+    {
+        return false;
+    }
+
+    f.name = func.name;
+    f.constantValue = object->get<std::string>(func.name);
+    f.realValue = object->get<double>(func.name);
+    return true;
+}
+
+void PlanNetworkPerceptionHandler::addPredicateChange(
+    const PlanningSlice::PredicateDefinition& pred,
+    const ObjectPtr& object,
+    PlanningSlice::StateUpdate& state)
+{
+    PredicateMap::iterator sent =
+        sentPredicates.find(ValueKey(pred.name, object->getId()));
+    PlanningSlice::PredicateInstance p;
+
+    if ( ! getPredicate(pred, object, p))
+    {
+        if (sent != sentPredicates.end())
+        {
+            state.unknownPredicates.push_back(sent->second);
+            sentPredicates.erase(sent);
+        }
+
+        return;
+    }
+
+    if (sent == sentPredicates.end())
+    {
+        sentPredicates[ValueKey(pred.name, object->getId())] = p;
+    }
+    else if (sent->second != p)
+    {
+        // a relation to another object replaces the one sent before
+        if (sent->second.parameters != p.parameters)
+        {
+            state.unknownPredicates.push_back(sent->second);
+        }
+
+        sent->second = p;
+    }
+    else
+    {
+        return;
+    }
+
+    state.knownPredicates.push_back(p);
+}
+
+void PlanNetworkPerceptionHandler::addFunctionChange(
+    const PlanningSlice::FunctionDefinition& func,
+    const ObjectPtr& object,
+    PlanningSlice::StateUpdate& state)
+{
+    FunctionMap::iterator sent =
+        sentFunctions.find(ValueKey(func.name, object->getId()));
+    PlanningSlice::FunctionValue f;
+
+    if ( ! getFunctionValue(func, object, f))
+    {
+        if (sent != sentFunctions.end())
+        {
+            state.unknownFunctionValues.push_back(sent->second);
+            sentFunctions.erase(sent);
+        }
+
+        return;
+    }
+
+    if (sent == sentFunctions.end())
+    {
+        sentFunctions[ValueKey(func.name, object->getId())] = f;
+    }
+    else if (sent->second != f)
+    {
+        sent->second = f;
+    }
+    else
+    {
+        return;
+    }
+
+    state.knownFunctionValues.push_back(f);
+}
@@ -24,6 +24,14 @@
 #ifndef SPOAC_STM_PLANNETWORKPERCEPTIONHANDLER
 #define SPOAC_STM_PLANNETWORKPERCEPTIONHANDLER
 
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+
+#include <boost/weak_ptr.hpp>
+
+#include <spoac/stm/ObjectSet.h>
 #include <spoac/stm/PerceptionHandler.h>
 #include <spoac/Planning.h>
 #include <spoac/ice/IceHelper.h>
@@ -31,6 +39,19 @@
 
 namespace spoac
 {
+    /**
+    * Sends the predicates and function values of the objects in the STM
+    * to the planner.
+    *
+    * After the first full state only the values which changed since the
+    * last state sent are published: new or changed ones as known values,
+    * removed ones as unknown values. Every few updates the full state is
+    * sent again in case the planner missed any.
+    *
+    * The STM indexes the objects by the predicates and functions of the
+    * scenario, so a full state only visits objects which have them. The
+    * indexes are dropped again along with the scenario.
+    */
     class PlanNetworkPerceptionHandler : public PerceptionHandler
     {
     public:
@@ -43,18 +64,134 @@ namespace spoac
 
         PlanNetworkPerceptionHandler(
             ice::IceHelperPtr iceHelper,
-            PKSServicePtr pksService);
+            PKSServicePtr pksService,
+            STMPtr stm);
+
+        /**
+        * Removes the indexes added for the scenario from the STM.
+        */
+        ~PlanNetworkPerceptionHandler();
 
         void update(spoac::STMPtr stm);
 
         void setScenario(const LTMSlice::Scenario& scenario);
 
+        /**
+        * Returns the values of all predicates and functions.
+        */
         PlanningSlice::StateUpdate getState(spoac::STMPtr stm);
 
+        /**
+        * Returns the values which differ from the last state returned by
+        * getStateChanges() or getFullState(), and remembers them as sent.
+        *
+        * @param stm     The STM the changes were drained from.
+        * @param changes The properties of objects which changed since.
+        */
+        PlanningSlice::StateUpdate getStateChanges(
+            spoac::STMPtr stm,
+            const ObjectSet::ChangeMap& changes);
+
+        /**
+        * Returns the values of all predicates and functions as known
+        * values, plus those sent before which no longer exist as unknown
+        * values, and remembers them as sent.
+        */
+        PlanningSlice::StateUpdate getFullState(spoac::STMPtr stm);
+
+        /**
+        * Sets after how many states sent to the planner the full state is
+        * sent again, 1 sends the full state every time.
+        */
+        void setFullStateInterval(int interval);
+
     protected:
+        /**
+        * Predicate or function name and object id of a value.
+        */
+        typedef std::pair<std::string, std::string> ValueKey;
+
+        typedef std::map<ValueKey, PlanningSlice::PredicateInstance>
+            PredicateMap;
+        typedef std::map<ValueKey, PlanningSlice::FunctionValue>
+            FunctionMap;
+
+        /**
+        * Returns the values of all predicates and functions and adds them
+        * to the given maps by name and object id.
+        */
+        PlanningSlice::StateUpdate getState(
+            spoac::STMPtr stm,
+            PredicateMap& predicateValues,
+            FunctionMap& functionValues);
+
+        /**
+        * Reads the value of a predicate from an object.
+        *
+        * @return False if the object does not have a value of it.
+        */
+        bool getPredicate(
+            const PlanningSlice::PredicateDefinition& pred,
+            const ObjectPtr& object,
+            PlanningSlice::PredicateInstance& p);
+
+        /**
+        * Reads the value of a function from an object.
+        *
+        * @return False if the object does not have a value of it.
+        */
+        bool getFunctionValue(
+            const PlanningSlice::FunctionDefinition& func,
+            const ObjectPtr& object,
+            PlanningSlice::FunctionValue& f);
+
+        /**
+        * Adds the value of a predicate or function of an object to state
+        * if it differs from the one sent before.
+        */
+        void addPredicateChange(
+            const PlanningSlice::PredicateDefinition& pred,
+            const ObjectPtr& object,
+            PlanningSlice::StateUpdate& state);
+        void addFunctionChange(
+            const PlanningSlice::FunctionDefinition& func,
+            const ObjectPtr& object,
+            PlanningSlice::StateUpdate& state);
+
         PlanningSlice::PredicateDefinitionList predicates;
         PlanningSlice::FunctionDefinitionList functions;
 
+        // the definitions by name, to look up those of changed properties
+        std::map<std::string, PlanningSlice::PredicateDefinition>
+            predicatesByName;
+        std::map<std::string, PlanningSlice::FunctionDefinition>
+            functionsByName;
+
+        // the values sent to the planner
+        PredicateMap sentPredicates;
+        FunctionMap sentFunctions;
+
+        /**
+        * Indexes the STM by the predicates and functions of the scenario,
+        * and removes the indexes added for the scenario before.
+        */
+        void updateIndexes();
+
+        // the STM is not kept alive by its own perception handler
+        boost::weak_ptr<STM> weakSTM;
+
+        // indexes added to the STM, those which existed before are left
+        std::set<std::string> indexedKeys;
+
+        // changes drained from the STM which were not sent yet
+        ObjectSet::ChangeMap changes;
+
+        // whether the next state sent is a full one, and how many states
+        // are sent until the next full one
+        bool sendFullState;
+        int fullStateInterval;
+        int statesUntilFullState;
+
         ice::IceHelperPtr iceHelper;
         PKSServicePtr pksService;
         PlanningSlice::PlanControllerTopicPrx planner;
@@ -42,6 +42,9 @@ namespace spoac
     * value types. These types must meet the BoundedType requirements:
     * http://www.boost.org/doc/libs/1_37_0/doc/html/variant/
     * reference.html#variant.concepts.bounded-type
+    *
+    * Derived classes can override keyInserted(), keyErased() and
+    * keyWritten() to be told about changes to the set of keys and values.
     */
     template <
         typename Key,
@@ -184,7 +187,13 @@ namespace spoac
         */
         VariantMap& operator=(const VariantMap& v)
         {
-            map = v.map;
+            if (this != &v)
+            {
+                keysErased();
+                map = v.map;
+                keysInserted();
+            }
+
             return *this;
         }
 
@@ -245,7 +254,59 @@ namespace spoac
             return find(key) != end();
         }
 
+    protected:
+        /**
+        * Called after a key was added to the map, by any of the modifying
+        * methods including operator[]. Does nothing by default.
+        */
+        virtual void keyInserted(const Key& key)
+        {
+        }
+
+        /**
+        * Called after a key was removed from the map. Does nothing by
+        * default.
+        */
+        virtual void keyErased(const Key& key)
+        {
+        }
+
+        /**
+        * Called when the value of a key may have been written: after a key
+        * was inserted and whenever operator[] returns a value, which can
+        * be assigned to. Values written through iterators are not
+        * reported. Does nothing by default.
+        */
+        virtual void keyWritten(const Key& key)
+        {
+        }
+
     private:
+        /**
+        * Calls keyInserted() for every key in the map.
+        */
+        void keysInserted()
+        {
+            const_iterator it;
+            for (it = begin(); it != end(); ++it)
+            {
+                keyInserted(it->first);
+                keyWritten(it->first);
+            }
+        }
+
+        /**
+        * Calls keyErased() for every key in the map.
+        */
+        void keysErased()
+        {
+            const_iterator it;
+            for (it = begin(); it != end(); ++it)
+            {
+                keyErased(it->first);
+            }
+        }
+
         /**
         * Internal instance of an STL map.
         */
@@ -266,7 +327,10 @@ namespace spoac
 
         void clear()
         {
-            map.clear();
+            while ( ! map.empty())
+            {
+                erase(map.begin());
+            }
         }
 
         size_type count(const Key& key) const
@@ -301,17 +365,29 @@ namespace spoac
 
         void erase(iterator pos)
         {
+            Key key = pos->first;
             map.erase(pos);
+            keyErased(key);
         }
 
         size_type erase(const Key& key)
         {
-            return map.erase(key);
+            size_type n = map.erase(key);
+
+            if (n != 0)
+            {
+                keyErased(key);
+            }
+
+            return n;
         }
 
         void erase(iterator first, iterator last)
         {
-            map.erase(first, last);
+            while (first != last)
+            {
+                erase(first++);
+            }
         }
 
         iterator find(const Key& key)
@@ -331,18 +407,38 @@ namespace spoac
 
         std::pair<iterator, bool> insert(const value_type& value)
         {
-            return map.insert(value);
+            std::pair<iterator, bool> result = map.insert(value);
+
+            if (result.second)
+            {
+                keyInserted(value.first);
+                keyWritten(value.first);
+            }
+
+            return result;
         }
 
         iterator insert(iterator pos, const value_type& value)
         {
-            return map.insert(pos, value);
+            size_type n = map.size();
+            iterator it = map.insert(pos, value);
+
+            if (map.size() != n)
+            {
+                keyInserted(value.first);
+                keyWritten(value.first);
+            }
+
+            return it;
         }
 
         template <typename InputIterator>
         void insert(InputIterator first, InputIterator last)
         {
-            map.insert<InputIterator>(first, last);
+            for (; first != last; ++first)
+            {
+                insert(*first);
+            }
         }
 
         key_compare key_comp() const
@@ -367,7 +463,17 @@ namespace spoac
 
         variant_type& operator[](const Key& key)
         {
-            return map[key];
+            iterator it = map.lower_bound(key);
+
+            if (it == map.end() || map.key_comp()(key, it->first))
+            {
+                it = map.insert(it, value_type(key, variant_type()));
+                keyInserted(key);
+            }
+
+            keyWritten(key);
+
+            return it->second;
         }
 
         reverse_iterator rbegin()
@@ -397,7 +503,13 @@ namespace spoac
 
         virtual void swap(VariantMap& other_map)
         {
+            keysErased();
+            other_map.keysErased();
+
             map.swap(other_map.map);
+
+            keysInserted();
+            other_map.keysInserted();
         }
 
         iterator upper_bound(const Key& key)
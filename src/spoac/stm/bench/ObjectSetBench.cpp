@@ -0,0 +1,417 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+/**
+* Compares the ObjectSet with the std::set and std::map of iterators it
+* used to be made of, for sets of 100, 10000 and 100000 objects.
+*
+* Usage: spoac_stm_bench [-t milliseconds] [-n objects[,objects...]]
+*
+* Every operation runs until -t milliseconds have passed and the time per
+* object is printed: inserting all objects into an empty set, looking up
+* every object by id, looking up ids which are not in the set, and
+* iterating over the objects and over the id view.
+*
+* Then the objects which have each of 20 properties, carried by one in 20
+* objects, are collected once by checking every object and once through
+* the indexes of the properties, the way predicates are extracted for the
+* planner.
+*/
+
+#include <spoac/stm/ObjectSet.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
+#include <sys/time.h>
+
+using namespace spoac;
+
+/**
+* The layout of the ObjectSet before objects were stored in slots.
+*/
+class TreeObjectSet
+{
+public:
+    typedef std::set<ObjectPtr> SetType;
+    typedef std::map<std::string, SetType::iterator> MapType;
+
+    void insert(ObjectPtr object)
+    {
+        std::pair<SetType::iterator, bool> result = objects.insert(object);
+        map[object->getId()] = result.first;
+    }
+
+    ObjectPtr get(const std::string& id)
+    {
+        MapType::iterator it = map.find(id);
+
+        if (it == map.end())
+        {
+            throw STMException("Object with id '" + id + "' does not exist.");
+        }
+
+        return *(it->second);
+    }
+
+    bool exists(const std::string& id) const
+    {
+        return map.find(id) != map.end();
+    }
+
+    SetType::const_iterator begin() const { return objects.begin(); }
+    SetType::const_iterator end() const { return objects.end(); }
+    MapType::const_iterator beginMap() const { return map.begin(); }
+    MapType::const_iterator endMap() const { return map.end(); }
+
+private:
+    SetType objects;
+    MapType map;
+};
+
+static double now()
+{
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/**
+* Keeps the optimizer from dropping the loops.
+*/
+static volatile size_t sink = 0;
+
+template <class Set>
+class Operations
+{
+public:
+    Operations(
+        const std::vector<ObjectPtr>& objects,
+        const std::vector<std::string>& ids,
+        const std::vector<std::string>& missing) :
+        objects(objects),
+        ids(ids),
+        missing(missing)
+    {
+        for (size_t i = 0; i < objects.size(); i++)
+        {
+            set.insert(objects[i]);
+        }
+    }
+
+    void insert()
+    {
+        Set s;
+
+        for (size_t i = 0; i < objects.size(); i++)
+        {
+            s.insert(objects[i]);
+        }
+    }
+
+    void get()
+    {
+        for (size_t i = 0; i < ids.size(); i++)
+        {
+            sink += set.get(ids[i]).get() != NULL;
+        }
+    }
+
+    void exists()
+    {
+        for (size_t i = 0; i < missing.size(); i++)
+        {
+            sink += set.exists(missing[i]);
+        }
+    }
+
+    void iterate()
+    {
+        const Set& s = set;
+
+        for (typeof(s.begin()) it = s.begin(); it != s.end(); ++it)
+        {
+            sink += it->get() != NULL;
+        }
+    }
+
+    void iterateMap()
+    {
+        const Set& s = set;
+
+        for (typeof(s.beginMap()) it = s.beginMap(); it != s.endMap(); ++it)
+        {
+            sink += (*(it->second)).get() != NULL;
+        }
+    }
+
+private:
+    const std::vector<ObjectPtr>& objects;
+    const std::vector<std::string>& ids;
+    const std::vector<std::string>& missing;
+    Set set;
+};
+
+/**
+* Runs an operation until the given time has passed and returns the
+* nanoseconds per object.
+*/
+template <class Set>
+double measure(
+    Operations<Set>& operations,
+    void (Operations<Set>::*operation)(),
+    size_t objects,
+    double milliseconds)
+{
+    size_t runs = 0;
+    double start = now();
+    double elapsed = 0;
+
+    do
+    {
+        (operations.*operation)();
+        runs++;
+        elapsed = now() - start;
+    }
+    while (elapsed * 1000 < milliseconds);
+
+    return elapsed * 1000000000.0 / (runs * objects);
+}
+
+template <class Set>
+void run(
+    const char* name,
+    const std::vector<ObjectPtr>& objects,
+    const std::vector<std::string>& ids,
+    const std::vector<std::string>& missing,
+    double milliseconds)
+{
+    Operations<Set> operations(objects, ids, missing);
+    size_t n = objects.size();
+
+    std::cout << std::setw(8) << n << std::setw(8) << name
+        << std::fixed << std::setprecision(1)
+        << std::setw(10) << measure(operations, &Operations<Set>::insert, n, milliseconds)
+        << std::setw(10) << measure(operations, &Operations<Set>::get, n, milliseconds)
+        << std::setw(10) << measure(operations, &Operations<Set>::exists, n, milliseconds)
+        << std::setw(10) << measure(operations, &Operations<Set>::iterate, n, milliseconds)
+        << std::setw(10) << measure(operations, &Operations<Set>::iterateMap, n, milliseconds)
+        << std::endl;
+}
+
+/**
+* Collects the objects having each of the properties by checking all
+* objects, or through the indexes of the properties.
+*/
+class KeyedOperations
+{
+public:
+    KeyedOperations(
+        const std::vector<ObjectPtr>& objects,
+        const std::vector<std::string>& keys) :
+        keys(keys)
+    {
+        for (size_t i = 0; i < objects.size(); i++)
+        {
+            set.insert(objects[i]);
+        }
+
+        for (size_t k = 0; k < keys.size(); k++)
+        {
+            set.addIndex(keys[k]);
+        }
+    }
+
+    void scan()
+    {
+        for (size_t k = 0; k < keys.size(); k++)
+        {
+            ObjectSet::const_iterator it;
+
+            for (it = set.begin(); it != set.end(); ++it)
+            {
+                if ((*it)->has_key(keys[k]))
+                {
+                    sink += it->get() != NULL;
+                }
+            }
+        }
+    }
+
+    void index()
+    {
+        for (size_t k = 0; k < keys.size(); k++)
+        {
+            const ObjectSet::SlotSet& slots = set.findWithKey(keys[k]);
+            ObjectSet::SlotSet::const_iterator slot;
+
+            for (slot = slots.begin(); slot != slots.end(); ++slot)
+            {
+                sink += set.at(*slot).get() != NULL;
+            }
+        }
+    }
+
+private:
+    const std::vector<std::string>& keys;
+    ObjectSet set;
+};
+
+/**
+* Runs a keyed operation until the given time has passed and returns the
+* microseconds per run.
+*/
+double measureKeyed(
+    KeyedOperations& operations,
+    void (KeyedOperations::*operation)(),
+    double milliseconds)
+{
+    size_t runs = 0;
+    double start = now();
+    double elapsed = 0;
+
+    do
+    {
+        (operations.*operation)();
+        runs++;
+        elapsed = now() - start;
+    }
+    while (elapsed * 1000 < milliseconds);
+
+    return elapsed * 1000000.0 / runs;
+}
+
+int main(int argc, char* argv[])
+{
+    double milliseconds = 500;
+    std::vector<size_t> sizes;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+        {
+            milliseconds = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+        {
+            std::istringstream list(argv[++i]);
+            std::string size;
+
+            while (std::getline(list, size, ','))
+            {
+                sizes.push_back(strtoul(size.c_str(), NULL, 10));
+            }
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                << " [-t milliseconds] [-n objects[,objects...]]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (sizes.empty())
+    {
+        sizes.push_back(100);
+        sizes.push_back(10000);
+        sizes.push_back(100000);
+    }
+
+    std::cout << "ns per object" << std::endl;
+    std::cout << std::setw(8) << "objects" << std::setw(8) << "set"
+        << std::setw(10) << "insert" << std::setw(10) << "get"
+        << std::setw(10) << "miss" << std::setw(10) << "iterate"
+        << std::setw(10) << "map" << std::endl;
+
+    for (size_t s = 0; s < sizes.size(); s++)
+    {
+        std::vector<ObjectPtr> objects;
+        std::vector<std::string> ids;
+        std::vector<std::string> missing;
+
+        for (size_t i = 0; i < sizes[s]; i++)
+        {
+            std::ostringstream id;
+            id << "object" << i;
+
+            objects.push_back(ObjectPtr(new Object("cup", id.str())));
+            ids.push_back(id.str());
+            missing.push_back(id.str() + "_missing");
+        }
+
+        // look the objects up in a different order than they were inserted
+        for (size_t i = ids.size(); i > 1; i--)
+        {
+            std::swap(ids[i - 1], ids[rand() % i]);
+        }
+
+        run<TreeObjectSet>("tree", objects, ids, missing, milliseconds);
+        run<ObjectSet>("slots", objects, ids, missing, milliseconds);
+    }
+
+    std::cout << std::endl << "us per collection of 20 properties" << std::endl;
+    std::cout << std::setw(8) << "objects"
+        << std::setw(10) << "scan" << std::setw(10) << "index" << std::endl;
+
+    for (size_t s = 0; s < sizes.size(); s++)
+    {
+        std::vector<ObjectPtr> objects;
+        std::vector<std::string> keys;
+
+        for (size_t k = 0; k < 20; k++)
+        {
+            std::ostringstream key;
+            key << "predicate" << k;
+            keys.push_back(key.str());
+        }
+
+        for (size_t i = 0; i < sizes[s]; i++)
+        {
+            std::ostringstream id;
+            id << "object" << i;
+
+            ObjectPtr object(new Object("cup", id.str()));
+            (*object)["color"] = std::string("red");
+            (*object)[keys[i % 20]] = true;
+
+            objects.push_back(object);
+        }
+
+        KeyedOperations operations(objects, keys);
+
+        std::cout << std::setw(8) << sizes[s]
+            << std::fixed << std::setprecision(1)
+            << std::setw(10) << measureKeyed(
+                operations, &KeyedOperations::scan, milliseconds)
+            << std::setw(10) << measureKeyed(
+                operations, &KeyedOperations::index, milliseconds)
+            << std::endl;
+    }
+
+    return 0;
+}
@@ -25,6 +25,7 @@
 #include <spoactest/test.h>
 
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <spoac/stm/ObjectSet.h>
 
@@ -75,3 +76,237 @@ BOOST_AUTO_TEST_CASE(testTwoElements)
     BOOST_CHECK_EQUAL(objects.exists("foo1"), true);
     BOOST_CHECK_EQUAL(objects.exists("foobar23"), false);
 }
+
+BOOST_AUTO_TEST_CASE(testReplace)
+{
+    spoac::ObjectPtr foo1(new spoac::Object("foo", "foo1"));
+    spoac::ObjectPtr bar1(new spoac::Object("bar", "bar1"));
+    spoac::ObjectPtr newFoo1(new spoac::Object("foo", "foo1"));
+
+    spoac::ObjectSet objects;
+
+    objects.insert(foo1);
+    objects.insert(bar1);
+    objects.insert(newFoo1);
+
+    // an object with the same id takes the place of the old one
+    BOOST_CHECK_EQUAL(objects.size(), 2);
+    BOOST_CHECK(objects["foo1"] == newFoo1);
+    BOOST_CHECK(*objects.begin() == newFoo1);
+    BOOST_CHECK(*(objects.beginMap()->second) == newFoo1);
+}
+
+BOOST_AUTO_TEST_CASE(testOrder)
+{
+    spoac::ObjectSet objects;
+    std::vector<std::string> ids;
+
+    ids.push_back("foo1");
+    ids.push_back("bar1");
+    ids.push_back("abc1");
+
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        objects.insert(spoac::ObjectPtr(new spoac::Object("foo", ids[i])));
+    }
+
+    // both views iterate in the order the objects were inserted
+    spoac::ObjectSet::const_iterator it = objects.begin();
+    spoac::ObjectSet::const_iterator_map entry = objects.beginMap();
+
+    for (size_t i = 0; i < ids.size(); i++, ++it, ++entry)
+    {
+        BOOST_CHECK_EQUAL((*it)->getId(), ids[i]);
+        BOOST_CHECK_EQUAL(entry->first, ids[i]);
+        BOOST_CHECK(*(entry->second) == *it);
+    }
+
+    BOOST_CHECK(it == objects.end());
+    BOOST_CHECK(entry == objects.endMap());
+}
+
+BOOST_AUTO_TEST_CASE(testSlots)
+{
+    spoac::ObjectSet objects;
+
+    objects.insert(spoac::ObjectPtr(new spoac::Object("foo", "foo0")));
+    spoac::ObjectSet::size_type slot = objects.find("foo0");
+
+    BOOST_CHECK_EQUAL(objects.find("missing"), spoac::ObjectSet::npos);
+
+    // slots do not change while the index grows
+    for (int i = 1; i < 1000; i++)
+    {
+        std::ostringstream id;
+        id << "foo" << i;
+        objects.insert(spoac::ObjectPtr(new spoac::Object("foo", id.str())));
+    }
+
+    BOOST_CHECK_EQUAL(objects.size(), 1000);
+    BOOST_CHECK_EQUAL(objects.find("foo0"), slot);
+    BOOST_CHECK_EQUAL(objects.at(slot)->getId(), "foo0");
+
+    for (int i = 0; i < 1000; i++)
+    {
+        std::ostringstream id;
+        id << "foo" << i;
+        BOOST_REQUIRE(objects.exists(id.str()));
+        BOOST_CHECK_EQUAL(objects[id.str()]->getId(), id.str());
+    }
+
+    BOOST_CHECK( ! objects.exists("foo1000"));
+}
+
+BOOST_AUTO_TEST_CASE(testAssignment)
+{
+    spoac::ObjectPtr foo1(new spoac::Object("foo", "foo1"));
+    spoac::Object other("bar", "bar1");
+
+    {
+        spoac::ObjectSet objects;
+        objects.insert(foo1);
+        objects.addIndex("red");
+
+        spoac::Object update("foo", "foo1");
+        update["red"] = true;
+
+        *foo1 = update;
+
+        BOOST_CHECK(objects.get("foo1") == foo1);
+        BOOST_CHECK_EQUAL(objects.findWithKey("red").size(), 1);
+
+        // the set could no longer find an object with another id
+        BOOST_CHECK_THROW(*foo1 = other, STMException);
+        BOOST_CHECK_EQUAL(foo1->getId(), "foo1");
+        BOOST_CHECK_EQUAL(foo1->getName(), "foo");
+        BOOST_CHECK(objects.get("foo1") == foo1);
+    }
+
+    // once the set is gone any object can be assigned
+    *foo1 = other;
+    BOOST_CHECK_EQUAL(foo1->getId(), "bar1");
+}
+
+BOOST_AUTO_TEST_CASE(testIndex)
+{
+    spoac::ObjectPtr foo1(new spoac::Object("foo", "foo1"));
+    spoac::ObjectPtr foo2(new spoac::Object("foo", "foo2"));
+    spoac::ObjectPtr foo3(new spoac::Object("foo", "foo3"));
+
+    (*foo1)["red"] = true;
+    (*foo3)["red"] = true;
+
+    spoac::ObjectSet objects;
+    objects.insert(foo1);
+    objects.insert(foo2);
+
+    BOOST_CHECK( ! objects.hasIndex("red"));
+    BOOST_CHECK_THROW(objects.findWithKey("red"), STMException);
+
+    // objects already in the set are indexed, as are new ones
+    objects.addIndex("red");
+    objects.insert(foo3);
+
+    BOOST_CHECK(objects.hasIndex("red"));
+
+    const spoac::ObjectSet::SlotSet& red = objects.findWithKey("red");
+    BOOST_REQUIRE_EQUAL(red.size(), 2);
+    BOOST_CHECK(objects.at(*red.begin()) == foo1);
+    BOOST_CHECK(objects.at(*red.rbegin()) == foo3);
+
+    // writing properties of objects in the set updates the index
+    (*foo2)["red"] = false;
+    foo1->erase("red");
+
+    BOOST_REQUIRE_EQUAL(red.size(), 2);
+    BOOST_CHECK(objects.at(*red.begin()) == foo2);
+    BOOST_CHECK(objects.at(*red.rbegin()) == foo3);
+
+    // a replaced object is no longer watched
+    spoac::ObjectPtr newFoo3(new spoac::Object("foo", "foo3"));
+    objects.insert(newFoo3);
+
+    BOOST_CHECK_EQUAL(red.size(), 1);
+    (*foo3)["blue"] = true;
+    (*newFoo3)["red"] = true;
+    BOOST_CHECK_EQUAL(red.size(), 2);
+
+    // a copy keeps its own index
+    {
+        spoac::ObjectSet copy(objects);
+        foo2->clear();
+
+        BOOST_CHECK_EQUAL(copy.findWithKey("red").size(), 1);
+        BOOST_CHECK_EQUAL(red.size(), 1);
+    }
+
+    (*foo1)["red"] = true;
+    BOOST_CHECK_EQUAL(red.size(), 2);
+
+    objects.removeIndex("red");
+    objects.removeIndex("blue");
+
+    BOOST_CHECK( ! objects.hasIndex("red"));
+    BOOST_CHECK_THROW(objects.findWithKey("red"), STMException);
+
+    // objects written afterwards no longer touch the index
+    (*foo1)["red"] = false;
+    objects.insert(spoac::ObjectPtr(new spoac::Object("foo", "foo4")));
+}
+
+BOOST_AUTO_TEST_CASE(testChanges)
+{
+    spoac::ObjectPtr foo1(new spoac::Object("foo", "foo1"));
+    spoac::ObjectPtr foo2(new spoac::Object("foo", "foo2"));
+
+    (*foo1)["red"] = true;
+
+    spoac::ObjectSet objects;
+    spoac::ObjectSet::ChangeMap changes;
+
+    // nothing is recorded before the changes are drained the first time
+    objects.insert(foo1);
+    objects.drainChanges(changes);
+    BOOST_CHECK(changes.empty());
+
+    (*foo1)["red"] = false;
+    (*foo1)["blue"] = true;
+    objects.insert(foo2);
+
+    objects.drainChanges(changes);
+
+    BOOST_REQUIRE_EQUAL(changes.size(), 2);
+    BOOST_CHECK_EQUAL(changes[0].size(), 2);
+    BOOST_CHECK_EQUAL(changes[0].count("red"), 1);
+    BOOST_CHECK_EQUAL(changes[0].count("blue"), 1);
+    BOOST_CHECK(changes[1].empty());
+
+    // drained changes are not reported again, new ones are added
+    foo1->erase("blue");
+    (*foo2)["green"] = true;
+
+    objects.drainChanges(changes);
+
+    BOOST_REQUIRE_EQUAL(changes.size(), 2);
+    BOOST_CHECK_EQUAL(changes[0].size(), 2);
+    BOOST_CHECK_EQUAL(changes[1].count("green"), 1);
+
+    // replacing an object changes the properties of both
+    spoac::ObjectPtr newFoo1(new spoac::Object("foo", "foo1"));
+    (*newFoo1)["yellow"] = true;
+
+    changes.clear();
+    objects.insert(newFoo1);
+    (*foo1)["red"] = true;
+
+    objects.drainChanges(changes);
+
+    BOOST_REQUIRE_EQUAL(changes.size(), 1);
+    BOOST_CHECK_EQUAL(changes[0].size(), 2);
+    BOOST_CHECK_EQUAL(changes[0].count("red"), 1);
+    BOOST_CHECK_EQUAL(changes[0].count("yellow"), 1);
+
+    changes.clear();
+    objects.drainChanges(changes);
+    BOOST_CHECK(changes.empty());
+}
@@ -28,6 +28,32 @@
 #include <vector>
 #include <spoac/stm/Object.h>
 
+/**
+* Records the properties added to and removed from objects, and those
+* written separately.
+*/
+class KeyRecorder : public spoac::ObjectListener
+{
+public:
+    void keyInserted(spoac::Object& object, const std::string& key)
+    {
+        events.push_back("+" + key);
+    }
+
+    void keyErased(spoac::Object& object, const std::string& key)
+    {
+        events.push_back("-" + key);
+    }
+
+    void keyWritten(spoac::Object& object, const std::string& key)
+    {
+        writes.push_back(key);
+    }
+
+    std::vector<std::string> events;
+    std::vector<std::string> writes;
+};
+
 BOOST_AUTO_TEST_CASE(testEmptyObject)
 {
     spoac::Object object("foo", "foo1");
@@ -90,3 +116,111 @@ BOOST_AUTO_TEST_CASE(testJSON)
 "\t]\n"
 "}");
 }
+
+BOOST_AUTO_TEST_CASE(testAppendKey)
+{
+    spoac::Object object("foo", "foo1");
+    object["bar"] = std::string("bar");
+    object["foobar"] = 1337;
+
+    std::string key;
+    object.appendKey(key);
+
+    spoac::Object equal("foo", "foo1");
+    equal["foobar"] = 1337;
+    equal["bar"] = std::string("bar");
+
+    std::string equalKey;
+    equal.appendKey(equalKey);
+    BOOST_CHECK(key == equalKey);
+
+    // a changed property or id changes the key
+    equal["foobar"] = 1338;
+    equalKey.clear();
+    equal.appendKey(equalKey);
+    BOOST_CHECK(key != equalKey);
+
+    spoac::Object other("foo", "foo2");
+    other["bar"] = std::string("bar");
+    other["foobar"] = 1337;
+
+    std::string otherKey;
+    other.appendKey(otherKey);
+    BOOST_CHECK(key != otherKey);
+
+    // keys are appended, not replaced
+    size_t length = otherKey.size();
+    other.appendKey(otherKey);
+    BOOST_CHECK_EQUAL(2 * length, otherKey.size());
+}
+
+BOOST_AUTO_TEST_CASE(testListener)
+{
+    spoac::Object object("foo", "foo1");
+    KeyRecorder recorder;
+
+    object.addListener(&recorder);
+
+    object["bar"] = 1;
+    BOOST_REQUIRE_EQUAL(recorder.events.size(), 1);
+    BOOST_CHECK_EQUAL(recorder.events[0], "+bar");
+
+    // changing a value does not change the keys
+    object["bar"] = 2;
+    object.insert(std::make_pair(std::string("bar"), spoac::Object::variant_type(3)));
+    BOOST_CHECK_EQUAL(recorder.events.size(), 1);
+    BOOST_CHECK_EQUAL(object.get<int>("bar"), 2);
+
+    object.insert(std::make_pair(std::string("foobar"), spoac::Object::variant_type(3)));
+    object.erase("bar");
+    object.erase("bar");
+    object["baz"] = true;
+    object.clear();
+
+    BOOST_REQUIRE_EQUAL(recorder.events.size(), 6);
+    BOOST_CHECK_EQUAL(recorder.events[1], "+foobar");
+    BOOST_CHECK_EQUAL(recorder.events[2], "-bar");
+    BOOST_CHECK_EQUAL(recorder.events[3], "+baz");
+    BOOST_CHECK_EQUAL(recorder.events[4], "-baz");
+    BOOST_CHECK_EQUAL(recorder.events[5], "-foobar");
+
+    // copies do not share the listeners, assignment replaces all keys
+    object["bar"] = 1;
+    recorder.events.clear();
+
+    spoac::Object copy(object);
+    copy["baz"] = 2;
+    BOOST_CHECK(recorder.events.empty());
+
+    object = copy;
+    BOOST_REQUIRE_EQUAL(recorder.events.size(), 3);
+    BOOST_CHECK_EQUAL(recorder.events[0], "-bar");
+    BOOST_CHECK_EQUAL(recorder.events[1], "+bar");
+    BOOST_CHECK_EQUAL(recorder.events[2], "+baz");
+
+    object.removeListener(&recorder);
+    object["foo"] = 1;
+    BOOST_CHECK_EQUAL(recorder.events.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(testWrites)
+{
+    spoac::Object object("foo", "foo1");
+    KeyRecorder recorder;
+
+    object.addListener(&recorder);
+
+    object["bar"] = 1;
+    object["baz"] = 2;
+
+    // operator[] may write, get() does not
+    object["bar"] = 3;
+    object.get<int>("baz");
+
+    object.erase("baz");
+
+    BOOST_REQUIRE_EQUAL(recorder.writes.size(), 3);
+    BOOST_CHECK_EQUAL(recorder.writes[0], "bar");
+    BOOST_CHECK_EQUAL(recorder.writes[1], "baz");
+    BOOST_CHECK_EQUAL(recorder.writes[2], "bar");
+}
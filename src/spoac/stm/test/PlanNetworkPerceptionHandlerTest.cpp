@@ -27,16 +27,19 @@
 #include <iostream>
 #include <spoac/stm/PlanNetworkPerceptionHandler.h>
 #include <spoac/stm/STM.h>
+#include <spoac/common/Exception.h>
+#include "RecordingPKSService.h"
 
 BOOST_AUTO_TEST_CASE(testEmpty)
 {
     spoac::STMPtr stm(new spoac::STM());
     spoac::PKSServicePtr pks(new spoac::PKSService(
-        stm, spoac::ice::IceHelperPtr()));
+        stm, spoac::ice::IceHelperPtr(), spoac::LTMClientPtr()));
     spoac::PlanNetworkPerceptionHandlerPtr controller(
         new spoac::PlanNetworkPerceptionHandler(
             spoac::ice::IceHelperPtr(),
-            pks));
+            pks,
+            stm));
 
     spoac::ObjectPtr obj(new spoac::Object("obj1", "obj1"));
     (*obj)["pred1"] = "foo";
@@ -67,3 +70,280 @@ BOOST_AUTO_TEST_CASE(testEmpty)
     BOOST_CHECK_EQUAL(state.knownPredicates.size(), 1);
     BOOST_CHECK_EQUAL(state.knownFunctionValues.size(), 1);
 }
+
+BOOST_AUTO_TEST_CASE(testPropertyChanges)
+{
+    spoac::STMPtr stm(new spoac::STM());
+    spoac::PKSServicePtr pks(new spoac::PKSService(
+        stm, spoac::ice::IceHelperPtr(), spoac::LTMClientPtr()));
+    spoac::PlanNetworkPerceptionHandlerPtr controller(
+        new spoac::PlanNetworkPerceptionHandler(
+            spoac::ice::IceHelperPtr(),
+            pks,
+            stm));
+
+    spoac::ObjectPtr cup1(new spoac::Object("cup", "cup1"));
+    spoac::ObjectPtr cup2(new spoac::Object("cup", "cup2"));
+    spoac::ObjectPtr table(new spoac::Object("table", "table1"));
+
+    (*cup2)["clean"] = true;
+    (*cup1)["clean"] = false;
+
+    stm->insert(cup1);
+    stm->insert(cup2);
+    stm->insert(table);
+
+    spoac::PlanningSlice::PredicateDefinition clean;
+    clean.name = "clean";
+    clean.arguments = 1;
+
+    spoac::LTMSlice::Scenario scenario;
+    scenario.predicates.push_back(clean);
+
+    controller->setScenario(scenario);
+
+    spoac::PlanningSlice::StateUpdate state = controller->getState(stm);
+
+    // objects are visited in the order they were inserted into the stm
+    BOOST_REQUIRE_EQUAL(state.knownPredicates.size(), 2);
+    BOOST_CHECK_EQUAL(state.knownPredicates[0].parameters[0], "cup1");
+    BOOST_CHECK_EQUAL(state.knownPredicates[0].value, false);
+    BOOST_CHECK_EQUAL(state.knownPredicates[1].parameters[0], "cup2");
+    BOOST_CHECK_EQUAL(state.knownPredicates[1].value, true);
+
+    // properties written after the first update are found as well
+    cup1->erase("clean");
+    (*table)["clean"] = true;
+
+    state = controller->getState(stm);
+
+    BOOST_REQUIRE_EQUAL(state.knownPredicates.size(), 2);
+    BOOST_CHECK_EQUAL(state.knownPredicates[0].parameters[0], "cup2");
+    BOOST_CHECK_EQUAL(state.knownPredicates[1].parameters[0], "table1");
+}
+
+BOOST_AUTO_TEST_CASE(testStateChanges)
+{
+    spoac::STMPtr stm(new spoac::STM());
+    spoac::PKSServicePtr pks(new spoac::PKSService(
+        stm, spoac::ice::IceHelperPtr(), spoac::LTMClientPtr()));
+    spoac::PlanNetworkPerceptionHandlerPtr controller(
+        new spoac::PlanNetworkPerceptionHandler(
+            spoac::ice::IceHelperPtr(),
+            pks,
+            stm));
+
+    spoac::ObjectPtr cup(new spoac::Object("cup", "cup1"));
+    spoac::ObjectPtr table(new spoac::Object("table", "table1"));
+
+    (*cup)["clean"] = true;
+    (*cup)["on"] = std::make_pair(true, std::string("table1"));
+    (*table)["height"] = 0.7;
+
+    stm->insert(cup);
+    stm->insert(table);
+
+    spoac::PlanningSlice::PredicateDefinition clean;
+    clean.name = "clean";
+    clean.arguments = 1;
+
+    spoac::PlanningSlice::PredicateDefinition on;
+    on.name = "on";
+    on.arguments = 2;
+
+    spoac::PlanningSlice::FunctionDefinition height;
+    height.name = "height";
+    height.arguments = 0;
+
+    spoac::LTMSlice::Scenario scenario;
+    scenario.predicates.push_back(clean);
+    scenario.predicates.push_back(on);
+    scenario.functions.push_back(height);
+
+    controller->setScenario(scenario);
+
+    spoac::ObjectSet::ChangeMap changes;
+    stm->drainChanges(changes);
+
+    spoac::PlanningSlice::StateUpdate state = controller->getFullState(stm);
+
+    BOOST_CHECK_EQUAL(state.knownPredicates.size(), 2);
+    BOOST_CHECK_EQUAL(state.knownFunctionValues.size(), 1);
+    BOOST_CHECK(state.unknownPredicates.empty());
+
+    // unchanged values and unrelated properties are not sent again
+    (*cup)["clean"] = true;
+    (*cup)["color"] = std::string("red");
+    (*table)["height"] = 0.7;
+
+    changes.clear();
+    stm->drainChanges(changes);
+    BOOST_CHECK_EQUAL(changes.size(), 2);
+
+    state = controller->getStateChanges(stm, changes);
+
+    BOOST_CHECK(state.knownPredicates.empty());
+    BOOST_CHECK(state.unknownPredicates.empty());
+    BOOST_CHECK(state.knownFunctionValues.empty());
+
+    // changed values are known, removed ones unknown and a relation to
+    // another object replaces the previous one
+    (*cup)["clean"] = false;
+    (*cup)["on"] = std::make_pair(true, std::string("shelf1"));
+    table->erase("height");
+
+    changes.clear();
+    stm->drainChanges(changes);
+
+    state = controller->getStateChanges(stm, changes);
+
+    BOOST_REQUIRE_EQUAL(state.knownPredicates.size(), 2);
+    BOOST_CHECK_EQUAL(state.knownPredicates[0].name, "clean");
+    BOOST_CHECK_EQUAL(state.knownPredicates[0].value, false);
+    BOOST_CHECK_EQUAL(state.knownPredicates[1].name, "on");
+    BOOST_CHECK_EQUAL(state.knownPredicates[1].parameters[1], "shelf1");
+
+    BOOST_REQUIRE_EQUAL(state.unknownPredicates.size(), 1);
+    BOOST_CHECK_EQUAL(state.unknownPredicates[0].parameters[1], "table1");
+
+    BOOST_CHECK(state.knownFunctionValues.empty());
+    BOOST_CHECK_EQUAL(state.unknownFunctionValues.size(), 1);
+
+    // the full state has all current values and none which are gone
+    state = controller->getFullState(stm);
+
+    BOOST_CHECK_EQUAL(state.knownPredicates.size(), 2);
+    BOOST_CHECK(state.knownFunctionValues.empty());
+    BOOST_CHECK(state.unknownPredicates.empty());
+    BOOST_CHECK(state.unknownFunctionValues.empty());
+}
+
+BOOST_AUTO_TEST_CASE(testIndexes)
+{
+    spoac::STMPtr stm(new spoac::STM());
+    spoac::PKSServicePtr pks(new spoac::PKSService(
+        stm, spoac::ice::IceHelperPtr(), spoac::LTMClientPtr()));
+    spoac::PlanNetworkPerceptionHandlerPtr controller(
+        new spoac::PlanNetworkPerceptionHandler(
+            spoac::ice::IceHelperPtr(),
+            pks,
+            stm));
+
+    // indexes added by someone else are left alone
+    stm->addIndex("on");
+
+    spoac::PlanningSlice::PredicateDefinition clean;
+    clean.name = "clean";
+    clean.arguments = 1;
+
+    spoac::PlanningSlice::PredicateDefinition on;
+    on.name = "on";
+    on.arguments = 2;
+
+    spoac::PlanningSlice::FunctionDefinition height;
+    height.name = "height";
+    height.arguments = 0;
+
+    spoac::LTMSlice::Scenario first;
+    first.predicates.push_back(clean);
+    first.predicates.push_back(on);
+
+    controller->setScenario(first);
+
+    BOOST_CHECK(stm->hasIndex("clean"));
+    BOOST_CHECK(stm->hasIndex("on"));
+
+    spoac::LTMSlice::Scenario second;
+    second.functions.push_back(height);
+
+    controller->setScenario(second);
+
+    BOOST_CHECK( ! stm->hasIndex("clean"));
+    BOOST_CHECK(stm->hasIndex("on"));
+    BOOST_CHECK(stm->hasIndex("height"));
+
+    controller.reset();
+
+    BOOST_CHECK( ! stm->hasIndex("height"));
+    BOOST_CHECK(stm->hasIndex("on"));
+}
+
+BOOST_AUTO_TEST_CASE(testUpdate)
+{
+    spoac::STMPtr stm(new spoac::STM());
+    boost::shared_ptr<spoactest::RecordingPKSService> pks(
+        new spoactest::RecordingPKSService(stm));
+    spoac::PlanNetworkPerceptionHandlerPtr controller(
+        new spoac::PlanNetworkPerceptionHandler(
+            spoac::ice::IceHelperPtr(),
+            pks,
+            stm));
+
+    spoac::ObjectPtr cup1(new spoac::Object("cup", "cup1"));
+    spoac::ObjectPtr cup2(new spoac::Object("cup", "cup2"));
+
+    (*cup1)["clean"] = true;
+    (*cup2)["clean"] = true;
+
+    stm->insert(cup1);
+    stm->insert(cup2);
+
+    spoac::PlanningSlice::PredicateDefinition clean;
+    clean.name = "clean";
+    clean.arguments = 1;
+
+    spoac::LTMSlice::Scenario scenario;
+    scenario.predicates.push_back(clean);
+
+    controller->setFullStateInterval(3);
+    controller->setScenario(scenario);
+
+    // nothing is sent for the first few updates of a scenario
+    for (int i = 0; i < 5; i++)
+    {
+        controller->update(stm);
+    }
+
+    BOOST_CHECK(pks->states.empty());
+
+    // then the full state
+    controller->update(stm);
+
+    BOOST_REQUIRE_EQUAL(pks->states.size(), 1);
+    BOOST_CHECK_EQUAL(pks->states[0].knownPredicates.size(), 2);
+
+    // updates without changes are not sent
+    controller->update(stm);
+
+    BOOST_CHECK_EQUAL(pks->states.size(), 1);
+
+    (*cup1)["clean"] = false;
+    controller->update(stm);
+
+    BOOST_REQUIRE_EQUAL(pks->states.size(), 2);
+    BOOST_REQUIRE_EQUAL(pks->states[1].knownPredicates.size(), 1);
+    BOOST_CHECK_EQUAL(pks->states[1].knownPredicates[0].parameters[0],
+        "cup1");
+    BOOST_CHECK_EQUAL(pks->states[1].knownPredicates[0].value, false);
+
+    // every third state is a full one, even without changes
+    controller->update(stm);
+
+    BOOST_REQUIRE_EQUAL(pks->states.size(), 3);
+    BOOST_CHECK_EQUAL(pks->states[2].knownPredicates.size(), 2);
+
+    // the changes are lost when the planner cannot be reached
+    (*cup2)["clean"] = false;
+    pks->fail = true;
+
+    BOOST_CHECK_THROW(controller->update(stm), spoac::Exception);
+    BOOST_CHECK_EQUAL(pks->states.size(), 3);
+
+    // so the next update is the full state again
+    pks->fail = false;
+    controller->update(stm);
+
+    BOOST_REQUIRE_EQUAL(pks->states.size(), 4);
+    BOOST_REQUIRE_EQUAL(pks->states[3].knownPredicates.size(), 2);
+    BOOST_CHECK_EQUAL(pks->states[3].knownPredicates[1].value, false);
+}
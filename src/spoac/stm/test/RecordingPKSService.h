@@ -0,0 +1,53 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+namespace spoactest
+{
+    /**
+    * Records the state updates meant for the planner instead of sending
+    * them, or fails like an unreachable planner.
+    */
+    class RecordingPKSService : public spoac::PKSService
+    {
+    public:
+        RecordingPKSService(spoac::STMPtr stm) :
+            spoac::PKSService(stm, spoac::ice::IceHelperPtr(),
+                spoac::LTMClientPtr()),
+            fail(false)
+        {
+        }
+
+        void updateState(const spoac::PlanningSlice::StateUpdate& state)
+        {
+            if (fail)
+            {
+                throw spoac::Exception("The planner is unreachable");
+            }
+
+            states.push_back(state);
+        }
+
+        std::vector<spoac::PlanningSlice::StateUpdate> states;
+        bool fail;
+    };
+}
@@ -0,0 +1,66 @@
+/**
+* This file is part of SPOAC.
+*
+* SPOAC is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* SPOAC is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    SPOAC
+* @author     Nils Adermann <naderman at naderman dot de>
+* @copyright  2010 Nils Adermann
+* @license    http://www.gnu.org/licenses/gpl.txt
+*             GNU General Public License
+*/
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include <stdlib.h>
+
+namespace spoactest
+{
+    /**
+    * A directory of its own below /tmp, which is removed with all files
+    * in it once the test is done.
+    */
+    struct TemporaryDirectory
+    {
+        TemporaryDirectory(const std::string& prefix)
+        {
+            std::string pattern = "/tmp/" + prefix + "_XXXXXX";
+            std::vector<char> dir(pattern.begin(), pattern.end());
+            dir.push_back('\0');
+
+            root = mkdtemp(&dir[0]);
+        }
+
+        ~TemporaryDirectory()
+        {
+            boost::filesystem::remove_all(root);
+        }
+
+        /**
+        * Creates or replaces a file.
+        */
+        static void write(
+            const boost::filesystem::path& path,
+            const std::string& contents)
+        {
+            std::ofstream file(path.string().c_str());
+            file << contents;
+        }
+
+        boost::filesystem::path root;
+    };
+}